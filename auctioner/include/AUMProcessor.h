@@ -41,6 +41,7 @@
 #include "FieldDefManager.h"
 #include "AuctionProcessObject.h"
 #include "EventSchedulerAuctioner.h"
+#include "IntervalIndex.h"
 
 namespace auction
 {
@@ -87,6 +88,10 @@ typedef map<int, auctionProcess>            auctionProcessList_t;
 typedef map<int, auctionProcess>::iterator  auctionProcessListIter_t;
 typedef  map<int, auctionProcess>::reverse_iterator  auctionProcessListRevIter_t;
 
+//! start and stop of the auctions of every resource
+typedef map<string, IntervalIndex>            resourceIntervalIndex_t;
+typedef map<string, IntervalIndex>::iterator  resourceIntervalIndexIter_t;
+
 typedef map< agentFieldSet_t, set<ipap_field_key> >  		  setFieldsList_t;
 typedef map< agentFieldSet_t, set<ipap_field_key> >::iterator  setFieldsListIter_t;
 
@@ -109,13 +114,18 @@ class AUMProcessor : public AuctionManagerComponent, public IpApMessageParser, p
 
     //! action of every auction being processed.
     auctionProcessList_t  auctions;
+
+    //! auctions being processed indexed by resource and time, the same as auctions.
+    resourceIntervalIndex_t auctionIntervals;
 	
 	miscList_t readMiscData( ipap_template *templ, ipap_data_record &record);
 	
-	bool intersects( time_t startDttmAuc, time_t stopDttmAuc, 
-					 time_t startDttmReq, time_t stopDttmReq );
-	
-	bool forResource(string resourceAuc, string resourceIdReq);
+	/*! \short  find the auctions of a resource running within a period
+		\arg \c resourceId - resource requested, any for all of them
+		\arg \c ids - receives the ids of the auctions, sorted
+	*/
+	void findAuctions(const string &resourceId, time_t startDttm, time_t stopDttm, 
+					  vector<int> &ids);
 	
   public:
 
@@ -34,15 +34,51 @@
 #include "Error.h"
 #include "Logger.h"
 #include "aqueue.h"
+#include "EventHandoff.h"
+#include "BiddingObjectManager.h"
+#include "TokenBucket.h"
 
 namespace auction
 {
 
 
+//! events taken from the anslp queue and not processed yet.
+typedef deque<anslp::AnslpEvent *>            anslpEventQueue_t;
+typedef deque<anslp::AnslpEvent *>::iterator  anslpEventQueueIter_t;
+
+//! rate of the bidding messages admitted for each session, by session id.
+typedef map<string, TokenBucket>							sessionBucketList_t;
+typedef map<string, TokenBucket>::iterator				sessionBucketListIter_t;
+
+//! rate of the bidding messages admitted for each auction, by set and name.
+typedef map<pair<string, string>, TokenBucket>				auctionBucketList_t;
+typedef map<pair<string, string>, TokenBucket>::iterator	auctionBucketListIter_t;
+
+
 /*! \short   Manage network events.
 
     the AgentProcessor class allows and agent to receive 
 		and process messages from the network.
+
+    The anslp daemon fills the queue from its own threads. Once
+    enableSignal() is called, a relay thread waits on that queue, moves the
+    events into a local queue and signals an eventfd watched by the main
+    loop, so the loop sleeps in select until there is something to do.
+    Each call of handleFDEvent processes up to AUM_ANSLP_DRAIN_BUDGET
+    events; without the relay it polls the anslp queue instead.
+
+    Threaded, the component's own thread takes the anslp events, checks
+    and converts them into auction events and hands these to the core
+    through an EventHandoff, signalling the eventfd. handleFDEvent then
+    only moves the converted events to the core's list. Once the core
+    hands over its templates with setTemplates, the anslp thread also
+    parses the bidding objects of auction interactions against that copy,
+    so the core only parses the messages the copy could not handle.
+
+    Bidding messages go through the admission buckets of their session and
+    auctions as they are converted, before any parsing; the auctions are
+    read with the cheap getAuctionKeys pass. A message over any of the
+    rates is marked in the event and left unparsed, the core drops it.
 */
 
 class AnslpProcessor : public AuctionManagerComponent
@@ -50,6 +86,91 @@ class AnslpProcessor : public AuctionManagerComponent
   private:
 	
 	anslp::FastQueue *queue;
+
+	//! eventfd signalled when events are relayed, -1 without relay.
+	int signalFd;
+
+	//! events relayed and waiting to be processed.
+	anslpEventQueue_t relayed;
+
+	//! events converted by the anslp thread, NULL if not threaded.
+	EventHandoff *handoff;
+
+	//! set when the relay or the anslp thread has to finish.
+	int stopping;
+
+	//! set while the anslp thread converts an event.
+	int busy;
+
+	//! parses bidding objects ahead and reads their auctions, set before running.
+	BiddingObjectManager *bidm;
+
+	//! copy of the core's templates, only read by the anslp thread.
+	ipap_template_container *templates;
+
+	//! version of the core's templates the copy was taken from.
+	uint32_t templatesVersion;
+
+	//! arena of the objects parsed by the anslp thread in this interval.
+	BiddingObjectArena *arena;
+
+	//! bidding messages per second admitted from a session and at once, 0 for no limit.
+	double sessionRate;
+	double sessionBurst;
+
+	//! bidding messages per second admitted for an auction and at once, 0 for no limit.
+	double auctionRate;
+	double auctionBurst;
+
+	//! admission of the sessions that sent bidding messages.
+	sessionBucketList_t sessionBuckets;
+
+	//! admission of the auctions that received bidding messages.
+	auctionBucketList_t auctionBuckets;
+
+	//! next time the full buckets are dropped.
+	time_t bucketsPruned;
+
+#ifdef ENABLE_THREADS
+	thread_t relayThread;
+	mutex_t relayAccess;
+
+	//! guards the template copy while the anslp thread parses with it.
+	mutex_t templatesAccess;
+#endif
+
+	//! parse the bidding objects of the event's messages, from the anslp thread.
+	void parseBiddingObjects(AuctionInteractionEvent *retEvent);
+
+	//! mark the event's messages over the session or auction rates.
+	void admitMessages(AuctionInteractionEvent *retEvent);
+
+	/*! \short  decide whether a bidding message is parsed or dropped
+
+		takes a token from the session and from every auction the message
+		refers to, a message over any of the rates takes none.
+	*/
+	bool admitMessage(const string &sessionId, ipap_message &message, struct timeval now);
+
+	//! drop the buckets full again, they are the same as new ones.
+	void pruneBuckets(struct timeval now);
+
+	//! take the next event, waiting for the first one if there is no relay.
+	anslp::AnslpEvent *nextEvent(bool first);
+
+	//! signal the eventfd, the main loop wakes up.
+	void wakeUp();
+
+	//! reset the eventfd before taking events.
+	void clearSignal();
+
+	//! relay thread main loop
+	void relay();
+
+	//! push the events to the core and wake it up, from the anslp thread.
+	void handOff(eventVec_t &events);
+
+	static void *relay_func(void *arg);
 	  
   protected:
   
@@ -68,11 +189,46 @@ class AnslpProcessor : public AuctionManagerComponent
 
 	anslp::FastQueue *get_fqueue(){ return queue; }
 
+	/*! \short  wake up the main loop through an eventfd added to the
+		descriptors of the component, call it before mergeFDs. Without
+		a thread of its own the processor starts the relay thread.
+
+		\returns false if it is not supported by this build.
+		\throws Error if the eventfd or the thread can not be created.
+	*/
+	bool enableSignal();
+
+	//! return the eventfd signalled on new events, -1 if not enabled.
+	inline int getSignalFd(){ return signalFd; }
+
+	/*! \short  limit the bidding messages admitted, call it before running
+
+		\arg \c _bidm - manager reading the auctions of the messages
+		\arg \c _sessionRate - messages per second from a session, 0 for no limit
+		\arg \c _sessionBurst - messages a session may send at once
+		\arg \c _auctionRate - messages per second for an auction, 0 for no limit
+		\arg \c _auctionBurst - messages an auction may receive at once
+	*/
+	void setAdmission(BiddingObjectManager *_bidm, double _sessionRate, double _sessionBurst,
+					  double _auctionRate, double _auctionBurst);
+
+	/*! \short  let the anslp thread parse bidding objects against a copy
+		of the core's templates, with the manager given to setAdmission
+
+		call it again whenever the core's templates change, events parsed
+		with an older version are parsed again by the core. Does nothing
+		if the processor has no thread of its own.
+	*/
+	void setTemplates(ipap_template_container *_templates, uint32_t version);
+
     //! handle file descriptor event
     virtual int handleFDEvent(eventVec_t *e, fd_set *rset, fd_set *wset, fd_sets_t *fds);
 	
     //! thread main function
     void main();
+
+    //! make the thread leave main and wait for it.
+    virtual void stop();
       
     //! get information about load module
     string getInfo();
@@ -34,6 +34,7 @@
 #include "Error.h"
 #include "logfile.h"
 #include "Logger.h"
+#include "LazyLog.h"
 #include "CommandLineArgs.h"
 #include "ConfigManager.h"
 #include "BiddingObjectManager.h"
@@ -48,6 +49,9 @@
 #include "IpAp_template_container.h"
 #include "AnslpClient.h"
 #include "AnslpProcessor.h"
+#include "SocketTransport.h"
+#include "StateSnapshot.h"
+#include "StateLog.h"
 
 
 /*! \short   Auctioner class description
@@ -112,12 +116,72 @@ class Auctioner
     //! 1 if the procedure for applying receiving events from the anslp component runs in a separate thread
     int aprocThread;
 
+    //! true if the anslp processor wakes up select when events arrive
+    bool anslpSignal;
+
+    //! anslp socket polled by the main loop, owned by anslpc, NULL if not polled
+    SocketTransport *socketTransport;
+
     //! 1 if remote control interface is enabled
     static int enableCtrl;
 
 	//! List of templates thta have been created for exchanging with other parties.
 	auctionerTemplateList_t auctionerTemplates;
 
+	//! file keeping the state for warm restarts, empty if not enabled.
+	string snapshotFile;
+
+	//! seconds between snapshots without a state log, with one they follow its size.
+	unsigned long snapshotInterval;
+
+	//! auction file loaded at start, recorded in the snapshots.
+	string auctionFile;
+
+	//! log of the state changes since the last snapshot, NULL if not enabled.
+	auto_ptr<StateLog> stateLog;
+
+	//! size of the state log that triggers a snapshot.
+	unsigned long stateLogMaxSize;
+
+	//! a sync timer of the state log is scheduled.
+	bool stateLogSyncArmed;
+
+	//! ms before an unconfirmed message is sent again, 0 disables retransmissions.
+	unsigned long retransmitTimeout;
+
+	//! limit of the retransmission timeout.
+	unsigned long retransmitMaxTimeout;
+
+	//! retransmissions before an unconfirmed message is dropped.
+	unsigned int retransmitRetries;
+
+	//! unconfirmed messages kept per session.
+	unsigned int maxPendingMessages;
+
+	//! ms an ack waits for more messages to acknowledge, 0 acks every message at once.
+	unsigned long ackDelay;
+
+	//! data records of the bidding objects batched in one message to a session.
+	unsigned int maxMessageRecords;
+
+	//! leave out of the messages the templates the agent confirmed to hold.
+	bool templateReuse;
+
+	//! bidding messages per second admitted from a session, 0 for no limit.
+	unsigned long sessionBidRate;
+
+	//! bidding messages a session may send at once.
+	unsigned long sessionBidBurst;
+
+	//! bidding messages per second admitted for an auction, 0 for no limit.
+	unsigned long auctionBidRate;
+
+	//! bidding messages an auction may receive at once.
+	unsigned long auctionBidBurst;
+
+	//! changes of the templates, bidding objects parsed ahead with an older version are parsed again.
+	uint32_t templatesVersion;
+
     //! signal handlers
     static void sigint_handler(int i);
     static void sigusr1_handler(int i);
@@ -183,13 +247,100 @@ class Auctioner
 
 	void handleRemoveSession(Event *e, fd_sets_t *fds);
 
-	void handleSingleObjectAuctioningInteraction( string sessionId, anslp::anslp_ipap_message *ipap_mes);
+	/*! \short  decide whether a bidding message is parsed or dropped
+	
+		the anslp processor already went through the session and auction
+		rates and marked the message under key if it is over any of them.
+	*/
+	bool admitBiddingMessage(auction::Session *s, AuctionInteractionEvent *e,
+							 anslp::mspec_rule_key key, ipap_message &message);
+
+	/*! \short  handle one message of an auction interaction
+
+		the bidding objects the anslp thread parsed from the message under
+		key are taken from the event, otherwise the message is parsed here.
+	*/
+	void handleSingleObjectAuctioningInteraction( AuctionInteractionEvent *e, 
+							anslp::mspec_rule_key key, anslp::anslp_ipap_message *ipap_mes);
 
 	void handleAuctioningInteraction(Event *e, fd_sets_t *fds);
 	
 	void handleAddGeneratedBiddingObjects(Event *e, fd_sets_t *fds);
     
     void handleTransmitBiddingObjects(Event *e, fd_sets_t *fds);
+
+	//! schedule the next retransmission of the session, if it has none.
+	void armRetransmission(auction::Session *s);
+
+	void handleRetransmitMessages(Event *e, fd_sets_t *fds);
+
+	//! schedule the cumulative ack of the session, if it has none.
+	void armAck(auction::Session *s);
+
+	void handleAcknowledgeMessages(Event *e, fd_sets_t *fds);
+
+	//! read the address and port the agents use to reach this auction manager.
+	void getControlAddress(bool &useIPV6, string &sAddressIPV4, 
+						   string &sAddressIPV6, int &port);
+
+	//! hand a copy of the templates to the anslp thread after they change.
+	void publishTemplates();
+
+	//! return the message in the wire encoding kept in snapshots and in the state log.
+	string getWireMessage(ipap_message &message);
+
+	//! decode a message kept by getWireMessage, throws Error if it is damaged.
+	anslp::msg::anslp_ipap_message *fromWireMessage(const string &message);
+
+	//! copy the session into record, auctions are the ones it may reference.
+	void getSessionRecord(auction::Session *s, auctioningObjectDB_t &auctions,
+						  sessionStateRecord_t &record);
+
+	//! copy the auctions, sessions and active bids into snapshot.
+	void getStateSnapshot(stateSnapshot_t &snapshot);
+
+	//! write a snapshot of the state in snapshotFile and compact the state log.
+	void saveState();
+
+	//! append a state change to the state log, if there is one.
+	void logState(stateLogEntry_t &entry);
+
+	/*! \short  write the state changes logged, before a peer is told about them,
+				and schedule their sync at the end of the sync interval.
+	*/
+	void flushStateLog();
+
+	void handleSyncStateLog(Event *e, fd_sets_t *fds);
+
+	//! parse an auctions message and add its auctions, throws Error if they fail.
+	void addAuctionsMessage(const string &message);
+
+	/*! \short  parse a bidding objects message of the session and add them.
+		\returns the sequence number of the message
+	*/
+	uint32_t addBiddingObjectsMessage(string sessionId, const string &message);
+
+	//! add the session saved in record, with its pending messages.
+	void restoreSession(const sessionStateRecord_t &record);
+
+	//! add the auctions of the snapshot, returns false if there were none or they failed.
+	bool restoreAuctions(const stateSnapshot_t &snapshot);
+
+	//! add the sessions of the snapshot, with their pending messages.
+	void restoreSessions(const stateSnapshot_t &snapshot);
+
+	//! add the active bids of the snapshot.
+	void restoreBiddingObjects(const stateSnapshot_t &snapshot);
+
+	//! apply the state log entries after sequence, returns the number applied.
+	unsigned long replayStateLog(uint64_t after);
+
+	//! apply one state log entry.
+	void replayStateLogEntry(const stateLogEntry_t &entry);
+
+	void handleSaveState(Event *e, fd_sets_t *fds);
+
+	void handleRestoreState(Event *e, fd_sets_t *fds);
 		
   public:
 
@@ -379,6 +379,53 @@ class RemoveResourceEvent : public Event
 };
 
 
+//! save a snapshot of the state, recurrent every ival ms.
+class SaveStateEvent : public Event
+{
+  public:
+
+    SaveStateEvent(time_t offs_sec, unsigned long ival=0) 
+      : Event(SAVE_STATE, offs_sec, 0, ival) {  }
+};
+
+
+//! fdatasync the state log once its sync interval is over.
+class SyncStateLogEvent : public Event
+{
+  public:
+
+    SyncStateLogEvent(struct timeval when) 
+      : Event(SYNC_STATE_LOG, when) {  }
+};
+
+
+//! resume from the snapshot, or load the auction file if there is none.
+class RestoreStateEvent : public Event
+{
+  private:
+    string fileName;
+    string auctionFile;
+
+  public:
+
+    RestoreStateEvent(string fname, string afname) 
+      : Event(RESTORE_STATE), fileName(fname), auctionFile(afname)
+    {
+        
+    }
+
+    string getFileName()
+    {
+        return fileName;
+    }
+
+    string getAuctionFile()
+    {
+        return auctionFile;
+    }
+};
+
+
 
 }; // namespace auction
 
@@ -31,6 +31,7 @@
 #include "AUMProcessor.h"
 #include "Module.h"
 #include "IpAp_create_map.h"
+#include "Timeval.h"
 
 
 using namespace auction;
@@ -141,50 +142,29 @@ AUMProcessor::readMiscData( ipap_template *templ, ipap_data_record &record)
 }
 
 
-bool AUMProcessor::intersects( time_t startDttmAuc, time_t stopDttmAuc, 
-								 time_t startDttmReq, time_t stopDttmReq)
-{
+/* ------------------------- findAuctions ------------------------- */
 
+void AUMProcessor::findAuctions(const string &resourceId, time_t startDttm, 
+								time_t stopDttm, vector<int> &ids)
+{
 #ifdef DEBUG
-	struct timeval t1, t2, t3, t4;
-	t1.tv_sec = startDttmAuc;
-	t2.tv_sec = stopDttmAuc;
-	t3.tv_sec = startDttmReq;
-	t4.tv_sec = stopDttmReq;
-    log->dlog(ch,"Start intersects %s - %s - %s -%s",  (Timeval::toString(t1)).c_str(), 
-									 (Timeval::toString(t2)).c_str(),
-									 (Timeval::toString(t3)).c_str(),
-									 (Timeval::toString(t4)).c_str() );
+    log->dlog(ch,"Start findAuctions resourceReq:%s", resourceId.c_str());
 #endif
 
-	if (stopDttmReq <= startDttmAuc){		
-		return false;
-	}
-	
-	if (stopDttmAuc <= startDttmReq){
-		return false;
+	if (resourceId.compare("any") == 0) {
+		resourceIntervalIndexIter_t iter;
+		for (iter = auctionIntervals.begin(); iter != auctionIntervals.end(); ++iter) {
+			(iter->second).find(startDttm, stopDttm, ids);
+		}
+	} else {
+		resourceIntervalIndexIter_t iter = auctionIntervals.find(resourceId);
+		if (iter != auctionIntervals.end()) {
+			(iter->second).find(startDttm, stopDttm, ids);
+		}
 	}
-	
-	return true;
 
-}
-
-bool AUMProcessor::forResource(string resourceAuc, string resourceIdReq)
-{
-#ifdef DEBUG
-    log->dlog(ch,"Start forResource resourceAuc:%s, resourceReq:%s", 
-					resourceAuc.c_str(), resourceIdReq.c_str());
-#endif
-	
-	if (resourceAuc.compare(resourceIdReq) == 0 ){
-		return true;
-	}
-	
-	if (resourceIdReq.compare("any") == 0){
-		return true;
-	}
-	
-	return false;
+	// Same order as the auction process list.
+	sort(ids.begin(), ids.end());
 }
 
 /* ----------------------- addAuctionProcess ------------------------- */
@@ -242,6 +222,8 @@ AUMProcessor::addAuctionProcess( Auction *a, EventScheduler *evs )
 		// success ->enter struct into internal map
 		auctions[auctionId] = entry;
 
+		auctionIntervals[a->getAuctionResource()].insert(auctionId, a->getStart(), a->getStop());
+
     } 
     catch (Error &e) 
     { 
@@ -291,6 +273,42 @@ void AUMProcessor::delAuctions(auctionDB_t *aucts)
 }
 */
 
+/* ------------------------- fillSummary ------------------------- */
+
+//! summarize an execution from the bids given and the allocations returned.
+static void fillSummary(Auction *auction, time_t start, time_t stop, 
+						auctioningObjectDB_t *bids, auctioningObjectDB_t *allocations,
+						auctionSummaryRecord_t &summary)
+{
+	summary.auctionSet = auction->getSet();
+	summary.auctionName = auction->getName();
+	summary.start = start;
+	summary.stop = stop;
+	summary.demand = 0;
+	summary.quantitySold = 0;
+	summary.clearingPrice = 0;
+	summary.bids = bids->size();
+	summary.allocations = allocations->size();
+	summary.executionTime = 0;
+
+	auctioningObjectDBIter_t iter;
+	for (iter = bids->begin(); iter != bids->end(); ++iter) {
+		BiddingObject *bid = dynamic_cast<BiddingObject *>(*iter);
+		summary.demand += bid->getElementsTotal("quantity");
+	}
+
+	for (iter = allocations->begin(); iter != allocations->end(); ++iter) {
+		BiddingObject *alloc = dynamic_cast<BiddingObject *>(*iter);
+		summary.quantitySold += alloc->getElementsTotal("quantity");
+
+		double price = alloc->getElementsMax("unitprice");
+		if (price > summary.clearingPrice) {
+			summary.clearingPrice = price;
+		}
+	}
+}
+
+
 /* ------------------------- execute ------------------------- */
 
 void AUMProcessor::executeAuction(int index, time_t start, time_t stop, EventScheduler *e )
@@ -315,7 +333,11 @@ void AUMProcessor::executeAuction(int index, time_t start, time_t stop, EventSch
 		
 		if ( actProcess.getBids()->size() > 0 ){
 		
+			struct timeval before, after;
+			
 			try {			
+				gettimeofday(&before, NULL);
+				
 				actProcess.getMAPI()->execute( FieldDefManager::getFieldDefs(),
 												FieldDefManager::getFieldVals(),
 												actProcess.getParams(), 
@@ -325,6 +347,8 @@ void AUMProcessor::executeAuction(int index, time_t start, time_t stop, EventSch
 												actProcess.getBids(), 
 												&ptr );
 
+				gettimeofday(&after, NULL);
+
 //#ifdef DEBUG	
 				log->log(ch,"Number of allocations generated %d", allocations.size() ); 
 //#endif	
@@ -334,7 +358,14 @@ void AUMProcessor::executeAuction(int index, time_t start, time_t stop, EventSch
 				throw Error(e.getError().c_str());
 			}
 			
-			e->addEvent(new AddGeneratedBiddingObjectsEvent(index, allocations));
+			auctionSummaryRecord_t summary;
+			fillSummary(actProcess.getAuction(), start, stop, actProcess.getBids(), 
+						&allocations, summary);
+			
+			struct timeval elapsed = Timeval::sub0(after, before);
+			summary.executionTime = elapsed.tv_sec * 1000000 + elapsed.tv_usec;
+			
+			e->addEvent(new AddGeneratedBiddingObjectsEvent(index, allocations, summary));
 		}
 		else {
 			log->log(ch,"No bids included");
@@ -471,6 +502,16 @@ void AUMProcessor::delAuctionProcess( int index, EventSchedulerAuctioner *e )
      
     auctions.erase(index); 
 
+    if (entry.auction != NULL) {
+        resourceIntervalIndexIter_t iter = auctionIntervals.find(entry.auction->getAuctionResource());
+        if (iter != auctionIntervals.end()) {
+            (iter->second).erase(index, entry.auction->getStart());
+            if ((iter->second).empty()) {
+                auctionIntervals.erase(iter);
+            }
+        }
+    }
+
 	e->delProcessExecutionEvents(index);
 
 //#ifdef DEBUG
@@ -520,14 +561,15 @@ AUMProcessor::getApplicableAuctions(ipap_message *message)
 				 
 				string resourceId = getMiscVal(&miscs, "resourceid"); 
 				
-				auctionProcessListIter_t aucIter;
-				for (aucIter = auctions.begin(); aucIter != auctions.end(); ++aucIter){
-					Auction *auction =  (aucIter->second).auction;
-					if (intersects(auction->getStart(), auction->getStop(), startDttm, stopDttm) 
-						&& ( forResource(auction->getAuctionResource(), resourceId))){
-						auctions_anw->push_back(auction);
+				vector<int> ids;
+				findAuctions(resourceId, startDttm, stopDttm, ids);
+
+				for (vector<int>::iterator idIter = ids.begin(); idIter != ids.end(); ++idIter){
+					auctionProcessListIter_t aucIter = auctions.find(*idIter);
+					if (aucIter != auctions.end()){
+						auctions_anw->push_back((aucIter->second).auction);
 					}
-				}				
+				}
 				
 			}
 		}	
@@ -29,8 +29,16 @@
 
 #include "ParserFcts.h"
 #include "AnslpProcessor.h"
+#include "ConstantsAum.h"
+#include "Constants.h"
 #include "benchmark_journal.h"
 #include "EventAuctioner.h"
+#include "anslp_ipap_message.h"
+#include "anslp_ipap_exception.h"
+
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
 
 #ifdef BENCHMARK
   extern benchmark_journal journal;
@@ -41,7 +49,10 @@ using namespace anslp::msg;
 using namespace auction;
 
 AnslpProcessor::AnslpProcessor(ConfigManager *cnf, int threaded ) 
-    : AuctionManagerComponent(cnf, "ANSLP_PROCESSOR", threaded)
+    : AuctionManagerComponent(cnf, "ANSLP_PROCESSOR", threaded), 
+      signalFd(-1), handoff(NULL), stopping(0), busy(0), bidm(NULL), 
+      templates(NULL), templatesVersion(0), arena(NULL), sessionRate(0), sessionBurst(0),
+      auctionRate(0), auctionBurst(0), bucketsPruned(0)
 {
 #ifdef DEBUG
     log->dlog(ch,"Starting ANSLP Processor");
@@ -51,6 +62,14 @@ AnslpProcessor::AnslpProcessor(ConfigManager *cnf, int threaded )
 	queue = _queue;
 	
 	assert(_queue != NULL);
+
+#ifdef ENABLE_THREADS
+	if (threaded) {
+		handoff = new EventHandoff(AUM_ANSLP_HANDOFF_SIZE);
+		mutexInit(&templatesAccess);
+	}
+#endif
+
 }
 
 AnslpProcessor::~AnslpProcessor()
@@ -66,12 +85,71 @@ AnslpProcessor::~AnslpProcessor()
         stop();
         mutexUnlock(&maccess);
         mutexDestroy(&maccess);
+        mutexDestroy(&templatesAccess);
+    }
+
+    // without a thread of its own the eventfd is fed by the relay.
+    if ((signalFd >= 0) && (handoff == NULL)) {
+        mutexLock(&relayAccess);
+        stopping = 1;
+        mutexUnlock(&relayAccess);
+
+        // returns within AUM_ANSLP_RELAY_WAIT ms.
+        threadJoin(relayThread);
+        mutexDestroy(&relayAccess);
     }
 #endif
+
+    if (signalFd >= 0) {
+        removeFd(signalFd);
+        ::close(signalFd);
+        signalFd = -1;
+    }
+
+    for (anslpEventQueueIter_t iter = relayed.begin(); iter != relayed.end(); ++iter) {
+        delete *iter;
+    }
+    relayed.clear();
 	
+	// events converted and not taken by the core.
+	saveDelete(handoff);
+	saveDelete(templates);
+
+	// goes once the core retires what was parsed in it.
+	if (arena != NULL) {
+		arena->close();
+	}
+
 	saveDelete(queue);	
 }
 
+/* ------------------------- moveMessages ------------------------- */
+
+/*! \short  transfer the ipap messages of an anslp event to the auction event
+
+    other objects can not be handled by the core, they are dropped here
+    so the core only gets valid messages.
+    \returns the number of messages transferred
+*/
+static int moveMessages(anslp::objectList_t *objects, AuctionInteractionEvent *retEvent)
+{
+	int moved = 0;
+
+	anslp::objectListIter_t it;
+	for (it = objects->begin(); it != objects->end(); ++it){
+		if (dynamic_cast<anslp::anslp_ipap_message *>(it->second) != NULL) {
+			retEvent->setObject(it->first, it->second);
+			moved++;
+		} else {
+			delete it->second;
+		}
+		it->second = NULL;
+	}
+	objects->clear();
+
+	return moved;
+}
+
 void AnslpProcessor::process(eventVec_t *e, AnslpEvent *evt)
 {
 
@@ -91,11 +169,7 @@ void AnslpProcessor::process(eventVec_t *e, AnslpEvent *evt)
 
 		auction::CreateCheckSessionEvent *retEvent = new CreateCheckSessionEvent(sessionId, che->getQueue());
 				
-		anslp::objectList_t *objects = che->getObjects();
-		anslp::objectListIter_t it;
-		for (it = objects->begin(); it != objects->end(); ++it){
-			retEvent->setObject(it->first, it->second->copy());
-		}
+		moveObjects(che->getObjects(), retEvent);
 		
 		e->push_back(retEvent);	
 				
@@ -109,11 +183,7 @@ void AnslpProcessor::process(eventVec_t *e, AnslpEvent *evt)
 		string sessionId = ase->getSession();
 		CreateSessionEvent *retEvent = new CreateSessionEvent(sessionId, ase->getQueue());
 		
-		anslp::objectList_t *objects = ase->getObjects();
-		anslp::objectListIter_t it;
-		for (it = objects->begin(); it != objects->end(); ++it){
-			retEvent->setObject(it->first,it->second->copy());
-		}
+		moveObjects(ase->getObjects(), retEvent);
 		
 		e->push_back(retEvent);	
 		
@@ -138,12 +208,10 @@ void AnslpProcessor::process(eventVec_t *e, AnslpEvent *evt)
 			
 		string sessionId = rse->getSession();
 		RemoveSessionEvent *retEvent = new auction::RemoveSessionEvent(sessionId, rse->getQueue());
+
+		sessionBuckets.erase(sessionId);
 		
-		anslp::objectList_t *objects = rse->getObjects();
-		anslp::objectListIter_t it;
-		for (it = objects->begin(); it != objects->end(); ++it){
-			retEvent->setObject(it->first,it->second->copy());
-		}
+		moveObjects(rse->getObjects(), retEvent);
 		
 		e->push_back(retEvent);	
 
@@ -158,19 +226,19 @@ void AnslpProcessor::process(eventVec_t *e, AnslpEvent *evt)
 
 		assert(retEvent != NULL);
 
-		anslp::objectList_t *objects = aie->getObjects();
-		anslp::objectListIter_t it;
-		for (it = objects->begin(); it != objects->end(); ++it){
-			
-#ifdef DEBUG
-    log->dlog(ch,"objectId: %s", (it->first).to_string().c_str());
-#endif		
-			assert(it->second != NULL);
+		if (moveMessages(aie->getObjects(), retEvent) == 0) {
+			log->wlog(ch, "Auction interaction of session %s without ipap messages", 
+					  sessionId.c_str());
+			delete retEvent;
+			return;
+		}
 
-#ifdef DEBUG
-    log->dlog(ch,"after assert");
-#endif		
-			retEvent->setObject(it->first, it->second->copy());
+		// Messages over the rates are never parsed.
+		admitMessages(retEvent);
+
+		// Threaded, the parsing is taken off the core.
+		if (handoff != NULL) {
+			parseBiddingObjects(retEvent);
 		}
 
 		e->push_back(retEvent);	
@@ -185,42 +253,426 @@ void AnslpProcessor::process(eventVec_t *e, AnslpEvent *evt)
 
 }
 
+/* ------------------------- setAdmission ------------------------- */
+
+void AnslpProcessor::setAdmission(BiddingObjectManager *_bidm, double _sessionRate, 
+								  double _sessionBurst, double _auctionRate, 
+								  double _auctionBurst)
+{
+	bidm = _bidm;
+	sessionRate = _sessionRate;
+	sessionBurst = _sessionBurst;
+	auctionRate = _auctionRate;
+	auctionBurst = _auctionBurst;
+
+	sessionBuckets.clear();
+	auctionBuckets.clear();
+}
+
+
+/* ------------------------- admitMessages ------------------------- */
+
+void AnslpProcessor::admitMessages(AuctionInteractionEvent *retEvent)
+{
+	if ((sessionRate <= 0) && (auctionRate <= 0)) {
+		return;
+	}
+
+	struct timeval now;
+	gettimeofday(&now, NULL);
+
+	if (now.tv_sec >= bucketsPruned) {
+		pruneBuckets(now);
+		bucketsPruned = now.tv_sec + AUM_ANSLP_BUCKET_PRUNE;
+	}
+
+	anslp::objectListIter_t it;
+	for (it = retEvent->getObjects()->begin(); it != retEvent->getObjects()->end(); ++it) {
+		ipap_message &message = 
+			dynamic_cast<anslp::anslp_ipap_message *>(it->second)->ip_message;
+
+		// Bare acks carry no bidding objects, they cost nothing.
+		if (message.begin() == message.end()) {
+			continue;
+		}
+
+		if (!admitMessage(retEvent->getSessionId(), message, now)) {
+			retEvent->setOverLimit(it->first);
+		}
+	}
+}
+
+
+/* ------------------------- admitMessage ------------------------- */
+
+bool AnslpProcessor::admitMessage(const string &sessionId, ipap_message &message, 
+								  struct timeval now)
+{
+	// Every bucket must have room before any token is taken.
+	vector<TokenBucket *> buckets;
+
+	if (sessionRate > 0) {
+		sessionBucketListIter_t iter = sessionBuckets.find(sessionId);
+		if (iter == sessionBuckets.end()) {
+			iter = sessionBuckets.insert(make_pair(sessionId, 
+							TokenBucket(sessionRate, sessionBurst))).first;
+		}
+
+		if (!(iter->second).isAvailable(now)) {
+			return false;
+		}
+		buckets.push_back(&(iter->second));
+	}
+
+	if ((auctionRate > 0) && (bidm != NULL)) {
+		auctionKeyList_t keys;
+		try {
+			bidm->getAuctionKeys(&message, keys);
+		} catch (ipap_bad_argument &e) {
+			// The parser rejects the message and reports it.
+			keys.clear();
+		}
+
+		// Unknown auctions get a bucket as well, dropped once it is full again.
+		auctionKeyListIter_t iter;
+		for (iter = keys.begin(); iter != keys.end(); ++iter) {
+			auctionBucketListIter_t bucketIter = auctionBuckets.find(*iter);
+			if (bucketIter == auctionBuckets.end()) {
+				bucketIter = auctionBuckets.insert(make_pair(*iter, 
+								TokenBucket(auctionRate, auctionBurst))).first;
+			}
+
+			if (!(bucketIter->second).isAvailable(now)) {
+				return false;
+			}
+			buckets.push_back(&(bucketIter->second));
+		}
+	}
+
+	for (size_t i = 0; i < buckets.size(); i++) {
+		buckets[i]->take(now);
+	}
+
+	return true;
+}
+
+
+/* ------------------------- pruneBuckets ------------------------- */
+
+void AnslpProcessor::pruneBuckets(struct timeval now)
+{
+	sessionBucketListIter_t sessionIter = sessionBuckets.begin();
+	while (sessionIter != sessionBuckets.end()) {
+		if ((sessionIter->second).isAvailable(now, (sessionIter->second).getBurst())) {
+			sessionBuckets.erase(sessionIter++);
+		} else {
+			++sessionIter;
+		}
+	}
+
+	auctionBucketListIter_t auctionIter = auctionBuckets.begin();
+	while (auctionIter != auctionBuckets.end()) {
+		if ((auctionIter->second).isAvailable(now, (auctionIter->second).getBurst())) {
+			auctionBuckets.erase(auctionIter++);
+		} else {
+			++auctionIter;
+		}
+	}
+}
+
+
+/* ------------------------- setTemplates ------------------------- */
+
+void AnslpProcessor::setTemplates(ipap_template_container *_templates, uint32_t version)
+{
+
+#ifdef ENABLE_THREADS
+	if (handoff == NULL) {
+		return;
+	}
+
+	// The copy is taken on the core, so the anslp thread never sees the
+	// core's container while it changes.
+	ipap_template_container *copy = new ipap_template_container();
+	list<int> templateIds = _templates->get_template_list();
+	list<int>::iterator iter;
+	for (iter = templateIds.begin(); iter != templateIds.end(); ++iter) {
+		copy->add_template(_templates->get_template(*iter)->copy());
+	}
+
+	mutexLock(&templatesAccess);
+	ipap_template_container *old = templates;
+	templates = copy;
+	templatesVersion = version;
+	mutexUnlock(&templatesAccess);
+
+	saveDelete(old);
+#endif
+
+}
+
+
+/* ------------------------- parseBiddingObjects ------------------------- */
+
+void AnslpProcessor::parseBiddingObjects(AuctionInteractionEvent *retEvent)
+{
+
+#ifdef ENABLE_THREADS
+	mutexLock(&templatesAccess);
+
+	if ((templates != NULL) && (bidm != NULL)) {
+
+		// A new arena every interval, the core retires the objects.
+		time_t now = time(NULL);
+		time_t start = now - (now % BIDDING_OBJECT_ARENA_INTERVAL);
+		if ((arena != NULL) && (arena->getStart() != start)) {
+			arena->close();
+			arena = NULL;
+		}
+		if (arena == NULL) {
+			arena = new BiddingObjectArena(start);
+		}
+		arenaScope scope(arena);
+
+		anslp::objectListIter_t it;
+		for (it = retEvent->getObjects()->begin(); it != retEvent->getObjects()->end(); ++it) {
+			ipap_message &message = 
+				dynamic_cast<anslp::anslp_ipap_message *>(it->second)->ip_message;
+
+			// Bare acks carry no bidding objects, the core drops the ones over the rates.
+			if ((message.begin() == message.end()) || retEvent->isOverLimit(it->first)) {
+				continue;
+			}
+
+			// On failure the core parses the message again and reports it.
+			try {
+				retEvent->setBiddingObjects(it->first, 
+						bidm->parseMessage(&message, templates), templatesVersion);
+			} catch (Error &e) {
+#ifdef DEBUG
+				log->dlog(ch, "bidding objects left to the core: %s", e.getError().c_str());
+#endif
+			} catch (anslp::msg::anslp_ipap_bad_argument &e) {
+#ifdef DEBUG
+				log->dlog(ch, "bidding objects left to the core: %s", e.what());
+#endif
+			} catch (ipap_bad_argument &e) {
+#ifdef DEBUG
+				log->dlog(ch, "bidding objects left to the core: %s", e.what());
+#endif
+			}
+		}
+	}
+
+	mutexUnlock(&templatesAccess);
+#endif
+
+}
+
+
+/* ------------------------- enableSignal ------------------------- */
+
+bool AnslpProcessor::enableSignal()
+{
+
+#if defined(ENABLE_THREADS) && defined(HAVE_SYS_EVENTFD_H)
+	if (signalFd >= 0) {
+		return true;
+	}
+
+	signalFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (signalFd < 0) {
+		throw Error("Cannot create anslp eventfd: %s", strerror(errno));
+	}
+
+	// The anslp thread signals by itself.
+	if (handoff == NULL) {
+		mutexInit(&relayAccess);
+
+		int res = threadCreate(&relayThread, relay_func, this);
+		if (res != 0) {
+			mutexDestroy(&relayAccess);
+			::close(signalFd);
+			signalFd = -1;
+			throw Error("Cannot create anslp relay thread: %s", strerror(res));
+		}
+	}
+
+	addFd(signalFd);
+
+#ifdef DEBUG
+	log->dlog(ch, "anslp events signalled through eventfd %d", signalFd);
+#endif
+
+	return true;
+#else
+	return false;
+#endif
+
+}
+
+
+/* ------------------------- relay_func ------------------------- */
+
+void *AnslpProcessor::relay_func(void *arg)
+{
+	((AnslpProcessor *)arg)->relay();
+	return NULL;
+}
+
+
+/* ------------------------- relay ------------------------- */
+
+void AnslpProcessor::relay()
+{
+
+#ifdef ENABLE_THREADS
+	while (1) {
+
+		// The timeout only bounds how long stopping takes.
+		anslp::AnslpEvent *evt = queue->dequeue_timedwait(AUM_ANSLP_RELAY_WAIT);
+
+		mutexLock(&relayAccess);
+
+		// Only the first event needs a signal, the loop drains the rest.
+		bool wake = false;
+		if (evt != NULL) {
+			wake = relayed.empty();
+			relayed.push_back(evt);
+		}
+		int stop = stopping;
+
+		mutexUnlock(&relayAccess);
+
+		if (wake) {
+			wakeUp();
+		}
+
+		if (stop) {
+			break;
+		}
+	}
+#endif
+
+}
+
+
+/* ------------------------- wakeUp ------------------------- */
+
+void AnslpProcessor::wakeUp()
+{
+	uint64_t one = 1;
+
+	// Only fails when the counter is already far from zero.
+	while ((::write(signalFd, &one, sizeof(one)) < 0) && (errno == EINTR));
+}
+
+
+/* ------------------------- clearSignal ------------------------- */
+
+void AnslpProcessor::clearSignal()
+{
+	uint64_t count;
+
+	// Reset before looking, an event arriving later signals again.
+	while ((::read(signalFd, &count, sizeof(count)) < 0) && (errno == EINTR));
+}
+
+
+/* ------------------------- nextEvent ------------------------- */
+
+anslp::AnslpEvent *AnslpProcessor::nextEvent(bool first)
+{
+
+#ifdef ENABLE_THREADS
+	if (signalFd >= 0) {
+		if (first) {
+			clearSignal();
+		}
+
+		anslp::AnslpEvent *evt = NULL;
+
+		mutexLock(&relayAccess);
+		if (!relayed.empty()) {
+			evt = relayed.front();
+			relayed.pop_front();
+		}
+		mutexUnlock(&relayAccess);
+
+		return evt;
+	}
+#endif
+
+	// A timeout makes sure the loop condition is checked regularly,
+	// events already queued are taken without waiting.
+	return queue->dequeue_timedwait(first ? 10 : 0);
+}
+
+
+/* ------------------------- handleFDEvent ------------------------- */
+
 int 
 AnslpProcessor::handleFDEvent(eventVec_t *e, fd_set *rset, fd_set *wset, fd_sets_t *fds)
 {
 
 	assert( e != NULL );
 
-	// Takes from the queue.
-	anslp::FastQueue *anslp_input = get_fqueue();
+	unsigned int n = 0;
 
-	// A timeout makes sure the loop condition is checked regularly.
-	anslp::AnslpEvent *evt = anslp_input->dequeue_timedwait(10);
-		
-	if ( evt == NULL ){
-		return 0;	// no message in the queue
+	// Threaded, the events are already converted by the anslp thread.
+	if (handoff != NULL) {
+		if (signalFd >= 0) {
+			clearSignal();
+		}
+
+		Event *ev;
+		while ((n < AUM_ANSLP_DRAIN_BUDGET) && ((ev = handoff->pop()) != NULL)) {
+			e->push_back(ev);
+			n++;
+		}
+
+		if ((signalFd >= 0) && (n == AUM_ANSLP_DRAIN_BUDGET) && !handoff->isEmpty()) {
+			wakeUp();
+		}
+		return 0;
 	}
 
-#ifdef DEBUG
-    log->dlog(ch,"ANSLP Processor: message in queue");
-#endif
-			
-	MP(benchmark_journal::PRE_PROCESSING);
+	anslp::AnslpEvent *evt = NULL;
 
-	// Then feed the event to the dispatcher.
-	if ( evt != NULL ) {
+	// Takes what is queued, up to the budget so other sources are not starved.
+	while ((n < AUM_ANSLP_DRAIN_BUDGET) && ((evt = nextEvent(n == 0)) != NULL)) {
+
+		MP(benchmark_journal::PRE_PROCESSING);
+
+		// Then feed the event to the dispatcher.
 		MP(benchmark_journal::PRE_DISPATCHER);
 		process(e, evt);
 		MP(benchmark_journal::POST_DISPATCHER);
 		delete evt;
+
+		MP(benchmark_journal::POST_PROCESSING);
+
+		n++;
 	}
 
-	MP(benchmark_journal::POST_PROCESSING);
+#ifdef ENABLE_THREADS
+	// Budget used up, make the next select return at once.
+	if ((signalFd >= 0) && (n == AUM_ANSLP_DRAIN_BUDGET)) {
+		mutexLock(&relayAccess);
+		bool pending = !relayed.empty();
+		mutexUnlock(&relayAccess);
+
+		if (pending) {
+			wakeUp();
+		}
+	}
+#endif
 
 #ifdef DEBUG
-    log->dlog(ch,"ending ANSLP Processor handleFDEvent");
+	if (n > 0) {
+		log->dlog(ch,"ending ANSLP Processor handleFDEvent, %u events", n);
+	}
 #endif
-
 	
 	return 0;
 		
@@ -230,22 +682,88 @@ void
 AnslpProcessor::waitUntilDone(void)
 {
 #ifdef ENABLE_THREADS
-    AUTOLOCK(threaded, &maccess);
-	// TODO AM: Implement.
-
+	// Wait for the anslp thread to convert what is queued.
+	if (threaded) {
+		while ((queue->size() > 0) || __sync_fetch_and_add(&busy, 0)) {
+			usleep(AUM_ANSLP_HANDOFF_RETRY);
+		}
+	}
 #endif
 }
 
 
-// TODO AM : Implement threads.
+/* ------------------------- stop ------------------------- */
+
+void AnslpProcessor::stop()
+{
+	// main leaves on its own, a cancel could leave the anslp queue locked.
+	__sync_lock_test_and_set(&stopping, 1);
+
+	AuctionManagerComponent::stop();
+}
+
+
+/* ------------------------- handOff ------------------------- */
+
+void AnslpProcessor::handOff(eventVec_t &events)
+{
+	for (eventVecIter_t iter = events.begin(); iter != events.end(); ++iter) {
+
+		// The core is behind, the anslp queue absorbs the burst meanwhile.
+		while (!handoff->push(*iter)) {
+			if (__sync_fetch_and_add(&stopping, 0)) {
+				for (; iter != events.end(); ++iter) {
+					delete *iter;
+				}
+				events.clear();
+				return;
+			}
+			usleep(AUM_ANSLP_HANDOFF_RETRY);
+		}
+	}
+
+	events.clear();
+
+	if (signalFd >= 0) {
+		wakeUp();
+	}
+}
+
+
+/* ------------------------- main ------------------------- */
+
 void AnslpProcessor::main()
 {
     // this function will be run as a single thread inside the anslp processor
     log->log(ch, "anslp thread running");
-    
-    for (;;) {
-        handleFDEvent(NULL, NULL,NULL, NULL);
-    }
+
+#ifdef ENABLE_THREADS
+	threadSetCancelState(PTHREAD_CANCEL_DISABLE, NULL);
+
+	eventVec_t events;
+
+	while (!__sync_fetch_and_add(&stopping, 0)) {
+
+		// The timeout only bounds how long stopping takes.
+		anslp::AnslpEvent *evt = queue->dequeue_timedwait(AUM_ANSLP_RELAY_WAIT);
+		if (evt == NULL) {
+			continue;
+		}
+
+		__sync_lock_test_and_set(&busy, 1);
+
+		MP(benchmark_journal::PRE_PROCESSING);
+		MP(benchmark_journal::PRE_DISPATCHER);
+		process(&events, evt);
+		MP(benchmark_journal::POST_DISPATCHER);
+		delete evt;
+		MP(benchmark_journal::POST_PROCESSING);
+
+		handOff(events);
+
+		__sync_lock_release(&busy);
+	}
+#endif
 
 }
 
@@ -30,6 +30,7 @@
 #include "Auctioner.h"
 #include "ConstantsAum.h"
 #include "EventAuctioner.h"
+#include "AnslpMessageCodec.h"
 #include "anslp_ipap_xml_message.h"
 #include "anslp_ipap_message.h"
 #include "anslp_ipap_exception.h" 
@@ -62,11 +63,25 @@ static inline char *noNewline( char* s )
     return s;
 }
 
+// modification time of a file, 0 if it can not be read
+static time_t getModificationTime(const string &fileName)
+{
+	struct stat st;
+	if (fileName.empty() || (stat(fileName.c_str(), &st) != 0)) {
+		return 0;
+	}
+	return st.st_mtime;
+}
+
 
 /* ------------------------- Auctioner ------------------------- */
 
 Auctioner::Auctioner( int argc, char *argv[])
-    :  domainId(0), pprocThread(0)
+    :  domainId(0), pprocThread(0), aprocThread(0), anslpSignal(false), socketTransport(NULL),
+       snapshotInterval(0), stateLogMaxSize(0), stateLogSyncArmed(false), retransmitTimeout(0),
+       retransmitMaxTimeout(0), retransmitRetries(0), maxPendingMessages(0), ackDelay(0),
+       maxMessageRecords(0), templateReuse(false), sessionBidRate(0), sessionBidBurst(0),
+       auctionBidRate(0), auctionBidBurst(0), templatesVersion(0)
 {
 
     // record auction manager start time for later output
@@ -188,7 +203,8 @@ Auctioner::Auctioner( int argc, char *argv[])
         string verbosity = conf->getValue("VerboseLevel", "MAIN");
         
         if (!verbosity.empty()) {
-            log->setLogLevel( ParserFcts::parseInt( verbosity, -1, 4 ) );
+            int level = ParserFcts::parseInt( verbosity, -1, 4 );
+            log->setLogLevel( level );
         }
         
 #ifdef DEBUG
@@ -251,10 +267,26 @@ Auctioner::Auctioner( int argc, char *argv[])
 			connectionDb = connectionDb + " port=" + _dbPort;
 		} 
         
+        // time partitions of the archive tables, none if no interval is given;
+        // expired partitions are only detached unless drop is asked for.
+        string _archInterval = conf->getValue("ArchivePartitionInterval", "MAIN");
+        string _archRetention = conf->getValue("ArchiveRetention", "MAIN");
+        string _archExpiry = conf->getValue("ArchiveExpiry", "MAIN");
+
+        if (!_archExpiry.empty() && (_archExpiry != "drop") && (_archExpiry != "detach")) {
+            throw Error("ArchiveExpiry must be drop or detach, not %s", _archExpiry.c_str());
+        }
+
         auto_ptr<BiddingObjectManager> _bidm(new BiddingObjectManager(domainId, 
 																	  conf->getValue("FieldDefFile", "MAIN"),
 																	  conf->getValue("FieldConstFile", "MAIN"),
-																	  connectionDb));
+																	  connectionDb,
+																	  conf->getValue("JournalFile", "MAIN"),
+																	  (_archInterval.empty()) ? 0 
+																		: ParserFcts::parseULong(_archInterval),
+																	  (_archRetention.empty()) ? 0 
+																		: ParserFcts::parseULong(_archRetention),
+																	  (_archExpiry != "drop")));
         bidm = _bidm;
 		
         auto_ptr<AuctionManager> _aucm(new AuctionManager( domainId,
@@ -321,21 +353,44 @@ Auctioner::Auctioner( int argc, char *argv[])
         
         auto_ptr<AnslpProcessor> _anslproc(new AnslpProcessor(conf.get(), 0 ));
         aprocThread = 0;
+		
+        if (conf->isTrue("Thread", "ANSLP_PROCESSOR") ) {
+            log->wlog(ch, "Threads enabled in config file but executable is compiled without thread support");
+        }
+#endif
 
         anslproc = _anslproc;
+
+        // threaded, the anslp thread parses the bidding objects ahead.
+        publishTemplates();
+
+        // wake up the main loop when anslp events arrive instead of polling.
+        anslpSignal = anslproc->enableSignal();
+
         anslproc->mergeFDs(&fdList);
 
-		
-		auto_ptr<AnslpClient> _anslpc(new AnslpClient(anslpConfFile, anslproc->get_fqueue() ));
+		// the peer listens on a local socket, the daemon is not started.
+		string socketPath = conf->getValue("AnslpSocket", "MAIN");
+		AnslpClient *client = NULL;
+		if (!socketPath.empty()) {
+			SocketTransport *transport = new SocketTransport(socketPath, 
+									 conf->getValue("AnslpPeerSocket", "MAIN"), 
+									 anslproc->get_fqueue());
+			client = new AnslpClient(transport);
+
+			// without threads the main loop reads the socket.
+			if (transport->getPollFd() >= 0) {
+				socketTransport = transport;
+				fdList[make_fd(transport->getPollFd(), FD_RD)] = NULL;
+			}
+		} else {
+			client = new AnslpClient(anslpConfFile, anslproc->get_fqueue());
+		}
+
+		auto_ptr<AnslpClient> _anslpc(client);
 					
 		anslpc = _anslpc;
 
-		
-        if (conf->isTrue("Thread", "ANSLP_PROCESSOR") ) {
-            log->wlog(ch, "Threads enabled in config file but executable is compiled without thread support");
-        }
-#endif
-
 		// setup initial resources
 		string rfn = conf->getValue("ResourceFile", "MAIN");
         if (!rfn.empty()) {
@@ -343,20 +398,83 @@ Auctioner::Auctioner( int argc, char *argv[])
         }
 		
 		cout << "after add resource request numEvents:" << evnt->getNbrEvents() << endl;
-		
-		// setup initial auctions
+
+		// messages to the agents not confirmed in time are sent again.
+		string stimeout = conf->getValue("RetransmitTimeout", "MAIN");
+		string smaxtimeout = conf->getValue("RetransmitMaxTimeout", "MAIN");
+		string sretries = conf->getValue("RetransmitRetries", "MAIN");
+		string smaxpending = conf->getValue("MaxPendingMessages", "MAIN");
+
+		retransmitTimeout = (stimeout.empty()) ? AUM_RETRANSMIT_TIMEOUT 
+											   : ParserFcts::parseULong(stimeout);
+		retransmitMaxTimeout = (smaxtimeout.empty()) ? AUM_RETRANSMIT_MAX_TIMEOUT 
+													 : ParserFcts::parseULong(smaxtimeout);
+		retransmitRetries = (sretries.empty()) ? AUM_RETRANSMIT_RETRIES 
+											   : ParserFcts::parseULong(sretries);
+		maxPendingMessages = (smaxpending.empty()) ? AUM_MAX_PENDING_MESSAGES 
+												   : ParserFcts::parseULong(smaxpending);
+
+		// cumulative acks, the agents must use them too.
+		string sackdelay = conf->getValue("AckDelay", "MAIN");
+		ackDelay = (sackdelay.empty()) ? 0 : ParserFcts::parseULong(sackdelay);
+
+		string smaxrecords = conf->getValue("MaxMessageRecords", "MAIN");
+		maxMessageRecords = (smaxrecords.empty()) ? MESSAGE_MAX_RECORDS 
+												  : ParserFcts::parseULong(smaxrecords);
+
+		// the agents and the ipap library must keep the templates of a session.
+		string sreuse = conf->getValue("TemplateReuse", "MAIN");
+		templateReuse = (!sreuse.empty()) && (ParserFcts::parseBool(sreuse) == 1);
+
+		// bidding messages admitted per second, for each session and each auction.
+		string ssrate = conf->getValue("SessionBidRate", "MAIN");
+		string ssburst = conf->getValue("SessionBidBurst", "MAIN");
+		string sarate = conf->getValue("AuctionBidRate", "MAIN");
+		string saburst = conf->getValue("AuctionBidBurst", "MAIN");
+
+		sessionBidRate = (ssrate.empty()) ? 0 : ParserFcts::parseULong(ssrate);
+		sessionBidBurst = (ssburst.empty()) ? sessionBidRate : ParserFcts::parseULong(ssburst);
+		auctionBidRate = (sarate.empty()) ? 0 : ParserFcts::parseULong(sarate);
+		auctionBidBurst = (saburst.empty()) ? auctionBidRate : ParserFcts::parseULong(saburst);
+
+		// checked by the anslp processor before the messages are parsed.
+		anslproc->setAdmission(bidm.get(), sessionBidRate, sessionBidBurst, 
+							   auctionBidRate, auctionBidBurst);
+		
+		// setup initial auctions, resuming from the last snapshot if there is one
 		string afn = conf->getValue("AuctionFile", "MAIN");
+		snapshotFile = conf->getValue("SnapshotFile", "MAIN");
+		auctionFile = afn;
+
+        if (!snapshotFile.empty()) {
+			string sinterval = conf->getValue("SnapshotInterval", "MAIN");
+			snapshotInterval = (sinterval.empty()) ? AUM_SNAPSHOT_INTERVAL 
+												   : ParserFcts::parseULong(sinterval);
+
+			// changes between snapshots, it only makes sense with them.
+			string slfn = conf->getValue("StateLogFile", "MAIN");
+			if (!slfn.empty()) {
+				string ssync = conf->getValue("StateLogSyncInterval", "MAIN");
+				string smax = conf->getValue("StateLogMaxSize", "MAIN");
+				
+				stateLogMaxSize = (smax.empty()) ? AUM_STATELOG_MAX_SIZE 
+												 : ParserFcts::parseULong(smax);
+				stateLog.reset(new StateLog(slfn, (ssync.empty()) ? AUM_STATELOG_SYNC_INTERVAL 
+														: ParserFcts::parseULong(ssync)));
+			}
 
-        if (!afn.empty()) {
+			evnt->addEvent(new RestoreStateEvent(snapshotFile, afn));
+        } else if (!afn.empty()) {
 			evnt->addEvent(new AddAuctionsEvent(afn));
         }
 		
 		cout << "after add auction numEvents:" << evnt->getNbrEvents() << endl;
 		
-        // disable logger threading if not needed
-        if (!pprocThread ) {
-            log->setThreaded(0);
-        }
+        // disable logger threading if not needed, with threads the database
+        // writer, the anslp thread and the socket transport log on their own.
+#ifndef ENABLE_THREADS
+        log->setThreaded(0);
+#endif
 
 		// ctrlcomm can never be a separate thread
 		auto_ptr<CtrlComm> _comm(new CtrlComm(conf.get(), 0));
@@ -473,6 +591,9 @@ string Auctioner::getInfo(infoType_t what, string param)
             }
         }
         break;
+    case I_DB_WRITER:
+        s << bidm->getWriterInfo();
+        break;
     case I_NUMAUCTIONMANAGERINFOS:
     default:
         return string();
@@ -663,6 +784,7 @@ void Auctioner::handleAddAuctions(Event *e, fd_sets_t *fds)
         
         // support only XML rules from file
         new_auctions = aucm->parseAuctions(((AddAuctionsEvent *)e)->getFileName(), iter->second);
+        publishTemplates();
 
 #ifdef DEBUG
 		iter = auctionerTemplates.find(domainId);
@@ -684,6 +806,21 @@ void Auctioner::handleAddAuctions(Event *e, fd_sets_t *fds)
 			// and removal. It verifies auction intervals for every resource. 
 			aucm->addAuctioningObjects(new_auctions, evnt.get());
 
+			if (stateLog.get() != NULL) {
+				bool useIPV6;
+				string sAddressIPV4, sAddressIPV6;
+				int port;
+				
+				getControlAddress(useIPV6, sAddressIPV4, sAddressIPV6, port);
+				auto_ptr<ipap_message> message(aucm->get_ipap_message(new_auctions, iter->second, 
+												useIPV6, sAddressIPV4, sAddressIPV6, port));
+				
+				stateLogEntry_t entry;
+				entry.type = STATELOG_AUCTIONS_ADDED;
+				entry.message = getWireMessage(*message);
+				logState(entry);
+			}
+
 		}	
         saveDelete(new_auctions);
 
@@ -910,6 +1047,16 @@ void Auctioner::handleRemoveBiddingObjects(Event *e, fd_sets_t *fds)
 			BiddingObject *bidTmp = dynamic_cast<BiddingObject *>(*iter);
 			string aSet = bidTmp->getAuctionSet();
 			string aName = bidTmp->getAuctionName();
+			
+			// only bids are kept across restarts.
+			if (bidTmp->getType() == IPAP_BID) {
+				stateLogEntry_t entry;
+				entry.type = STATELOG_BIDDING_OBJECT_REMOVED;
+				entry.set = bidTmp->getSet();
+				entry.name = bidTmp->getName();
+				logState(entry);
+			}
+			
 			try
 			{
 				// The Auction can be deleted by now.
@@ -1015,8 +1162,12 @@ void Auctioner::handlePushExecution(Event *e, fd_sets_t *fds)
         if (stoptmp > stop)
 			stoptmp = stop;
         
-		// Execute the algorithm
-        proc->executeAuction(index, start, stoptmp, evnt.get());
+		// Execute the algorithm, the allocations go in the arena of the
+		// interval they end in.
+		{
+			arenaScope scope(bidm->getIntervalArena(stoptmp));
+			proc->executeAuction(index, start, stoptmp, evnt.get());
+		}
                       
         // Re-schedule the event.
         if (stoptmp < stop){
@@ -1054,14 +1205,11 @@ Auctioner::handleSingleCheckSession(string sessionId, anslp::mspec_rule_key key,
 
 	try{
 
-		ipap_message message = ipap_mes->ip_message;
+		ipap_message &message = ipap_mes->ip_message;
 
-//#ifdef DEBUG
-		anslp::msg::anslp_ipap_message messagedebug1(message);
-		anslp::msg::anslp_ipap_xml_message xmlMesdebug1;
-		string xmlMessagedebug1 = xmlMesdebug1.get_message(messagedebug1);
-		log->log(ch,xmlMessagedebug1.c_str() );
-//#endif
+#ifdef DEBUG
+		LazyLog::log(log.get(), ch, LAZY_LOG_DEBUG, IpApXmlFormatter(message));
+#endif
 
 		ostringstream os;
 		auctions = proc->getApplicableAuctions(&message);
@@ -1138,11 +1286,9 @@ Auctioner::handleSingleCheckSession(string sessionId, anslp::mspec_rule_key key,
 			objectList->insert(std::pair<anslp::mspec_rule_key, 
 										 anslp::msg::anslp_mspec_object *>(key,ipap_mes_return.copy()));
 
-//#ifdef DEBUG
-			anslp::msg::anslp_ipap_xml_message xmlMesdebug;
-			string xmlMessagedebug = xmlMesdebug.get_message(ipap_mes_return);
-			log->log(ch,xmlMessagedebug.c_str() );
-//#endif
+#ifdef DEBUG
+			LazyLog::log(log.get(), ch, LAZY_LOG_DEBUG, IpApXmlFormatter(*message_return));
+#endif
 		
 			saveDelete(message_return);
 			
@@ -1242,14 +1388,11 @@ Auctioner::handleSingleCreateSession(string sessionId, anslp::mspec_rule_key key
 
 	try{
     
-		ipap_message message = ipap_mes->ip_message;
+		ipap_message &message = ipap_mes->ip_message;
 
-//#ifdef DEBUG
-		anslp::msg::anslp_ipap_message messagedebug1(message);
-		anslp::msg::anslp_ipap_xml_message xmlMesdebug1;
-		string xmlMessagedebug1 = xmlMesdebug1.get_message(messagedebug1);
-		log->log(ch,xmlMessagedebug1.c_str() );
-//#endif		
+#ifdef DEBUG
+		LazyLog::log(log.get(), ch, LAZY_LOG_DEBUG, IpApXmlFormatter(message));
+#endif
 
 
 		auctions = proc->getApplicableAuctions(&message);
@@ -1306,6 +1449,11 @@ Auctioner::handleSingleCreateSession(string sessionId, anslp::mspec_rule_key key
 #endif
 					
 			s = new auction::Session(sessionId);
+			s->setRetransmission(retransmitTimeout, retransmitMaxTimeout, 
+								 retransmitRetries, maxPendingMessages);
+
+			// The agent numbers its messages from this one.
+			s->startReceiving(seqNo);
 
 			// Bring the id of every auction in the auctionDB.
 			auctionSet_t setAuc; 
@@ -1360,19 +1508,23 @@ Auctioner::handleSingleCreateSession(string sessionId, anslp::mspec_rule_key key
 							
 			uint32_t SeqNbr = s->getNextMessageId();
 			message_return->set_seqno(SeqNbr);
-				
-			anslp::msg::anslp_ipap_xml_message mess;
-			anslp::msg::anslp_ipap_message anlp_mess(*message_return);
 
 			// Add the message as pending for the session.
 			s->addPendingMessage(*message_return);
 				
 			anslp::anslp_ipap_message ipap_mes_return(*message_return);
-			
-			string xmlMessage = mess.get_message(anlp_mess);
 
 			// Add the new session to session manager.
 			sesm->addSession(s); 
+			armRetransmission(s);
+
+			if (stateLog.get() != NULL) {
+				stateLogEntry_t entry;
+				entry.type = STATELOG_SESSION_CREATED;
+				getSessionRecord(s, *auctions, entry.session);
+				logState(entry);
+				flushStateLog();
+			}
 
 			saveDelete(auctions);
 			
@@ -1380,10 +1532,7 @@ Auctioner::handleSingleCreateSession(string sessionId, anslp::mspec_rule_key key
 										 anslp::msg::anslp_mspec_object *>(key,ipap_mes_return.copy()));
 			
 #ifdef DEBUG
-			anslp::msg::anslp_ipap_message messagedebug(ipap_mes_return);
-			anslp::msg::anslp_ipap_xml_message xmlMesdebug;
-			string xmlMessagedebug = xmlMesdebug.get_message(messagedebug);
-			log->dlog(ch,xmlMessagedebug.c_str() );
+			LazyLog::log(log.get(), ch, LAZY_LOG_DEBUG, IpApXmlFormatter(*message_return));
 #endif
 			saveDelete(message_return);
 			
@@ -1501,6 +1650,11 @@ void Auctioner::handleRemoveSession(Event *e, fd_sets_t *fds)
 	try{
 		// Remove the session from the container.
 		sesm->delSession(sessionId, evnt.get());
+
+		stateLogEntry_t entry;
+		entry.type = STATELOG_SESSION_REMOVED;
+		entry.sessionId = sessionId;
+		logState(entry);
 	} catch(Error &e) {
 		log->dlog(ch, e.getError().c_str() );
 	}
@@ -1530,7 +1684,8 @@ void Auctioner::handleRemoveSession(Event *e, fd_sets_t *fds)
 
 
 void 
-Auctioner::handleSingleObjectAuctioningInteraction( string sessionId, anslp::anslp_ipap_message *ipap_mes)
+Auctioner::handleSingleObjectAuctioningInteraction( AuctionInteractionEvent *e, 
+							anslp::mspec_rule_key key, anslp::anslp_ipap_message *ipap_mes)
 {
 
 #ifdef DEBUG
@@ -1541,7 +1696,8 @@ Auctioner::handleSingleObjectAuctioningInteraction( string sessionId, anslp::ans
 
 	assert(ipap_mes != NULL);
 	
-    ipap_message message = ipap_mes->ip_message;
+	string sessionId = e->getSessionId();
+    ipap_message &message = ipap_mes->ip_message;
 
 	// Search for the session that is involved.
 	s = sesm->getSession(sessionId);
@@ -1559,7 +1715,19 @@ Auctioner::handleSingleObjectAuctioningInteraction( string sessionId, anslp::ans
 	log->dlog(ch,"handle Auction Interaction confirming message" );
 #endif
 			
-		s->confirmMessage(ackSeqNbr-1);
+		stateLogEntry_t entry;
+		entry.sessionId = sessionId;
+		entry.messageId = ackSeqNbr-1;
+
+		// Cumulative acks confirm every message up to the one acknowledged.
+		if (ackDelay > 0) {
+			s->confirmMessages(ackSeqNbr-1);
+			entry.type = STATELOG_MESSAGES_CONFIRMED;
+		} else {
+			s->confirmMessage(ackSeqNbr-1);
+			entry.type = STATELOG_MESSAGE_CONFIRMED;
+		}
+		logState(entry);
 			
 #ifdef DEBUG
 		log->dlog(ch,"Ending handle Auction Interaction" );
@@ -1567,71 +1735,155 @@ Auctioner::handleSingleObjectAuctioningInteraction( string sessionId, anslp::ans
 			
 	}	
 	
-	else {
-
+	// The objects may come along with an ack, whatever mode the peer uses.
 #ifdef DEBUG
-		log->dlog(ch,"handle Auction Interaction bidding object" );
+	log->dlog(ch,"handle Auction Interaction bidding object" );
 #endif
 
-		// Bring the list of local templates
-		auctionerTemplateListIter_t templIter = auctionerTemplates.find(domainId);
-		if (templIter == auctionerTemplates.end()){
-			throw Error("Local templates not initialized with domain:%d", domainId);
-		} 
-		else {	
+	// A retransmission, the objects are in but the ack may have been lost.
+	// Acks are never retransmitted, so it carries objects.
+	if (s->wasReceived(seqNbr)) {
+		s->messageReceived(seqNbr);
+		if (ackDelay > 0) {
+			armAck(s);
+		} else {
+			ipap_message conf = ipap_message(domainId, IPAP_VERSION, true);
+			conf.set_seqno(s->getNextMessageId());
+			conf.set_ackseqno(seqNbr+1);
+			conf.output();
 			
+			anslpc->tg_bidding( new anslp::session_id(sessionId), 
+									s->getReceiverAddress(), 
+									s->getSenderAddress(), 
+									s->getReceiverPort(), 
+									s->getSenderPort(),
+									s->getProtocol(), conf );
+		}
+		return;
+	}
+
+	// Over the rate the message is dropped unparsed and unacknowledged,
+	// the agent sends it again when its retransmission timer expires.
+	if (!admitBiddingMessage(s, e, key, message)) {
+		return;
+	}
+
+	// Bring the list of local templates
+	auctionerTemplateListIter_t templIter = auctionerTemplates.find(domainId);
+	if (templIter == auctionerTemplates.end()){
+		throw Error("Local templates not initialized with domain:%d", domainId);
+	} 
+	else {	
+		
+		// Parsed by the anslp thread unless the templates changed meanwhile.
+		bids = e->takeBiddingObjects(key, templatesVersion);
+		if (bids == NULL) {
+			arenaScope scope(bidm->getIntervalArena(time(NULL)));
 			bids = bidm->parseMessage(&message,templIter->second);
-				
-			// Insert the session as part of the elements of bidding object
-			auctioningObjectDBIter_t bidIter;
-			for (bidIter = bids->begin(); bidIter != bids->end(); ++bidIter)
-			{
-				BiddingObject *bidTmp = dynamic_cast<BiddingObject *>(*bidIter);
-				bidTmp->setSession(sessionId);
-				
+		}
+			
+		// Insert the session as part of the elements of bidding object
+		auctioningObjectDBIter_t bidIter;
+		for (bidIter = bids->begin(); bidIter != bids->end(); ++bidIter)
+		{
+			BiddingObject *bidTmp = dynamic_cast<BiddingObject *>(*bidIter);
+			bidTmp->setSession(sessionId);
+			
 #ifdef DEBUG
-				log->dlog(ch, "New BiddingObject After handle iteraction: %s.%s", bidTmp->getSet().c_str(), 
-					bidTmp->getName().c_str());
+			log->dlog(ch, "New BiddingObject After handle iteraction: %s.%s", bidTmp->getSet().c_str(), 
+				bidTmp->getName().c_str());
 #endif				
+		}
+			
+		// Add the bidding objects to the bidding object manager.
+		bidm->addAuctioningObjects(bids, evnt.get());  
+
+		// Acks take a number too, so every message counts for the 
+		// cumulative ack, but only the ones with objects are acknowledged.
+		s->messageReceived(seqNbr);
+
+		// We are assuming that a message with more than a bidding object its ok.
+		if ( bids->size() > 0 ){
+
+			// The ack goes later, along with the ones of the messages arriving meanwhile.
+			if (ackDelay > 0) {
+				if (stateLog.get() != NULL) {
+					stateLogEntry_t entry;
+					entry.type = STATELOG_BIDDING_OBJECTS_ADDED;
+					entry.sessionId = sessionId;
+					entry.messageId = s->getLastMessageId();
+					entry.message = getWireMessage(message);
+					logState(entry);
+				}
+
+				armAck(s);
+				return;
 			}
-				
-			// Add the bidding objects to the bidding object manager.
-			bidm->addAuctioningObjects(bids, evnt.get());  
+					
+			// Build the response for the originator agent.
+			ipap_message conf = ipap_message(domainId, IPAP_VERSION, true);
+			conf.set_seqno(s->getNextMessageId());
+
+			if (stateLog.get() != NULL) {
+				stateLogEntry_t entry;
+				entry.type = STATELOG_BIDDING_OBJECTS_ADDED;
+				entry.sessionId = sessionId;
+				entry.messageId = conf.get_seqno();
+				entry.message = getWireMessage(message);
+				logState(entry);
+			}
+			conf.set_ackseqno(seqNbr+1);
+			conf.output();
+
+			// The agent takes the objects as accepted once it gets the ack.
+			flushStateLog();
 
-			// We are assuming that a message with more than a bidding object its ok.
-			if ( bids->size() > 0 ){
-						
-				// Build the response for the originator agent.
-				ipap_message conf = ipap_message(domainId, IPAP_VERSION, true);
-				conf.set_seqno(s->getNextMessageId());
-				conf.set_ackseqno(seqNbr+1);
-				conf.output();
-								
 #ifdef DEBUG
-				// Activate to see the message to send.
-				anslp::msg::anslp_ipap_xml_message mess2;
-				anslp::msg::anslp_ipap_message anlp_mess2(conf);
-				string confXmlMessage = mess2.get_message(anlp_mess2);
+			LazyLog::log(log.get(), ch, LAZY_LOG_DEBUG, IpApXmlFormatter(conf), "Confirmation: ");
 #endif
-				// Finally send the message through the anslp client application.
-					
-				anslpc->tg_bidding( new anslp::session_id(sessionId), 
-										s->getReceiverAddress(), 
-										s->getSenderAddress(), 
-										s->getReceiverPort(), 
-										s->getSenderPort(),
-										s->getProtocol(), conf );
-			}
+
+			// Finally send the message through the anslp client application.
+				
+			anslpc->tg_bidding( new anslp::session_id(sessionId), 
+									s->getReceiverAddress(), 
+									s->getSenderAddress(), 
+									s->getReceiverPort(), 
+									s->getSenderPort(),
+									s->getProtocol(), conf );
+		}
 
 #ifdef DEBUG
-			log->dlog(ch,"Ending handle Auction Interaction" );
+		log->dlog(ch,"Ending handle Auction Interaction" );
 #endif			
 
 
-		}	
-	}
+	}	
 } 
 
+
+/* -------------------- admitBiddingMessage -------------------- */
+
+bool Auctioner::admitBiddingMessage(auction::Session *s, AuctionInteractionEvent *e,
+									anslp::mspec_rule_key key, ipap_message &message)
+{
+	// Bare acks carry no bidding objects, they cost nothing.
+	if (message.begin() == message.end()) {
+		return true;
+	}
+
+	bool admitted = !e->isOverLimit(key);
+	s->countAdmission(admitted);
+
+#ifdef DEBUG
+	if (!admitted) {
+		log->dlog(ch, "Session %s over the bidding rate, message %u dropped - rejected:%lu", 
+				  s->getSessionId().c_str(), message.get_seqno(), s->getRejectedMessages());
+	}
+#endif
+
+	return admitted;
+}
+
 void Auctioner::handleAuctioningInteraction(Event *e, fd_sets_t *fds)
 {
 
@@ -1667,7 +1919,8 @@ void Auctioner::handleAuctioningInteraction(Event *e, fd_sets_t *fds)
 				
 				anslp::anslp_ipap_message *ipap_mes = dynamic_cast<anslp::anslp_ipap_message *>(it->second);
 				if (ipap_mes != NULL)
-					handleSingleObjectAuctioningInteraction(sessionId, ipap_mes);
+					handleSingleObjectAuctioningInteraction((AuctionInteractionEvent *)e, 
+															it->first, ipap_mes);
 					
 			}
 		} else {
@@ -1694,6 +1947,9 @@ void Auctioner::handleAddGeneratedBiddingObjects(Event *e, fd_sets_t *fds)
 
        new_bids = ((AddGeneratedBiddingObjectsEvent *)e)->getBiddingObjects();
 	   index = ((AddGeneratedBiddingObjectsEvent *)e)->getIndex();
+
+	   // Archive the result of the execution.
+	   bidm->storeAuctionSummary(((AddGeneratedBiddingObjectsEvent *)e)->getSummary());
 	   
        // Add the new bidding object in the biddingObject manager
        bidm->addAuctioningObjects(new_bids, evnt.get());
@@ -1726,6 +1982,7 @@ Auctioner::handleTransmitBiddingObjects(Event *e, fd_sets_t *fds)
 #endif	
 	
 	ipap_message *mes = NULL;
+	vector<ipap_message *> messages;
 
 	try{
 		auctioningObjectDB_t *new_bids = ((TransmitBiddingObjectsEvent *)e)->getBiddingObjects();
@@ -1734,14 +1991,27 @@ Auctioner::handleTransmitBiddingObjects(Event *e, fd_sets_t *fds)
 		auctionerTemplateListIter_t templIter = auctionerTemplates.find(domainId);
 		if (templIter != auctionerTemplates.end()){
 			
+			// Group the bidding objects by session, each one gets as few messages as possible.
+			map<string, biddingObjectBatch_t> batches;
+			map<string, biddingObjectBatch_t>::iterator batchIter;
+
 			auctioningObjectDBIter_t iter;
 			for (iter = new_bids->begin(); iter != new_bids->end(); ++iter)
 			{
 				// We find the auction for the bidding object
 				BiddingObject *biddingObject = dynamic_cast<BiddingObject *>(*iter);
 			
+				AuctioningObject *ao = aucm->getAuctioningObject(biddingObject->getAuctionSet(), 
+														biddingObject->getAuctionName());
+				Auction *a = dynamic_cast<Auction *>(ao);
+
+				batches[biddingObject->getSession()].push_back(make_pair(biddingObject, a));
+			}
+
+			for (batchIter = batches.begin(); batchIter != batches.end(); ++batchIter)
+			{
 				// Search for the corresponding session for this connection
-				string sessionId = biddingObject->getSession();
+				string sessionId = batchIter->first;
 				
 				Session *session = sesm->getSession(sessionId);
 				
@@ -1752,42 +2022,68 @@ Auctioner::handleTransmitBiddingObjects(Event *e, fd_sets_t *fds)
 				
 				if (session == NULL)
 					throw Error("Session not found");
-					
-				AuctioningObject *ao = aucm->getAuctioningObject(biddingObject->getAuctionSet(), 
-														biddingObject->getAuctionName());
-				Auction *a = dynamic_cast<Auction *>(ao);
 				
-				uint32_t mid = session->getNextMessageId();
-				
-				mes = bidm->get_ipap_message(biddingObject, a, templIter->second);
+				messages = bidm->get_ipap_messages(&(batchIter->second), templIter->second, 
+												   maxMessageRecords, 
+												   templateReuse ? &(session->getPeerTemplates()) : NULL);
+
+				for (size_t i = 0; i < messages.size(); i++)
+				{
+					mes = messages[i];
+					messages[i] = NULL;
+
+					uint32_t mid = session->getNextMessageId();
 								
-				mes->set_seqno(mid);
-				mes->set_ackseqno(0);
+					mes->set_seqno(mid);
+					mes->set_ackseqno(0);
+
+					// A pending cumulative ack goes along with the objects.
+					uint32_t ackSeqNo;
+					if ((ackDelay > 0) && session->takeAck(ackSeqNo)) {
+						mes->set_ackseqno(ackSeqNo);
+						flushStateLog();
+					}
 								
-				// Save the message within the pending messages.
-				session->addPendingMessage(*mes);		
+					// Save the message within the pending messages.
+					session->addPendingMessage(*mes);		
+					armRetransmission(session);
+
+					if (templateReuse) {
+						session->addSentTemplates(mid, mes->get_template_list());
+					}
+
+					if (stateLog.get() != NULL) {
+						stateLogEntry_t entry;
+						entry.type = STATELOG_MESSAGE_SENT;
+						entry.sessionId = sessionId;
+						entry.messageId = mid;
+						entry.message = getWireMessage(*mes);
+						logState(entry);
+					}
 
 #ifdef DEBUG
-				log->dlog(ch,"ReceivAddr:%s, SenderAddr:%s, RecPort:%d, senderPort:%d, Prot:%d, mesId:", 
-							session->getReceiverAddress().get_ip_str(), session->getSenderAddress().get_ip_str(), 
-							session->getReceiverPort(), session->getSenderPort(), 
-							session->getProtocol(), mes->get_seqno()  );
+					log->dlog(ch,"ReceivAddr:%s, SenderAddr:%s, RecPort:%d, senderPort:%d, Prot:%d, mesId:", 
+								session->getReceiverAddress().get_ip_str(), session->getSenderAddress().get_ip_str(), 
+								session->getReceiverPort(), session->getSenderPort(), 
+								session->getProtocol(), mes->get_seqno()  );
 #endif
-				// Finally send the message through the anslp client application.
-				anslpc->tg_bidding( new anslp::session_id(sessionId), 
-									session->getReceiverAddress(), 
-									session->getSenderAddress(), 
-									session->getReceiverPort(), 
-									session->getSenderPort(),
-									session->getProtocol(), *mes );
-
-				saveDelete(mes);
+					// Finally send the message through the anslp client application.
+					anslpc->tg_bidding( new anslp::session_id(sessionId), 
+										session->getReceiverAddress(), 
+										session->getSenderAddress(), 
+										session->getReceiverPort(), 
+										session->getSenderPort(),
+										session->getProtocol(), *mes );
+
+					saveDelete(mes);
+				}
+				messages.clear();
+			}
 
 #ifdef DEBUG
     log->dlog(ch,"ending event process handleTransmitBiddingObjects" );
 #endif
 
-			}
 		} 
 		else 
 		{
@@ -1802,6 +2098,10 @@ Auctioner::handleTransmitBiddingObjects(Event *e, fd_sets_t *fds)
 			saveDelete(mes);
 		 }	
 
+		for (size_t i = 0; i < messages.size(); i++) {
+			saveDelete(messages[i]);
+		}
+
         if (log.get()) {
             log->elog(ch, e.getError().c_str());
         }  else {
@@ -1813,6 +2113,737 @@ Auctioner::handleTransmitBiddingObjects(Event *e, fd_sets_t *fds)
 
 
 
+/* -------------------- armRetransmission -------------------- */
+
+void Auctioner::armRetransmission(auction::Session *s)
+{
+	struct timeval when;
+
+	// One timer per session, it is armed again when it fires.
+	if (!s->isRetransmitArmed() && s->getNextRetransmission(when)) {
+		evnt->addEvent(new RetransmitMessagesEvent(when, s->getSessionId()));
+		s->setRetransmitArmed(true);
+	}
+}
+
+
+/* -------------------- handleRetransmitMessages -------------------- */
+
+void Auctioner::handleRetransmitMessages(Event *e, fd_sets_t *fds)
+{
+	string sessionId = ((RetransmitMessagesEvent *)e)->getSessionId();
+
+	// It may have been removed since the timer was armed.
+	auction::Session *s = sesm->getSession(sessionId);
+	if (s == NULL) {
+		return;
+	}
+
+	s->setRetransmitArmed(false);
+
+	struct timeval now;
+	gettimeofday(&now, NULL);
+
+	vector<ipap_message *> due;
+	vector<uint32_t> expired;
+	s->getRetransmissions(now, due, expired);
+
+	for (vector<uint32_t>::iterator iter = expired.begin(); iter != expired.end(); ++iter) {
+		log->wlog(ch, "Message %u of session %s not confirmed, dropped", 
+				  *iter, sessionId.c_str());
+
+		stateLogEntry_t entry;
+		entry.type = STATELOG_MESSAGE_EXPIRED;
+		entry.sessionId = sessionId;
+		entry.messageId = *iter;
+		logState(entry);
+	}
+
+	// The agent may have lost the session state, templates go again.
+	if (!expired.empty()) {
+		s->resetPeerTemplates();
+	}
+
+	if (!due.empty()) {
+
+#ifdef DEBUG
+		log->dlog(ch, "Retransmitting %d messages of session %s", 
+				  (int) due.size(), sessionId.c_str());
+#endif
+
+		// All of them go to the same peer in a single call.
+		std::vector<anslp::anslp_event_msg *> events;
+		for (vector<ipap_message *>::iterator iter = due.begin(); iter != due.end(); ++iter) {
+			events.push_back(anslpc->delayed_tg_bidding(new anslp::session_id(sessionId), 
+									s->getReceiverAddress(), 
+									s->getSenderAddress().get_ip_str(), 
+									s->getReceiverPort(), 
+									s->getSenderPort(),
+									s->getProtocol(), **iter));
+		}
+		anslpc->tg_bidding(&events);
+	}
+
+	armRetransmission(s);
+}
+
+
+/* -------------------- armAck -------------------- */
+
+void Auctioner::armAck(auction::Session *s)
+{
+	// Messages arriving before it fires share the ack.
+	if (!s->isAckArmed()) {
+		evnt->addEvent(new AcknowledgeMessagesEvent(s->getSessionId(), ackDelay));
+		s->setAckArmed(true);
+	}
+}
+
+
+/* -------------------- handleAcknowledgeMessages -------------------- */
+
+void Auctioner::handleAcknowledgeMessages(Event *e, fd_sets_t *fds)
+{
+	string sessionId = ((AcknowledgeMessagesEvent *)e)->getSessionId();
+
+	auction::Session *s = sesm->getSession(sessionId);
+	if (s == NULL) {
+		return;
+	}
+
+	s->setAckArmed(false);
+
+	// It may have gone along with objects sent meanwhile.
+	uint32_t ackSeqNo;
+	if (!s->takeAck(ackSeqNo)) {
+		return;
+	}
+
+	ipap_message conf = ipap_message(domainId, IPAP_VERSION, true);
+	conf.set_seqno(s->getNextMessageId());
+	conf.set_ackseqno(ackSeqNo);
+	conf.output();
+
+	// The agent takes the objects as accepted once it gets the ack.
+	flushStateLog();
+
+	anslpc->tg_bidding( new anslp::session_id(sessionId), 
+						s->getReceiverAddress(), 
+						s->getSenderAddress(), 
+						s->getReceiverPort(), 
+						s->getSenderPort(),
+						s->getProtocol(), conf );
+}
+
+
+/* -------------------- getControlAddress -------------------- */
+
+void Auctioner::getControlAddress(bool &useIPV6, string &sAddressIPV4, 
+								  string &sAddressIPV6, int &port)
+{
+	port = atoi(conf->getValue("ControlPort", "CONTROL").c_str());
+
+	useIPV6 = (ParserFcts::parseBool(conf->getValue("UseIPv6", "CONTROL")) == 1);
+	if (useIPV6) {
+		sAddressIPV6 = conf->getValue("LocalAddr-V6", "CONTROL");
+	} else {
+		sAddressIPV4 = conf->getValue("LocalAddr-V4", "CONTROL");
+	}
+}
+
+
+/* -------------------- publishTemplates -------------------- */
+
+void Auctioner::publishTemplates()
+{
+	auctionerTemplateListIter_t templIter = auctionerTemplates.find(domainId);
+	if ((anslproc.get() == NULL) || (templIter == auctionerTemplates.end())) {
+		return;
+	}
+
+	anslproc->setTemplates(templIter->second, ++templatesVersion);
+}
+
+
+/* -------------------- getWireMessage -------------------- */
+
+string Auctioner::getWireMessage(ipap_message &message)
+{
+	anslp::msg::anslp_ipap_message anlp_mess(message);
+	string out;
+	encodeIpApMessage(anlp_mess, out);
+	return out;
+}
+
+
+/* -------------------- fromWireMessage -------------------- */
+
+anslp::msg::anslp_ipap_message *Auctioner::fromWireMessage(const string &message)
+{
+	anslp::msg::anslp_ipap_message *ipap_mes = 
+		decodeIpApMessage(message.data(), message.size());
+	if (ipap_mes == NULL) {
+		throw Error("damaged message of %d bytes", (int) message.size());
+	}
+	return ipap_mes;
+}
+
+
+/* -------------------- getSessionRecord -------------------- */
+
+void Auctioner::getSessionRecord(auction::Session *s, auctioningObjectDB_t &auctions,
+								 sessionStateRecord_t &record)
+{
+	record.sessionId = s->getSessionId();
+	record.anslpSessionId = s->getAnlspSession();
+	record.state = s->getState();
+	record.senderAddress = s->getSenderAddress().get_ip_str();
+	record.receiverAddress = s->getReceiverAddress().get_ip_str();
+	record.sourceAddress = s->getSourceAddress().get_ip_str();
+	record.senderPort = s->getSenderPort();
+	record.receiverPort = s->getReceiverPort();
+	record.protocol = s->getProtocol();
+	record.lifetime = s->getLifetime();
+	record.lastMessageId = s->getLastMessageId();
+	record.lastReceived = s->getLastReceived();
+	
+	for (pendingMessageListIter_t mesIter = s->beginMessages(); 
+			mesIter != s->endMessages(); ++mesIter) {
+		record.pendingMessages.push_back(make_pair(mesIter->first, 
+											getWireMessage(mesIter->second)));
+	}
+	
+	for (auctioningObjectDBIter_t auctIter = auctions.begin(); 
+			auctIter != auctions.end(); ++auctIter) {
+		Auction *a = dynamic_cast<Auction *>(*auctIter);
+		if (a->getSessions().count(record.sessionId) > 0) {
+			record.auctions.push_back(a->getSet() + "." + a->getName());
+		}
+	}
+}
+
+
+/* -------------------- getStateSnapshot -------------------- */
+
+void Auctioner::getStateSnapshot(stateSnapshot_t &snapshot)
+{
+	auctionerTemplateListIter_t templIter = auctionerTemplates.find(domainId);
+	snapshot.created = time(NULL);
+	snapshot.auctionFile = auctionFile;
+	snapshot.auctionFileTime = getModificationTime(auctionFile);
+
+	// Every change logged so far is part of this snapshot.
+	snapshot.logSequence = (stateLog.get() != NULL) ? stateLog->getSequence() : 0;
+
+	// Auctions and their templates, as they are sent to the agents.
+	auctioningObjectDB_t auctions = aucm->getAuctioningObjects();
+	if (!auctions.empty()) {
+		bool useIPV6;
+		string sAddressIPV4, sAddressIPV6;
+		int port;
+		
+		getControlAddress(useIPV6, sAddressIPV4, sAddressIPV6, port);
+		
+		auto_ptr<ipap_message> message(aucm->get_ipap_message(&auctions, templIter->second, 
+										useIPV6, sAddressIPV4, sAddressIPV6, port));
+		snapshot.auctions = getWireMessage(*message);
+	}
+	
+	// Sessions, with the messages still waiting for confirmation.
+	sessionDB_t sessions = sesm->getSessions();
+	for (sessionDBIter_t iter = sessions.begin(); iter != sessions.end(); ++iter) {
+		snapshot.sessions.push_back(sessionStateRecord_t());
+		getSessionRecord(*iter, auctions, snapshot.sessions.back());
+	}
+	
+	// Bids still taking part in an auction.
+	auctioningObjectDB_t bids = bidm->getAuctioningObjects();
+	for (auctioningObjectDBIter_t iter = bids.begin(); iter != bids.end(); ++iter) {
+		
+		BiddingObject *b = dynamic_cast<BiddingObject *>(*iter);
+		if ((b->getType() != IPAP_BID) || (b->getState() == AO_DONE) || 
+			(b->getState() == AO_ERROR)) {
+			continue;
+		}
+		
+		Auction *a = aucm->getAuction(b->getAuctionSet(), b->getAuctionName());
+		if (a == NULL) {
+			continue;
+		}
+		
+		auto_ptr<ipap_message> message(bidm->get_ipap_message(b, a, templIter->second));
+		
+		snapshot.biddingObjects.push_back(biddingObjectStateRecord_t());
+		snapshot.biddingObjects.back().sessionId = b->getSession();
+		snapshot.biddingObjects.back().message = getWireMessage(*message);
+	}
+}
+
+
+/* -------------------- saveState -------------------- */
+
+void Auctioner::saveState()
+{
+	try {
+		stateSnapshot_t snapshot;
+		getStateSnapshot(snapshot);
+		StateSnapshot::write(snapshotFile, snapshot);
+
+		// The snapshot is on disk, the entries it includes are not needed anymore.
+		if (stateLog.get() != NULL) {
+			stateLog->compact(snapshot.logSequence);
+		}
+
+#ifdef DEBUG
+		log->dlog(ch, "state saved in %s: %d sessions, %d bidding objects", 
+					snapshotFile.c_str(), snapshot.sessions.size(), 
+					snapshot.biddingObjects.size());
+#endif
+
+	} catch (Error &e) {
+		// the previous snapshot is still there, try again on the next timer.
+		log->elog(ch, "cannot save the state: %s", e.getError().c_str());
+	} catch (ipap_bad_argument &e) {
+		log->elog(ch, "cannot save the state: %s", e.what());
+	}
+}
+
+
+/* -------------------- logState -------------------- */
+
+void Auctioner::logState(stateLogEntry_t &entry)
+{
+	if (stateLog.get() != NULL) {
+		stateLog->append(entry);
+	}
+}
+
+
+/* -------------------- flushStateLog -------------------- */
+
+void Auctioner::flushStateLog()
+{
+	if (stateLog.get() == NULL) {
+		return;
+	}
+
+	stateLog->flush();
+
+	// The main loop may sleep until the next event, the timer bounds 
+	// the entries a crash of the host can lose.
+	struct timeval when;
+	if (!stateLogSyncArmed && stateLog->getNextSync(when)) {
+		evnt->addEvent(new SyncStateLogEvent(when));
+		stateLogSyncArmed = true;
+	}
+}
+
+
+/* -------------------- handleSyncStateLog -------------------- */
+
+void Auctioner::handleSyncStateLog(Event *e, fd_sets_t *fds)
+{
+	stateLogSyncArmed = false;
+
+	if (stateLog.get() != NULL) {
+		stateLog->sync();
+	}
+}
+
+
+/* -------------------- addAuctionsMessage -------------------- */
+
+void Auctioner::addAuctionsMessage(const string &message)
+{
+	auctionerTemplateListIter_t templIter = auctionerTemplates.find(domainId);
+	anslp::msg::anslp_ipap_message *ipap_mes = NULL;
+	auctioningObjectDB_t *auctions = NULL;
+	
+	try {
+		ipap_mes = fromWireMessage(message);
+		
+		// the templates keep their ids, the agents refer to them.
+		auctions = aucm->parseMessage(&(ipap_mes->ip_message), templIter->second);
+		saveDelete(ipap_mes);
+		publishTemplates();
+		
+		list<int> templateIds = templIter->second->get_template_list();
+		for (list<int>::iterator iter = templateIds.begin(); iter != templateIds.end(); ++iter) {
+			TemplateIdSource::getInstance()->reserveId((uint16_t) *iter);
+		}
+		
+		for (auctioningObjectDBIter_t iter = auctions->begin(); iter != auctions->end(); ++iter) {
+			(*iter)->setState(AO_NEW);
+		}
+		
+		if (!resm->verifyAuctions(auctions)) {
+			throw Error("the auctions do not fit the resources");
+		}
+		
+		aucm->addAuctioningObjects(auctions, evnt.get());
+		saveDelete(auctions);
+		
+	} catch (...) {
+		if (ipap_mes) {
+			saveDelete(ipap_mes);
+		}
+	
+		if (auctions) {
+			for (auctioningObjectDBIter_t iter = auctions->begin(); iter != auctions->end(); ++iter) {
+				saveDelete(*iter);
+			}
+			saveDelete(auctions);
+		}
+		throw;
+	}
+}
+
+
+/* -------------------- addBiddingObjectsMessage -------------------- */
+
+uint32_t Auctioner::addBiddingObjectsMessage(string sessionId, const string &message)
+{
+	auctionerTemplateListIter_t templIter = auctionerTemplates.find(domainId);
+	auctioningObjectDB_t *bids = NULL;
+	
+	auto_ptr<anslp::msg::anslp_ipap_message> ipap_mes(fromWireMessage(message));
+	
+	{
+		arenaScope scope(bidm->getIntervalArena(time(NULL)));
+		bids = bidm->parseMessage(&(ipap_mes->ip_message), templIter->second);
+	}
+	
+	for (auctioningObjectDBIter_t iter = bids->begin(); iter != bids->end(); ++iter) {
+		BiddingObject *b = dynamic_cast<BiddingObject *>(*iter);
+		b->setSession(sessionId);
+		b->setState(AO_NEW);
+	}
+	
+	// scheduled for activation as if they had just arrived.
+	bidm->addAuctioningObjects(bids, evnt.get());
+	saveDelete(bids);
+	
+	return ipap_mes->ip_message.get_seqno();
+}
+
+
+/* -------------------- restoreSession -------------------- */
+
+void Auctioner::restoreSession(const sessionStateRecord_t &record)
+{
+	auction::Session *s = new auction::Session(record.sessionId);
+	
+	try {
+		s->setRetransmission(retransmitTimeout, retransmitMaxTimeout, 
+							 retransmitRetries, maxPendingMessages);
+		s->setSenderAddress(record.senderAddress);
+		s->setReceiverAddress(record.receiverAddress);
+		s->setSourceAddress(record.sourceAddress);
+		s->setSenderPort(record.senderPort);
+		s->setReceiverPort(record.receiverPort);
+		s->setProtocol(record.protocol);
+		s->setLifetime(record.lifetime);
+		s->setAnlspSession(record.anslpSessionId);
+		
+		// keep numbering where the agent expects it.
+		s->setLastMessageId(record.lastMessageId);
+		
+		// and the messages of the agent already processed.
+		s->startReceiving(record.lastReceived);
+		
+		pendingMessageRecordListConstIter_t mesIter;
+		for (mesIter = record.pendingMessages.begin(); 
+				mesIter != record.pendingMessages.end(); ++mesIter) {
+			auto_ptr<anslp::msg::anslp_ipap_message> ipap_mes(fromWireMessage(mesIter->second));
+			s->addPendingMessage(ipap_mes->ip_message);
+		}
+		
+	} catch (...) {
+		saveDelete(s);
+		throw;
+	}
+	
+	sesm->addSession(s);
+	armRetransmission(s);
+	
+	s->setState((sessionState_t) record.state);
+	if (!record.anslpSessionId.empty()) {
+		sesm->indexActiveSession(record.sessionId, record.anslpSessionId);
+	}
+	
+	auctionSet_t setAuc;
+	vector<string>::const_iterator auctIter;
+	for (auctIter = record.auctions.begin(); auctIter != record.auctions.end(); ++auctIter) {
+		size_t dot = auctIter->find(".");
+		Auction *a = aucm->getAuction(auctIter->substr(0, dot), auctIter->substr(dot + 1));
+		if (a != NULL) {
+			setAuc.insert(a->getUId());
+		}
+	}
+	aucm->incrementReferences(setAuc, record.sessionId);
+}
+
+
+/* -------------------- restoreAuctions -------------------- */
+
+bool Auctioner::restoreAuctions(const stateSnapshot_t &snapshot)
+{
+	if (snapshot.auctions.empty()) {
+		return false;
+	}
+
+	try {
+		addAuctionsMessage(snapshot.auctions);
+		return true;
+		
+	} catch (Error &e) {
+		log->elog(ch, "cannot restore the auctions: %s", e.getError().c_str());
+	} catch (anslp::msg::anslp_ipap_bad_argument &e) {
+		log->elog(ch, "cannot restore the auctions: %s", e.what());
+	} catch (ipap_bad_argument &e) {
+		log->elog(ch, "cannot restore the auctions: %s", e.what());
+	}
+
+	// start from the auction file with a clean set of templates.
+	auctionerTemplates.find(domainId)->second->delete_all_templates();
+	publishTemplates();
+	return false;
+}
+
+
+/* -------------------- restoreSessions -------------------- */
+
+void Auctioner::restoreSessions(const stateSnapshot_t &snapshot)
+{
+	sessionStateRecordListConstIter_t iter;
+	for (iter = snapshot.sessions.begin(); iter != snapshot.sessions.end(); ++iter) {
+		try {
+			restoreSession(*iter);
+		} catch (Error &e) {
+			log->elog(ch, "cannot restore session %s: %s", iter->sessionId.c_str(), 
+						e.getError().c_str());
+		} catch (anslp::msg::anslp_ipap_bad_argument &e) {
+			log->elog(ch, "cannot restore session %s: %s", iter->sessionId.c_str(), e.what());
+		}
+	}
+}
+
+
+/* -------------------- restoreBiddingObjects -------------------- */
+
+void Auctioner::restoreBiddingObjects(const stateSnapshot_t &snapshot)
+{
+	biddingObjectStateRecordListConstIter_t iter;
+	for (iter = snapshot.biddingObjects.begin(); iter != snapshot.biddingObjects.end(); ++iter) {
+		try {
+			addBiddingObjectsMessage(iter->sessionId, iter->message);
+		} catch (Error &e) {
+			log->elog(ch, "cannot restore a bidding object: %s", e.getError().c_str());
+		} catch (anslp::msg::anslp_ipap_bad_argument &e) {
+			log->elog(ch, "cannot restore a bidding object: %s", e.what());
+		} catch (ipap_bad_argument &e) {
+			log->elog(ch, "cannot restore a bidding object: %s", e.what());
+		}
+	}
+}
+
+
+/* -------------------- replayStateLogEntry -------------------- */
+
+void Auctioner::replayStateLogEntry(const stateLogEntry_t &entry)
+{
+	auction::Session *s = NULL;
+	
+	if (!entry.sessionId.empty()) {
+		s = sesm->getSession(entry.sessionId);
+	}
+
+	switch (entry.type) {
+	case STATELOG_AUCTIONS_ADDED:
+		addAuctionsMessage(entry.message);
+		break;
+		
+	case STATELOG_AUCTION_REMOVED:
+		{
+			Auction *a = aucm->getAuction(entry.set, entry.name);
+			if (a != NULL) {
+				auctioningObjectDB_t auctions(1, a);
+				aucm->delAuctioningObjects(&auctions, evnt.get());
+			}
+		}
+		break;
+		
+	case STATELOG_BIDDING_OBJECTS_ADDED:
+		{
+			uint32_t seqNo = addBiddingObjectsMessage(entry.sessionId, entry.message);
+			if (s != NULL) {
+				if (entry.messageId > s->getLastMessageId()) {
+					s->setLastMessageId(entry.messageId);
+				}
+				// Bare acks are not logged, so the agent's messages up to 
+				// this one count as received, its retransmissions are dropped.
+				s->startReceiving(seqNo);
+			}
+		}
+		break;
+		
+	case STATELOG_BIDDING_OBJECT_REMOVED:
+		{
+			BiddingObject *b = dynamic_cast<BiddingObject *>(
+									bidm->getAuctioningObject(entry.set, entry.name));
+			if (b != NULL) {
+				// it was archived when it was removed.
+				bidm->delBiddingObject(b, evnt.get(), false);
+			}
+		}
+		break;
+		
+	case STATELOG_SESSION_CREATED:
+		restoreSession(entry.session);
+		break;
+		
+	case STATELOG_SESSION_REMOVED:
+		if (s != NULL) {
+			sesm->delSession(s, evnt.get());
+		}
+		break;
+		
+	case STATELOG_MESSAGE_SENT:
+		if (s != NULL) {
+			auto_ptr<anslp::msg::anslp_ipap_message> ipap_mes(fromWireMessage(entry.message));
+			s->addPendingMessage(ipap_mes->ip_message);
+			armRetransmission(s);
+			if (entry.messageId > s->getLastMessageId()) {
+				s->setLastMessageId(entry.messageId);
+			}
+		}
+		break;
+		
+	case STATELOG_MESSAGE_CONFIRMED:
+	case STATELOG_MESSAGE_EXPIRED:
+		if (s != NULL) {
+			s->confirmMessage(entry.messageId);
+		}
+		break;
+
+	case STATELOG_MESSAGES_CONFIRMED:
+		if (s != NULL) {
+			s->confirmMessages(entry.messageId);
+		}
+		break;
+		
+	default:
+		break;
+	}
+}
+
+
+/* -------------------- replayStateLog -------------------- */
+
+unsigned long Auctioner::replayStateLog(uint64_t after)
+{
+	StateLogReader reader(stateLog->getFileName());
+	stateLogEntry_t entry;
+	unsigned long applied = 0;
+	
+	while (reader.next(entry)) {
+		
+		// already in the snapshot
+		if (entry.sequence <= after) {
+			continue;
+		}
+		
+		try {
+			replayStateLogEntry(entry);
+			applied++;
+		} catch (Error &e) {
+			log->elog(ch, "cannot replay state log entry %llu: %s", 
+						(unsigned long long) entry.sequence, e.getError().c_str());
+		} catch (anslp::msg::anslp_ipap_bad_argument &e) {
+			log->elog(ch, "cannot replay state log entry %llu: %s", 
+						(unsigned long long) entry.sequence, e.what());
+		} catch (ipap_bad_argument &e) {
+			log->elog(ch, "cannot replay state log entry %llu: %s", 
+						(unsigned long long) entry.sequence, e.what());
+		}
+	}
+	
+	return applied;
+}
+
+
+/* -------------------- handleSaveState -------------------- */
+
+void Auctioner::handleSaveState(Event *e, fd_sets_t *fds)
+{
+	saveState();
+}
+
+
+/* -------------------- handleRestoreState -------------------- */
+
+void Auctioner::handleRestoreState(Event *e, fd_sets_t *fds)
+{
+	string fileName = ((RestoreStateEvent *)e)->getFileName();
+	string afn = ((RestoreStateEvent *)e)->getAuctionFile();
+	
+	stateSnapshot_t snapshot;
+	bool found = false;
+	
+	try {
+		found = StateSnapshot::read(fileName, snapshot);
+	} catch (Error &err) {
+		log->elog(ch, "ignoring the snapshot: %s", err.getError().c_str());
+	}
+
+	// An auction file edited since the snapshot replaces the saved state,
+	// the changes logged refer to the auctions of the old one.
+	bool changed = false;
+	if (found && !afn.empty() && ((snapshot.auctionFile != afn) || 
+		(snapshot.auctionFileTime != getModificationTime(afn)))) {
+		log->log(ch, "auction file %s changed since the snapshot, it is loaded instead",
+					afn.c_str());
+		found = false;
+		changed = true;
+	}
+	
+	if (found && restoreAuctions(snapshot)) {
+		restoreSessions(snapshot);
+		restoreBiddingObjects(snapshot);
+		
+		unsigned long replayed = 0;
+		if (stateLog.get() != NULL) {
+			replayed = replayStateLog(snapshot.logSequence);
+		}
+		
+		log->log(ch, "state restored from %s taken at %s and %lu later changes: "
+					"%d sessions, %d bidding objects", fileName.c_str(), 
+					Timeval::toString(snapshot.created).c_str(), replayed,
+					sesm->getNumSessions(), bidm->getNumAuctioningObjects());
+		return;
+	}
+	
+	// Without a snapshot the log is only complete if it was never compacted.
+	if (!changed && (stateLog.get() != NULL) && (stateLog->getBaseSequence() == 0)) {
+		unsigned long replayed = replayStateLog(0);
+		if (aucm->getNumAuctioningObjects() > 0) {
+			log->log(ch, "state restored from %lu changes in %s", replayed, 
+						stateLog->getFileName().c_str());
+			return;
+		}
+	}
+	
+	if (stateLog.get() != NULL) {
+		// what is left refers to a snapshot that is gone.
+		stateLog->compact(stateLog->getSequence());
+	}
+	
+	if (!afn.empty()) {
+		evnt->addEvent(new AddAuctionsEvent(afn));
+	}
+}
+
+
 /* -------------------- handleEvent -------------------- */
 
 void Auctioner::handleEvent(Event *e, fd_sets_t *fds)
@@ -1906,6 +2937,26 @@ void Auctioner::handleEvent(Event *e, fd_sets_t *fds)
     case REMOVE_SESSION:
 		handleRemoveSession(e,fds);
 		break;
+
+	case SAVE_STATE:
+		handleSaveState(e,fds);
+		break;
+
+	case RESTORE_STATE:
+		handleRestoreState(e,fds);
+		break;
+
+	case SYNC_STATE_LOG:
+		handleSyncStateLog(e,fds);
+		break;
+
+	case RETRANSMIT_MESSAGES:
+		handleRetransmitMessages(e,fds);
+		break;
+
+	case ACKNOWLEDGE_MESSAGES:
+		handleAcknowledgeMessages(e,fds);
+		break;
 		
     default:
 
@@ -1955,9 +3006,16 @@ void Auctioner::run()
 			evnt->addEvent(new CtrlCommTimerEvent(t, t * 1000));
 		}
 		
+		// register a timer for the state snapshots, with a state log they
+		// are only taken when it grows too large and on shutdown.
+		if (!snapshotFile.empty() && (stateLog.get() == NULL) && (snapshotInterval > 0)) {
+			evnt->addEvent(new SaveStateEvent(snapshotInterval, snapshotInterval * 1000));
+		}
+		
 		
         // start threads (if threading is configured)
         proc->run();
+        anslproc->run();
 
 #ifdef DEBUG
         log->dlog(ch,"------- Auction Manager is running -------");
@@ -1973,8 +3031,9 @@ void Auctioner::run()
 	    			
 			tv = evnt->getNextEventTime();
 			
-			// Calculates the min between the event timeout and the anslp queu timeout 
-			if (Timeval::cmp(tv_anslp, tv) < 0) 
+			// Calculates the min between the event timeout and the anslp queu timeout,
+			// not needed when the anslp queue wakes up select.
+			if (!anslpSignal && (Timeval::cmp(tv_anslp, tv) < 0)) 
 				tv = tv_anslp;
 
             // note: under most unix the minimal sleep time of select is
@@ -2046,10 +3105,14 @@ void Auctioner::run()
 #ifdef DEBUG			
 			log->dlog(ch,"after proc handleFDEvent");
 #endif
-			if (!aprocThread) {
-				anslproc->handleFDEvent(&retEvents, NULL,NULL, NULL);
+			// without threads the anslp socket is read here.
+			if (socketTransport != NULL) {
+				socketTransport->receive();
 			}
 
+			// threaded it only takes the events already converted.
+			anslproc->handleFDEvent(&retEvents, NULL,NULL, NULL);
+
 #ifdef DEBUG			
 			log->dlog(ch,"after anslp proc handleFDEvent");
 #endif
@@ -2064,12 +3127,25 @@ void Auctioner::run()
                 retEvents.clear(); 
             }
 
+			// write the state changes of this round, one write call.
+			if (stateLog.get() != NULL) {
+				flushStateLog();
+				if (stateLog->getSize() > stateLogMaxSize) {
+					saveState();
+				}
+			}
+
 //#ifdef DEBUG			
 //			log->dlog(ch,"it is going to start again");
 //#endif
 
         } while (!stop);
 
+		// leave a fresh snapshot for the next start
+		if (!snapshotFile.empty()) {
+			saveState();
+		}
+
 		proc->waitUntilDone();
 
 		// Cleaup the OPEN SSL framework.
@@ -2283,6 +3359,15 @@ void Auctioner::handleRemoveAuctions(Event *e, fd_sets_t *fds)
 		}
 		*/
 						
+		auctioningObjectDBIter_t iter;
+		for (iter = auctions->begin(); iter != auctions->end(); ++iter) {
+			stateLogEntry_t entry;
+			entry.type = STATELOG_AUCTION_REMOVED;
+			entry.set = (*iter)->getSet();
+			entry.name = (*iter)->getName();
+			logState(entry);
+		}
+						
 		// Remove the auction from the manager
 		aucm->delAuctioningObjects(auctions, evnt.get());
 
@@ -0,0 +1,404 @@
+/*! \file   journal_replay.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Replay a journal of bidding objects and auction summaries into the
+    database or export it to csv.
+
+    $Id: journal_replay.cpp 748 2015-08-13 16:40:00Z amarentes $
+*/
+
+#include "config.h"
+#include "stdincpp.h"
+#include "Error.h"
+#include "CommandLineArgs.h"
+#include "BiddingObjectJournal.h"
+#include "BiddingObjectBulkLoader.h"
+#include "ArchivePartitions.h"
+#include "Constants.h"
+#include <pqxx/pqxx>
+
+using namespace auction;
+
+//! records loaded per transaction when no batch size is given
+const unsigned int REPLAY_BATCH_SIZE = 1000;
+
+//! table keeping, for every journal, the last entry loaded
+const string REPLAY_MARK_TABLE = "auctionJournalReplay";
+
+
+//! quote a value for csv (RFC 4180).
+static string csvQuote(const string &value)
+{
+	if (value.find_first_of(",\"\r\n") == string::npos) {
+		return value;
+	}
+
+	string out = "\"";
+	for (string::size_type i = 0; i < value.size(); i++) {
+		if (value[i] == '"') {
+			out += '"';
+		}
+		out += value[i];
+	}
+	return out + "\"";
+}
+
+
+//! release the records of the batch.
+static void releaseBatch(biddingObjectRecordBatch_t &batch, auctionSummaryBatch_t &summaries)
+{
+	biddingObjectRecordBatchIter_t iter;
+	for (iter = batch.begin(); iter != batch.end(); ++iter) {
+		delete *iter;
+	}
+	batch.clear();
+
+	auctionSummaryBatchIter_t summaryIter;
+	for (summaryIter = summaries.begin(); summaryIter != summaries.end(); ++summaryIter) {
+		delete *summaryIter;
+	}
+	summaries.clear();
+}
+
+
+//! create the table of the replay marks if needed.
+static void createMarkTable(pqxx::connection &conn)
+{
+	pqxx::work w(conn);
+	w.exec("CREATE TABLE IF NOT EXISTS " + REPLAY_MARK_TABLE + " ("
+		   "journal VARCHAR(1024) PRIMARY KEY, "
+		   "entryOffset BIGINT NOT NULL, "
+		   "entryCrc BIGINT NOT NULL)");
+	w.commit();
+}
+
+
+/*! \short  continue after the last entry of the journal loaded before
+	\returns true if entries were loaded before.
+*/
+static bool resumeFromMark(pqxx::connection &conn, BiddingObjectJournalReader &reader,
+						   const string &journal)
+{
+	pqxx::work w(conn);
+	pqxx::result r = w.exec("SELECT entryOffset, entryCrc FROM " + REPLAY_MARK_TABLE +
+							" WHERE journal = " + w.quote(journal));
+	w.commit();
+
+	if (r.empty()) {
+		return false;
+	}
+
+	unsigned long offset = r[0][0].as<unsigned long>();
+	uint32_t crc = (uint32_t) r[0][1].as<unsigned long>();
+
+	if (!reader.resume(offset, crc)) {
+		cerr << "journal " << journal << " does not match what was loaded from it, "
+			 << "it is loaded from the start" << endl;
+		return false;
+	}
+	return true;
+}
+
+
+//! record the last entry read, in the transaction loading it.
+static void writeMark(pqxx::work &w, BiddingObjectJournalReader &reader, const string &journal)
+{
+	string values = "entryOffset = " + w.quote(reader.getLastOffset()) + 
+					", entryCrc = " + w.quote((unsigned long) reader.getLastCrc());
+
+	pqxx::result r = w.exec("UPDATE " + REPLAY_MARK_TABLE + " SET " + values +
+							" WHERE journal = " + w.quote(journal));
+
+	if (r.affected_rows() == 0) {
+		w.exec("INSERT INTO " + REPLAY_MARK_TABLE + " VALUES (" + w.quote(journal) + "," +
+			   w.quote(reader.getLastOffset()) + "," + 
+			   w.quote((unsigned long) reader.getLastCrc()) + ")");
+	}
+}
+
+
+/*! \short  load the batch and the mark after it in one transaction
+
+	with partitions the rows go to the partition of the time they are
+	loaded, as the auction manager does with the rows it writes.
+*/
+static void loadBatch(pqxx::connection &conn, biddingObjectRecordBatch_t &batch,
+					  auctionSummaryBatch_t &summaries, BiddingObjectJournalReader &reader,
+					  const string &journal, ArchivePartitions *partitions)
+{
+	if (batch.empty() && summaries.empty()) {
+		return;
+	}
+
+	string suffix;
+	if (partitions != NULL) {
+		time_t now = time(NULL);
+		partitions->maintain(conn, now);
+		suffix = partitions->getSuffix(now);
+	}
+
+	pqxx::work w(conn);
+	if (!batch.empty()) {
+		BiddingObjectBulkLoader::load(w, batch, suffix);
+	}
+	BiddingObjectBulkLoader::loadSummaries(w, summaries, suffix);
+	writeMark(w, reader, journal);
+	w.commit();
+}
+
+
+/* ------------------------- replayDatabase ------------------------- */
+
+/*! Entries loaded are marked in the database, in the same transaction, so
+	replaying a journal again only loads the entries appended since; with
+	fromStart the mark is ignored and every entry is loaded again.
+	A partition interval other than 0 loads into the archive partitions,
+	which are created when missing but never expired here.
+*/
+static unsigned long replayDatabase(BiddingObjectJournalReader &reader, string connectionDb,
+									unsigned int batchSize, const string &journal,
+									bool fromStart, unsigned long archiveInterval)
+{
+	auto_ptr<ArchivePartitions> partitions;
+	if (archiveInterval > 0) {
+		partitions.reset(new ArchivePartitions(archiveInterval, ARCHIVE_PARTITIONS_AHEAD, 
+											   0, true));
+	}
+
+	pqxx::connection conn(connectionDb);
+
+	createMarkTable(conn);
+	BiddingObjectBulkLoader::createSummaryTable(conn);
+
+	if (!fromStart && resumeFromMark(conn, reader, journal)) {
+		cout << "continuing " << journal << " after offset " << reader.getOffset() << endl;
+	}
+
+	biddingObjectRecordBatch_t batch;
+	auctionSummaryBatch_t summaries;
+	unsigned long loaded = 0;
+
+	try {
+		biddingObjectRecord_t *record = new biddingObjectRecord_t;
+		auctionSummaryRecord_t *summary = new auctionSummaryRecord_t;
+		journalEntry_t type;
+
+		while ((type = reader.next(*record, *summary)) != JOURNAL_END) {
+			if (type == JOURNAL_BIDDING_OBJECT) {
+				batch.push_back(record);
+				record = new biddingObjectRecord_t;
+			} else {
+				summaries.push_back(summary);
+				summary = new auctionSummaryRecord_t;
+			}
+
+			if (batch.size() + summaries.size() >= batchSize) {
+				loadBatch(conn, batch, summaries, reader, journal, partitions.get());
+				loaded += batch.size() + summaries.size();
+				releaseBatch(batch, summaries);
+			}
+		}
+		delete record;
+		delete summary;
+
+		loadBatch(conn, batch, summaries, reader, journal, partitions.get());
+		loaded += batch.size() + summaries.size();
+		releaseBatch(batch, summaries);
+
+	} catch (...) {
+		releaseBatch(batch, summaries);
+		cerr << loaded << " entries loaded before the error" << endl;
+		throw;
+	}
+
+	return loaded;
+}
+
+
+/* ------------------------- exportCsv ------------------------- */
+
+//! create the csv file and write the line with the column names.
+static void openCsv(ofstream &out, string fileName, const vector<string> &columns)
+{
+	out.open(fileName.c_str(), ios::out | ios::trunc);
+	if (!out) {
+		throw Error("cannot create %s", fileName.c_str());
+	}
+
+	for (unsigned int i = 0; i < columns.size(); i++) {
+		out << (i > 0 ? "," : "") << csvQuote(columns[i]);
+	}
+	out << "\n";
+}
+
+
+//! write the rows as csv lines.
+static void writeCsv(ofstream &out, bulkRowList_t &rows)
+{
+	for (bulkRowListIter_t row = rows.begin(); row != rows.end(); ++row) {
+		for (unsigned int i = 0; i < row->size(); i++) {
+			out << (i > 0 ? "," : "") << csvQuote((*row)[i]);
+		}
+		out << "\n";
+	}
+}
+
+
+//! close the csv file, checking that everything was written.
+static void closeCsv(ofstream &out, string fileName)
+{
+	out.close();
+	if (out.fail()) {
+		throw Error("cannot write %s", fileName.c_str());
+	}
+}
+
+
+static unsigned long exportCsv(BiddingObjectJournalReader &reader, string prefix)
+{
+	ofstream out[BO_NUM_TABLES];
+	ofstream summaryOut;
+
+	for (int t = 0; t < BO_NUM_TABLES; t++) {
+		biddingObjectTable_t table = (biddingObjectTable_t) t;
+		openCsv(out[t], prefix + BiddingObjectBulkLoader::getTableName(table) + ".csv",
+				BiddingObjectBulkLoader::getColumns(table));
+	}
+
+	string summaryFile = prefix + BiddingObjectBulkLoader::getSummaryTableName() + ".csv";
+	openCsv(summaryOut, summaryFile, BiddingObjectBulkLoader::getSummaryColumns());
+
+	unsigned long exported = 0;
+	biddingObjectRecord_t record;
+	auctionSummaryRecord_t summary;
+	journalEntry_t type;
+
+	while ((type = reader.next(record, summary)) != JOURNAL_END) {
+		if (type == JOURNAL_BIDDING_OBJECT) {
+			for (int t = 0; t < BO_NUM_TABLES; t++) {
+				bulkRowList_t rows;
+				BiddingObjectBulkLoader::appendRows(record, (biddingObjectTable_t) t, rows);
+				writeCsv(out[t], rows);
+			}
+			record = biddingObjectRecord_t();
+		} else {
+			bulkRowList_t rows;
+			BiddingObjectBulkLoader::appendSummaryRow(summary, rows);
+			writeCsv(summaryOut, rows);
+		}
+
+		exported++;
+	}
+
+	for (int t = 0; t < BO_NUM_TABLES; t++) {
+		closeCsv(out[t], prefix + BiddingObjectBulkLoader::getTableName((biddingObjectTable_t) t) 
+						 + ".csv");
+	}
+	closeCsv(summaryOut, summaryFile);
+
+	return exported;
+}
+
+
+/* ------------------------- main() ------------------------- */
+
+int main(int argc, char *argv[])
+{
+	try {
+
+		CommandLineArgs args;
+
+		args.add('j', "JournalFile", "<file>", "journal to replay", "MAIN", "journal");
+		args.add('d', "Connection", "<string>", "load into the database, e.g. "
+				 "\"dbname=auctionDB user=postgres hostaddr=127.0.0.1 port=5432\"",
+				 "MAIN", "db");
+		args.add('o', "CsvPrefix", "<prefix>", "write <prefix><table>.csv files",
+				 "MAIN", "csv");
+		args.add('b', "BatchSize", "<number>", "entries per transaction",
+				 "MAIN", "batch");
+		args.add('p', "ArchivePartitionInterval", "<seconds>", "load into the archive "
+				 "partitions of this interval, as set in the auction manager configuration",
+				 "MAIN", "partitions");
+		args.addFlag('a', "FromStart", "load every entry again, not only the ones "
+					 "appended since the last load", "MAIN", "all");
+
+		if (args.parseArgs(argc, argv)) {
+			// user wanted help
+			exit(0);
+		}
+
+		string journalFile = args.getArgValue('j');
+		string connectionDb = args.getArgValue('d');
+		string csvPrefix = args.getArgValue('o');
+
+		if (journalFile.empty() || (connectionDb.empty() == csvPrefix.empty())) {
+			cerr << "Usage: " << argv[0] << " -j <file> (-d <string> [-a] [-p <seconds>] | -o <prefix>)" 
+				 << endl
+				 << args.getUsage();
+			exit(1);
+		}
+
+		unsigned int batchSize = REPLAY_BATCH_SIZE;
+		if (!args.getArgValue('b').empty()) {
+			batchSize = atoi(args.getArgValue('b').c_str());
+			if (batchSize == 0) {
+				throw Error("invalid batch size %s", args.getArgValue('b').c_str());
+			}
+		}
+
+		unsigned long archiveInterval = 0;
+		if (!args.getArgValue('p').empty()) {
+			archiveInterval = strtoul(args.getArgValue('p').c_str(), NULL, 10);
+		}
+
+		BiddingObjectJournalReader reader(journalFile);
+
+		unsigned long n;
+		if (!connectionDb.empty()) {
+			// The mark is kept under the full path, whatever path is given.
+			char *path = realpath(journalFile.c_str(), NULL);
+			string journal = (path != NULL) ? string(path) : journalFile;
+			free(path);
+
+			n = replayDatabase(reader, connectionDb, batchSize, journal, 
+							   !args.getArgValue('a').empty(), archiveInterval);
+			cout << n << " entries loaded from " << journalFile << endl;
+		} else {
+			n = exportCsv(reader, csvPrefix);
+			cout << n << " entries exported from " << journalFile << endl;
+		}
+
+		if (reader.isCorrupt()) {
+			cerr << "damaged entry at offset " << reader.getOffset()
+				 << ", the rest of the journal was ignored" << endl;
+			exit(2);
+		}
+
+	} catch (Error &e) {
+		cerr << "Error: " << e.getError() << endl;
+		exit(1);
+	} catch (const std::exception &e) {
+		cerr << "Error: " << e.what() << endl;
+		exit(1);
+	}
+
+	return 0;
+}
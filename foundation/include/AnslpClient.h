@@ -41,6 +41,7 @@
 #include "anslp_daemon.h"
 #include "auction_rule.h"
 #include "msg/anslp_ipap_message.h"
+#include "AnslpTransport.h"
 
 
 namespace auction
@@ -67,9 +68,15 @@ class AnslpClient
 		//! Pointer to the anslp deamon object .
 		anslp::anslp_daemon *anslpd; 
 
+		//! transport used instead of the daemon, NULL when the daemon runs.
+		AnslpTransport *transport;
+
 	public:
 		
 		AnslpClient(string config_filename, anslp::FastQueue *installQueue=NULL);
+
+		//! use the transport instead of the daemon, which is not started
+		AnslpClient(AnslpTransport *_transport);
 		
 		~AnslpClient();
 		
@@ -99,6 +106,7 @@ class AnslpClient
 					    uint16_t source_port, uint16_t dest_port, 
 						uint8_t protocol, ipap_message &message);
 
+		//! with a transport the message goes at once and NULL is returned.
 		anslp::anslp_event_msg *
 		delayed_tg_bidding(anslp::session_id *sid, 
 						   const protlib::hostaddress &source_addr, 
@@ -0,0 +1,104 @@
+/*! \file   AnslpEventTransport.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Transport building the anslp events the daemon of the peer would produce.
+
+    $Id: AnslpEventTransport.h 748 2015-08-23 16:05:00Z amarentes $
+*/
+
+#ifndef _ANSLP_EVENT_TRANSPORT_H_
+#define _ANSLP_EVENT_TRANSPORT_H_
+
+#include "stdincpp.h"
+#include "Logger.h"
+#include "Error.h"
+#include "aqueue.h"
+#include "AnslpTransport.h"
+
+
+namespace auction
+{
+
+/*! \short   transport handing anslp events straight to the peer
+
+    Each request becomes the anslp event the daemon of the peer would
+    produce, and subclasses carry it to the AnslpProcessor queue of the
+    peer. Session creation is answered by the peer through install();
+    confirmations with no counterpart on the wire (check, remove, and the
+    install of the initiator) are dropped.
+*/
+class AnslpEventTransport : public AnslpTransport
+{
+  protected:
+
+	Logger *log;
+	int ch;
+
+	//! queue of the AnslpProcessor of this end.
+	anslp::FastQueue *queue;
+
+	//! anslp sessions opened by this end.
+	set<string> initiated;
+
+	//! put an event in the queue of this end
+	void enqueue(anslp::AnslpEvent *evt);
+
+	/*! \short  hand an event to the peer, which takes it over
+		\throws Error if the peer can not be reached, the event is deleted.
+	*/
+	virtual void deliver(anslp::AnslpEvent *evt) = 0;
+
+  public:
+
+	/*! \arg \c name - logger channel of the transport
+		\arg \c _queue - queue of the AnslpProcessor of this end
+	*/
+	AnslpEventTransport(string name, anslp::FastQueue *_queue);
+
+	virtual ~AnslpEventTransport() {}
+
+	virtual string getLocalAddress();
+
+	virtual uint32_t getInitiatorLifetime();
+
+	virtual void create(const string sessionId, const protlib::hostaddress &source_addr,
+						const protlib::hostaddress &destination_addr,
+						uint16_t source_port, uint16_t dest_port,
+						uint8_t protocol, uint32_t session_lifetime,
+						ipap_message &message);
+
+	virtual void teardown(anslp::session_id *sid);
+
+	virtual void check(string sessionId, anslp::objectList_t &mspec_objects);
+
+	virtual void install(string sessionId, anslp::objectList_t &mspec_objects);
+
+	virtual void remove(string sessionId, anslp::objectList_t &mspec_objects);
+
+	virtual void bidding(anslp::session_id *sid, const protlib::hostaddress &source_addr,
+						 const protlib::hostaddress &destination_addr,
+						 uint16_t source_port, uint16_t dest_port,
+						 uint8_t protocol, ipap_message &message);
+};
+
+} // namespace auction
+
+#endif // _ANSLP_EVENT_TRANSPORT_H_
@@ -0,0 +1,62 @@
+/*! \file   AnslpMessageCodec.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Binary encoding of ipap messages out of the a-nslp daemon.
+
+    $Id: AnslpMessageCodec.h 748 2015-08-23 16:05:00Z amarentes $
+*/
+
+#ifndef _ANSLP_MESSAGE_CODEC_H_
+#define _ANSLP_MESSAGE_CODEC_H_
+
+#include "stdincpp.h"
+#include "RecordCodec.h"
+#include "msg/anslp_ipap_message.h"
+
+
+namespace auction
+{
+
+/*! \short  append an ipap message as the a-nslp daemon puts it on the wire
+
+    The templates travel within the message with their ids, so the
+    message decodes without any other state.
+*/
+void encodeIpApMessage(const anslp::msg::anslp_ipap_message &message, string &out);
+
+/*! \short  decode a message written by encodeIpApMessage
+    \returns a new message owned by the caller, NULL if the data does not
+             hold exactly one message
+*/
+anslp::msg::anslp_ipap_message *decodeIpApMessage(const char *data, size_t len);
+
+//! append an ipap message with its length in front
+void putIpApMessage(string &out, const anslp::msg::anslp_ipap_message &message);
+
+/*! \short  read a message written by putIpApMessage
+    \returns a new message owned by the caller, NULL if the buffer is too
+             short or does not decode
+*/
+anslp::msg::anslp_ipap_message *getIpApMessage(recordReader &in);
+
+} // namespace auction
+
+#endif // _ANSLP_MESSAGE_CODEC_H_
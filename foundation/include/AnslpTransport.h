@@ -0,0 +1,88 @@
+/*! \file   AnslpTransport.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Transport replacing the a-nslp daemon under AnslpClient.
+
+    $Id: AnslpTransport.h 748 2015-08-23 16:05:00Z amarentes $
+*/
+
+#ifndef _ANSLP_TRANSPORT_H_
+#define _ANSLP_TRANSPORT_H_
+
+#include "stdincpp.h"
+#include "address.h"
+#include "session_id.h"
+#include "events.h"
+#include "IpAp_message.h"
+
+
+namespace auction
+{
+
+/*! \short   carries the requests of AnslpClient to the peer
+
+    By default AnslpClient starts the a-nslp daemon and the NSIS stack
+    below it. Given a transport, it starts neither and hands every request
+    to the transport instead, which must put the anslp events the peer
+    would get from its own daemon in the peer's AnslpProcessor queue.
+    Session ids passed as pointers are owned by the transport.
+*/
+class AnslpTransport
+{
+  public:
+
+	virtual ~AnslpTransport() {}
+
+	//! address the peer reaches this end at
+	virtual string getLocalAddress() = 0;
+
+	//! seconds a session created by this end lives
+	virtual uint32_t getInitiatorLifetime() = 0;
+
+	//! open a session with the auction manager at destination_addr
+	virtual void create(const string sessionId, const protlib::hostaddress &source_addr,
+						const protlib::hostaddress &destination_addr,
+						uint16_t source_port, uint16_t dest_port,
+						uint8_t protocol, uint32_t session_lifetime,
+						ipap_message &message) = 0;
+
+	//! close a session opened by this end
+	virtual void teardown(anslp::session_id *sid) = 0;
+
+	//! answer the check of a session opened by the peer
+	virtual void check(string sessionId, anslp::objectList_t &mspec_objects) = 0;
+
+	//! answer the creation of a session, or confirm the answer of the peer
+	virtual void install(string sessionId, anslp::objectList_t &mspec_objects) = 0;
+
+	//! confirm the removal of a session
+	virtual void remove(string sessionId, anslp::objectList_t &mspec_objects) = 0;
+
+	//! send a message within a session
+	virtual void bidding(anslp::session_id *sid, const protlib::hostaddress &source_addr,
+						 const protlib::hostaddress &destination_addr,
+						 uint16_t source_port, uint16_t dest_port,
+						 uint8_t protocol, ipap_message &message) = 0;
+};
+
+} // namespace auction
+
+#endif // _ANSLP_TRANSPORT_H_
@@ -0,0 +1,116 @@
+/*! \file   ArchivePartitions.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Time partitions of the bidding object archive tables.
+
+    $Id: ArchivePartitions.h 748 2015-08-19 11:30:00Z amarentes $
+*/
+
+#ifndef _ARCHIVE_PARTITIONS_H_
+#define _ARCHIVE_PARTITIONS_H_
+
+#include "stdincpp.h"
+#include "Logger.h"
+#include "Error.h"
+#include <pqxx/pqxx>
+
+
+namespace auction
+{
+
+/*! \short   time partitions of the archive tables
+
+    Every archive table (the bidding object tables and the auction
+    summaries) is split in child tables, one per interval of time, named
+    after the table and the UTC start of the interval: biddingObjectHdr_20150819
+    for daily partitions, biddingObjectHdr_201508191200 for shorter ones.
+    Children inherit from the table, so queries on it still see every row,
+    while the writer copies straight into the child of the current
+    interval and its indexes only grow with the rows of that interval.
+
+    maintain() is called by the writer before each batch and does its work
+    at most once per interval: it creates the partitions of the current
+    interval and of the next ahead ones, and drops the partitions older than
+    the retention, or only detaches them from the table when asked to, so
+    expiring old data costs a DROP TABLE instead of a DELETE of every row.
+*/
+class ArchivePartitions
+{
+  private:
+
+	Logger *log;
+	int ch;
+
+	unsigned long interval;		//!< seconds covered by a partition
+	unsigned int ahead;			//!< partitions created in advance
+	unsigned long retention;	//!< seconds kept, 0 to keep everything
+	bool detach;				//!< detach expired partitions instead of dropping them
+
+	//! start of the interval maintained last, -1 if none yet.
+	time_t maintained;
+
+	//! create the partitions of the interval starting at start.
+	void create(pqxx::connection &conn, time_t start);
+
+	//! drop or detach the partitions of parent that expired at now.
+	void expire(pqxx::connection &conn, const string &parent, time_t now);
+
+  public:
+
+	/*! \short  create the partitioning
+		\arg \c interval   - seconds covered by a partition, at least 60
+		\arg \c ahead      - partitions created ahead of the current one
+		\arg \c retention  - seconds a partition is kept, 0 to keep every partition
+		\arg \c detach     - detach expired partitions instead of dropping them
+		\throws Error if the interval is too short.
+	*/
+	ArchivePartitions(unsigned long interval, unsigned int ahead,
+					  unsigned long retention, bool detach);
+
+	~ArchivePartitions();
+
+	/*! \short  create and expire the partitions for the time given
+
+		Only the first call within an interval touches the database.
+		\throws Error if the database rejects the statements.
+	*/
+	void maintain(pqxx::connection &conn, time_t now);
+
+	//! suffix of the partition holding the rows written at time t.
+	string getSuffix(time_t t) const;
+
+	//! start of the interval including time t.
+	inline time_t getStart(time_t t) const { return t - (t % interval); }
+
+	//! return true if child is a partition of parent expired at time now.
+	bool isExpired(const string &child, const string &parent, time_t now) const;
+
+	inline unsigned long getInterval() const { return interval; }
+
+	inline unsigned long getRetention() const { return retention; }
+
+	//! names of the partitioned tables.
+	static const vector<string> &getTables();
+};
+
+} // namespace auction
+
+#endif // _ARCHIVE_PARTITIONS_H_
@@ -253,6 +253,9 @@ class Auction : public AuctioningObject
 	void decrementSessionReferences(string sessionId);
 	
 	int getSessionReferences(){ return sessions.size(); } 
+
+	//! get the ids of the sessions referencing this auction
+	const sessionList_t &getSessions(){ return sessions; }
 	
 	//! get the Module name for the default action.
 	string getModuleName();
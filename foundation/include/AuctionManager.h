@@ -83,6 +83,10 @@ typedef map<procdef_t, auctionDB_t, lttexp>::iterator  auctionIntervalsIndexIter
 typedef set<int> 		    auctionSet_t;
 typedef set<int>::iterator  auctionSetIter_t;
 
+//! announcement messages already built, indexed by auctions and local address
+typedef map<string, ipap_message *>            announcementCache_t;
+typedef map<string, ipap_message *>::iterator  announcementCacheIter_t;
+
 /*! \short   manage adding/deleting of complete auction descriptions
   
   the AuctionManager class allows to add and remove auctions in the Auction
@@ -101,6 +105,24 @@ class AuctionManager : public AuctioningObjectManager
     //! otherwise it is created when during the auction activation.
     bool immediateStart; 
 
+    //! announcement messages built for the current generation of auctions.
+    announcementCache_t announcements;
+
+    //! generation of the auctions the announcements were built from.
+    unsigned long announcementGeneration;
+
+    /*! \short  key of the announcement of a set of auctions
+        \returns an empty string if some auction is not installed, its
+                 announcement can not be cached.
+    */
+    string getAnnouncementKey(auctioningObjectDB_t *auctions, 
+                              ipap_template_container *templates,
+                              bool useIPV6, const string &sAddressIPV4, 
+                              const string &sAddressIPV6, uint16_t port);
+
+    //! delete the cached announcements
+    void clearAnnouncements();
+
   public:
 
     /*! \short   construct and initialize a AuctionManager object
@@ -151,6 +173,11 @@ class AuctionManager : public AuctioningObjectManager
      * 			  the container. 
 		\arg     auction - container to put in the message.
 		
+		The message is built once for every set of installed auctions and 
+		local address, later calls return a copy of it until an auction is
+		added, deleted or activated. The caller owns the copy and sets the
+		sequence numbers.
+		
         \throws an Error exception if some field required is missing.
     */	
 	ipap_message * get_ipap_message(auctioningObjectDB_t *auctions, 
@@ -48,6 +48,7 @@ enum infoType_t {
     I_HELLO,
     I_BIDLIST,
     I_BID,
+    I_DB_WRITER,
     // insert new items here
     I_NUMAUCTIONMANAGERINFOS
 };
@@ -31,6 +31,7 @@
 
 #include "stdincpp.h"
 #include "Logger.h"
+#include "StringTable.h"
 
 namespace auction
 {
@@ -62,17 +63,17 @@ class AuctioningObject
     //! state of this auction
     AuctioningObjectState_t state;
 
-    //! set this auctioning object belongs to
-    string _set;
+    //! set this auctioning object belongs to, interned as it is shared by many objects
+    InternedString _set;
 
     //! name of the auctioning object by convention this must be either: <name> or <set>.name
-    string _name;
+    InternedString _name;
 
 	//! Parents' set 
-	string _setParent;
+	InternedString _setParent;
 	
 	//! Parents' name
-	string _nameParent;
+	InternedString _nameParent;
 
   public:
     
@@ -85,19 +86,25 @@ class AuctioningObject
     
     virtual ~AuctioningObject();
 
-    inline string getSet(){ return _set; }
+    inline const string &getSet(){ return _set.str(); }
+
+    //! get the interned set, copying it does not copy the string.
+    inline const InternedString &getSetHandle(){ return _set; }
 	
 	inline void setSet(string sname){ _set = sname; }
 	
 	inline void setName(string aname){ _name = aname; }
 	
-    inline string getName(){ return _name; }
+    inline const string &getName(){ return _name.str(); }
+
+    //! get the interned name, the manager indexes are keyed on it.
+    inline const InternedString &getNameHandle(){ return _name; }
 
-    inline string getSetParent(){ return _setParent; }
+    inline const string &getSetParent(){ return _setParent.str(); }
     
     inline void setSetParent(string sParent){ _setParent = sParent; }
     
-    inline string getNameParent(){ return _nameParent; }
+    inline const string &getNameParent(){ return _nameParent.str(); }
     
     inline void setNameParent(string nameParent){ _nameParent = nameParent; }
 
@@ -0,0 +1,477 @@
+/*! \file   AuctioningObjectIndex.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Open addressing hash index keyed by (set, name) used by the
+    auctioning object managers.
+
+    $Id: AuctioningObjectIndex.h 748 2015-07-23 15:30:00Z amarentes $
+*/
+
+#ifndef _AUCTIONING_OBJECT_INDEX_H_
+#define _AUCTIONING_OBJECT_INDEX_H_
+
+#include "stdincpp.h"
+#include "StringTable.h"
+
+
+namespace auction
+{
+
+/*! \short  hash of the composite key (set, name)
+
+    Built from the hashes the interned strings keep, so no character is
+    read. (set, name) and (name, set) hash differently. Zero is never
+    returned.
+*/
+inline uint32_t hashObjectKey(const InternedString &set, const InternedString &name)
+{
+	uint32_t h = (set.hash() * 16777619U) ^ name.hash();
+	return (h == 0) ? 1 : h;
+}
+
+
+/*! \short   open addressing hash table keyed by (set, name)
+
+    Linear probing over a power of two table with tombstones for removed
+    entries. Keys are interned strings: the hash comes from the handles
+    and two keys are equal when their handles are, so neither lookups nor
+    inserts touch the characters. Lookups, inserts and removals are O(1)
+    on average.
+*/
+template <class T>
+class AuctioningObjectIndex
+{
+
+  private:
+
+	typedef enum
+	{
+		SLOT_EMPTY = 0,
+		SLOT_FULL,
+		SLOT_DELETED
+	} slotState_t;
+
+	typedef struct
+	{
+		uint32_t hash;
+		slotState_t state;
+		InternedString set;
+		InternedString name;
+		T value;
+
+	} slot_t;
+
+	vector<slot_t> slots;
+
+	//! number of entries stored
+	size_t entries;
+
+	//! number of deleted slots not reused yet
+	size_t deleted;
+
+	//! return the slot holding the key, or -1 if not present
+	long lookup(const InternedString &set, const InternedString &name, uint32_t hash) const
+	{
+		if (slots.empty()) {
+			return -1;
+		}
+
+		size_t mask = slots.size() - 1;
+		size_t i = hash & mask;
+
+		while (slots[i].state != SLOT_EMPTY) {
+			if ((slots[i].state == SLOT_FULL) && (slots[i].hash == hash) &&
+				(slots[i].name == name) && (slots[i].set == set)) {
+				return (long) i;
+			}
+			i = (i + 1) & mask;
+		}
+
+		return -1;
+	}
+
+	//! rebuild the table with the capacity given, drops tombstones
+	void rehash(size_t capacity)
+	{
+		vector<slot_t> old;
+		old.swap(slots);
+
+		slots.resize(capacity);
+		for (size_t j = 0; j < capacity; j++) {
+			slots[j].state = SLOT_EMPTY;
+		}
+
+		size_t mask = capacity - 1;
+		for (size_t j = 0; j < old.size(); j++) {
+			if (old[j].state == SLOT_FULL) {
+				size_t i = old[j].hash & mask;
+				while (slots[i].state != SLOT_EMPTY) {
+					i = (i + 1) & mask;
+				}
+				slots[i] = old[j];
+			}
+		}
+
+		deleted = 0;
+	}
+
+  public:
+
+	AuctioningObjectIndex() : entries(0), deleted(0) { }
+
+	~AuctioningObjectIndex() { }
+
+	inline size_t size() const { return entries; }
+
+	inline bool empty() const { return entries == 0; }
+
+	//! return a pointer to the value stored for the key, NULL if not present.
+	T *find(const InternedString &set, const InternedString &name)
+	{
+		long i = lookup(set, name, hashObjectKey(set, name));
+		return (i < 0) ? NULL : &(slots[i].value);
+	}
+
+	/*! \short  insert a new key
+		\returns a pointer to the value stored, or NULL if the key was already present
+	*/
+	T *insert(const InternedString &set, const InternedString &name, const T &value)
+	{
+		uint32_t hash = hashObjectKey(set, name);
+
+		if (lookup(set, name, hash) >= 0) {
+			return NULL;
+		}
+
+		// keep load (tombstones included) under 3/4
+		if ((entries + deleted + 1) * 4 > slots.size() * 3) {
+			size_t capacity = (slots.empty()) ? 16 : slots.size();
+			while ((entries + 1) * 2 > capacity) {
+				capacity = capacity * 2;
+			}
+			rehash(capacity);
+		}
+
+		size_t mask = slots.size() - 1;
+		size_t i = hash & mask;
+		while (slots[i].state == SLOT_FULL) {
+			i = (i + 1) & mask;
+		}
+
+		if (slots[i].state == SLOT_DELETED) {
+			deleted--;
+		}
+
+		slots[i].hash = hash;
+		slots[i].state = SLOT_FULL;
+		slots[i].set = set;
+		slots[i].name = name;
+		slots[i].value = value;
+		entries++;
+
+		return &(slots[i].value);
+	}
+
+	//! remove the key, returns false if it was not present.
+	bool erase(const InternedString &set, const InternedString &name)
+	{
+		long i = lookup(set, name, hashObjectKey(set, name));
+		if (i < 0) {
+			return false;
+		}
+
+		// the handles go, so the table can collect the strings.
+		slots[i].state = SLOT_DELETED;
+		slots[i].set = InternedString();
+		slots[i].name = InternedString();
+		slots[i].value = T();
+		entries--;
+		deleted++;
+
+		return true;
+	}
+
+	//! remove all entries
+	void clear()
+	{
+		slots.clear();
+		entries = 0;
+		deleted = 0;
+	}
+};
+
+
+/*! \short   open addressing hash table keyed by uid
+
+    Same layout as AuctioningObjectIndex, for the unique uids that leave
+    the key space sparse. Entries read as the pairs of a map (first is
+    the uid, second the value) and can be walked with an iterator, which
+    an insert invalidates. Lookups, inserts and removals are O(1) on
+    average.
+*/
+template <class T>
+class UIdIndex
+{
+
+  public:
+
+	typedef enum
+	{
+		SLOT_EMPTY = 0,
+		SLOT_FULL,
+		SLOT_DELETED
+	} slotState_t;
+
+	typedef struct
+	{
+		slotState_t state;
+		int first;
+		T second;
+
+	} slot_t;
+
+	//! walks the full slots in table order
+	class iterator
+	{
+	  private:
+
+		slot_t *slot;
+		slot_t *last;
+
+		void skip()
+		{
+			while ((slot != last) && (slot->state != SLOT_FULL)) {
+				slot++;
+			}
+		}
+
+	  public:
+
+		iterator() : slot(NULL), last(NULL) { }
+
+		iterator(slot_t *_slot, slot_t *_last) : slot(_slot), last(_last) { skip(); }
+
+		inline slot_t &operator*() const { return *slot; }
+
+		inline slot_t *operator->() const { return slot; }
+
+		iterator &operator++() { slot++; skip(); return *this; }
+
+		iterator operator++(int) { iterator i = *this; ++(*this); return i; }
+
+		inline bool operator==(const iterator &i) const { return slot == i.slot; }
+
+		inline bool operator!=(const iterator &i) const { return slot != i.slot; }
+	};
+
+  private:
+
+	vector<slot_t> slots;
+
+	//! number of entries stored
+	size_t entries;
+
+	//! number of deleted slots not reused yet
+	size_t deleted;
+
+	//! spread consecutive uids over the table
+	static inline uint32_t hashUId(int uid)
+	{
+		uint32_t h = (uint32_t) uid * 2654435761U;
+		return h ^ (h >> 16);
+	}
+
+	//! return the slot holding the uid, or -1 if not present
+	long lookup(int uid) const
+	{
+		if (slots.empty()) {
+			return -1;
+		}
+
+		size_t mask = slots.size() - 1;
+		size_t i = hashUId(uid) & mask;
+
+		while (slots[i].state != SLOT_EMPTY) {
+			if ((slots[i].state == SLOT_FULL) && (slots[i].first == uid)) {
+				return (long) i;
+			}
+			i = (i + 1) & mask;
+		}
+
+		return -1;
+	}
+
+	//! rebuild the table with the capacity given, drops tombstones
+	void rehash(size_t capacity)
+	{
+		vector<slot_t> old;
+		old.swap(slots);
+
+		slots.resize(capacity);
+		for (size_t j = 0; j < capacity; j++) {
+			slots[j].state = SLOT_EMPTY;
+		}
+
+		size_t mask = capacity - 1;
+		for (size_t j = 0; j < old.size(); j++) {
+			if (old[j].state == SLOT_FULL) {
+				size_t i = hashUId(old[j].first) & mask;
+				while (slots[i].state != SLOT_EMPTY) {
+					i = (i + 1) & mask;
+				}
+				slots[i] = old[j];
+			}
+		}
+
+		deleted = 0;
+	}
+
+	inline slot_t *first() { return (slots.empty()) ? NULL : &slots[0]; }
+
+	inline slot_t *last() { return (slots.empty()) ? NULL : &slots[0] + slots.size(); }
+
+  public:
+
+	UIdIndex() : entries(0), deleted(0) { }
+
+	~UIdIndex() { }
+
+	inline size_t size() const { return entries; }
+
+	inline bool empty() const { return entries == 0; }
+
+	inline iterator begin() { return iterator(first(), last()); }
+
+	inline iterator end() { return iterator(last(), last()); }
+
+	//! return the entry of the uid, end() if not present.
+	iterator find(int uid)
+	{
+		long i = lookup(uid);
+		return (i < 0) ? end() : iterator(&slots[i], last());
+	}
+
+	//! return the value of the uid, inserted with T() if not present.
+	T &operator[](int uid)
+	{
+		long j = lookup(uid);
+		if (j >= 0) {
+			return slots[j].second;
+		}
+
+		// keep load (tombstones included) under 3/4
+		if ((entries + deleted + 1) * 4 > slots.size() * 3) {
+			size_t capacity = (slots.empty()) ? 16 : slots.size();
+			while ((entries + 1) * 2 > capacity) {
+				capacity = capacity * 2;
+			}
+			rehash(capacity);
+		}
+
+		size_t mask = slots.size() - 1;
+		size_t i = hashUId(uid) & mask;
+		while (slots[i].state == SLOT_FULL) {
+			i = (i + 1) & mask;
+		}
+
+		if (slots[i].state == SLOT_DELETED) {
+			deleted--;
+		}
+
+		slots[i].state = SLOT_FULL;
+		slots[i].first = uid;
+		slots[i].second = T();
+		entries++;
+
+		return slots[i].second;
+	}
+
+	//! remove the entry given, other iterators stay valid.
+	void erase(iterator iter)
+	{
+		iter->state = SLOT_DELETED;
+		iter->second = T();
+		entries--;
+		deleted++;
+	}
+
+	//! remove the uid, returns the number of entries removed.
+	size_t erase(int uid)
+	{
+		iterator iter = find(uid);
+		if (iter == end()) {
+			return 0;
+		}
+
+		erase(iter);
+		return 1;
+	}
+
+	//! remove all entries
+	void clear()
+	{
+		slots.clear();
+		entries = 0;
+		deleted = 0;
+	}
+};
+
+
+//! position of each uid inside the uid list that holds it, by uid.
+typedef UIdIndex<int>				uidListPosition_t;
+typedef UIdIndex<int>::iterator		uidListPositionIter_t;
+
+/*! \short  add uid at the end of the list and record its position
+*/
+inline void addToUIdList(vector<int> &list, uidListPosition_t &positions, int uid)
+{
+	positions[uid] = list.size();
+	list.push_back(uid);
+}
+
+/*! \short  remove uid from the list in O(1), the last uid takes its place
+
+	\returns false if the uid was not in the list.
+*/
+inline bool delFromUIdList(vector<int> &list, uidListPosition_t &positions, int uid)
+{
+	uidListPositionIter_t iter = positions.find(uid);
+	if ((iter == positions.end()) || ((unsigned int) iter->second >= list.size()) || 
+		(list[iter->second] != uid)) {
+		return false;
+	}
+
+	int pos = iter->second;
+	int last = list.back();
+
+	positions.erase(iter);
+	list[pos] = last;
+	if (last != uid) {
+		positions[last] = pos;
+	}
+	list.pop_back();
+
+	return true;
+}
+
+} // namespace auction
+
+#endif // _AUCTIONING_OBJECT_INDEX_H_
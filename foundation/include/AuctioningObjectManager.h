@@ -33,8 +33,9 @@
 #include "stdincpp.h"
 #include "Logger.h"
 #include "Error.h"
-#include "IdSource.h"
+#include "WideIdSource.h"
 #include "AuctioningObject.h"
+#include "AuctioningObjectIndex.h"
 #include "EventScheduler.h"
 #include "FieldDefManager.h"
 
@@ -43,11 +44,19 @@ namespace auction
 
 // AuctioningObjectDB definition is currently in AuctionFileParser.h
 
-// index by set id and name
+//! auctioning objects of a set (name, uid), returned as a snapshot
 typedef map<string, int>            		    	  	auctioningObjectIndex_t;
 typedef map<string, int>::iterator  		    	  	auctioningObjectIndexIter_t;
-typedef map<string, auctioningObjectIndex_t>            auctioningObjectSetIndex_t;
-typedef map<string, auctioningObjectIndex_t>::iterator  auctioningObjectSetIndexIter_t;
+
+//! hash index by (set, name) to uid
+typedef AuctioningObjectIndex<int>						auctioningObjectKeyIndex_t;
+
+//! hash index by set to the uids of the set
+typedef AuctioningObjectIndex< vector<int> >			auctioningObjectSetIndex_t;
+
+//! hash index by uid to auction objects, uids are unique so they are sparse
+typedef UIdIndex<AuctioningObject *>            		auctioningObjectUIdIndex_t;
+typedef UIdIndex<AuctioningObject *>::iterator  		auctioningObjectUIdIndexIter_t;
 
 //! list of done Auction Object
 typedef list<AuctioningObject*>            auctioningObjectDone_t;
@@ -70,13 +79,22 @@ class AuctioningObjectManager : public FieldDefManager
     int objects;
 
     //! index to auction objects via setID and name
+    auctioningObjectKeyIndex_t auctioningObjectKeyIndex;
+
+    //! uids of the auction objects of every set
     auctioningObjectSetIndex_t auctioningObjectSetIndex;
 
-    //! stores all auction objects indexed by setID, bidID
-    auctioningObjectDB_t  auctioningObjectDB;
+    //! position of every uid within its set list
+    uidListPosition_t setPositions;
+
+    //! stores all auction objects indexed by uid
+    auctioningObjectUIdIndex_t  auctioningObjectDB;
 
     //! list with auction object done
     auctioningObjectDone_t auctioningObjectDone;
+
+    //! changes every time an object is added, deleted or activated.
+    unsigned long generation;
 		
 	//! This field identifies uniquely the agent.
 	int domain; 
@@ -93,9 +111,18 @@ class AuctioningObjectManager : public FieldDefManager
        \arg \a Auctioning Object
     */
     void storeAuctioningObjectAsDone(AuctioningObject *a);
+
+    //! release all auctioning objects, either active or done.
+    void clearAuctioningObjects();
+
+    //! release an object that left the done list, by default it is deleted.
+    virtual void releaseAuctioningObject(AuctioningObject *a);
   
-    //! pool of unique ids
-    IdSource idSource;
+    /*! pool of unique ids, uids are known outside the manager (events,
+        processing modules), so they are not recycled until the space,
+        bounded by MANAGER_MAX_UID, wraps.
+    */
+    WideIdSource idSource;
 
 
   public:
@@ -127,8 +154,9 @@ class AuctioningObjectManager : public FieldDefManager
 	//! get auction object with id uid from the stored mark as done.
 	AuctioningObject *getAuctioningObjectDone(int uid);
 
-    //! get all Auctioning Objects in auctionset with name sname 
-    auctioningObjectIndex_t *getAuctioningObjects(string sname);
+    //! get all Auctioning Objects in auctionset with name sname, the map
+    //! returned is a copy so objects can be deleted while iterating it.
+    auctioningObjectIndex_t getAuctioningObjects(string sname);
 
     //! get all auctioning objects, creates a new vector with 
     //! the same pointers to auction objects, so it does not 
@@ -177,6 +205,9 @@ class AuctioningObjectManager : public FieldDefManager
 
 	//! Return the domain
 	inline int getDomain(){ return domain; }
+
+	//! Return the generation, anything built from the objects is stale once it changes.
+	inline unsigned long getGeneration(){ return generation; }
     		
 };
 
@@ -35,6 +35,7 @@
 #include "IpAp_template.h"
 #include "AuctionTimer.h"
 #include "AuctioningObject.h"
+#include "BiddingObjectArena.h"
 #include <pqxx/pqxx>
 
 
@@ -55,16 +56,84 @@ typedef vector< pair<time_t, biddingObjectInterval_t> >::iterator			biddingObjec
 typedef vector< pair<time_t, biddingObjectInterval_t> >::const_iterator		biddingObjectIntervalListConstIter_t;
 
 
-//! element map (elementName, fieldlist).
-typedef map<string, fieldList_t>            		elementList_t;
-typedef map<string, fieldList_t>::iterator  		elementListIter_t;
-typedef map<string, fieldList_t>::const_iterator  	elementListConstIter_t;
+//! element map (elementName, fieldlist), taken from the current arena.
+typedef map<string, fieldList_t, less<string>, 
+			ArenaAllocator< pair<const string, fieldList_t> > >            		elementList_t;
+typedef elementList_t::iterator  												elementListIter_t;
+typedef elementList_t::const_iterator  											elementListConstIter_t;
 
 
 //! option vector (optionName, fieldlist), options must be ordered.
-typedef vector< pair<string, fieldList_t> >            			optionList_t;
-typedef vector< pair<string, fieldList_t> >::iterator  			optionListIter_t;
-typedef vector< pair<string, fieldList_t> >::const_iterator  	optionListConstIter_t;
+typedef vector< pair<string, fieldList_t>, 
+				ArenaAllocator< pair<string, fieldList_t> > >            		optionList_t;
+typedef optionList_t::iterator  												optionListIter_t;
+typedef optionList_t::const_iterator  											optionListConstIter_t;
+
+
+//! one field of an element or option, as stored in the database.
+typedef struct
+{
+	string ownerName;		//!< element or option name
+	string fieldName;
+	string fieldType;
+	int len;
+	string value;
+
+} biddingObjectFieldRecord_t;
+
+typedef vector<biddingObjectFieldRecord_t>					biddingObjectFieldRecordList_t;
+typedef vector<biddingObjectFieldRecord_t>::const_iterator	biddingObjectFieldRecordListConstIter_t;
+
+/*! \short  rows to store for a bidding object.
+
+    Plain copy of everything the database tables need, so it can be written
+    after the bidding object itself is gone.
+*/
+typedef struct
+{
+	string auctionSet;
+	string auctionName;
+	string set;
+	string name;
+	string sessionId;
+	string type;
+	string state;
+	vector<string> elements;
+	biddingObjectFieldRecordList_t elementFields;
+	vector<string> options;
+	biddingObjectFieldRecordList_t optionFields;
+
+} biddingObjectRecord_t;
+
+//! records written in one transaction.
+typedef vector<biddingObjectRecord_t *>            		biddingObjectRecordBatch_t;
+typedef vector<biddingObjectRecord_t *>::iterator  		biddingObjectRecordBatchIter_t;
+typedef vector<biddingObjectRecord_t *>::const_iterator	biddingObjectRecordBatchConstIter_t;
+
+/*! \short  result of running an auction over an interval.
+
+    Built from the bids given to the algorithm and the allocations it
+    returned, so it does not depend on the module.
+*/
+typedef struct
+{
+	string auctionSet;
+	string auctionName;
+	time_t start;
+	time_t stop;
+	double demand;				//!< quantity requested by the bids
+	double quantitySold;		//!< quantity in the allocations
+	double clearingPrice;		//!< highest unit price of the allocations
+	unsigned int bids;
+	unsigned int allocations;
+	unsigned long executionTime;	//!< us spent in the algorithm
+
+} auctionSummaryRecord_t;
+
+//! summaries written in one transaction.
+typedef vector<auctionSummaryRecord_t *>            		auctionSummaryBatch_t;
+typedef vector<auctionSummaryRecord_t *>::iterator  		auctionSummaryBatchIter_t;
+typedef vector<auctionSummaryRecord_t *>::const_iterator	auctionSummaryBatchConstIter_t;
 
 class BiddingObject : public AuctioningObject
 {
@@ -76,19 +145,43 @@ public:
         \returns a new object instance.
     */
 	BiddingObject(  string auctionSet, string auctionName, string BiddingObjectSet, string BiddingObjectName, 
-				    ipap_object_type_t _type, elementList_t &elements, optionList_t &options );
+				    ipap_object_type_t _type, const elementList_t &elements, const optionList_t &options );
+
+    //! create an object without fields, they are handed over with takeFields.
+	BiddingObject(  string auctionSet, string auctionName, string BiddingObjectSet, string BiddingObjectName, 
+				    ipap_object_type_t _type );
 
 	BiddingObject( const BiddingObject &rhs );
 
 	~BiddingObject();
 
+	/*! \short  allocate the object in the current interval arena (see 
+		BiddingObjectArena::setCurrent), or in the heap if there is none.
+	*/
+	static void *operator new(size_t size);
+
+	//! release an object allocated from an arena or from the heap.
+	static void operator delete(void *ptr);
+
+	/*! \short  retire an object that is not used anymore
+
+		an arena object is destroyed along with the rest of its arena, a heap
+		object is deleted at once.
+	*/
+	static void retire(BiddingObject *b);
+
     void setAuctionSet(string _auctionset);	
 
-    string getAuctionSet();
+    const string &getAuctionSet();
 
 	void setAuctionName(string _auctionName);
 
-    string getAuctionName();
+    const string &getAuctionName();
+
+    //! get the interned auction set and name, the manager index is keyed on them.
+    inline const InternedString &getAuctionSetHandle(){ return auctionSet; }
+
+    inline const InternedString &getAuctionNameHandle(){ return auctionName; }
 
     /*! \short   get the Id to be used when transfering the object in a ipap_message
      *   \arg domain - domain to use in case that the BiddingObject does not have a group.
@@ -103,13 +196,23 @@ public:
 	
 	inline void setSession(string _sessionId){ sessionId = _sessionId; }
 	
-	inline string getSession(){ return sessionId; } 	
+	inline const string &getSession(){ return sessionId.str(); } 
+
+	//! get the interned session id, copying it does not copy the string.
+	inline const InternedString &getSessionHandle(){ return sessionId; }	
 
     /*! \short   get names and values (parameters) of configured elements
         \returns a pointer (link) to a list that contains the configured elements for this BiddingObject
     */
     inline elementList_t *getElements(){ return &elementList; }
 
+    /*! \short  hand the fields over to the object instead of copying them
+
+        the fields of the object are replaced, elements and options are
+        left empty.
+    */
+    void takeFields(elementList_t &elements, optionList_t &options);
+
 	inline optionList_t *getOptions() {return &optionList; }
 	
 	bool operator==(const BiddingObject &rhs);
@@ -122,6 +225,12 @@ public:
 	//! get a value by name from the misc rule attributes
     field_t getOptionVal(string optionName, string name);
 
+	//! sum of the numeric field name over all the elements, 0 if none has it.
+	double getElementsTotal(string name);
+
+	//! largest value of the numeric field name over all the elements, 0 if none has it.
+	double getElementsMax(string name);
+
 	//! Calculates intervals associated to BiddingObject.
 	void calculateIntervals(time_t now, biddingObjectIntervalList_t *list);
     
@@ -132,30 +241,42 @@ public:
 	inline void setType(ipap_object_type_t _type) { biddingObjectType = _type; }
 
 	//! prepare the sql statement to save the hdr in the DB.
-	void prepare_insert_biddingObjectHdr(pqxx::connection_base &c);
+	static void prepare_insert_biddingObjectHdr(pqxx::connection_base &c);
 	
 	string execute_insert_biddingObjectHdr( void );
 	
 	//! prepare the sql statement to save elements in the DB.
-	void prepare_insert_biddingObjectElement(pqxx::connection_base &c);
+	static void prepare_insert_biddingObjectElement(pqxx::connection_base &c);
 	
 	string execute_insert_biddingObjectElement( string elementName );
 	
 	//! prepare the sql statement to save element fields in the DB.
-	void prepare_insert_biddingObjectElementField(pqxx::connection_base &c);
+	static void prepare_insert_biddingObjectElementField(pqxx::connection_base &c);
 	
 	string execute_insert_biddingObjectElementField( string elementName, auction::field_t field );
 	
 	//! prepare the sql statement to save options in the DB.
-	void prepare_insert_biddingObjectOption(pqxx::connection_base &c);
+	static void prepare_insert_biddingObjectOption(pqxx::connection_base &c);
 	
 	string execute_insert_biddingObjectOption( string optionName );
 	
 	//! prepare the sql statement to save option fields in the DB.
-	void prepare_insert_biddingObjectOptionField(pqxx::connection_base &c);
+	static void prepare_insert_biddingObjectOptionField(pqxx::connection_base &c);
 	
 	string execute_insert_biddingObjectOptionField( string optionName, auction::field_t field );
 	
+	//! copy the rows to store for this bidding object into record.
+	void getRecord(biddingObjectRecord_t &record);
+
+	//! prepare all the sql statements used by save_record.
+	static void prepare_insert_record(pqxx::connection_base &c);
+
+	/*! \short  insert the rows of a bidding object within the transaction given.
+	
+		statements have to be prepared in the connection (prepare_insert_record).
+	*/
+	static void save_record(pqxx::work &w, const biddingObjectRecord_t &record);
+
 	//! save the bidding object in the database.
 	void save_ver4(pqxx::connection_base &c);
 	
@@ -167,14 +288,14 @@ protected:
 	
 
     //! set of the auction that this BiddingObject belongs to 
-    string auctionSet;
+    InternedString auctionSet;
     
     //! name of the auction that this BiddingObject belongs to 
-    string auctionName;
+    InternedString auctionName;
    
     //! for the auctioneer this field has a reference to the session 
     //! that is the origin of the bidding object.
-    string sessionId;
+    InternedString sessionId;
    
     //! Bidding object type
     ipap_object_type_t biddingObjectType;
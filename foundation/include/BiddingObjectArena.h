@@ -0,0 +1,264 @@
+/*! \file   BiddingObjectArena.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Region allocator for the bidding objects (bids and allocations) of an
+    auction interval and for the field containers inside them. Memory is
+    carved out of large blocks, the blocks go back in one step once every
+    object of the interval has been retired.
+
+    $Id: BiddingObjectArena.h 748 2015-07-23 15:30:00Z amarentes $
+*/
+
+#ifndef _BIDDINGOBJECTARENA_H_
+#define _BIDDINGOBJECTARENA_H_
+
+#include "stdincpp.h"
+#include "Error.h"
+
+
+namespace auction
+{
+
+//! function used to run the destructor of an object on release.
+typedef void (*arenaDestroy_t)(void *);
+
+//! default size of the blocks requested by an arena.
+const size_t ARENA_BLOCK_SIZE = 65536;
+
+//! header written in front of everything handed out (arena or heap).
+typedef struct
+{
+	void *arena;			//!< owner arena, NULL for the heap.
+	arenaDestroy_t destroy;	//!< destructor of an object not destroyed yet, NULL otherwise.
+
+} arenaChunk_t;
+
+//! memory block owned by an arena.
+typedef struct
+{
+	char *data;
+	size_t size;
+	size_t used;
+
+} arenaBlock_t;
+
+typedef vector<arenaBlock_t>            	arenaBlockList_t;
+typedef vector<arenaBlock_t>::iterator  	arenaBlockListIter_t;
+
+//! objects of an arena, walked on release to destroy the retired ones.
+typedef vector<void *>            			arenaObjectList_t;
+typedef vector<void *>::iterator  			arenaObjectListIter_t;
+
+
+/*! \short   region allocator for the bidding objects of an auction interval
+
+  While an arena is installed as current in a thread (see arenaScope),
+  bidding objects and the nodes of their element, option and value
+  containers are bump allocated from its blocks; otherwise they come from
+  the heap.
+
+  Objects are retired with retire(), which leaves the destructor for the
+  release: when the producer closes the arena and the last object is
+  retired, the arena runs the pending destructors in one pass and frees its
+  blocks. Container nodes are never freed one by one. Objects may still be
+  deleted; that destroys them at once and counts as retiring them.
+
+  Only one thread allocates from an arena (the one that opened it), objects
+  can be retired and the arena closed from any thread. An object and its
+  containers must be filled within the scope of the same arena, nodes taken
+  from another arena are gone when that one is released.
+*/
+class BiddingObjectArena
+{
+
+  private:
+
+	//! start of the interval served by this arena.
+	time_t start;
+
+	//! size of the blocks requested from the heap.
+	size_t blockSize;
+
+	//! memory blocks owned by the arena.
+	arenaBlockList_t blocks;
+
+	//! objects allocated, in allocation order.
+	arenaObjectList_t objects;
+
+	//! objects not retired yet, plus one while the producer keeps it open.
+	volatile int refs;
+
+	//! number of bytes handed out, headers included.
+	unsigned long bytes;
+
+	//! arena used by new bidding objects in this thread, NULL means heap.
+	static __thread BiddingObjectArena *current;
+
+	//! add a new block able to hold at least size bytes.
+	arenaBlock_t *addBlock(size_t size);
+
+	//! take size bytes from the blocks, destroy is NULL for container nodes.
+	void *carve(size_t size, arenaDestroy_t destroy);
+
+	//! take a reference away, the last one releases the arena.
+	void unref();
+
+	//! destroy the objects not destroyed yet and free the blocks.
+	~BiddingObjectArena();
+
+  public:
+
+    /*! \short   construct an empty arena, open for the calling thread
+        \arg \c _start  		start of the auction interval
+        \arg \c _blockSize  	size of the blocks to request
+     */
+	BiddingObjectArena(time_t _start, size_t _blockSize = ARENA_BLOCK_SIZE);
+
+	/*! \short  stop allocating from the arena
+
+	    the arena is released once its objects are retired, and may be
+	    gone when close returns.
+	*/
+	void close();
+
+	inline time_t getStart() { return start; }
+
+	//! number of objects allocated.
+	inline unsigned long getNumObjects() { return objects.size(); }
+
+	inline unsigned long getAllocatedBytes() { return bytes; }
+
+	//! return the number of blocks currently held.
+	inline size_t getNumBlocks() { return blocks.size(); }
+
+	//! get the arena used in this thread, NULL means heap.
+	static inline BiddingObjectArena *getCurrent() { return current; }
+
+	//! set the arena used in this thread, NULL means heap.
+	static inline void setCurrent(BiddingObjectArena *arena) { current = arena; }
+
+	/*! \short  allocate from the current arena, or from the heap if there is none
+
+	    this is the function to be called from the class operator new, and
+	    with a NULL destroy from the container allocator.
+	*/
+	static void *allocate(size_t size, arenaDestroy_t destroy);
+
+	/*! \short  release memory got from allocate(), the object was already destroyed.
+
+	    this is the function to be called from the class operator delete
+	    and from the container allocator.
+	*/
+	static void deallocate(void *ptr);
+
+	/*! \short  retire an object got from allocate() without destroying it
+
+	    objects of an arena are destroyed when the arena is released, heap
+	    objects are destroyed and freed at once.
+	*/
+	static void retire(void *ptr);
+
+	//! return the arena of the memory given, NULL if it comes from the heap
+	static BiddingObjectArena *getArena(void *ptr);
+
+	string getInfo();
+};
+
+
+//! install an arena as current in this thread during the life time of the object
+struct arenaScope
+{
+	BiddingObjectArena *previous;
+
+	arenaScope(BiddingObjectArena *arena)
+		: previous(BiddingObjectArena::getCurrent())
+	{
+		BiddingObjectArena::setCurrent(arena);
+	}
+
+	~arenaScope()
+	{
+		BiddingObjectArena::setCurrent(previous);
+	}
+};
+
+
+/*! \short  container allocator taking its nodes from the current arena
+
+    stateless, every instance can free what any other allocated, so
+    containers can be swapped whatever arena their nodes come from.
+*/
+template <class T>
+class ArenaAllocator
+{
+  public:
+
+	typedef T				value_type;
+	typedef T*				pointer;
+	typedef const T*		const_pointer;
+	typedef T&				reference;
+	typedef const T&		const_reference;
+	typedef size_t			size_type;
+	typedef ptrdiff_t		difference_type;
+
+	template <class U> struct rebind { typedef ArenaAllocator<U> other; };
+
+	ArenaAllocator() {}
+
+	ArenaAllocator(const ArenaAllocator &) {}
+
+	template <class U> ArenaAllocator(const ArenaAllocator<U> &) {}
+
+	~ArenaAllocator() {}
+
+	pointer address(reference x) const { return &x; }
+
+	const_pointer address(const_reference x) const { return &x; }
+
+	pointer allocate(size_type n, const void * = 0)
+	{
+		if (n > max_size()) {
+			throw std::bad_alloc();
+		}
+		return static_cast<pointer>(BiddingObjectArena::allocate(n * sizeof(T), NULL));
+	}
+
+	void deallocate(pointer p, size_type)
+	{
+		BiddingObjectArena::deallocate(p);
+	}
+
+	size_type max_size() const { return size_t(-1) / sizeof(T) / 2; }
+
+	void construct(pointer p, const T &val) { new ((void *) p) T(val); }
+
+	void destroy(pointer p) { p->~T(); }
+};
+
+template <class T, class U>
+inline bool operator==(const ArenaAllocator<T> &, const ArenaAllocator<U> &) { return true; }
+
+template <class T, class U>
+inline bool operator!=(const ArenaAllocator<T> &, const ArenaAllocator<U> &) { return false; }
+
+} // namespace auction
+
+#endif // _BIDDINGOBJECTARENA_H_
@@ -0,0 +1,112 @@
+/*! \file   BiddingObjectBulkLoader.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Load batches of bidding objects with the COPY protocol.
+
+    $Id: BiddingObjectBulkLoader.h 748 2015-08-11 09:10:00Z amarentes $
+*/
+
+#ifndef _BIDDINGOBJECT_BULK_LOADER_H_
+#define _BIDDINGOBJECT_BULK_LOADER_H_
+
+#include "stdincpp.h"
+#include "BiddingObject.h"
+
+
+namespace auction
+{
+
+//! tables holding the bidding objects, in load order.
+typedef enum
+{
+	BO_TABLE_HDR = 0,
+	BO_TABLE_ELEMENT,
+	BO_TABLE_ELEMENTFIELD,
+	BO_TABLE_OPTION,
+	BO_TABLE_OPTIONFIELD,
+	BO_NUM_TABLES
+
+} biddingObjectTable_t;
+
+//! one row, values in the order of the table columns.
+typedef vector<string>							bulkRow_t;
+
+typedef vector<bulkRow_t>            			bulkRowList_t;
+typedef vector<bulkRow_t>::iterator  			bulkRowListIter_t;
+
+
+/*! \short   store batches of bidding objects with COPY
+
+    Each table is streamed in a single COPY ... FROM STDIN through a pqxx
+    tablewriter, so a batch costs one round trip per table instead of one
+    INSERT per row. The rows go to the same tables and columns used by
+    BiddingObject::save_record. Auction summaries go to their own table,
+    one row per auction execution, created by createSummaryTable() on
+    databases that predate it.
+*/
+class BiddingObjectBulkLoader
+{
+  public:
+
+	//! name of the table
+	static const char *getTableName(biddingObjectTable_t table);
+
+	//! columns of the table, in the order of the values of the rows.
+	static const vector<string> &getColumns(biddingObjectTable_t table);
+
+	//! append the rows that the record has in the table given.
+	static void appendRows(const biddingObjectRecord_t &record,
+						   biddingObjectTable_t table, bulkRowList_t &rows);
+
+	/*! \short  write the records within the transaction given.
+
+		\arg \c suffix - appended to the table names, to write in a partition
+		\throws Error if the database rejects the data.
+	*/
+	static void load(pqxx::work &w, const biddingObjectRecordBatch_t &batch,
+					 const string &suffix = "");
+
+	//! name of the table with the auction summaries
+	static const char *getSummaryTableName();
+
+	//! columns of the auction summary table.
+	static const vector<string> &getSummaryColumns();
+
+	/*! \short  create the auction summary table if it does not exist yet.
+		\throws Error if the database rejects the statement.
+	*/
+	static void createSummaryTable(pqxx::connection &conn);
+
+	//! append the row of the auction summary.
+	static void appendSummaryRow(const auctionSummaryRecord_t &summary, bulkRowList_t &rows);
+
+	/*! \short  write the auction summaries within the transaction given.
+
+		\arg \c suffix - appended to the table name, to write in a partition
+		\throws Error if the database rejects the data.
+	*/
+	static void loadSummaries(pqxx::work &w, const auctionSummaryBatch_t &batch,
+							  const string &suffix = "");
+};
+
+} // namespace auction
+
+#endif // _BIDDINGOBJECT_BULK_LOADER_H_
@@ -0,0 +1,230 @@
+/*! \file   BiddingObjectJournal.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Local append only journal of done bidding objects and allocations.
+
+    $Id: BiddingObjectJournal.h 748 2015-08-13 16:40:00Z amarentes $
+*/
+
+#ifndef _BIDDINGOBJECT_JOURNAL_H_
+#define _BIDDINGOBJECT_JOURNAL_H_
+
+#include "stdincpp.h"
+#include "Logger.h"
+#include "Error.h"
+#include "Threads.h"
+#include "BiddingObject.h"
+#include "RecordCodec.h"
+
+
+namespace auction
+{
+
+//! first bytes of a journal file
+const char JOURNAL_MAGIC[4] = { 'A', 'U', 'M', 'J' };
+
+//! format version written after the magic
+const uint32_t JOURNAL_VERSION = 1;
+
+//! size of the file header: magic + version
+const size_t JOURNAL_HEADER_LEN = 8;
+
+//! size of the entry header: payload length + crc32 of the payload
+const size_t JOURNAL_ENTRY_HEADER_LEN = 8;
+
+//! largest payload accepted when reading, protects against garbage lengths.
+const uint32_t JOURNAL_MAX_ENTRY_LEN = 16 * 1024 * 1024;
+
+//! kind of the entries, first byte of the payload.
+typedef enum
+{
+	JOURNAL_END = 0,				//!< no more entries
+	JOURNAL_BIDDING_OBJECT,
+	JOURNAL_AUCTION_SUMMARY
+
+} journalEntry_t;
+
+
+/*! \short   append only journal of bidding object records and auction summaries
+
+    The file starts with a header (magic and version) followed by entries.
+    Every entry is the payload length and its crc32, both 32 bit little
+    endian, and the encoded record. Entries are buffered and written with
+    one write call. The file is fsync'ed every syncEvery entries or when
+    syncInterval milliseconds passed since the last sync, whichever comes
+    first, and on sync(). A crash can only lose the entries not synced yet;
+    a partly written entry at the end is detected when the journal is opened
+    again and cut off, so new entries follow the last valid one.
+*/
+class BiddingObjectJournal
+{
+  private:
+
+	Logger *log;
+	int ch;
+
+	string fileName;
+	int fd;
+
+	//! entries encoded but not written yet.
+	string buffer;
+
+	unsigned int syncEvery;
+	unsigned int syncInterval;	//!< ms
+
+	//! entries appended since the last sync.
+	unsigned int pending;
+
+	struct timeval lastSync;
+
+	unsigned long appended;
+	unsigned long syncs;
+
+	int threaded;
+
+#ifdef ENABLE_THREADS
+	mutex_t maccess;
+#endif
+
+	//! write the buffer and fsync, called with the lock held.
+	void doSync();
+
+	//! frame the payload and add it to the buffer.
+	void appendPayload(const string &payload);
+
+  public:
+
+	/*! \short  open the journal for appending, creating it if needed.
+
+		Entries after the first damaged one are truncated.
+		\throws Error if it can not be opened or is not a journal.
+	*/
+	BiddingObjectJournal(string fileName, unsigned int syncEvery,
+						 unsigned int syncInterval);
+
+	//! sync and close the journal.
+	~BiddingObjectJournal();
+
+	//! append a record, it may be synced later.
+	void append(const biddingObjectRecord_t &record);
+
+	//! append an auction summary, it may be synced later.
+	void append(const auctionSummaryRecord_t &summary);
+
+	//! write and fsync every entry appended.
+	void sync();
+
+	inline string getFileName() { return fileName; }
+
+	//! return the number of entries appended since the journal was opened
+	unsigned long getNumAppended();
+
+	//! return the number of fsync calls
+	unsigned long getNumSyncs();
+
+	//! encode the record as an entry payload
+	static void encode(const biddingObjectRecord_t &record, string &payload);
+
+	/*! \short  decode an entry payload
+		\returns false if the payload is not a valid record.
+	*/
+	static bool decode(const string &payload, biddingObjectRecord_t &record);
+
+	//! encode the auction summary as an entry payload
+	static void encode(const auctionSummaryRecord_t &summary, string &payload);
+
+	/*! \short  decode an entry payload
+		\returns false if the payload is not a valid auction summary.
+	*/
+	static bool decode(const string &payload, auctionSummaryRecord_t &summary);
+};
+
+
+/*! \short   sequential reader of a journal file
+
+    next() returns the records in the order they were appended. It stops
+    at the end of the file or at the first entry that is incomplete or
+    fails its checksum; isCorrupt() tells which case it was.
+*/
+class BiddingObjectJournalReader
+{
+  private:
+
+	ifstream in;
+
+	string fileName;
+
+	//! offset of the next entry
+	unsigned long offset;
+
+	unsigned long entries;
+
+	bool corrupt;
+
+	//! offset and crc32 of the last entry read
+	unsigned long lastOffset;
+	uint32_t lastCrc;
+
+  public:
+
+	/*! \short  open the journal for reading
+		\throws Error if it can not be opened or is not a journal.
+	*/
+	BiddingObjectJournalReader(string fileName);
+
+	~BiddingObjectJournalReader();
+
+	/*! \short  read the next entry into record or summary, depending on its kind.
+		\returns the kind of the entry read, JOURNAL_END when there are no more.
+	*/
+	journalEntry_t next(biddingObjectRecord_t &record, auctionSummaryRecord_t &summary);
+
+	//! read the next bidding object record, skipping summaries.
+	bool next(biddingObjectRecord_t &record);
+
+	//! return true if reading stopped at a damaged entry
+	inline bool isCorrupt() { return corrupt; }
+
+	//! return the offset of the next entry, or of the damaged one.
+	inline unsigned long getOffset() { return offset; }
+
+	//! return the number of entries read
+	inline unsigned long getNumEntries() { return entries; }
+
+	//! return the offset of the last entry read
+	inline unsigned long getLastOffset() { return lastOffset; }
+
+	//! return the crc32 of the last entry read
+	inline uint32_t getLastCrc() { return lastCrc; }
+
+	/*! \short  continue after an entry read before, see getLastOffset()
+
+		The entry at entryOffset must still have the crc32 given, otherwise
+		the journal is not the one the position was taken from and reading
+		starts again from the first entry.
+		\returns true if reading continues after the entry.
+	*/
+	bool resume(unsigned long entryOffset, uint32_t crc);
+};
+
+} // namespace auction
+
+#endif // _BIDDINGOBJECT_JOURNAL_H_
@@ -37,6 +37,10 @@
 #include "ProcModuleInterface.h"
 #include "AuctioningObjectManager.h"
 #include "BiddingObject.h"
+#include "BiddingObjectArena.h"
+#include "BiddingObjectWriter.h"
+#include "BiddingObjectJournal.h"
+#include "ArchivePartitions.h"
 #include "BiddingObjectFileParser.h"
 #include "MAPIBiddingObjectParser.h"
 #include "EventScheduler.h"
@@ -53,10 +57,12 @@ const time_t FLOW_IDLE_TIMEOUT = 30;
 typedef map<time_t, auctioningObjectDB_t>            	biddingObjectTimeIndex_t;
 typedef map<time_t, auctioningObjectDB_t>::iterator  	biddingObjectTimeIndexIter_t;
 
-typedef map<string, vector<int> >					auctionBidIndex_t;
-typedef map<string, vector<int> >::iterator			auctionBidIndexIter_t;
-typedef map<string, auctionBidIndex_t>				auctionSetBidIndex_t;
-typedef map<string, auctionBidIndex_t>::iterator	auctionSetBidIndexIter_t;
+//! index biddingObjects uids by (auction set, auction name)
+typedef AuctioningObjectIndex< vector<int> >		auctionBidIndex_t;
+
+//! open arenas by start of their interval
+typedef map<time_t, BiddingObjectArena *>            	biddingObjectArenaList_t;
+typedef map<time_t, BiddingObjectArena *>::iterator  	biddingObjectArenaListIter_t;
 
 /*! \short   manage adding/deleting of complete biddingObject  descriptions
   
@@ -73,15 +79,36 @@ class BiddingObjectManager : public AuctioningObjectManager
 
 
 	//! index biddingObjects via AuctionSetId and Auction name.
-	auctionSetBidIndex_t bidAuctionSetIndex;
+	auctionBidIndex_t bidAuctionIndex;
+
+	//! position of every bidding object within its auction list.
+	uidListPosition_t bidAuctionPositions;
 	
     //! connection string to the database.
     string connectionDBStr;
+
+	//! connections to the database, NULL if there is no database.
+	DBConnectionPool *pool;
+
+	//! writer storing done bidding objects, NULL if there is no database.
+	BiddingObjectWriter *writer;
+
+	//! local journal of done bidding objects, NULL if not configured.
+	BiddingObjectJournal *journal;
+
+	//! time partitions of the archive tables, NULL if not partitioned.
+	ArchivePartitions *partitions;
+
+	//! arenas still taking objects, see getIntervalArena.
+	biddingObjectArenaList_t arenas;
     
 	/*! \short add the biddingObject  name to the list of finished biddingObjects
        \arg \c b - object to store biddingObject  (source.name).
     */
     void storeBiddingObjectAsDone(BiddingObject  *b);
+
+	//! retire the bidding object, its arena destroys it on release.
+	virtual void releaseAuctioningObject(AuctioningObject *a);
   
   public:
 
@@ -89,8 +116,17 @@ class BiddingObjectManager : public AuctioningObjectManager
         \arg \c fdname  		field definition file name
         \arg \c fvname  		field value definition name
         \arg \c connectionDB 	string to connect to the data base. If empty inactive DB management.
+        \arg \c journalFile 	local journal of done bidding objects. With a data base it
+        						keeps what could not be written, without one every done
+        						object. If empty there is no journal.
+        \arg \c archiveInterval seconds covered by each partition of the archive tables,
+        						0 to write in the tables themselves.
+        \arg \c archiveRetention seconds the partitions are kept, 0 to keep them all.
+        \arg \c archiveDetach	detach expired partitions instead of dropping them.
      */
-    BiddingObjectManager(int domain, string fdname, string fvname, string connectionDB); //Ok
+    BiddingObjectManager(int domain, string fdname, string fvname, string connectionDB,
+                         string journalFile = "", unsigned long archiveInterval = 0,
+                         unsigned long archiveRetention = 0, bool archiveDetach = false); //Ok
 
     //! destroy a BiddingObjectManager object
     ~BiddingObjectManager(); // Ok
@@ -104,7 +140,11 @@ class BiddingObjectManager : public AuctioningObjectManager
     //! parse XML or Auction API biddingObjects from buffer
     auctioningObjectDB_t *parseBiddingObjectsBuffer(char *buf, int len);
 
-    //! parse biddingObjects from ipap_message 
+    /*! \short  parse biddingObjects from ipap_message 
+
+        only reads the field definitions and the templates, it can run in
+        another thread as long as nobody changes the templates meanwhile.
+    */
     auctioningObjectDB_t *parseMessage(ipap_message *messageIn, ipap_template_container *templates);
 
    
@@ -123,7 +163,11 @@ class BiddingObjectManager : public AuctioningObjectManager
 	//! add a single biddingObject
 	void addBiddingObject(BiddingObject *b);
 
-	void delBiddingObject(BiddingObject *r, EventScheduler *e);
+	/*! \short   delete a bidding object
+		\arg \c archive  false if it was already stored as done, as when
+						  replaying the state log.
+	*/
+	void delBiddingObject(BiddingObject *r, EventScheduler *e, bool archive = true);
 
 	void delBiddingObject(int uid, EventScheduler *e);
 	
@@ -143,6 +187,28 @@ class BiddingObjectManager : public AuctioningObjectManager
 									Auction *auction, 
 									ipap_template_container *templates);
 
+	/*! \short   get the messages carrying the bidding objects of the batch, 
+				  as few as fit in maxRecords data records each.
+
+		templates in peerTemplates are left out, the receiver holds them.
+        \throws an Error exception if some field required is missing.
+    */	
+	vector<ipap_message *> get_ipap_messages(biddingObjectBatch_t *batch,
+											 ipap_template_container *templates,
+											 unsigned int maxRecords,
+											 const set<uint16_t> *peerTemplates = NULL);
+
+	/*! \short  get the arena for the objects created at time t
+
+		there is one arena per BIDDING_OBJECT_ARENA_INTERVAL seconds, the
+		ones of past intervals are closed here and go away with their last
+		object. To be called from the thread running the manager only.
+	*/
+	BiddingObjectArena *getIntervalArena(time_t t);
+
+	//! get the auctions the bidding objects of a message are for, without parsing them
+	void getAuctionKeys(ipap_message *message, auctionKeyList_t &auctions);
+
     /*! \short   get information from the auction manager
 
         these functions can be used to get information for a single auction object,
@@ -153,6 +219,20 @@ class BiddingObjectManager : public AuctioningObjectManager
     string getInfo(string sname);
     string getInfo();
 
+	/*! \short  archive the result of an auction execution, with the
+		bidding objects when there is a database, in the journal if not.
+	*/
+	void storeAuctionSummary(const auctionSummaryRecord_t &summary);
+
+	//! get the state of the database writer as an xml string
+	string getWriterInfo();
+
+	//! get the local journal, NULL if there is no journal.
+	inline BiddingObjectJournal *getJournal() { return journal; }
+
+	//! get the pool of connections to the database, NULL if there is no database.
+	inline DBConnectionPool *getConnectionPool() { return pool; }
+
     //! dump a AuctionManager object
     void dump( ostream &os );
 	
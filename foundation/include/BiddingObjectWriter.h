@@ -0,0 +1,237 @@
+/*! \file   BiddingObjectWriter.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Background writer storing done bidding objects in the database.
+
+    $Id: BiddingObjectWriter.h 748 2015-08-10 10:30:00Z amarentes $
+*/
+
+#ifndef _BIDDINGOBJECT_WRITER_H_
+#define _BIDDINGOBJECT_WRITER_H_
+
+#include "stdincpp.h"
+#include "Logger.h"
+#include "Error.h"
+#include "Threads.h"
+#include "BiddingObject.h"
+#include "DBConnectionPool.h"
+#include "BiddingObjectJournal.h"
+#include "ArchivePartitions.h"
+
+
+namespace auction
+{
+
+//! records waiting to be written, in arrival order.
+typedef deque<biddingObjectRecord_t *>            	biddingObjectRecordQueue_t;
+typedef deque<biddingObjectRecord_t *>::iterator  	biddingObjectRecordQueueIter_t;
+
+typedef deque<auctionSummaryRecord_t *>            	auctionSummaryQueue_t;
+typedef deque<auctionSummaryRecord_t *>::iterator  	auctionSummaryQueueIter_t;
+
+//! records taken from the queues to be written in one transaction.
+typedef struct
+{
+	biddingObjectRecordBatch_t objects;
+	auctionSummaryBatch_t summaries;
+
+} biddingObjectWriterBatch_t;
+
+//! counters published through getInfo.
+typedef struct
+{
+	unsigned long enqueued;		//!< records accepted in the queue
+	unsigned long written;		//!< records committed to the database
+	unsigned long summaries;	//!< auction summaries committed to the database
+	unsigned long batches;		//!< transactions committed
+	unsigned long failures;		//!< transactions failed
+	unsigned long full;			//!< pushes that found the queue full
+	unsigned long spilled;		//!< records appended to the journal
+	unsigned long dropped;		//!< records lost
+	unsigned long maxQueued;	//!< highest queue length seen
+
+} biddingObjectWriterStats_t;
+
+
+/*! \short   store done bidding objects in the database off the event loop
+
+    push() takes a copy of the rows of the bidding object, or the auction
+    summary, and puts it in a bounded queue. With threads enabled a worker
+    drains the queue over a connection leased from the pool, committing up to
+    batchSize records per transaction. Batches of DB_WRITER_COPY_THRESHOLD
+    objects or more are streamed with COPY (BiddingObjectBulkLoader), as are
+    the summaries, which go in a transaction of their own so a failure of
+    one table does not hold back the other.
+
+    With partitions the rows of a batch go, always with COPY, to the
+    partitions of the interval the batch is written in, and the partitions
+    are maintained before each batch.
+
+    push() never waits. When the queue is full the record is appended to
+    the journal, to be loaded later with auctionJournal, or dropped when
+    there is no journal. A failed batch is tried once more after
+    DB_WRITER_RETRY_DELAY and then sent to the journal; while batches keep
+    failing they go to the journal without the retry. Without threads the
+    queue is written from the event loop, once a batch is complete or
+    flush() is called, never retrying; while the database is down batches
+    go to the journal for DB_WRITER_RETRY_DELAY before it is tried again.
+    The journal is written without holding the queue lock.
+*/
+class BiddingObjectWriter
+{
+  private:
+
+	Logger *log;
+	int ch;
+
+	//! pool the connection for each batch is leased from.
+	DBConnectionPool *pool;
+
+	unsigned int queueSize;
+	unsigned int batchSize;
+
+	//! journal receiving the records not written, NULL to drop them.
+	BiddingObjectJournal *journal;
+
+	//! time partitions of the archive tables, NULL to write in the tables.
+	ArchivePartitions *partitions;
+
+	//! set once the auction summary table is known to exist.
+	bool summaryTableReady;
+
+	//! set while batches fail, they are spilled without a retry.
+	bool failing;
+
+	//! when the last batch written from the event loop failed.
+	time_t lastFailure;
+
+	biddingObjectRecordQueue_t queue;
+
+	auctionSummaryQueue_t summaryQueue;
+
+	biddingObjectWriterStats_t stats;
+
+	int threaded;
+
+	//! set when the worker has to finish.
+	int stopping;
+
+#ifdef ENABLE_THREADS
+	thread_t thread;
+	mutex_t maccess;
+	thread_cond_t notEmpty;
+#endif
+
+	/*! \short  write the batch, bidding objects and summaries each in one
+		transaction. What is written is released from the batch.
+		\returns false if something is left.
+	*/
+	bool writeBatch(biddingObjectWriterBatch_t &batch);
+
+	//! write the bidding objects in one transaction, returns false on failure.
+	bool writeObjects(DBConnectionLease &lease, biddingObjectRecordBatch_t &objects,
+					  const string &suffix);
+
+	//! write the auction summaries in one transaction, returns false on failure.
+	bool writeSummaries(DBConnectionLease &lease, auctionSummaryBatch_t &summaries,
+						const string &suffix);
+
+	//! count a batch not written.
+	void failed();
+
+	//! number of records waiting in both queues, called with the lock held.
+	inline unsigned int queued() { return queue.size() + summaryQueue.size(); }
+
+	//! count a record queued and wake up the worker, called with the lock held.
+	void enqueued();
+
+	//! move up to batchSize records from the queues into batch.
+	void takeBatch(biddingObjectWriterBatch_t &batch);
+
+	//! append the record to the journal, returns false if not possible. Called without the lock.
+	bool spill(biddingObjectRecord_t *record);
+
+	//! append the summary to the journal, returns false if not possible. Called without the lock.
+	bool spill(auctionSummaryRecord_t *summary);
+
+	//! spill or drop the records of the batch, called without the lock.
+	void discardBatch(biddingObjectWriterBatch_t &batch);
+
+	//! release the records of the batch.
+	void releaseBatch(biddingObjectWriterBatch_t &batch);
+
+	//! release the bidding object records of the batch.
+	void releaseObjects(biddingObjectWriterBatch_t &batch);
+
+	//! release the auction summaries of the batch.
+	void releaseSummaries(biddingObjectWriterBatch_t &batch);
+
+	//! worker main loop
+	void main();
+
+	//! wait DB_WRITER_RETRY_DELAY seconds, less if stopping.
+	void waitRetry();
+
+	static void *thread_func(void *arg);
+
+  public:
+
+	/*! \short  create the writer, with threads enabled the worker starts here.
+		\arg \c pool         - pool of connections to the data base
+		\arg \c queueSize    - maximum number of records waiting
+		\arg \c batchSize    - maximum number of records per transaction
+		\arg \c journal      - journal for the records not written, NULL to drop them
+		\arg \c partitions   - partitions of the archive tables, NULL to write in the tables
+	*/
+	BiddingObjectWriter(DBConnectionPool *pool, unsigned int queueSize,
+						unsigned int batchSize,
+						BiddingObjectJournal *journal,
+						ArchivePartitions *partitions = NULL);
+
+	//! stop the worker and write the records still queued.
+	~BiddingObjectWriter();
+
+	//! queue the rows of the bidding object to be written.
+	void push(BiddingObject *b);
+
+	//! queue the auction summary to be written.
+	void push(const auctionSummaryRecord_t &summary);
+
+	/*! \short  write what is queued.
+
+		without threads the records are written before returning, with
+		threads the worker is only woken up.
+	*/
+	void flush();
+
+	//! return the number of records waiting
+	unsigned int getQueueLength();
+
+	//! get a copy of the counters
+	biddingObjectWriterStats_t getStats();
+
+	//! get the counters as an xml string
+	string getInfo();
+};
+
+} // namespace auction
+
+#endif // _BIDDINGOBJECT_WRITER_H_
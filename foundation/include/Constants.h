@@ -46,6 +46,34 @@ extern const string AUC_DEFAULT_SETNAME;
 extern const unsigned int  DONE_LIST_SIZE;
 extern const string        FIELDVAL_FILE;
 extern const string        FILTERDEF_FILE;
+extern const unsigned int  ANNOUNCEMENT_CACHE_SIZE;
+extern const uint32_t      MANAGER_MAX_UID;
+
+// BiddingObjectManager.cpp
+extern const unsigned int  MESSAGE_MAX_RECORDS;
+extern const unsigned int  ARCHIVE_PARTITIONS_AHEAD;
+extern const time_t        BIDDING_OBJECT_ARENA_INTERVAL;
+
+// DBConnectionPool.cpp
+extern const unsigned int  DB_POOL_SIZE;
+extern const time_t        DB_POOL_CHECK_IDLE;
+
+// BiddingObjectWriter.cpp
+extern const unsigned int  DB_WRITER_QUEUE_SIZE;
+extern const unsigned int  DB_WRITER_BATCH_SIZE;
+extern const unsigned int  DB_WRITER_RETRY_DELAY;
+extern const unsigned int  DB_WRITER_COPY_THRESHOLD;
+
+// BiddingObjectJournal.cpp
+extern const unsigned int  JOURNAL_SYNC_EVERY;
+extern const unsigned int  JOURNAL_SYNC_INTERVAL;
+
+// AnslpEventTransport.cpp
+extern const string        ANSLP_TRANSPORT_LOCAL_ADDRESS;
+extern const uint32_t      ANSLP_TRANSPORT_SESSION_LIFETIME;
+
+// SocketTransport.cpp
+extern const unsigned int  SOCKET_TRANSPORT_MAX_MESSAGE;
 
 
 // Logger.h
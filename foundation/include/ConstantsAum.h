@@ -44,6 +44,22 @@ extern const string AUM_DEFAULT_LOG_FILE;
 // ConfigParser.h
 extern const string AUM_CONFIGFILE_DTD;
 
+// Auctioner.h
+extern const unsigned long AUM_SNAPSHOT_INTERVAL;
+extern const unsigned int AUM_STATELOG_SYNC_INTERVAL;
+extern const unsigned long AUM_STATELOG_MAX_SIZE;
+extern const unsigned long AUM_RETRANSMIT_TIMEOUT;
+extern const unsigned long AUM_RETRANSMIT_MAX_TIMEOUT;
+extern const unsigned int AUM_RETRANSMIT_RETRIES;
+extern const unsigned int AUM_MAX_PENDING_MESSAGES;
+
+// AnslpProcessor.h
+extern const unsigned int AUM_ANSLP_DRAIN_BUDGET;
+extern const unsigned int AUM_ANSLP_RELAY_WAIT;
+extern const unsigned int AUM_ANSLP_HANDOFF_SIZE;
+extern const unsigned int AUM_ANSLP_HANDOFF_RETRY;
+extern const unsigned int AUM_ANSLP_BUCKET_PRUNE;
+
 
 #ifdef USE_SSL
 // certificate file location (SSL)
@@ -0,0 +1,176 @@
+/*! \file   DBConnectionPool.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Pool of database connections that remember their prepared statements.
+
+    $Id: DBConnectionPool.h 748 2015-08-12 11:20:00Z amarentes $
+*/
+
+#ifndef _DB_CONNECTION_POOL_H_
+#define _DB_CONNECTION_POOL_H_
+
+#include "stdincpp.h"
+#include "Logger.h"
+#include "Error.h"
+#include "Threads.h"
+#include <pqxx/pqxx>
+
+
+namespace auction
+{
+
+//! a connection of the pool
+typedef struct
+{
+	pqxx::connection *conn;
+
+	//! names of the statements already prepared in conn.
+	set<string> prepared;
+
+	//! last time the connection was given back
+	time_t lastUsed;
+
+	bool leased;
+
+} pooledConnection_t;
+
+typedef vector<pooledConnection_t *>            	pooledConnectionList_t;
+typedef vector<pooledConnection_t *>::iterator  	pooledConnectionListIter_t;
+
+
+/*! \short   pool of connections to the database
+
+    Connections are opened on demand up to maxConnections and kept open.
+    A connection is checked before being leased: a closed one is
+    reactivated, one idle for more than checkIdle seconds is probed with a
+    trivial query, and it is reopened if that fails. Each connection keeps
+    the names of the statements prepared in it, so they are prepared once
+    per connection instead of once per use.
+*/
+class DBConnectionPool
+{
+  private:
+
+	Logger *log;
+	int ch;
+
+	string connectionDBStr;
+
+	unsigned int maxConnections;
+
+	//! seconds a connection can stay idle without being probed.
+	time_t checkIdle;
+
+	pooledConnectionList_t connections;
+
+	unsigned long reconnects;
+
+	int threaded;
+
+#ifdef ENABLE_THREADS
+	mutex_t maccess;
+	thread_cond_t released;
+#endif
+
+	//! make sure the connection works, reopening it if needed.
+	void check(pooledConnection_t *entry);
+
+	//! open the connection of the entry, dropping its prepared statements.
+	void open(pooledConnection_t *entry);
+
+  public:
+
+	/*! \short  create the pool, no connection is opened here.
+		\arg \c connectionDB   - string to connect to the data base
+		\arg \c maxConnections - maximum number of connections open
+		\arg \c checkIdle      - seconds idle before a connection is probed
+	*/
+	DBConnectionPool(string connectionDB, unsigned int maxConnections, time_t checkIdle);
+
+	//! close all the connections, none can be leased.
+	~DBConnectionPool();
+
+	/*! \short  take a connection working, waits if all are leased.
+
+		\throws Error if the database can not be reached, or if every
+		connection is leased and threads are not enabled.
+	*/
+	pooledConnection_t *lease();
+
+	/*! \short  give the connection back to the pool.
+		\arg \c broken - the connection failed while leased, it is closed.
+	*/
+	void release(pooledConnection_t *entry, bool broken = false);
+
+	//! return the number of connections created, open or being reopened
+	unsigned int getNumConnections();
+
+	//! return the number of times a connection was opened
+	unsigned long getNumReconnects();
+};
+
+
+/*! \short  connection leased from a pool for the life of the object
+
+	Use as automatic (stack) variable. Call invalidate() if the connection
+	fails, so it is not given to anyone else as it is.
+*/
+class DBConnectionLease
+{
+  private:
+
+	DBConnectionPool *pool;
+	pooledConnection_t *entry;
+	bool broken;
+
+  public:
+
+	DBConnectionLease(DBConnectionPool *_pool)
+		: pool(_pool), entry(_pool->lease()), broken(false) { }
+
+	~DBConnectionLease() { pool->release(entry, broken); }
+
+	inline pqxx::connection &getConnection() { return *(entry->conn); }
+
+	//! return true if the statement was already prepared in the connection.
+	inline bool isPrepared(const string &name)
+	{
+		return entry->prepared.find(name) != entry->prepared.end();
+	}
+
+	//! record that the statement is prepared in the connection.
+	inline void setPrepared(const string &name) { entry->prepared.insert(name); }
+
+	//! prepare the statement unless the connection already has it.
+	inline void prepare(const string &name, const string &sql)
+	{
+		if (!isPrepared(name)) {
+			entry->conn->prepare(name, sql);
+			setPrepared(name);
+		}
+	}
+
+	inline void invalidate() { broken = true; }
+};
+
+} // namespace auction
+
+#endif // _DB_CONNECTION_POOL_H_
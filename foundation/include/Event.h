@@ -80,7 +80,12 @@ typedef enum
       ADD_RESOURCE,
       ADD_RESOURCE_CTRLCOMM,
       ACTIVATE_RESOURCE,
-      REMOVE_RESOURCE
+      REMOVE_RESOURCE,
+      SAVE_STATE,
+      RESTORE_STATE,
+      RETRANSMIT_MESSAGES,
+      ACKNOWLEDGE_MESSAGES,
+      SYNC_STATE_LOG
 } event_t;
 
 //! event names for dump method
@@ -120,7 +125,12 @@ const string eventNames[] =
       "Add-Resource",
       "Add-Resource-ctrlcomm",
       "Activate-Resource",
-      "Remove-Resource"
+      "Remove-Resource",
+      "Save-State",
+      "Restore-State",
+      "Retransmit-Messages",
+      "Acknowledge-Messages",
+      "Sync-State-Log"
 };
 
 /* ------------------------- Event class ------------------------- */
@@ -322,10 +332,22 @@ class AddGeneratedBiddingObjectsEvent : public Event
     int index;
     auctioningObjectDB_t biddingObjects;
 
+    //! result of the execution that generated the bidding objects.
+    auctionSummaryRecord_t summary;
+
   public:
 
     AddGeneratedBiddingObjectsEvent( int _index, auctioningObjectDB_t &biddingObjects ): 
-    Event(ADD_GENERATED_BIDDING_OBJECTS), index(_index), biddingObjects(biddingObjects) 
+    Event(ADD_GENERATED_BIDDING_OBJECTS), index(_index), biddingObjects(biddingObjects),
+    summary()
+    {
+        
+    }
+
+    AddGeneratedBiddingObjectsEvent( int _index, auctioningObjectDB_t &biddingObjects,
+                                     const auctionSummaryRecord_t &_summary ): 
+    Event(ADD_GENERATED_BIDDING_OBJECTS), index(_index), biddingObjects(biddingObjects),
+    summary(_summary)
     {
         
     }
@@ -336,6 +358,8 @@ class AddGeneratedBiddingObjectsEvent : public Event
     }
     
     int getIndex(){ return index; }
+
+    const auctionSummaryRecord_t &getSummary(){ return summary; }
     
     int deleteBiddingObject(int uid)
     {
@@ -742,16 +766,40 @@ class RemoveAuctionsCtrlEvent : public CtrlCommEvent
     }
 };
 
+//! bidding objects parsed ahead from the messages of an auction interaction.
+typedef map<anslp::mspec_rule_key, auctioningObjectDB_t *>            parsedObjectList_t;
+typedef map<anslp::mspec_rule_key, auctioningObjectDB_t *>::iterator  parsedObjectListIter_t;
+
 class AuctionInteractionEvent : public Event
 {
   private:
 	string sessionId;
 	anslp::objectList_t objects;
+
+	//! bidding objects parsed by the anslp thread, by message.
+	parsedObjectList_t parsed;
+
+	//! version of the templates the objects were parsed with.
+	uint32_t templatesVersion;
+
+	//! messages over the admission rates, left unparsed.
+	set<anslp::mspec_rule_key> overLimit;
+
+	static void deleteParsed(auctioningObjectDB_t *bids)
+	{
+		auctioningObjectDBIter_t it;
+		for ( it = bids->begin(); it != bids->end(); it++)
+		{
+			saveDelete(*it);
+		}
+		saveDelete(bids);
+	}
     
   public:
 
     AuctionInteractionEvent(string _sessionId, unsigned long ival=0, int align=0) 
-      : Event(AUCTION_INTERACTION, ival, align), sessionId(_sessionId) {  }
+      : Event(AUCTION_INTERACTION, ival, align), sessionId(_sessionId), 
+        templatesVersion(0) {  }
 
     ~AuctionInteractionEvent() 
     {
@@ -761,6 +809,55 @@ class AuctionInteractionEvent : public Event
 			if (it->second != NULL)
 				delete(it->second);
 		}
+
+		// objects not taken by the core.
+		parsedObjectListIter_t pit;
+		for ( pit = parsed.begin(); pit != parsed.end(); pit++)
+		{
+			deleteParsed(pit->second);
+		}
+	}
+
+	//! keep the bidding objects parsed from the message under key.
+	void setBiddingObjects(anslp::mspec_rule_key key, auctioningObjectDB_t *bids, 
+						   uint32_t version)
+	{
+		parsedObjectListIter_t it = parsed.find(key);
+		if (it != parsed.end()) {
+			deleteParsed(it->second);
+		}
+		parsed[key] = bids;
+		templatesVersion = version;
+	}
+
+	/*! \short  take the bidding objects parsed from the message under key
+
+		\returns the objects, owned by the caller, or NULL if the message
+				 was not parsed or was parsed with other templates than
+				 those of version.
+	*/
+	auctioningObjectDB_t *takeBiddingObjects(anslp::mspec_rule_key key, 
+											 uint32_t version)
+	{
+		parsedObjectListIter_t it = parsed.find(key);
+		if ((it == parsed.end()) || (templatesVersion != version)) {
+			return NULL;
+		}
+		auctioningObjectDB_t *bids = it->second;
+		parsed.erase(it);
+		return bids;
+	}
+
+	//! mark the message under key as over the admission rates.
+	void setOverLimit(anslp::mspec_rule_key key)
+	{
+		overLimit.insert(key);
+	}
+
+	//! return true if the message under key went over the admission rates.
+	bool isOverLimit(anslp::mspec_rule_key key)
+	{
+		return (overLimit.find(key) != overLimit.end());
 	}
 
 
@@ -790,6 +887,58 @@ class AuctionInteractionEvent : public Event
 };
 
 
+//! send again the messages of a session not confirmed in time.
+class RetransmitMessagesEvent : public Event
+{
+  private:
+    string sessionId;
+
+  public:
+
+    RetransmitMessagesEvent(struct timeval when, string _sessionId) 
+      : Event(RETRANSMIT_MESSAGES, when), sessionId(_sessionId) {  }
+
+    string getSessionId()
+    {
+        return sessionId;
+    }
+};
+
+
+//! send the cumulative acknowledgement of a session, delay ms after the first message.
+class AcknowledgeMessagesEvent : public Event
+{
+  private:
+	string sessionId;
+	
+	//! address and port to send to, when the session does not keep them.
+	string destination;
+	uint16_t port;
+
+  public:
+
+    AcknowledgeMessagesEvent(string _sessionId, unsigned long delay, 
+							 string _destination = "", uint16_t _port = 0) 
+      : Event(ACKNOWLEDGE_MESSAGES, delay / 1000, (delay % 1000) * 1000), 
+        sessionId(_sessionId), destination(_destination), port(_port) {  }
+
+	string getSessionId()
+	{
+		return sessionId;
+	}
+
+	string getDestination()
+	{
+		return destination;
+	}
+
+	uint16_t getPort()
+	{
+		return port;
+	}
+};
+
+
 class RemoveSessionEvent : public Event
 {
   private:
@@ -843,6 +992,23 @@ class RemoveSessionEvent : public Event
 };
 
 
+/*! \short  transfer the objects of an anslp event to an event holding them
+
+    E is any event with setObject. The anslp event is left without
+    objects, so they are handed over instead of being copied.
+*/
+template <class E>
+inline void moveObjects(anslp::objectList_t *objects, E *retEvent)
+{
+	anslp::objectListIter_t it;
+	for (it = objects->begin(); it != objects->end(); ++it){
+		assert(it->second != NULL);
+		retEvent->setObject(it->first, it->second);
+		it->second = NULL;
+	}
+	objects->clear();
+}
+
 
 //! overload for << so that an Event object can be thrown into an ostream
 ostream& operator<< ( ostream &os, Event &ev );
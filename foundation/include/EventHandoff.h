@@ -0,0 +1,108 @@
+/*! \file   EventHandoff.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Bounded lock free queue handing events from worker threads to the core.
+
+    $Id: EventHandoff.h 748 2015-08-20 10:15:00Z amarentes $
+*/
+
+#ifndef _EVENT_HANDOFF_H_
+#define _EVENT_HANDOFF_H_
+
+#include "stdincpp.h"
+#include "Event.h"
+
+
+namespace auction
+{
+
+//! size of a cache line, keeps the positions of producers and consumer apart.
+const size_t HANDOFF_CACHE_LINE = 64;
+
+//! a slot of the queue
+typedef struct
+{
+	//! position the cell is free for, or position + 1 once it holds the event.
+	volatile unsigned long sequence;
+	Event *event;
+
+} handoffCell_t;
+
+
+/*! \short   bounded lock free queue of events, many producers, one consumer
+
+    Worker threads push the events they built, the core thread pops them.
+    Each cell carries a sequence number telling whether it is free for
+    the push of a given position or holds the event of that position, so
+    producers only compete on a compare and swap of the push position and
+    the consumer never takes a lock. A full queue makes push() fail, the
+    producer decides whether to retry.
+*/
+class EventHandoff
+{
+  private:
+
+	handoffCell_t *cells;
+
+	//! capacity - 1, the capacity is a power of two.
+	unsigned long mask;
+
+	char pad0[HANDOFF_CACHE_LINE];
+
+	//! next position to push, shared by the producers.
+	volatile unsigned long pushPos;
+
+	char pad1[HANDOFF_CACHE_LINE];
+
+	//! next position to pop, only used by the consumer.
+	unsigned long popPos;
+
+	char pad2[HANDOFF_CACHE_LINE];
+
+  public:
+
+	/*! \short  create an empty queue
+		\arg \c capacity - events it holds, rounded up to a power of two
+	*/
+	EventHandoff(unsigned int capacity);
+
+	//! delete the events not popped
+	~EventHandoff();
+
+	/*! \short  add an event, from any thread
+		\returns false if the queue is full, the event is not taken.
+	*/
+	bool push(Event *e);
+
+	/*! \short  take the oldest event, only from the consumer thread
+		\returns NULL if the queue is empty.
+	*/
+	Event *pop();
+
+	//! return true if there is nothing to pop, from the consumer thread.
+	bool isEmpty();
+
+	inline unsigned long getCapacity() { return mask + 1; }
+};
+
+} // namespace auction
+
+#endif // _EVENT_HANDOFF_H_
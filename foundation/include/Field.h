@@ -34,6 +34,7 @@
 #include "stdincpp.h"
 #include "Error.h"
 #include "FieldValue.h"
+#include "BiddingObjectArena.h"
 
 namespace auction
 {
@@ -102,6 +103,11 @@ typedef enum
     FT_WILD
 } fieldType_t;
 
+//! values of a field, taken from the current arena (see BiddingObjectArena)
+typedef vector<FieldValue, ArenaAllocator<FieldValue> >						fieldValueList_t;
+typedef vector<FieldValue, ArenaAllocator<FieldValue> >::iterator			fieldValueListIter_t;
+typedef vector<FieldValue, ArenaAllocator<FieldValue> >::const_iterator	fieldValueListConstIter_t;
+
 //! definition of a field
 class field_t
 {
@@ -119,7 +125,7 @@ public:
 	//! RANGE -> min in value[0], max in value[1]
 	//! SET -> value[0-n] where value.len>0
 	//! WILD -> no value
-	vector<FieldValue> value;
+	fieldValueList_t value;
 	
 	field_t(): name(), type(), mtype(FT_WILD), len(0), cnt(0)  {}
 	
@@ -146,10 +152,10 @@ public:
 //! overload for <<, so that a field_t object can be thrown into an iostream
 ostream& operator<< ( ostream &os, field_t &f );
 
-//! field list (only push_back & sequential access)
-typedef vector<field_t>            			fieldList_t;
-typedef vector<field_t>::iterator  			fieldListIter_t;
-typedef vector<field_t>::const_iterator  	fieldListconstIter_t;
+//! field list (only push_back & sequential access), taken from the current arena
+typedef vector<field_t, ArenaAllocator<field_t> >            			fieldList_t;
+typedef vector<field_t, ArenaAllocator<field_t> >::iterator  			fieldListIter_t;
+typedef vector<field_t, ArenaAllocator<field_t> >::const_iterator  	fieldListconstIter_t;
 
 
 } // namespace auction.
@@ -0,0 +1,106 @@
+/*! \file   IntervalIndex.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Index of time intervals answering which ones overlap a period.
+
+    $Id: IntervalIndex.h 748 2015-08-21 09:40:00Z amarentes $
+*/
+
+
+#ifndef _INTERVAL_INDEX_H_
+#define _INTERVAL_INDEX_H_
+
+#include "stdincpp.h"
+
+
+namespace auction
+{
+
+//! an indexed interval [start, stop) and the id of its owner
+typedef struct
+{
+	time_t start;
+	time_t stop;
+	int id;
+
+} indexedInterval_t;
+
+typedef vector<indexedInterval_t>            indexedIntervalList_t;
+typedef vector<indexedInterval_t>::iterator  indexedIntervalListIter_t;
+
+
+/*! \short   index of intervals to find those overlapping a period
+
+    The intervals are kept sorted by start, and the sorted list is read as
+    a balanced binary tree: the middle of a range is the node, its halves
+    the subtrees. Every node stores the latest stop within its subtree, so
+    a query skips the subtrees ending before the period and stops where
+    the starts go past it, which takes O(log n + k) for k intervals found.
+    Inserting and removing move the list, and the latest stops are
+    recomputed on the next query. Both are rare next to the queries.
+*/
+class IntervalIndex
+{
+
+  private:
+
+	//! intervals sorted by start and id
+	indexedIntervalList_t intervals;
+
+	//! latest stop of the subtree having each position as its node
+	vector<time_t> maxStop;
+
+	//! maxStop does not match the intervals
+	bool dirty;
+
+	//! compute maxStop for the range [lo, hi), returns the latest stop
+	time_t build(size_t lo, size_t hi);
+
+	//! add to ids the intervals of [lo, hi) overlapping [start, stop)
+	void find(size_t lo, size_t hi, time_t start, time_t stop, vector<int> &ids) const;
+
+  public:
+
+	IntervalIndex();
+
+	~IntervalIndex();
+
+	//! add the interval [start, stop) of id
+	void insert(int id, time_t start, time_t stop);
+
+	/*! \short  remove the interval of id starting at start
+		\returns false if it is not indexed
+	*/
+	bool erase(int id, time_t start);
+
+	/*! \short  find the intervals overlapping [start, stop)
+		\arg \c ids - receives the ids found, in no particular order
+	*/
+	void find(time_t start, time_t stop, vector<int> &ids);
+
+	inline size_t size() const { return intervals.size(); }
+
+	inline bool empty() const { return intervals.empty(); }
+};
+
+} // namespace auction
+
+#endif // _INTERVAL_INDEX_H_
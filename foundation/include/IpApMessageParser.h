@@ -38,6 +38,10 @@
 namespace auction
 {
 
+//! field definitions by ipap key (eno, ftype)
+typedef map<pair<int, int>, fieldDefItem_t *>				fieldDefKeyIndex_t;
+typedef map<pair<int, int>, fieldDefItem_t *>::iterator	fieldDefKeyIndexIter_t;
+
 class IpApMessageParser
 {
 	
@@ -47,13 +51,20 @@ class IpApMessageParser
 		//! This field help to define uniquelly an agent with the auction. 
 		int domain;
 		
-		IpApMessageParser(int domain): domain(domain){}
+		IpApMessageParser(int domain): domain(domain), indexedDefs(NULL), indexedSize(0) {}
 		
 		~IpApMessageParser(){}
 
 		//! parse a field value
 		static void parseFieldValue(fieldValList_t *fieldVals, string value, field_t *f);
 
+		/*! \short  set the value of f from a value received in a message
+		
+			the value is already typed by its ipap field, so it is taken as
+			an exact value with no range, set or symbolic constant to parse.
+		*/
+		static void readFieldValue(ipap_field &field, ipap_value_field &value, field_t *f);
+
 		//! Find a field by eno and ftype within the list of fields.
 		static fieldDefItem_t findField(fieldDefList_t *fieldDefs, int eno, int ftype);
 
@@ -92,6 +103,21 @@ class IpApMessageParser
 
 		dataRecordList_t readDataRecords(ipap_message * message, uint16_t templId);
 
+		/*! \short  find a field by eno and ftype through an index of fieldDefs
+			\returns NULL if the field is not defined.
+		*/
+		fieldDefItem_t * findIndexedField(fieldDefList_t *fieldDefs, int eno, int ftype);
+
+	private:
+
+		//! index of indexedDefs, built on the first lookup.
+		fieldDefKeyIndex_t fieldIndex;
+
+		fieldDefList_t *indexedDefs;
+
+		//! definitions in indexedDefs when it was indexed.
+		size_t indexedSize;
+
 };
 
 }
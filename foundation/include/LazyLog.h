@@ -0,0 +1,114 @@
+/*! \file   LazyLog.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Log lines whose text is only built when their level is printed.
+
+    $Id: LazyLog.h 748 2015-08-21 09:40:00Z amarentes $
+*/
+
+#ifndef _LAZY_LOG_H_
+#define _LAZY_LOG_H_
+
+#include "stdincpp.h"
+#include "Logger.h"
+#include "IpAp_message.h"
+
+
+namespace auction
+{
+
+//! verbosity from which the Logger prints each kind of line.
+typedef enum
+{
+	LAZY_LOG_ERROR = 0,
+	LAZY_LOG_WARNING,
+	LAZY_LOG_INFO,
+	LAZY_LOG_DEBUG
+
+} lazyLogLevel_t;
+
+
+/*! \short   builds the text of a log line on demand
+
+    Subclasses keep references to what they describe, so a formatter
+    lives only as long as the LazyLog::log() call it is given to.
+*/
+class LogFormatter
+{
+  public:
+
+	virtual ~LogFormatter() {}
+
+	//! return the text to log
+	virtual string format() const = 0;
+};
+
+
+/*! \short   XML text of an IPAP message
+
+    It walks every record of the message, which is why it only runs for
+    lines that are printed.
+*/
+class IpApXmlFormatter : public LogFormatter
+{
+  private:
+
+	ipap_message &message;
+
+  public:
+
+	IpApXmlFormatter(ipap_message &_message) : message(_message) {}
+
+	virtual string format() const;
+};
+
+
+/*! \short   log lines evaluated only when their level is enabled
+
+    The Logger formats its arguments before it filters by level, so a line
+    whose argument is expensive to produce pays for it even when it is not
+    printed. LazyLog asks the Logger for its verbosity and calls the
+    formatter only when the line would be printed.
+*/
+class LazyLog
+{
+  public:
+
+	//! return true if the logger prints lines of the level.
+	static inline bool isEnabled(Logger *log, lazyLogLevel_t lvl)
+	{
+		return (log->getLogLevel() >= (int) lvl);
+	}
+
+	/*! \short  log a line whose text comes from a formatter
+		\arg \c log - logger to write to
+		\arg \c ch - channel of the caller
+		\arg \c lvl - level of the line, picks log, dlog, wlog or elog
+		\arg \c f - formatter, not called if the level is filtered
+		\arg \c prefix - text printed before the formatted one
+	*/
+	static void log(Logger *log, int ch, lazyLogLevel_t lvl, const LogFormatter &f,
+					const char *prefix = "");
+};
+
+} // namespace auction
+
+#endif // _LAZY_LOG_H_
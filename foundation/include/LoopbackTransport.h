@@ -0,0 +1,86 @@
+/*! \file   LoopbackTransport.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    In process transport joining an agent and an auction manager.
+
+    $Id: LoopbackTransport.h 748 2015-08-23 16:05:00Z amarentes $
+*/
+
+#ifndef _LOOPBACK_TRANSPORT_H_
+#define _LOOPBACK_TRANSPORT_H_
+
+#include "stdincpp.h"
+#include "Threads.h"
+#include "AnslpEventTransport.h"
+
+
+namespace auction
+{
+
+class LoopbackTransport;
+
+//! ends joined by each loopback channel, two at most.
+typedef map<string, vector<LoopbackTransport *> >				loopbackChannelList_t;
+typedef map<string, vector<LoopbackTransport *> >::iterator	loopbackChannelListIter_t;
+
+
+/*! \short   transport between two ends in the same process
+
+    Each end is built with the queue its AnslpProcessor reads and the name
+    of a channel; the two ends of a channel put their events straight into
+    the queue of the other end. No message is encoded. Both ends must run
+    in one process, an agent and an auction manager started as separate
+    daemons are joined by SocketTransport instead.
+*/
+class LoopbackTransport : public AnslpEventTransport
+{
+  private:
+
+	//! name of the channel joining the two ends.
+	string channel;
+
+	static loopbackChannelList_t channels;
+
+	static mutex_t channelsLock;
+
+	//! the other end of the channel, NULL if it is not up yet.
+	LoopbackTransport *getPeer();
+
+  protected:
+
+	virtual void deliver(anslp::AnslpEvent *evt);
+
+  public:
+
+	/*! \short  join a channel
+		\arg \c _channel - name shared with the other end
+		\arg \c _queue - queue of the AnslpProcessor of this end
+		\throws Error if the channel already has its two ends.
+	*/
+	LoopbackTransport(string _channel, anslp::FastQueue *_queue);
+
+	//! leave the channel
+	virtual ~LoopbackTransport();
+};
+
+} // namespace auction
+
+#endif // _LOOPBACK_TRANSPORT_H_
@@ -41,6 +41,14 @@
 namespace auction
 {
 
+//! bidding objects going in the same messages, along with their auctions.
+typedef vector<pair<BiddingObject *, Auction *> >				biddingObjectBatch_t;
+typedef vector<pair<BiddingObject *, Auction *> >::iterator		biddingObjectBatchIter_t;
+
+//! auctions a message refers to, by set and name.
+typedef set<pair<string, string> >								auctionKeyList_t;
+typedef set<pair<string, string> >::iterator					auctionKeyListIter_t;
+
 //! parser for API text BiddingObject syntax
 
 class MAPIBiddingObjectParser : public IpApMessageParser, public anslp::msg::anslp_ipap_message_splitter
@@ -75,11 +83,13 @@ class MAPIBiddingObjectParser : public IpApMessageParser, public anslp::msg::ans
 	
 	ipap_template * findTemplate(ipap_template_container *templatesOut, uint16_t templId);
 		   				  
+	//! add the bidding object to message, templates in peerTemplates are left out.
 	void get_ipap_message( fieldDefList_t *fieldDefs, 
 						   BiddingObject *biddingObjectPtr, 
 						   Auction *auctionPtr, 
 						   ipap_template_container *templates, 
-						   ipap_message *message);
+						   ipap_message *message,
+						   const set<uint16_t> *peerTemplates = NULL);
 
 	void parseAuctionKey( fieldDefList_t *fields, fieldValList_t *fieldVals,
 						  const anslp::msg::xml_object_key &key,
@@ -104,6 +114,26 @@ class MAPIBiddingObjectParser : public IpApMessageParser, public anslp::msg::ans
 									Auction *auction, 
 									ipap_template_container *templates );
 
+	/*! \short get the messages carrying the bidding objects of the batch, 
+		
+		each one with as many objects as fit in maxRecords data records, an
+		object with more goes alone. Templates shared by the objects of a 
+		message are included once, those in peerTemplates are not included,
+		the receiver already holds them.
+	*/
+	vector<ipap_message *> get_ipap_messages(fieldDefList_t *fieldDefs, 
+											 biddingObjectBatch_t *batch,
+											 ipap_template_container *templates,
+											 unsigned int maxRecords,
+											 const set<uint16_t> *peerTemplates = NULL );
+
+	/*! \short get the auctions the data records of a message refer to
+
+		only the auction field of each record is read, so it is cheap
+		enough to run before deciding whether to parse the message.
+	*/
+	void getAuctionKeys(ipap_message *message, auctionKeyList_t &auctions);
+
 };
 
 } // namespace auction
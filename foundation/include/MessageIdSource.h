@@ -64,6 +64,9 @@ class MessageIdSource
 
 	void setNewId(uint32_t val) {num = val;}
 
+	//! return the last id given
+	uint32_t getId() { return num; }
+
     /*! \short   generate a new internal id number
 
         return a new Id value that is currently not in use. This value will be
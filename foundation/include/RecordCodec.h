@@ -0,0 +1,178 @@
+/*! \file   RecordCodec.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Little endian encoding of the records kept in local files.
+
+    $Id: RecordCodec.h 748 2015-08-17 09:20:00Z amarentes $
+*/
+
+#ifndef _RECORD_CODEC_H_
+#define _RECORD_CODEC_H_
+
+#include "stdincpp.h"
+
+
+namespace auction
+{
+
+//! crc32 (IEEE 802.3) of the buffer
+uint32_t recordCrc32(const char *buf, size_t len);
+
+
+inline void putU32(string &out, uint32_t value)
+{
+	char b[4];
+	b[0] = value & 0xFF;
+	b[1] = (value >> 8) & 0xFF;
+	b[2] = (value >> 16) & 0xFF;
+	b[3] = (value >> 24) & 0xFF;
+	out.append(b, 4);
+}
+
+inline uint32_t getU32(const char *b)
+{
+	return ((uint32_t) (unsigned char) b[0]) |
+		   ((uint32_t) (unsigned char) b[1] << 8) |
+		   ((uint32_t) (unsigned char) b[2] << 16) |
+		   ((uint32_t) (unsigned char) b[3] << 24);
+}
+
+inline void putU64(string &out, uint64_t value)
+{
+	putU32(out, (uint32_t) (value & 0xFFFFFFFFU));
+	putU32(out, (uint32_t) (value >> 32));
+}
+
+inline uint64_t getU64(const char *b)
+{
+	return ((uint64_t) getU32(b + 4) << 32) | getU32(b);
+}
+
+inline void putDouble(string &out, double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	putU64(out, bits);
+}
+
+inline void putString(string &out, const string &value)
+{
+	putU32(out, value.size());
+	out.append(value);
+}
+
+inline void putStrings(string &out, const vector<string> &values)
+{
+	putU32(out, values.size());
+	for (vector<string>::const_iterator iter = values.begin(); iter != values.end(); ++iter) {
+		putString(out, *iter);
+	}
+}
+
+
+/*! \short   cursor over an encoded buffer
+
+    Every read checks the bounds and returns false when the buffer is too
+    short, so damaged input is rejected instead of read past its end. The
+    buffer is not copied, it can be a string or a mapped file.
+*/
+struct recordReader
+{
+	const char *data;
+	size_t size;
+	size_t pos;
+
+	recordReader(const char *d, size_t s) : data(d), size(s), pos(0) { }
+
+	recordReader(const string &d) : data(d.data()), size(d.size()), pos(0) { }
+
+	inline bool atEnd() { return pos == size; }
+
+	bool u8(uint8_t &value)
+	{
+		if (size - pos < 1) {
+			return false;
+		}
+		value = (uint8_t) data[pos];
+		pos += 1;
+		return true;
+	}
+
+	bool u32(uint32_t &value)
+	{
+		if (size - pos < 4) {
+			return false;
+		}
+		value = getU32(data + pos);
+		pos += 4;
+		return true;
+	}
+
+	bool u64(uint64_t &value)
+	{
+		if (size - pos < 8) {
+			return false;
+		}
+		value = getU64(data + pos);
+		pos += 8;
+		return true;
+	}
+
+	bool dbl(double &value)
+	{
+		uint64_t bits;
+		if (!u64(bits)) {
+			return false;
+		}
+		memcpy(&value, &bits, sizeof(value));
+		return true;
+	}
+
+	bool str(string &value)
+	{
+		uint32_t len;
+		if (!u32(len) || (size - pos < len)) {
+			return false;
+		}
+		value.assign(data + pos, len);
+		pos += len;
+		return true;
+	}
+
+	bool strings(vector<string> &values)
+	{
+		uint32_t n;
+		if (!u32(n)) {
+			return false;
+		}
+		for (uint32_t i = 0; i < n; i++) {
+			values.push_back(string());
+			if (!str(values.back())) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+} // namespace auction
+
+#endif // _RECORD_CODEC_H_
@@ -54,6 +54,27 @@ typedef map<uint32_t, ipap_message> 					pendingMessageList_t;
 typedef map<uint32_t, ipap_message>::iterator 			pendingMessageListIter_t;
 typedef map<uint32_t, ipap_message>::const_iterator 	pendingMessageListConstIter_t;
 
+//! retransmission state of a pending message
+typedef struct
+{
+	//! when it is sent again if not confirmed
+	struct timeval due;
+	
+	//! ms from the last transmission to due, doubled on every retransmission
+	unsigned long timeout;
+	
+	//! retransmissions done
+	unsigned int retries;
+	
+} retransmitState_t;
+
+typedef map<uint32_t, retransmitState_t> 				retransmitList_t;
+typedef map<uint32_t, retransmitState_t>::iterator 		retransmitListIter_t;
+
+//! templates carried by the pending messages, by message id
+typedef map<uint32_t, set<uint16_t> > 					templateInFlightList_t;
+typedef map<uint32_t, set<uint16_t> >::iterator 		templateInFlightListIter_t;
+
 
 class Session
 {
@@ -143,6 +164,12 @@ public:
 	uint32_t getLifetime();
 	
 	uint32_t getNextMessageId();
+
+	//! return the last message sequence number given
+	uint32_t getLastMessageId() { return mId.getId(); }
+
+	//! continue the message sequence numbers after id, used when resuming the session
+	void setLastMessageId(uint32_t id) { mId.setNewId(id); }
 	
 	//! Set a-nslp application sessionId 
 	void setAnlspSession(string _sid);	
@@ -151,15 +178,117 @@ public:
 		
 	//! Confirm the response of the message with id mid.
 	void confirmMessage(uint32_t mid);
+
+	/*! \short  confirm the messages up to mid, for cumulative acknowledgements
+		\returns the number of pending messages confirmed
+	*/
+	unsigned int confirmMessages(uint32_t mid);
+
+	/*! \short  start the sequence of messages received from the peer
 	
-	//! add to the list of pensing message a new entry.
-	void addPendingMessage(ipap_message mes);
+		every message up to seqNo counts as received, it is the one that
+		set up the session or the last one received before a restart. 
+		The sequence never goes back.
+	*/
+	void startReceiving(uint32_t seqNo);
+
+	/*! \short  record a message received from the peer, to acknowledge it
+	
+		advances the last contiguous number received. If the sequence was
+		not started, the first message received starts it. The 
+		acknowledgement becomes pending even for duplicates, their ack may
+		have been lost.
+	*/
+	void messageReceived(uint32_t seqNo);
+
+	//! true if the message was already received
+	bool wasReceived(uint32_t seqNo);
+
+	//! last message received with all the previous ones received too.
+	inline uint32_t getLastReceived() { return lastReceived; }
+
+	/*! \short  take the pending cumulative acknowledgement
+		\arg \c ackSeqNo - receives the number to put as ack, the last 
+						   contiguous message received + 1
+		\returns false if there is nothing to acknowledge
+	*/
+	bool takeAck(uint32_t &ackSeqNo);
+
+	//! true while an acknowledgement timer of the session is scheduled
+	inline bool isAckArmed() { return ackArmed; }
+
+	inline void setAckArmed(bool armed) { ackArmed = armed; }
+	
+	/*! \short  add to the list of pending message a new entry.
+	
+		when the maximum pending is reached the oldest messages are
+		dropped to make room, whether retransmissions are enabled or not.
+	*/
+	void addPendingMessage(const ipap_message &mes);
 	
 	pendingMessageListIter_t beginMessages() { return pendingMessages.begin(); }		
 	
 	pendingMessageListIter_t endMessages() { return pendingMessages.end(); }		
+
+	inline size_t getNumPendingMessages() { return pendingMessages.size(); }
+
+	/*! \short  retransmit the pending messages not confirmed in time
+		\arg \c timeout - ms before the first retransmission, 0 disables them
+		\arg \c maxTimeout - limit of the timeout while it doubles
+		\arg \c retries - retransmissions before a message expires
+		\arg \c maxPending - pending messages kept, 0 for no limit
+	*/
+	void setRetransmission(unsigned long timeout, unsigned long maxTimeout, 
+						   unsigned int retries, unsigned int maxPending);
+
+	/*! \short  collect the pending messages due at now
+	
+		due messages get their timeout doubled and are returned to be sent
+		again. Messages out of retries are expired and removed.
+		\arg \c due - receives the messages to send, valid until the
+					  pending messages change
+		\arg \c expired - receives the ids of the messages removed
+	*/
+	void getRetransmissions(struct timeval now, vector<ipap_message *> &due, 
+							vector<uint32_t> &expired);
+
+	/*! \short  time of the next retransmission
+		\returns false if there is nothing to retransmit
+	*/
+	bool getNextRetransmission(struct timeval &when);
+
+	//! true while a retransmission timer of the session is scheduled
+	inline bool isRetransmitArmed() { return retransmitArmed; }
+
+	inline void setRetransmitArmed(bool armed) { retransmitArmed = armed; }
+
+	/*! \short  record the templates a pending message carries
+	
+		once the message is confirmed the peer holds them, and later 
+		messages may refer to them without carrying them again.
+	*/
+	void addSentTemplates(uint32_t mid, const list<int> &templIds);
+
+	//! templates the peer confirmed to hold
+	inline const set<uint16_t> &getPeerTemplates() { return peerTemplates; }
+
+	//! forget the templates of the peer, the next messages carry them again
+	void resetPeerTemplates();
+
+	//! count a bidding message of the peer, admitted or rejected
+	void countAdmission(bool admitted);
+
+	inline unsigned long getAdmittedMessages() { return admittedMessages; }
+
+	inline unsigned long getRejectedMessages() { return rejectedMessages; }
 		
 protected:
+
+	//! the templates carried by message mid reached the peer
+	void templatesConfirmed(uint32_t mid);
+
+	//! advance lastReceived over the messages received ahead that follow it
+	void closeReceivedGap();
 	
     //! unique internal sessionID for this Session instance (has to be provided)
     int uid;
@@ -175,6 +304,51 @@ protected:
 
 	//! List of messages pending for confirmation.
 	pendingMessageList_t pendingMessages;
+
+	//! retransmission state of the pending messages, empty if disabled.
+	retransmitList_t retransmits;
+
+	//! ms before the first retransmission, 0 if disabled.
+	unsigned long retransmitTimeout;
+
+	//! limit of the retransmission timeout.
+	unsigned long retransmitMaxTimeout;
+
+	//! retransmissions before a message expires.
+	unsigned int retransmitRetries;
+
+	//! pending messages kept, 0 for no limit.
+	unsigned int maxPendingMessages;
+
+	//! a retransmission timer is scheduled.
+	bool retransmitArmed;
+
+	//! some message was received, lastReceived is valid.
+	bool receivedAny;
+
+	//! last message received with all the previous ones received too.
+	uint32_t lastReceived;
+
+	//! messages received after a gap following lastReceived.
+	set<uint32_t> receivedAhead;
+
+	//! a message was received and not acknowledged yet.
+	bool ackPending;
+
+	//! an acknowledgement timer is scheduled.
+	bool ackArmed;
+
+	//! templates the peer holds.
+	set<uint16_t> peerTemplates;
+
+	//! templates sent in messages not confirmed yet.
+	templateInFlightList_t templatesInFlight;
+
+	//! bidding messages of the peer admitted.
+	unsigned long admittedMessages;
+
+	//! bidding messages of the peer rejected for going over the rate.
+	unsigned long rejectedMessages;
 		  
 	//! sender host address.
 	protlib::hostaddress sender_addr;
@@ -34,7 +34,8 @@
 #include "Logger.h"
 #include "Error.h"
 #include "Session.h"
-#include "IdSource.h"
+#include "WideIdSource.h"
+#include "AuctioningObjectIndex.h"
 #include "EventScheduler.h"
 
 namespace auction
@@ -43,6 +44,10 @@ namespace auction
 typedef vector<Session *>						sessionDB_t;
 typedef vector<Session *>::iterator				sessionDBIter_t;
 
+//! hash index by uid to sessions, uids are unique so they are sparse
+typedef UIdIndex<Session *>						sessionUIdIndex_t;
+typedef UIdIndex<Session *>::iterator				sessionUIdIndexIter_t;
+
 typedef map<string, int>             				sessionIndex_t;
 typedef map<string, int>::iterator    				sessionIndexIter_t;
 
@@ -71,8 +76,8 @@ class SessionManager
     //!< number of sessions in the database
     int sessions;
 
-	//! session database.
-	sessionDB_t sessionDB;
+	//! session database, by uid.
+	sessionUIdIndex_t sessionDB;
 	
 	//! index by sessioId
 	sessionIndex_t sessionIndex;
@@ -83,8 +88,8 @@ class SessionManager
     //! list with sessions done
     sessionDone_t sessionsDone;
 
-    //! pool of unique sessions ids
-    IdSource idSource;
+    //! pool of unique sessions ids up to MANAGER_MAX_UID, events refer to sessions by uid.
+    WideIdSource idSource;
 
     /*! 
 	  \short add the session name to the list of finished sessions
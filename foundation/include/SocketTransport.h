@@ -0,0 +1,109 @@
+/*! \file   SocketTransport.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Unix socket transport joining an agent and an auction manager.
+
+    $Id: SocketTransport.h 748 2015-08-23 16:05:00Z amarentes $
+*/
+
+#ifndef _SOCKET_TRANSPORT_H_
+#define _SOCKET_TRANSPORT_H_
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "stdincpp.h"
+#include "Threads.h"
+#include "RecordCodec.h"
+#include "AnslpEventTransport.h"
+
+
+namespace auction
+{
+
+/*! \short   transport between two daemons on the same host
+
+    Each end binds a Unix datagram socket and sends to the socket of the
+    peer, so an agent and an auction manager started as separate daemons
+    talk without the a-nslp daemon. Events go one per datagram with the
+    ipap messages in the binary encoding of the wire, and a thread of each
+    end decodes what arrives into the queue of its AnslpProcessor. Built
+    without threads the main loop polls the socket and calls receive().
+*/
+class SocketTransport : public AnslpEventTransport
+{
+  private:
+
+	//! path of the socket of this end, removed when the end goes away.
+	string localPath;
+
+	//! path of the socket of the peer.
+	string peerPath;
+
+	int fd;
+
+	struct sockaddr_un peerAddr;
+
+#ifdef ENABLE_THREADS
+	thread_t thread;
+#endif
+
+	static void *thread_func(void *arg);
+
+	//! receive the events of the peer until the end goes away
+	void main();
+
+	//! encode an event for the peer
+	void encodeEvent(anslp::AnslpEvent *evt, string &out);
+
+	//! build the event encoded by the peer, NULL if it is damaged
+	anslp::AnslpEvent *decodeEvent(recordReader &in);
+
+	//! decode a datagram of the peer into the queue
+	void handleDatagram(const char *data, size_t len);
+
+  protected:
+
+	virtual void deliver(anslp::AnslpEvent *evt);
+
+  public:
+
+	/*! \short  bind the socket of this end
+		\arg \c _localPath - socket of this end, replaced if it exists
+		\arg \c _peerPath - socket of the peer, which can come up later
+		\arg \c _queue - queue of the AnslpProcessor of this end
+		\throws Error if the socket or its thread can not be set up.
+	*/
+	SocketTransport(string _localPath, string _peerPath, anslp::FastQueue *_queue);
+
+	//! stop the receiving thread and remove the socket
+	virtual ~SocketTransport();
+
+	//! socket the main loop has to poll, -1 when a thread receives
+	int getPollFd();
+
+	//! decode the datagrams waiting in the socket, does not wait
+	void receive();
+};
+
+} // namespace auction
+
+#endif // _SOCKET_TRANSPORT_H_
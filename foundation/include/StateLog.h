@@ -0,0 +1,261 @@
+/*! \file   StateLog.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Write ahead log of the auction manager state changes since the last
+    snapshot.
+
+    $Id: StateLog.h 748 2015-08-18 10:05:00Z amarentes $
+*/
+
+#ifndef _STATE_LOG_H_
+#define _STATE_LOG_H_
+
+#include "stdincpp.h"
+#include "Logger.h"
+#include "Error.h"
+#include "Threads.h"
+#include "RecordCodec.h"
+#include "StateSnapshot.h"
+
+
+namespace auction
+{
+
+//! first bytes of a state log file
+const char STATELOG_MAGIC[4] = { 'A', 'U', 'M', 'W' };
+
+//! format version written after the magic
+const uint32_t STATELOG_VERSION = 3;
+
+//! size of the file header: magic, version and base sequence
+const size_t STATELOG_HEADER_LEN = 16;
+
+//! size of the entry header: payload length + crc32 of the payload
+const size_t STATELOG_ENTRY_HEADER_LEN = 8;
+
+//! largest payload accepted when reading, protects against garbage lengths.
+const uint32_t STATELOG_MAX_ENTRY_LEN = 16 * 1024 * 1024;
+
+
+//! kind of state change, first byte of the payload.
+typedef enum
+{
+	STATELOG_END = 0,					//!< no more entries
+	STATELOG_AUCTIONS_ADDED,			//!< message
+	STATELOG_AUCTION_REMOVED,			//!< set, name
+	STATELOG_BIDDING_OBJECTS_ADDED,		//!< sessionId, messageId, message
+	STATELOG_BIDDING_OBJECT_REMOVED,	//!< set, name
+	STATELOG_SESSION_CREATED,			//!< session
+	STATELOG_SESSION_REMOVED,			//!< sessionId
+	STATELOG_MESSAGE_SENT,				//!< sessionId, messageId, message
+	STATELOG_MESSAGE_CONFIRMED,			//!< sessionId, messageId
+	STATELOG_MESSAGE_EXPIRED,			//!< sessionId, messageId
+	STATELOG_MESSAGES_CONFIRMED			//!< sessionId, messageId, every one up to it
+} stateLogEntryType_t;
+
+/*! \short  one state change
+
+    Only the fields listed for the type are encoded. Messages are in the
+    same wire form as in the snapshot.
+*/
+typedef struct
+{
+	stateLogEntryType_t type;
+	uint64_t sequence;
+	string sessionId;
+	string set;
+	string name;
+	uint32_t messageId;
+	string message;
+	sessionStateRecord_t session;
+
+} stateLogEntry_t;
+
+
+/*! \short   write ahead log of state changes
+
+    The file header holds the magic, the version and the base sequence,
+    the sequence of the last entry already included in a snapshot. It is
+    followed by entries: the payload length and its crc32, both 32 bit
+    little endian, and the payload (type, sequence and fields).
+
+    append() only encodes the entry into a buffer. flush() writes the
+    buffer with one write call, so a crash of the process loses nothing
+    flushed, and fdatasync's it once syncInterval milliseconds passed
+    since the last sync, which bounds what a crash of the host can lose.
+    getNextSync() tells when the entries written but not synced are
+    due, so the owner can sync them without waiting for more entries.
+
+    Once a snapshot including every entry up to a sequence is saved,
+    compact() records that sequence in the header and truncates the
+    file. On open, a damaged entry at the end, left by a crash in the
+    middle of a write, is cut off so new entries stay readable.
+*/
+class StateLog
+{
+  private:
+
+	Logger *log;
+	int ch;
+
+	string fileName;
+	int fd;
+
+	//! entries encoded but not written yet.
+	string buffer;
+
+	unsigned int syncInterval;	//!< ms
+
+	//! sequence included in the last snapshot
+	uint64_t baseSequence;
+
+	//! sequence of the last entry appended
+	uint64_t sequence;
+
+	//! size of the file, without the buffer
+	unsigned long size;
+
+	//! bytes written since the last sync.
+	unsigned long pending;
+
+	struct timeval lastSync;
+
+	unsigned long appended;
+	unsigned long syncs;
+
+	int threaded;
+#ifdef ENABLE_THREADS
+	mutex_t maccess;
+#endif
+
+	//! write the buffer, called with the lock held.
+	void doFlush(bool forceSync);
+
+	//! write the file header
+	void writeHeader();
+
+  public:
+
+	/*! \short  open the log for appending, creating it if needed.
+		\throws Error if it can not be opened or is not a state log.
+	*/
+	StateLog(string fileName, unsigned int syncInterval);
+
+	//! sync and close the log.
+	~StateLog();
+
+	//! add an entry, it gets the next sequence number.
+	void append(stateLogEntry_t &entry);
+
+	//! write the entries appended, fdatasync if the interval passed.
+	void flush();
+
+	//! write and fdatasync every entry appended.
+	void sync();
+
+	/*! \short  time the entries written but not synced are due for sync
+		\returns false if every entry is synced
+	*/
+	bool getNextSync(struct timeval &when);
+
+	/*! \short  drop the entries included in a snapshot
+		\arg \c upTo  sequence saved in the snapshot
+	*/
+	void compact(uint64_t upTo);
+
+	inline string getFileName() { return fileName; }
+
+	//! return the sequence of the last entry appended
+	uint64_t getSequence();
+
+	//! return the sequence the log starts after
+	uint64_t getBaseSequence();
+
+	//! return the size of the file, including entries not written yet
+	unsigned long getSize();
+
+	//! return the number of entries appended since the log was opened
+	unsigned long getNumAppended();
+
+	//! return the number of fdatasync calls
+	unsigned long getNumSyncs();
+
+	//! encode the entry as a payload
+	static void encode(const stateLogEntry_t &entry, string &payload);
+
+	/*! \short  decode an entry payload
+		\returns false if the payload is not a valid entry.
+	*/
+	static bool decode(const string &payload, stateLogEntry_t &entry);
+};
+
+
+/*! \short   sequential reader of a state log file
+
+    next() returns the entries in the order they were appended. It stops
+    at the end of the file or at the first entry that is incomplete or
+    fails its checksum; isCorrupt() tells which case it was.
+*/
+class StateLogReader
+{
+  private:
+
+	ifstream in;
+	string fileName;
+
+	uint64_t baseSequence;
+
+	//! offset of the next entry
+	unsigned long offset;
+
+	unsigned long entries;
+	bool corrupt;
+
+  public:
+
+	/*! \short  open the log for reading
+		\throws Error if it can not be opened or is not a state log.
+	*/
+	StateLogReader(string fileName);
+
+	~StateLogReader();
+
+	/*! \short  read the next entry
+		\returns false when there are no more.
+	*/
+	bool next(stateLogEntry_t &entry);
+
+	//! return the sequence of the last entry included in a snapshot
+	inline uint64_t getBaseSequence() { return baseSequence; }
+
+	//! return true if reading stopped at a damaged entry
+	inline bool isCorrupt() { return corrupt; }
+
+	//! return the offset of the next entry, or of the damaged one.
+	inline unsigned long getOffset() { return offset; }
+
+	//! return the number of entries read
+	inline unsigned long getNumEntries() { return entries; }
+};
+
+} // namespace auction
+
+#endif // _STATE_LOG_H_
@@ -0,0 +1,151 @@
+/*! \file   StateSnapshot.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Snapshot of the auction manager state used for warm restarts.
+
+    $Id: StateSnapshot.h 748 2015-08-17 09:20:00Z amarentes $
+*/
+
+#ifndef _STATE_SNAPSHOT_H_
+#define _STATE_SNAPSHOT_H_
+
+#include "stdincpp.h"
+#include "Error.h"
+#include "RecordCodec.h"
+
+
+namespace auction
+{
+
+//! first bytes of a snapshot file
+const char SNAPSHOT_MAGIC[4] = { 'A', 'U', 'M', 'S' };
+
+//! format version written after the magic
+const uint32_t SNAPSHOT_VERSION = 5;
+
+//! magic, version, creation time, payload length and payload crc32
+const size_t SNAPSHOT_HEADER_LEN = 28;
+
+
+//! message waiting for the agent's confirmation (sequence number, message).
+typedef vector< pair<uint32_t, string> >					pendingMessageRecordList_t;
+typedef vector< pair<uint32_t, string> >::const_iterator	pendingMessageRecordListConstIter_t;
+
+/*! \short  a session, with what is needed to resume it.
+
+    Messages are kept in the binary form the a-nslp daemon puts on the
+    wire (encodeIpApMessage), which keeps the template ids the agents
+    already know and decodes without going through xml.
+*/
+typedef struct
+{
+	string sessionId;
+	string anslpSessionId;
+	uint32_t state;
+	string senderAddress;
+	string receiverAddress;
+	string sourceAddress;
+	uint16_t senderPort;
+	uint16_t receiverPort;
+	uint8_t protocol;
+	uint32_t lifetime;
+	uint32_t lastMessageId;		//!< last sequence number given
+	uint32_t lastReceived;		//!< last sequence number of the agent received in order
+	vector<string> auctions;	//!< auctions referenced, as set.name
+	pendingMessageRecordList_t pendingMessages;
+
+} sessionStateRecord_t;
+
+typedef vector<sessionStateRecord_t>					sessionStateRecordList_t;
+typedef vector<sessionStateRecord_t>::const_iterator	sessionStateRecordListConstIter_t;
+
+//! an active bidding object and the session it came from.
+typedef struct
+{
+	string sessionId;
+	string message;
+
+} biddingObjectStateRecord_t;
+
+typedef vector<biddingObjectStateRecord_t>					biddingObjectStateRecordList_t;
+typedef vector<biddingObjectStateRecord_t>::const_iterator	biddingObjectStateRecordListConstIter_t;
+
+//! everything saved in a snapshot.
+typedef struct
+{
+	time_t created;
+	uint64_t logSequence;	//!< last state log entry included
+	string auctions;		//!< message with the auctions and their templates
+	string auctionFile;		//!< auction file loaded at start, empty if none
+	time_t auctionFileTime;	//!< modification time of the auction file
+	sessionStateRecordList_t sessions;
+	biddingObjectStateRecordList_t biddingObjects;
+
+} stateSnapshot_t;
+
+
+/*! \short   versioned snapshot file of the auction manager state
+
+    The file is a fixed header (magic, version, creation time, payload
+    length and crc32) followed by the payload: the sequence of the last
+    StateLog entry it includes, the auctions message, the sessions and
+    the bidding objects, encoded with RecordCodec. The auction file the
+    auctions came from and its modification time are kept as well, so an
+    edited file is loaded instead of the snapshot. write()
+    builds the file next to the target and renames it over, so a crash
+    leaves either the previous snapshot or the new one. read() maps the
+    file and decodes it in place without reading it through a buffer.
+*/
+class StateSnapshot
+{
+  public:
+
+	/*! \short  save the snapshot in fileName, replacing the previous one.
+		\throws Error if the file can not be written.
+	*/
+	static void write(string fileName, const stateSnapshot_t &snapshot);
+
+	/*! \short  load the snapshot saved in fileName.
+		\returns false if there is no snapshot.
+		\throws Error if the file is damaged or from another version.
+	*/
+	static bool read(string fileName, stateSnapshot_t &snapshot);
+
+	//! encode the snapshot payload
+	static void encode(const stateSnapshot_t &snapshot, string &payload);
+
+	/*! \short  decode a snapshot payload
+		\returns false if the payload is not a valid snapshot.
+	*/
+	static bool decode(const char *payload, size_t len, stateSnapshot_t &snapshot);
+
+	//! encode a session record, the state log uses it as well
+	static void encode(const sessionStateRecord_t &session, string &out);
+
+	/*! \short  decode a session record
+		\returns false if the buffer does not hold a valid session.
+	*/
+	static bool decode(recordReader &r, sessionStateRecord_t &session);
+};
+
+} // namespace auction
+
+#endif // _STATE_SNAPSHOT_H_
@@ -0,0 +1,235 @@
+/*! \file   StringTable.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Interning table for the set, name and session strings repeated by
+    every auctioning object.
+
+    $Id: StringTable.h 748 2015-07-23 15:30:00Z amarentes $
+*/
+
+#ifndef _STRING_TABLE_H_
+#define _STRING_TABLE_H_
+
+#include "stdincpp.h"
+#include "Threads.h"
+
+
+namespace auction
+{
+
+/*! \short  hash of a string
+
+    FNV-1a. Zero is never returned, so callers can use it to mark a hash
+    not computed yet.
+*/
+inline uint32_t hashString(const string &value)
+{
+	uint32_t h = 2166136261U;
+
+	for (string::size_type i = 0; i < value.size(); i++) {
+		h = (h ^ (unsigned char) value[i]) * 16777619U;
+	}
+
+	return (h == 0) ? 1 : h;
+}
+
+//! one interned string, shared by all the handles to the same value.
+typedef struct
+{
+	string value;
+	uint32_t hash;			//!< hashString(value)
+	volatile int refs;		//!< number of handles alive
+
+} internEntry_t;
+
+typedef map<string, internEntry_t *>            	internEntryList_t;
+typedef map<string, internEntry_t *>::iterator  	internEntryListIter_t;
+
+
+/*! \short   table of interned strings
+
+    Every distinct value is stored once. Lookups go through the table lock,
+    handles count their references atomically. Entries no longer referenced
+    are removed by collect().
+*/
+class StringTable
+{
+  private:
+
+    //! link to the globally available StringTable instance
+    static StringTable *s_instance;
+
+	internEntryList_t entries;
+
+	//! entry for the empty string, never removed.
+	internEntry_t *emptyEntry;
+
+	//! number of entries left by the last collection.
+	size_t collectedSize;
+
+	//! remove the entries not referenced, the lock must be held.
+	unsigned int doCollect();
+
+    int threaded;
+
+#ifdef ENABLE_THREADS
+    mutex_t maccess;  //!< mutex semaphore for thread safety blocking
+#endif
+
+	StringTable();
+
+  public:
+
+	~StringTable();
+
+    //! get access to the one and only StringTable instance
+    static StringTable *getInstance();
+
+	/*! \short  get the entry for the value, creating it if needed.
+
+		the reference count of the entry returned is already incremented.
+	*/
+	internEntry_t *intern(const string &value);
+
+	/*! \short  get the entry for the value, NULL if it is not interned.
+
+		the reference count of the entry returned is already incremented.
+	*/
+	internEntry_t *find(const string &value);
+
+	//! get the entry of the empty string, its reference count is incremented.
+	internEntry_t *getEmpty();
+
+	//! remove the entries not referenced, returns the number removed.
+	unsigned int collect();
+
+	/*! \short  collect once the table doubled since the last collection
+
+		every call walks the table, this keeps the cost amortized O(1)
+		per string interned, so it can be called after each batch of
+		objects is removed.
+	*/
+	unsigned int collectGrown();
+
+	//! return the number of distinct strings in the table
+	unsigned int size();
+};
+
+
+/*! \short   immutable handle to an interned string
+
+    Copying a handle does not copy the string. Two handles are equal if and
+    only if they point to the same entry, so comparisons are one pointer
+    compare. The hash of the value is precomputed.
+*/
+class InternedString
+{
+  private:
+
+	internEntry_t *entry;
+
+	inline void acquire() { __sync_fetch_and_add(&(entry->refs), 1); }
+
+	inline void release() { __sync_fetch_and_sub(&(entry->refs), 1); }
+
+	//! take over an entry whose reference count is already incremented
+	InternedString(internEntry_t *_entry) : entry(_entry) { }
+
+  public:
+
+	InternedString() : entry(StringTable::getInstance()->getEmpty()) { }
+
+	InternedString(const string &value)
+		: entry(StringTable::getInstance()->intern(value)) { }
+
+	InternedString(const char *value)
+		: entry(StringTable::getInstance()->intern(string(value))) { }
+
+	InternedString(const InternedString &rhs) : entry(rhs.entry) { acquire(); }
+
+	~InternedString() { release(); }
+
+	InternedString &operator=(const InternedString &rhs)
+	{
+		if (entry != rhs.entry) {
+			release();
+			entry = rhs.entry;
+			acquire();
+		}
+		return *this;
+	}
+
+	/*! \short  get the handle of a value only if it is interned
+
+		lookups of keys never stored end here, without adding the value
+		to the table.
+		\returns false if no handle holds the value.
+	*/
+	static bool find(const string &value, InternedString &handle)
+	{
+		internEntry_t *found = StringTable::getInstance()->find(value);
+		if (found == NULL) {
+			return false;
+		}
+		handle = InternedString(found);
+		return true;
+	}
+
+	inline const string &str() const { return entry->value; }
+
+	inline operator const string &() const { return entry->value; }
+
+	inline const char *c_str() const { return entry->value.c_str(); }
+
+	inline bool empty() const { return entry->value.empty(); }
+
+	inline uint32_t hash() const { return entry->hash; }
+
+	inline bool operator==(const InternedString &rhs) const { return entry == rhs.entry; }
+
+	inline bool operator!=(const InternedString &rhs) const { return entry != rhs.entry; }
+
+	//! orders by value, so containers keep the same order as with strings.
+	inline bool operator<(const InternedString &rhs) const
+	{
+		return (entry != rhs.entry) && (entry->value < rhs.entry->value);
+	}
+};
+
+//! overload for <<, so that an InternedString can be thrown into an iostream
+inline ostream& operator<< ( ostream &os, const InternedString &s )
+{
+	return os << s.str();
+}
+
+inline string operator+ ( const string &lhs, const InternedString &rhs )
+{
+	return lhs + rhs.str();
+}
+
+inline string operator+ ( const InternedString &lhs, const string &rhs )
+{
+	return lhs.str() + rhs;
+}
+
+} // namespace auction
+
+#endif // _STRING_TABLE_H_
@@ -101,6 +101,15 @@ class TemplateIdSource
     */
     void freeId( uint16_t id );
 
+    /*! \short   mark an id number as used
+
+        used for templates restored from a snapshot, whose ids the agents
+        already know; newId will not return it.
+
+        \arg \c id - id value in use
+    */
+    void reserveId( uint16_t id );
+
     //! dump a AllocationIdSource object
     void dump( ostream &os );
 
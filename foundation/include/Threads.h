@@ -65,6 +65,11 @@ inline int threadSetCancelType(int type, int *oldtype)
     return pthread_setcanceltype(type, oldtype);
 }
 
+inline int threadSetCancelState(int state, int *oldstate)
+{
+    return pthread_setcancelstate(state, oldstate);
+}
+
 // mutex functions
 
 inline int mutexInit(mutex_t *mutex)
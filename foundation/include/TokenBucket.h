@@ -0,0 +1,90 @@
+/*! \file   TokenBucket.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Token bucket limiting the rate of the bidding messages admitted.
+
+    $Id: TokenBucket.h 748 2015-08-22 10:20:00Z amarentes $
+*/
+
+#ifndef _TOKEN_BUCKET_H_
+#define _TOKEN_BUCKET_H_
+
+#include "stdincpp.h"
+
+
+namespace auction
+{
+
+/*! \short   token bucket, a rate with bursts
+
+    The bucket holds up to burst tokens and gains rate tokens per second;
+    every admitted message takes one. A bucket with a rate of 0 admits
+    everything. Time is given by the caller, so one clock reading serves
+    every bucket a message goes through.
+*/
+class TokenBucket
+{
+  private:
+
+	//! tokens gained per second, 0 for no limit.
+	double rate;
+
+	//! tokens the bucket holds at most.
+	double burst;
+
+	double tokens;
+
+	//! time tokens were last added, unset until the first message.
+	struct timeval last;
+
+	//! add the tokens gained up to now
+	void refill(struct timeval now);
+
+  public:
+
+	/*! \short  create a full bucket
+		\arg \c _rate - tokens per second, 0 for no limit
+		\arg \c _burst - tokens held at most, at least one
+	*/
+	TokenBucket(double _rate = 0, double _burst = 0);
+
+	//! change the rate and burst, the bucket starts full again
+	void setRate(double _rate, double _burst);
+
+	/*! \short  take n tokens
+		\returns false if there are not enough, nothing is taken.
+	*/
+	bool take(struct timeval now, double n = 1);
+
+	/*! \short  tell whether n tokens could be taken, without taking them
+	*/
+	bool isAvailable(struct timeval now, double n = 1);
+
+	inline bool isLimited() const { return (rate > 0); }
+
+	inline double getRate() const { return rate; }
+
+	inline double getBurst() const { return burst; }
+};
+
+} // namespace auction
+
+#endif // _TOKEN_BUCKET_H_
@@ -0,0 +1,149 @@
+/*! \file   WideIdSource.h
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    manage unique 32 bit numeric ids for an id space
+
+    $Id: WideIdSource.h 748 2015-07-23 52:09:00Z amarentes $
+*/
+
+#ifndef _WIDEIDSOURCE_H_
+#define _WIDEIDSOURCE_H_
+
+
+#include "stdincpp.h"
+#include "Error.h"
+
+
+namespace auction
+{
+
+//! largest id handed out by default, uids are kept in signed integers.
+const uint32_t WIDE_ID_MAX = 0x7FFFFFFF;
+
+/*! \short   generate unique 32 bit id numbers
+
+    Same contract as IdSource but for a 32 bit id space. Released ids are
+    kept in a stack and a bitmap records the ids in use, so newId and
+    freeId are both O(1). Releasing an id that is not in use is ignored.
+    If unique is set, ids are not recycled until the id space wraps around.
+
+    Above the bitmap every level has one bit per word of the level below,
+    set when that word is full. Once the ids wrap around, the next free id
+    is found by going up while the words are full and down again at the
+    first one that is not, in a few steps whatever the number of ids in use.
+*/
+
+class WideIdSource
+{
+  private:
+
+    //! next id to try when the free stack is empty
+    uint32_t num;
+
+    //! largest id that can be handed out
+    uint32_t maxId;
+
+    int unique;
+
+    //! number of ids currently in use (reserved ones included)
+    uint32_t used;
+
+    //! stack of previously freed (now unused) ids
+    vector<uint32_t> freeIds;
+
+    /*! one bit per id, set when the id is in use, then one level for every
+        32 times fewer bits, set when the word below is full. Levels grow with
+        the largest id seen, missing words are empty.
+    */
+    vector< vector<uint32_t> > usedMap;
+
+    //! return the word of the level, 0 if the level did not grow that far
+    inline uint32_t getWord(size_t level, uint64_t word)
+    {
+        return (word < usedMap[level].size()) ? usedMap[level][word] : 0;
+    }
+
+    //! mark the id as used, the levels above learn about words getting full
+    void setUsed(uint32_t id);
+
+    //! mark the id as free, the levels above learn about words not full anymore
+    void clearUsed(uint32_t id);
+
+    /*! \short  return the first position from pos on that is clear in the level
+
+        may return a position beyond the largest id.
+    */
+    uint64_t findClear(size_t level, uint64_t pos);
+
+    //! return the first id not in use from num on, wrapping around maxId.
+    uint32_t nextFreshId( void );
+
+  public:
+
+    /*! \short  construct and initialize a WideIdSource object
+        \arg \c unique - if set ids are not reused until wrapping around maxId
+        \arg \c maxId  - largest id to hand out
+    */
+    WideIdSource(int unique = 0, uint32_t maxId = WIDE_ID_MAX);
+
+    //! destroy a WideIdSource object
+    ~WideIdSource();
+
+    /*! \short   generate a new internal id number
+
+        return a new Id value that is currently not in use.
+        \throws Error if every id of the space is in use
+    */
+    uint32_t newId( void );
+
+    /*! \short   release an id number
+
+        The released id number can be reused (i.e. returned by newId) after
+        the call to freeId.
+
+        \arg \c id - id value that is to be released for future use
+    */
+    void freeId( uint32_t id );
+
+    //! mark the id as permanently used, it is never returned by newId
+    void reserveId( uint32_t id );
+
+    //! return true if the id is currently handed out or reserved
+    inline bool isUsed( uint32_t id )
+    {
+        return (getWord(0, id >> 5) & (1U << (id & 31))) != 0;
+    }
+
+    //! return the number of ids in use
+    inline uint32_t getNumUsed() { return used; }
+
+    //! dump a WideIdSource object
+    void dump( ostream &os );
+
+};
+
+
+//! overload for <<, so that a WideIdSource object can be thrown into an iostream
+ostream& operator<< ( ostream &os, WideIdSource &ris );
+
+} // namespace auction
+
+#endif // _WIDEIDSOURCE_H_
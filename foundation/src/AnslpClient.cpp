@@ -52,7 +52,7 @@ gistconf gconf;
 }
 
 AnslpClient::AnslpClient(string config_filename, anslp::FastQueue *installQueue): 
-starter(NULL), conf(NULL), anslpd(NULL)
+starter(NULL), conf(NULL), anslpd(NULL), transport(NULL)
 {
 	using namespace std;
 
@@ -122,6 +122,17 @@ starter(NULL), conf(NULL), anslpd(NULL)
 	
 }
 
+AnslpClient::AnslpClient(AnslpTransport *_transport): 
+starter(NULL), conf(NULL), anslpd(NULL), transport(_transport)
+{
+    log = Logger::getInstance();
+    ch = log->createChannel("AnslClient");
+
+	assert(transport != NULL);
+
+	log->log(ch,"a-nslp daemon replaced by a transport");
+}
+
 AnslpClient::~AnslpClient()
 {
 	
@@ -130,11 +141,15 @@ AnslpClient::~AnslpClient()
 #endif
 
 	// shutdown mnslp thread
-	starter->stop_processing();
-	starter->wait_until_stopped();
+	if (starter != NULL) {
+		starter->stop_processing();
+		starter->wait_until_stopped();
+	}
 	
 	saveDelete(starter);
 	
+	saveDelete(transport);
+	
 	saveDelete(conf);
 
 #ifdef DEBUG
@@ -154,6 +169,12 @@ AnslpClient::tg_create( const string sessionId,
 #ifdef DEBUG
     log->dlog(ch,"Starting tg_create");
 #endif
+
+	if (transport != NULL) {
+		transport->create(sessionId, source_addr, destination_addr, source_port, 
+						  dest_port, protocol, session_lifetime, message);
+		return;
+	}
 	
 	anslp_ipap_message mess(message); 
 		
@@ -208,6 +229,11 @@ AnslpClient::tg_teardown(anslp::session_id *sid)
     log->dlog(ch,"Starting tg_teardown ");
 #endif        
 
+	if (transport != NULL) {
+		transport->teardown(sid);
+		return;
+	}
+
 	event *e = new api_teardown_event(sid);
 
 	anslp_event_msg *msg = new anslp_event_msg(*sid, e);
@@ -229,6 +255,11 @@ AnslpClient::tg_check(string sessionId, objectList_t &mspec_objects)
 //#ifdef DEBUG
     log->log(ch,"Starting tg_check sessionId:%s", sessionId.c_str());
 //#endif        
+
+	if (transport != NULL) {
+		transport->check(sessionId, mspec_objects);
+		return;
+	}
 	
 	anslp::session_id *sid = new anslp::session_id(sessionId);
 	
@@ -266,6 +297,11 @@ AnslpClient::tg_install(string sessionId,
 //#ifdef DEBUG
     log->log(ch,"Starting tg_install sessionId:%s", sessionId.c_str());
 //#endif        
+
+	if (transport != NULL) {
+		transport->install(sessionId, mspec_objects);
+		return;
+	}
 	
 	anslp::session_id *sid = new anslp::session_id(sessionId);
 	
@@ -307,6 +343,12 @@ AnslpClient::tg_bidding(anslp::session_id *sid,
     log->dlog(ch,"Starting tg_bidding ");
 #endif        
 
+	if (transport != NULL) {
+		transport->bidding(sid, source_addr, destination_addr, source_port, 
+						   dest_port, protocol, message);
+		return;
+	}
+
     // Build an ipap_message for a create session, which only has 
     // auction template options.
 	// Build the request message 
@@ -352,6 +394,13 @@ AnslpClient::delayed_tg_bidding(anslp::session_id *sid,
 	protlib::hostaddress dest_addr;
 	dest_addr.set_ip(destination_addr);
 
+	// Nothing to hold back, no daemon orders the messages.
+	if (transport != NULL) {
+		transport->bidding(sid, source_addr, dest_addr, source_port, 
+						   dest_port, protocol, message);
+		return NULL;
+	}
+
     // Build an ipap_message for a create session, which only has 
     // auction template options.
 	// Build the request message 
@@ -382,7 +431,10 @@ AnslpClient::tg_bidding(std::vector<anslp::anslp_event_msg *> *events)
 	
 	for (it = events->begin(); it != events->end(); it++)
 	{
-		anslpd->get_fqueue()->enqueue(*it);
+		// Already sent by the transport.
+		if (*it != NULL) {
+			anslpd->get_fqueue()->enqueue(*it);
+		}
 	}
 }
 
@@ -410,6 +462,11 @@ AnslpClient::tg_remove(string sessionId, anslp::objectList_t &mspec_objects)
 //#ifdef DEBUG
     log->log(ch,"Starting tg_remove sessionId:%s", sessionId.c_str());
 //#endif        
+
+	if (transport != NULL) {
+		transport->remove(sessionId, mspec_objects);
+		return;
+	}
 	
 	anslp::session_id *sid = new anslp::session_id(sessionId);
 	
@@ -441,6 +498,10 @@ AnslpClient::tg_remove(string sessionId, anslp::objectList_t &mspec_objects)
 
 string AnslpClient::getLocalAddress(void)
 {
+	if (transport != NULL) {
+		return transport->getLocalAddress();
+	}
+
 	list<hostaddress>::iterator iter;
 	list<hostaddress> addresses4 = ntlp::gconf.getpar< list<hostaddress> >(gistconf_localaddrv4);
 	
@@ -462,6 +523,10 @@ string AnslpClient::getLocalAddress(void)
 
 uint32_t AnslpClient::getInitiatorLifetime(void)
 {
+	if (transport != NULL) {
+		return transport->getInitiatorLifetime();
+	}
+
 	if (conf){
 		uint32_t lifetime = conf->get_ni_session_lifetime();
 		return lifetime;
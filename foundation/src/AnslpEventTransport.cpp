@@ -0,0 +1,174 @@
+/*! \file   AnslpEventTransport.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Transport building the anslp events the daemon of the peer would produce.
+
+    $Id: AnslpEventTransport.cpp 748 2015-08-23 16:05:00Z amarentes $
+*/
+
+#include "config.h"
+#include "AnslpEventTransport.h"
+#include "Constants.h"
+#include "msg/anslp_ipap_message.h"
+
+using namespace anslp;
+using namespace anslp::msg;
+using namespace auction;
+
+
+/* ------------------------- AnslpEventTransport ------------------------- */
+
+AnslpEventTransport::AnslpEventTransport(string name, anslp::FastQueue *_queue)
+  : queue(_queue)
+{
+	log = Logger::getInstance();
+	ch = log->createChannel(name);
+
+	assert(queue != NULL);
+}
+
+
+/* ------------------------- enqueue ------------------------- */
+
+void AnslpEventTransport::enqueue(anslp::AnslpEvent *evt)
+{
+	if (!queue->enqueue(evt)) {
+		delete evt;
+		throw Error("cannot queue anslp event");
+	}
+}
+
+
+/* ------------------------- getLocalAddress ------------------------- */
+
+string AnslpEventTransport::getLocalAddress()
+{
+	return ANSLP_TRANSPORT_LOCAL_ADDRESS;
+}
+
+
+/* ------------------------- getInitiatorLifetime ------------------------- */
+
+uint32_t AnslpEventTransport::getInitiatorLifetime()
+{
+	return ANSLP_TRANSPORT_SESSION_LIFETIME;
+}
+
+
+/* ------------------------- create ------------------------- */
+
+void AnslpEventTransport::create(const string sessionId, const protlib::hostaddress &source_addr,
+							   const protlib::hostaddress &destination_addr,
+							   uint16_t source_port, uint16_t dest_port,
+							   uint8_t protocol, uint32_t session_lifetime,
+							   ipap_message &message)
+{
+	string anslpSessionId = anslp::session_id().to_string();
+	initiated.insert(anslpSessionId);
+
+	// What the daemon of the initiator reports once the session exists.
+	anslp::AddAnslpSessionEvent *ase = new anslp::AddAnslpSessionEvent();
+	ase->setSession(sessionId);
+	ase->setAnslpSession(anslpSessionId);
+	enqueue(ase);
+
+	anslp_ipap_message mess(message);
+
+	anslp::AddSessionEvent *e = new anslp::AddSessionEvent(queue);
+	e->setSession(anslpSessionId);
+	e->setObject(mspec_rule_key(), mess.copy());
+	deliver(e);
+
+#ifdef DEBUG
+	log->dlog(ch, "Session %s created as %s", sessionId.c_str(), anslpSessionId.c_str());
+#endif
+
+}
+
+
+/* ------------------------- teardown ------------------------- */
+
+void AnslpEventTransport::teardown(anslp::session_id *sid)
+{
+	string anslpSessionId = sid->to_string();
+	saveDelete(sid);
+
+	initiated.erase(anslpSessionId);
+
+	anslp::RemoveSessionEvent *e = new anslp::RemoveSessionEvent(queue);
+	e->setSession(anslpSessionId);
+	deliver(e);
+}
+
+
+/* ------------------------- check ------------------------- */
+
+void AnslpEventTransport::check(string sessionId, anslp::objectList_t &mspec_objects)
+{
+	// The peer never waits for it, creation goes straight to install.
+}
+
+
+/* ------------------------- install ------------------------- */
+
+void AnslpEventTransport::install(string sessionId, anslp::objectList_t &mspec_objects)
+{
+	// The initiator confirms the answer to its own daemon, nothing to carry.
+	if (initiated.find(sessionId) != initiated.end()) {
+		return;
+	}
+
+	anslp::AddSessionEvent *e = new anslp::AddSessionEvent(queue);
+	e->setSession(sessionId);
+
+	objectListIter_t it;
+	for (it = mspec_objects.begin(); it != mspec_objects.end(); ++it) {
+		e->setObject(it->first, it->second->copy());
+	}
+
+	deliver(e);
+}
+
+
+/* ------------------------- remove ------------------------- */
+
+void AnslpEventTransport::remove(string sessionId, anslp::objectList_t &mspec_objects)
+{
+	// The removal was already delivered by teardown.
+}
+
+
+/* ------------------------- bidding ------------------------- */
+
+void AnslpEventTransport::bidding(anslp::session_id *sid, const protlib::hostaddress &source_addr,
+								const protlib::hostaddress &destination_addr,
+								uint16_t source_port, uint16_t dest_port,
+								uint8_t protocol, ipap_message &message)
+{
+	anslp_ipap_message mess(message);
+
+	anslp::AuctionInteractionEvent *e = new anslp::AuctionInteractionEvent();
+	e->setSession(sid->to_string());
+	e->setObject(mspec_rule_key(), mess.copy());
+	saveDelete(sid);
+
+	deliver(e);
+}
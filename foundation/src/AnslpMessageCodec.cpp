@@ -0,0 +1,102 @@
+/*! \file   AnslpMessageCodec.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Binary encoding of ipap messages out of the a-nslp daemon.
+
+    $Id: AnslpMessageCodec.cpp 748 2015-08-23 16:05:00Z amarentes $
+*/
+
+#include "config.h"
+#include "AnslpMessageCodec.h"
+#include "network_message.h"
+
+using namespace protlib;
+using namespace anslp::msg;
+using namespace auction;
+
+
+/* ------------------------- encodeIpApMessage ------------------------- */
+
+void auction::encodeIpApMessage(const anslp_ipap_message &message, string &out)
+{
+	uint32_t size = message.get_serialized_size(IE::protocol_v1);
+
+	NetMsg msg(size);
+	uint32 written = 0;
+	message.serialize(msg, IE::protocol_v1, written);
+
+	out.append((const char *) msg.get_buffer(), written);
+}
+
+
+/* ------------------------- decodeIpApMessage ------------------------- */
+
+anslp_ipap_message *auction::decodeIpApMessage(const char *data, size_t len)
+{
+	if (len == 0) {
+		return NULL;
+	}
+
+	NetMsg msg((uchar *) data, len, true);
+
+	IEErrorList errors;
+	uint32 read = 0;
+
+	anslp_ipap_message *message = new anslp_ipap_message();
+	if ((message->deserialize(msg, IE::protocol_v1, errors, read, false) == NULL) || 
+		(read != len)) {
+		delete message;
+		return NULL;
+	}
+
+	return message;
+}
+
+
+/* ------------------------- putIpApMessage ------------------------- */
+
+void auction::putIpApMessage(string &out, const anslp_ipap_message &message)
+{
+	// The length goes in front once the message is written.
+	size_t start = out.size();
+	putU32(out, 0);
+	encodeIpApMessage(message, out);
+
+	string len;
+	putU32(len, out.size() - start - 4);
+	out.replace(start, 4, len);
+}
+
+
+/* ------------------------- getIpApMessage ------------------------- */
+
+anslp_ipap_message *auction::getIpApMessage(recordReader &in)
+{
+	uint32_t size;
+	if (!in.u32(size) || (in.size - in.pos < size)) {
+		return NULL;
+	}
+
+	anslp_ipap_message *message = decodeIpApMessage(in.data + in.pos, size);
+	in.pos += size;
+
+	return message;
+}
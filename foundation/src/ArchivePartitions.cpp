@@ -0,0 +1,247 @@
+/*! \file   ArchivePartitions.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Time partitions of the bidding object archive tables.
+
+    $Id: ArchivePartitions.cpp 748 2015-08-19 11:30:00Z amarentes $
+*/
+
+#include "config.h"
+#include "ArchivePartitions.h"
+#include "BiddingObjectBulkLoader.h"
+
+using namespace auction;
+
+
+//! shortest interval, suffixes have a resolution of one minute.
+static const unsigned long MIN_INTERVAL = 60;
+
+static const unsigned long SECONDS_PER_DAY = 86400;
+
+
+/* ------------------------- toLower ------------------------- */
+
+static string toLower(const string &s)
+{
+	string l(s);
+	for (size_t i = 0; i < l.size(); i++) {
+		l[i] = tolower(l[i]);
+	}
+	return l;
+}
+
+
+/* ------------------------- ArchivePartitions ------------------------- */
+
+ArchivePartitions::ArchivePartitions(unsigned long _interval, unsigned int _ahead,
+									 unsigned long _retention, bool _detach)
+  : interval(_interval), ahead(_ahead), retention(_retention), detach(_detach),
+    maintained(-1)
+{
+	log = Logger::getInstance();
+	ch = log->createChannel("ArchivePartitions");
+
+	if (interval < MIN_INTERVAL) {
+		throw Error("archive partition interval of %lu seconds, at least %lu are needed",
+					interval, MIN_INTERVAL);
+	}
+
+#ifdef DEBUG
+	log->dlog(ch, "Starting, interval:%lu retention:%lu", interval, retention);
+#endif
+
+}
+
+
+/* ------------------------- ~ArchivePartitions ------------------------- */
+
+ArchivePartitions::~ArchivePartitions()
+{
+
+#ifdef DEBUG
+	log->dlog(ch, "Shutdown");
+#endif
+
+}
+
+
+/* ------------------------- getTables ------------------------- */
+
+const vector<string> &ArchivePartitions::getTables()
+{
+	static vector<string> tables;
+
+	if (tables.empty()) {
+		for (int t = 0; t < BO_NUM_TABLES; t++) {
+			tables.push_back(BiddingObjectBulkLoader::getTableName((biddingObjectTable_t) t));
+		}
+		tables.push_back(BiddingObjectBulkLoader::getSummaryTableName());
+	}
+	return tables;
+}
+
+
+/* ------------------------- getSuffix ------------------------- */
+
+string ArchivePartitions::getSuffix(time_t t) const
+{
+	time_t start = getStart(t);
+	struct tm tm;
+	char buf[32];
+
+	gmtime_r(&start, &tm);
+
+	// Fixed width, so the names sort in time order.
+	if (interval % SECONDS_PER_DAY == 0) {
+		strftime(buf, sizeof(buf), "_%Y%m%d", &tm);
+	} else {
+		strftime(buf, sizeof(buf), "_%Y%m%d%H%M", &tm);
+	}
+	return buf;
+}
+
+
+/* ------------------------- isExpired ------------------------- */
+
+bool ArchivePartitions::isExpired(const string &child, const string &parent, time_t now) const
+{
+	if (retention == 0) {
+		return false;
+	}
+
+	string prefix = toLower(parent);
+	string name = toLower(child);
+	string limit = getSuffix(now - retention);
+
+	if ((name.size() != prefix.size() + limit.size()) ||
+		(name.compare(0, prefix.size(), prefix) != 0)) {
+		return false;
+	}
+
+	string suffix = name.substr(prefix.size());
+	if (suffix[0] != '_') {
+		return false;
+	}
+
+	for (size_t i = 1; i < suffix.size(); i++) {
+		if (!isdigit(suffix[i])) {
+			return false;
+		}
+	}
+
+	// The partition including now - retention still has rows to keep.
+	return (suffix < limit);
+}
+
+
+/* ------------------------- maintain ------------------------- */
+
+void ArchivePartitions::maintain(pqxx::connection &conn, time_t now)
+{
+	time_t start = getStart(now);
+
+	if (start == maintained) {
+		return;
+	}
+
+	for (unsigned int i = 0; i <= ahead; i++) {
+		create(conn, start + i * interval);
+	}
+
+	if (retention > 0) {
+		const vector<string> &tables = getTables();
+		for (vector<string>::const_iterator iter = tables.begin(); iter != tables.end(); ++iter) {
+			expire(conn, *iter, now);
+		}
+	}
+
+	maintained = start;
+}
+
+
+/* ------------------------- create ------------------------- */
+
+void ArchivePartitions::create(pqxx::connection &conn, time_t start)
+{
+	string suffix = getSuffix(start);
+
+	try {
+
+		pqxx::work w(conn);
+
+		const vector<string> &tables = getTables();
+		for (vector<string>::const_iterator iter = tables.begin(); iter != tables.end(); ++iter) {
+			// LIKE copies the indexes, INHERITS lets the table see the rows.
+			w.exec("CREATE TABLE IF NOT EXISTS " + *iter + suffix + " (LIKE " + *iter +
+				   " INCLUDING ALL) INHERITS (" + *iter + ")");
+		}
+
+		w.commit();
+
+	} catch (const pqxx::pqxx_exception &ex) {
+		throw Error("cannot create archive partitions %s: %s", suffix.c_str(),
+					ex.base().what());
+	}
+
+#ifdef DEBUG
+	log->dlog(ch, "Partitions %s ready", suffix.c_str());
+#endif
+
+}
+
+
+/* ------------------------- expire ------------------------- */
+
+void ArchivePartitions::expire(pqxx::connection &conn, const string &parent, time_t now)
+{
+	try {
+
+		pqxx::work w(conn);
+
+		pqxx::result children = w.exec("SELECT c.relname FROM pg_inherits i "
+									   "JOIN pg_class c ON c.oid = i.inhrelid "
+									   "JOIN pg_class p ON p.oid = i.inhparent "
+									   "WHERE p.relname = " + w.quote(toLower(parent)));
+
+		for (pqxx::result::size_type i = 0; i < children.size(); i++) {
+			string child = children[i][0].as<string>();
+
+			if (!isExpired(child, parent, now)) {
+				continue;
+			}
+
+			if (detach) {
+				w.exec("ALTER TABLE " + child + " NO INHERIT " + parent);
+			} else {
+				w.exec("DROP TABLE " + child);
+			}
+
+			log->log(ch, "%s expired archive partition %s", detach ? "Detached" : "Dropped",
+					 child.c_str());
+		}
+
+		w.commit();
+
+	} catch (const pqxx::pqxx_exception &ex) {
+		throw Error("cannot expire archive partitions of %s: %s", parent.c_str(),
+					ex.base().what());
+	}
+}
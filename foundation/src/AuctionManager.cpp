@@ -36,7 +36,8 @@ using namespace auction;
 /* ------------------------- AuctionManager ------------------------- */
 
 AuctionManager::AuctionManager( int domain, string fdname, string fvname, bool _immediateStart) 
-    : AuctioningObjectManager(domain, fdname, fvname, "AuctionManager"), immediateStart(_immediateStart)
+    : AuctioningObjectManager(domain, fdname, fvname, "AuctionManager"), immediateStart(_immediateStart),
+      announcementGeneration(0)
 {
 
 #ifdef DEBUG
@@ -51,6 +52,8 @@ AuctionManager::AuctionManager( int domain, string fdname, string fvname, bool _
 AuctionManager::~AuctionManager()
 {
 
+	clearAnnouncements();
+
 #ifdef DEBUG
     log->dlog(ch,"Shutdown");
 #endif
@@ -238,10 +241,83 @@ AuctionManager::get_ipap_message(auctioningObjectDB_t *auctions,
 								 string sAddressIPV6, uint16_t port)
 {
 
-	MAPIAuctionParser mpap = MAPIAuctionParser(getDomain());
+	// Auctions were added, deleted or activated since the messages were built.
+	if (announcementGeneration != getGeneration()) {
+		clearAnnouncements();
+		announcementGeneration = getGeneration();
+	}
+
+	string key = getAnnouncementKey(auctions, templates, useIPV6, 
+									sAddressIPV4, sAddressIPV6, port);
+
+	announcementCacheIter_t iter = announcements.end();
+	if (!key.empty()) {
+		iter = announcements.find(key);
+	}
+
+	if (iter == announcements.end()) {
+
+		MAPIAuctionParser mpap = MAPIAuctionParser(getDomain());
+
+		ipap_message *mes = mpap.get_ipap_message(FieldDefManager::getFieldDefs(), auctions,
+												  templates, useIPV6, sAddressIPV4, 
+												  sAddressIPV6, port);
+		if (key.empty()) {
+			return mes;
+		}
+
+		if (announcements.size() >= ANNOUNCEMENT_CACHE_SIZE) {
+			clearAnnouncements();
+		}
+
+		iter = announcements.insert(make_pair(key, mes)).first;
+	}
+
+	return new ipap_message(*(iter->second));
+}
+
+
+/* ---------------------- getAnnouncementKey ------------------------- */
+
+string 
+AuctionManager::getAnnouncementKey(auctioningObjectDB_t *auctions, 
+								   ipap_template_container *templates,
+								   bool useIPV6, const string &sAddressIPV4, 
+								   const string &sAddressIPV6, uint16_t port)
+{
+	vector<int> uids;
+	uids.reserve(auctions->size());
+
+	for (auctioningObjectDBIter_t iter = auctions->begin(); iter != auctions->end(); ++iter) {
+		if ((*iter == NULL) || (getAuctioningObject((*iter)->getUId()) != *iter)) {
+			return "";
+		}
+		uids.push_back((*iter)->getUId());
+	}
+
+	// The same auctions come in any order.
+	sort(uids.begin(), uids.end());
+
+	ostringstream key;
+	key << (void *) templates << "|" << (useIPV6 ? 6 : 4) << "|" 
+		<< (useIPV6 ? sAddressIPV6 : sAddressIPV4) << "|" << port << "|";
 
-	return mpap.get_ipap_message(FieldDefManager::getFieldDefs(), auctions,templates, 
-								 useIPV6, sAddressIPV4, sAddressIPV6, port);
+	for (vector<int>::iterator iter = uids.begin(); iter != uids.end(); ++iter) {
+		key << *iter << ",";
+	}
+
+	return key.str();
+}
+
+
+/* ---------------------- clearAnnouncements ------------------------- */
+
+void AuctionManager::clearAnnouncements()
+{
+	for (announcementCacheIter_t iter = announcements.begin(); iter != announcements.end(); ++iter) {
+		delete iter->second;
+	}
+	announcements.clear();
 }
 
 
@@ -285,12 +361,12 @@ void AuctionManager::delAuction(string sname, string rname, EventScheduler *e)
 void 
 AuctionManager::delAuctions(string sname, EventScheduler *e)
 {
-	auctioningObjectIndex_t *objects = getAuctioningObjects(sname);
+	auctioningObjectIndex_t objects = getAuctioningObjects(sname);
 	auctioningObjectIndexIter_t iter;
 	
-    for (auctioningObjectIndexIter_t i = objects->begin(); i != objects->end(); i++) 
+    for (auctioningObjectIndexIter_t i = objects.begin(); i != objects.end(); i++) 
     {						
-        Auction *o = dynamic_cast<Auction *>(getAuctioningObject(sname, i->first));
+        Auction *o = dynamic_cast<Auction *>(getAuctioningObject(i->second));
         delAuction(o,e);
     }
 }
@@ -433,11 +509,11 @@ string AuctionManager::getInfo(string sname)
 {
     ostringstream s;
 
-	auctioningObjectIndex_t *objects = getAuctioningObjects(sname);
+	auctioningObjectIndex_t objects = getAuctioningObjects(sname);
 	auctioningObjectIndexIter_t iter;
 
-    for (auctioningObjectIndexIter_t i = objects->begin(); i != objects->end(); i++) {						
-        Auction *o = dynamic_cast<Auction *>(getAuctioningObject(sname, i->first));
+    for (auctioningObjectIndexIter_t i = objects.begin(); i != objects.end(); i++) {						
+        Auction *o = dynamic_cast<Auction *>(getAuctioningObject(i->second));
         s << o->getInfo();
     }
     
@@ -38,7 +38,8 @@ char *AuctionManagerInfo::INFOS[] = { "all",
                              "use_ssl",
                              "hello",
                              "bidlist",
-                             "bid" };
+                             "bid",
+                             "db_writer" };
 
 typeMap_t AuctionManagerInfo::typeMap; //std::map< string, infoType_t >();
 
@@ -111,6 +112,7 @@ void AuctionManagerInfo::addInfo( string item, string param )
         addInfo(I_CONFIGFILE);
         addInfo(I_USE_SSL);
         addInfo(I_BIDLIST);
+        addInfo(I_DB_WRITER);
         break;
     case I_BID:
         addInfo(I_BID, param );
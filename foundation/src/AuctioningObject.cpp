@@ -33,14 +33,16 @@ using namespace auction;
 const char *auction::AuctionObjectStateNames[] = { "new", "valid", "scheduled", "active", "done", "error"};
 
 AuctioningObject::AuctioningObject(string channelName, string set, string name): 
-uid(0), state(AO_NEW), _set(set), _name(name), _setParent(""), _nameParent("")
+uid(0), state(AO_NEW), _set(set), _name(name),
+_setParent(), _nameParent()
 {
     log  = Logger::getInstance();
     ch   = log->createChannel( channelName );
 }
 
 AuctioningObject::AuctioningObject(string channelName, string set, string name, string setParent, string nameParent): 
-uid(0), state(AO_NEW), _set(set), _name(name), _setParent(setParent), _nameParent(nameParent)
+uid(0), state(AO_NEW), _set(set), _name(name),
+_setParent(setParent), _nameParent(nameParent)
 {
     log  = Logger::getInstance();
     ch   = log->createChannel( channelName );
@@ -52,7 +54,7 @@ AuctioningObject::~AuctioningObject()
 }
 
 AuctioningObject::AuctioningObject(const AuctioningObject &rhs):
-uid(rhs.uid), state(rhs.state), _set(rhs._set), _name(rhs._name), 
+uid(rhs.uid), state(rhs.state), _set(rhs._set), _name(rhs._name),
 _setParent(rhs._setParent), _nameParent(rhs._nameParent)
 {
 
@@ -64,16 +66,16 @@ _setParent(rhs._setParent), _nameParent(rhs._nameParent)
 bool 
 AuctioningObject::equals(const AuctioningObject &rhs)
 {
-	if (_set.compare(rhs._set) != 0 )
+	if (_set != rhs._set)
 		return false;
 
-	if (_name.compare(rhs._name) != 0 )
+	if (_name != rhs._name)
 		return false;
 
-	if (_setParent.compare(rhs._setParent) != 0 )
+	if (_setParent != rhs._setParent)
 		return false;
 
-	if (_nameParent.compare(rhs._nameParent) != 0 )
+	if (_nameParent != rhs._nameParent)
 		return false;
 
 	if (state != rhs.state)
@@ -36,7 +36,7 @@ using namespace auction;
 /* ------------------------- AuctioningObjectManager ------------------------- */
 
 AuctioningObjectManager::AuctioningObjectManager( int domain, string fdname, string fvname, string channelName) 
-    : FieldDefManager(fdname, fvname), objects(0), domain(domain), idSource(1)
+    : FieldDefManager(fdname, fvname), objects(0), generation(0), domain(domain), idSource(1, MANAGER_MAX_UID)
 {
     log = Logger::getInstance();
     ch = log->createChannel(channelName);
@@ -51,27 +51,41 @@ AuctioningObjectManager::AuctioningObjectManager( int domain, string fdname, str
 
 AuctioningObjectManager::~AuctioningObjectManager()
 {
-    auctioningObjectDBIter_t iter;
 
 #ifdef DEBUG
     log->dlog(ch,"Shutdown");
 #endif
 
+    clearAuctioningObjects();
+
+#ifdef DEBUG
+    log->dlog(ch,"Finish shutdown");
+#endif
+
+}
+
+
+/* ------------------------- clearAuctioningObjects ------------------------- */
+
+void AuctioningObjectManager::clearAuctioningObjects()
+{
+    auctioningObjectUIdIndexIter_t iter;
+
     for (iter = auctioningObjectDB.begin(); iter != auctioningObjectDB.end(); iter++) {
-        if (*iter != NULL) {
-            // delete auction Object
-            saveDelete(*iter);
-        } 
+        // release auction Object
+        releaseAuctioningObject(iter->second);
     }
+    auctioningObjectDB.clear();
 	
     for (auctioningObjectDoneIter_t i = auctioningObjectDone.begin(); i != auctioningObjectDone.end(); i++) {
-        saveDelete(*i);
+        releaseAuctioningObject(*i);
     }
+    auctioningObjectDone.clear();
 
-#ifdef DEBUG
-    log->dlog(ch,"Finish shutdown");
-#endif
-
+    auctioningObjectKeyIndex.clear();
+    auctioningObjectSetIndex.clear();
+    setPositions.clear();
+    objects = 0;
 }
 
 
@@ -79,8 +93,9 @@ AuctioningObjectManager::~AuctioningObjectManager()
 
 AuctioningObject *AuctioningObjectManager::getAuctioningObject(int uid)
 {
-    if ((uid >= 0) && ((unsigned int)uid < auctioningObjectDB.size())) {
-        return auctioningObjectDB[uid];
+    auctioningObjectUIdIndexIter_t iter = auctioningObjectDB.find(uid);
+    if (iter != auctioningObjectDB.end()) {
+        return iter->second;
     } else {
         return NULL;
     }
@@ -92,29 +107,18 @@ AuctioningObject *AuctioningObjectManager::getAuctioningObject(int uid)
 
 AuctioningObject *AuctioningObjectManager::getAuctioningObject(string sname, string rname)
 {
-    auctioningObjectSetIndexIter_t iter;
-    auctioningObjectIndexIter_t iter2;
-
-    iter = auctioningObjectSetIndex.find(sname);
-    if (iter != auctioningObjectSetIndex.end()) {		
-        iter2 = iter->second.find(rname);
-        if (iter2 != iter->second.end()) {
-            return getAuctioningObject(iter2->second);
+    // Names that were never interned belong to no object.
+    InternedString set, name;
+    if (InternedString::find(sname, set) && InternedString::find(rname, name)) {
+        int *uid = auctioningObjectKeyIndex.find(set, name);
+        if (uid != NULL) {
+            return getAuctioningObject(*uid);
         }
-        else
-        {
-#ifdef DEBUG
-    log->dlog(ch,"Auction Object Id not found %s", rname.c_str());
-#endif		
-			
-		}
     }
-    else
-    {
+
 #ifdef DEBUG
-    log->dlog(ch,"Auction Object set not found %s", sname.c_str());
+    log->dlog(ch,"Auction Object not found %s.%s", sname.c_str(), rname.c_str());
 #endif		
-	}
 
     return NULL;
 }
@@ -122,29 +126,32 @@ AuctioningObject *AuctioningObjectManager::getAuctioningObject(string sname, str
 
 /* ------------------------ getAuctionObjects -------------------- */
 
-auctioningObjectIndex_t *AuctioningObjectManager::getAuctioningObjects(string sname)
+auctioningObjectIndex_t AuctioningObjectManager::getAuctioningObjects(string sname)
 {
-    auctioningObjectSetIndexIter_t iter;
+    auctioningObjectIndex_t ret;
 
-    iter = auctioningObjectSetIndex.find(sname);
-    if (iter != auctioningObjectSetIndex.end()) {
-        return &(iter->second);
+    InternedString set;
+    if (!InternedString::find(sname, set)) {
+        return ret;
     }
 
-    return NULL;
+    vector<int> *uids = auctioningObjectSetIndex.find(set, InternedString());
+    if (uids != NULL) {
+        for (vector<int>::iterator i = uids->begin(); i != uids->end(); ++i) {
+            ret[getAuctioningObject(*i)->getName()] = *i;
+        }
+    }
+
+    return ret;
 }
 
 auctioningObjectDB_t  AuctioningObjectManager::getAuctioningObjects()
 {
     auctioningObjectDB_t ret;
 
-    for (auctioningObjectSetIndexIter_t r = auctioningObjectSetIndex.begin(); 
-				r != auctioningObjectSetIndex.end(); r++) 
-	{
-					
-        for (auctioningObjectIndexIter_t i = r->second.begin(); i != r->second.end(); i++) {
-            ret.push_back(getAuctioningObject(i->second));
-        }
+    ret.reserve(objects);
+    for (auctioningObjectUIdIndexIter_t i = auctioningObjectDB.begin(); i != auctioningObjectDB.end(); ++i) {
+        ret.push_back(i->second);
     }
 
     return ret;
@@ -162,6 +169,8 @@ void AuctioningObjectManager::activateAuctioningObjects(auctioningObjectDB_t *au
 						
         a->setState(AO_ACTIVE);
     }
+
+    generation++;
 }
 
 /* -------------------- addAuctionObject -------------------- */
@@ -197,19 +206,20 @@ void AuctioningObjectManager::addAuctioningObject(AuctioningObject *a)
 		log->dlog(ch, "Auctioning Object Id = #%d ", a->getUId());
 #endif 
 
-        // resize vector if necessary
-        if ((unsigned int)a->getUId() >= auctioningObjectDB.size()) {
-            auctioningObjectDB.reserve((a->getUId() * 2) + 1);
-            auctioningObjectDB.resize(a->getUId() + 1);
-        }
-		
         // insert auctioning Object
         auctioningObjectDB[a->getUId()] = a; 	
 
-        // add new entry in index
-        auctioningObjectSetIndex[a->getSet()][a->getName()] = a->getUId();
+        // add new entry in indexes
+        auctioningObjectKeyIndex.insert(a->getSetHandle(), a->getNameHandle(), a->getUId());
+
+        vector<int> *uids = auctioningObjectSetIndex.find(a->getSetHandle(), InternedString());
+        if (uids == NULL) {
+            uids = auctioningObjectSetIndex.insert(a->getSetHandle(), InternedString(), vector<int>());
+        }
+        addToUIdList(*uids, setPositions, a->getUId());
 	
         objects++;
+        generation++;
 
 #ifdef DEBUG    
     log->dlog(ch, "finish adding new auctioning objects with name = %s.%s",
@@ -319,14 +329,19 @@ AuctioningObjectManager::delAuctioningObjects(string sname)
     log->dlog(ch, "removing auctioning objects with set = '%s'", sname.c_str());
 #endif
     
-    if (auctioningObjectSetIndex.find(sname) != auctioningObjectSetIndex.end()) 
+    InternedString set;
+    if (!InternedString::find(sname, set)) {
+        return;
+    }
+
+    vector<int> *uids = auctioningObjectSetIndex.find(set, InternedString());
+    if (uids != NULL) 
     {
-        auctioningObjectSetIndexIter_t iter = auctioningObjectSetIndex.find(sname);    
-        auctioningObjectIndex_t auctionIndex = iter->second;
+        // copy, the list shrinks while deleting.
+        vector<int> auctionIndex = *uids;
         
-        for (auctioningObjectIndexIter_t i = auctionIndex.begin(); i != auctionIndex.end(); i++) {
-						
-            delAuctioningObject(getAuctioningObject(sname, i->first));
+        for (vector<int>::iterator i = auctionIndex.begin(); i != auctionIndex.end(); i++) {
+            delAuctioningObject(getAuctioningObject(*i));
         }
     }
 }
@@ -341,16 +356,24 @@ void AuctioningObjectManager::delAuctioningObject(AuctioningObject *a)
 #endif
 
     // remove auction from database and from index
-    storeAuctioningObjectAsDone(a);
-    auctioningObjectDB[a->getUId()] = NULL;
-    auctioningObjectSetIndex[a->getSet()].erase(a->getName());
+    auctioningObjectDB.erase(a->getUId());
+    auctioningObjectKeyIndex.erase(a->getSetHandle(), a->getNameHandle());
 
-    // delete auction set if empty
-    if (auctioningObjectSetIndex[a->getSet()].empty()) {
-        auctioningObjectSetIndex.erase(a->getSet());
+    vector<int> *uids = auctioningObjectSetIndex.find(a->getSetHandle(), InternedString());
+    if (uids != NULL) {
+        delFromUIdList(*uids, setPositions, a->getUId());
+        
+        // delete auction set if empty
+        if (uids->empty()) {
+            auctioningObjectSetIndex.erase(a->getSetHandle(), InternedString());
+        }
     }
+
+    // It may be released here, so it goes last.
+    storeAuctioningObjectAsDone(a);
     
     objects--;
+    generation++;
 }
 
 
@@ -369,10 +392,18 @@ void AuctioningObjectManager::storeAuctioningObjectAsDone(AuctioningObject *a)
         
         // remove auctioning object
         AuctioningObject *ao = auctioningObjectDone.front();
-        delete ao;
         auctioningObjectDone.pop_front();
+        releaseAuctioningObject(ao);
     }
 }
 
 
+/* -------------------- releaseAuctioningObject -------------------- */
+
+void AuctioningObjectManager::releaseAuctioningObject(AuctioningObject *a)
+{
+    delete a;
+}
+
+
 
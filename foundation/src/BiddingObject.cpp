@@ -38,7 +38,7 @@ using namespace auction;
 /* ------------------------- BiddingObject ------------------------- */
 
 BiddingObject::BiddingObject( string _auctionSet, string _auctionName, string _BiddingObjectSet, string _BiddingObjectName, 
-		  ipap_object_type_t _type, elementList_t &elements, optionList_t &options)
+		  ipap_object_type_t _type, const elementList_t &elements, const optionList_t &options)
   : AuctioningObject("BiddingObject", _BiddingObjectSet, _BiddingObjectName), auctionSet(_auctionSet), auctionName(_auctionName), 
 	biddingObjectType(_type), elementList(elements), optionList(options)
 {
@@ -53,6 +53,22 @@ BiddingObject::BiddingObject( string _auctionSet, string _auctionName, string _B
 
 }
 
+BiddingObject::BiddingObject( string _auctionSet, string _auctionName, string _BiddingObjectSet, string _BiddingObjectName, 
+		  ipap_object_type_t _type)
+  : AuctioningObject("BiddingObject", _BiddingObjectSet, _BiddingObjectName), auctionSet(_auctionSet), auctionName(_auctionName), 
+	biddingObjectType(_type)
+{
+
+	if ((_type < IPAP_BID) || (_type > IPAP_ALLOCATION)){
+		throw Error("An invalid type was given");
+	}
+
+#ifdef DEBUG
+    log->dlog(ch, "BiddingObject constructor");
+#endif    
+
+}
+
 BiddingObject::BiddingObject( const BiddingObject &rhs )
   : AuctioningObject(rhs)
 {
@@ -106,6 +122,33 @@ BiddingObject::~BiddingObject()
   
 }
 
+//! run the destructor of an object released along with its arena.
+static void destroyBiddingObject(void *ptr)
+{
+	static_cast<BiddingObject *>(ptr)->~BiddingObject();
+}
+
+/* ------------------------- operator new ------------------------- */
+
+void *BiddingObject::operator new(size_t size)
+{
+	return BiddingObjectArena::allocate(size, &destroyBiddingObject);
+}
+
+/* ------------------------- operator delete ------------------------- */
+
+void BiddingObject::operator delete(void *ptr)
+{
+	BiddingObjectArena::deallocate(ptr);
+}
+
+/* ------------------------- retire ------------------------- */
+
+void BiddingObject::retire(BiddingObject *b)
+{
+	BiddingObjectArena::retire(b);
+}
+
 string BiddingObject::getInfo()
 {
 	std::stringstream output;
@@ -202,10 +245,10 @@ bool BiddingObject::operator==(const BiddingObject &rhs)
 	if (AuctioningObject::equals(rhs) == false )
 		return false;
 
-	if (auctionSet.compare(rhs.auctionSet) != 0 )
+	if (auctionSet != rhs.auctionSet)
 		return false;
 		
-	if (auctionName.compare(rhs.auctionName) != 0 )
+	if (auctionName != rhs.auctionName)
 		return false;
 
 
@@ -324,6 +367,65 @@ BiddingObject::getElementVal(string elementName, string name)
 	return field;
 }
 
+/* ------------------------- takeFields ------------------------- */
+
+void BiddingObject::takeFields(elementList_t &elements, optionList_t &options)
+{
+	elementList.swap(elements);
+	optionList.swap(options);
+
+	elements.clear();
+	options.clear();
+}
+
+/* ------------------------- getElementsTotal ------------------------- */
+
+double BiddingObject::getElementsTotal(string name)
+{
+	double total = 0;
+
+	transform(name.begin(), name.end(), name.begin(), ToLower());
+
+	elementListIter_t iter;
+	for (iter = elementList.begin(); iter != elementList.end(); ++iter) {
+		fieldListIter_t fieldIter;
+		for (fieldIter = (iter->second).begin(); fieldIter != (iter->second).end(); ++fieldIter) {
+			if ((fieldIter->name == name) && !fieldIter->value.empty()) {
+				total += atof(fieldIter->value[0].getValue().c_str());
+			}
+		}
+	}
+
+	return total;
+}
+
+
+/* ------------------------- getElementsMax ------------------------- */
+
+double BiddingObject::getElementsMax(string name)
+{
+	double max = 0;
+	bool found = false;
+
+	transform(name.begin(), name.end(), name.begin(), ToLower());
+
+	elementListIter_t iter;
+	for (iter = elementList.begin(); iter != elementList.end(); ++iter) {
+		fieldListIter_t fieldIter;
+		for (fieldIter = (iter->second).begin(); fieldIter != (iter->second).end(); ++fieldIter) {
+			if ((fieldIter->name == name) && !fieldIter->value.empty()) {
+				double value = atof(fieldIter->value[0].getValue().c_str());
+				if (!found || (value > max)) {
+					max = value;
+					found = true;
+				}
+			}
+		}
+	}
+
+	return max;
+}
+
 /* functions for accessing the templates */
 field_t
 BiddingObject::getOptionVal(string optionName, string name)
@@ -585,6 +687,117 @@ BiddingObject::calculateIntervals(time_t now, biddingObjectIntervalList_t *list)
 		
 }
 
+void BiddingObject::getRecord(biddingObjectRecord_t &record)
+{
+	record.auctionSet = getAuctionSet();
+	record.auctionName = getAuctionName();
+	record.set = getSet();
+	record.name = getName();
+	record.sessionId = getSession();
+	record.type = ipap_object_type_names[getType()];
+	record.state = AuctionObjectStateNames[getState()];
+
+	elementListIter_t iter;
+	for (iter = elementList.begin(); iter != elementList.end(); ++iter ){
+		record.elements.push_back(iter->first);
+		
+		fieldListIter_t fieldIter;
+		for (fieldIter = (iter->second).begin(); fieldIter != iter->second.end(); ++fieldIter)
+		{
+			biddingObjectFieldRecord_t field;
+			field.ownerName = iter->first;
+			field.fieldName = fieldIter->name;
+			field.fieldType = fieldIter->type;
+			field.len = fieldIter->len;
+			field.value = ((fieldIter->value)[0]).getValue();
+			record.elementFields.push_back(field);
+		}
+	}
+
+	optionListIter_t iterOpt;
+	for (iterOpt = optionList.begin(); iterOpt != optionList.end(); ++iterOpt ){
+		record.options.push_back(iterOpt->first);
+
+		fieldListIter_t fieldIter;
+		for (fieldIter = (iterOpt->second).begin(); fieldIter != iterOpt->second.end(); ++fieldIter)
+		{
+			biddingObjectFieldRecord_t field;
+			field.ownerName = iterOpt->first;
+			field.fieldName = fieldIter->name;
+			field.fieldType = fieldIter->type;
+			field.len = fieldIter->len;
+			field.value = ((fieldIter->value)[0]).getValue();
+			record.optionFields.push_back(field);
+		}
+	}
+}
+
+void BiddingObject::prepare_insert_record(pqxx::connection_base &c)
+{
+	prepare_insert_biddingObjectHdr(c);
+	prepare_insert_biddingObjectElement(c);
+	prepare_insert_biddingObjectElementField(c);
+	prepare_insert_biddingObjectOption(c);
+	prepare_insert_biddingObjectOptionField(c);
+}
+
+void BiddingObject::save_record(pqxx::work &w, const biddingObjectRecord_t &record)
+{
+
+#ifdef HAVE_PQXX40
+	w.prepared("insertBO_HDR")(record.auctionSet)(record.auctionName)(record.set)(record.name)(record.sessionId)(record.type)(record.state).exec();
+
+	vector<string>::const_iterator iter;
+	for (iter = record.elements.begin(); iter != record.elements.end(); ++iter){
+		w.prepared("insertBO_ELEMENT")(record.auctionSet)(record.auctionName)(record.set)(record.name)(*iter).exec();
+	}
+
+	biddingObjectFieldRecordListConstIter_t fieldIter;
+	for (fieldIter = record.elementFields.begin(); fieldIter != record.elementFields.end(); ++fieldIter){
+		w.prepared("insertBO_ELEMENTFIELD")(record.auctionSet)(record.auctionName)(record.set)(record.name)(fieldIter->ownerName)(fieldIter->fieldName)(fieldIter->fieldType)(fieldIter->len)(fieldIter->value).exec();
+	}
+
+	for (iter = record.options.begin(); iter != record.options.end(); ++iter){
+		w.prepared("insertBO_OPTION")(record.auctionSet)(record.auctionName)(record.set)(record.name)(*iter).exec();
+	}
+
+	for (fieldIter = record.optionFields.begin(); fieldIter != record.optionFields.end(); ++fieldIter){
+		w.prepared("insertBO_OPTIONFIELD")(record.auctionSet)(record.auctionName)(record.set)(record.name)(fieldIter->ownerName)(fieldIter->fieldName)(fieldIter->fieldType)(fieldIter->len)(fieldIter->value).exec();
+	}
+#else
+	string key = w.quote(record.auctionSet) + "," + w.quote(record.auctionName) + "," +
+				 w.quote(record.set) + "," + w.quote(record.name);
+
+	w.exec("INSERT INTO biddingObjectHdr( auctionSet, auctionName, BiddingObjectSet, BiddingObjectName, sessionId, biddingObjectType, biddingobjectstatus) VALUES (" 
+			+ key + "," + w.quote(record.sessionId) + "," + w.quote(record.type) + "," + w.quote(record.state) + ")");
+
+	vector<string>::const_iterator iter;
+	for (iter = record.elements.begin(); iter != record.elements.end(); ++iter){
+		w.exec("INSERT INTO biddingObjectElement( auctionSet, auctionName, BiddingObjectSet, BiddingObjectName, elementName) VALUES (" 
+				+ key + "," + w.quote(*iter) + ")");
+	}
+
+	biddingObjectFieldRecordListConstIter_t fieldIter;
+	for (fieldIter = record.elementFields.begin(); fieldIter != record.elementFields.end(); ++fieldIter){
+		w.exec("INSERT INTO biddingObjectElementField(auctionSet, auctionName, BiddingObjectSet, BiddingObjectName, elementName, fieldName, fieldType, len, value) VALUES (" 
+				+ key + "," + w.quote(fieldIter->ownerName) + "," + w.quote(fieldIter->fieldName) + "," 
+				+ w.quote(fieldIter->fieldType) + "," + w.quote(fieldIter->len) + "," + w.quote(fieldIter->value) + ")");
+	}
+
+	for (iter = record.options.begin(); iter != record.options.end(); ++iter){
+		w.exec("INSERT INTO biddingObjectOption(auctionSet, auctionName, BiddingObjectSet, BiddingObjectName, optionName) VALUES (" 
+				+ key + "," + w.quote(*iter) + ")");
+	}
+
+	for (fieldIter = record.optionFields.begin(); fieldIter != record.optionFields.end(); ++fieldIter){
+		w.exec("INSERT INTO biddingObjectOptionField(auctionSet, auctionName, BiddingObjectSet, BiddingObjectName, optionName, fieldName, fieldType, len, value) VALUES (" 
+				+ key + "," + w.quote(fieldIter->ownerName) + "," + w.quote(fieldIter->fieldName) + "," 
+				+ w.quote(fieldIter->fieldType) + "," + w.quote(fieldIter->len) + "," + w.quote(fieldIter->value) + ")");
+	}
+#endif
+
+}
+
 void BiddingObject::save_ver4(pqxx::connection_base &c)
 {
 
@@ -593,62 +806,15 @@ void BiddingObject::save_ver4(pqxx::connection_base &c)
 										getName().c_str());
 #endif
 
+	biddingObjectRecord_t record;
+	getRecord(record);
 	
 	// Create a transaction object.
 	pqxx::work w(c);
 
 	try{
-		prepare_insert_biddingObjectHdr(c);
-		prepare_insert_biddingObjectElement(c);
-		prepare_insert_biddingObjectElementField(c);
-		prepare_insert_biddingObjectOption(c);
-		prepare_insert_biddingObjectOptionField(c);
-		
-#ifdef DEBUG
-		log->dlog(ch, "after preparing" );
-#endif
-		
-		
-		std::string biddingObjectTypeStr = ipap_object_type_names[getType()];
-		std::string biddingtypeStateStr = AuctionObjectStateNames[getState()];
-
-		pqxx::result r = w.prepared("insertBO_HDR")(auctionSet)(auctionName)(getSet())(getName())(sessionId)(biddingObjectTypeStr)(biddingtypeStateStr).exec();
-		
-#ifdef DEBUG
-		log->dlog(ch, "after header" );
-#endif
-		
-		elementListIter_t iter;
-		for (iter = elementList.begin(); iter != elementList.end(); ++iter ){
-
-			r = w.prepared("insertBO_ELEMENT")(auctionSet)(auctionName)(getSet())(getName())(iter->first).exec();
-			fieldListIter_t fieldIter;
-			
-			for (fieldIter = (iter->second).begin(); fieldIter != iter->second.end(); ++fieldIter)
-			{
-				r = w.prepared("insertBO_ELEMENTFIELD")(auctionSet)(auctionName)(getSet())(getName())(iter->first)(fieldIter->name)(fieldIter->type)(fieldIter->len)(((fieldIter->value)[0]).getValue()).exec();
-			}
-
-		}
-		
-#ifdef DEBUG
-		log->dlog(ch, "after elements" );
-#endif
-			
-		optionListIter_t iterOpt;
-		for (iterOpt = optionList.begin(); iterOpt != optionList.end(); ++iterOpt ){
-
-			r = w.prepared("insertBO_OPTION")(auctionSet)(auctionName)(getSet())(getName())(iterOpt->first).exec();
-
-			fieldListIter_t fieldIter;
-		
-			for (fieldIter = (iterOpt->second).begin(); fieldIter != iterOpt->second.end(); ++fieldIter)
-			{
-				r = w.prepared("insertBO_OPTIONFIELD")(auctionSet)(auctionName)(getSet())(getName())(iterOpt->first)(fieldIter->name)(fieldIter->type)(fieldIter->len)(((fieldIter->value)[0]).getValue()).exec();
-			}
-
-		}
-		
+		prepare_insert_record(c);
+		save_record(w, record);
 		w.commit();
 	
 	} catch (const pqxx::pqxx_exception & ex) {
@@ -735,10 +901,10 @@ BiddingObject::setAuctionSet(string _auctionset)
 	auctionSet = _auctionset; 
 }	
 
-string 
+const string &
 BiddingObject::getAuctionSet()
 { 
-	return auctionSet; 
+	return auctionSet.str(); 
 }
 
 void 
@@ -747,8 +913,8 @@ BiddingObject::setAuctionName(string _auctionName)
 	auctionName = _auctionName; 
 }
 
-string 
+const string &
 BiddingObject::getAuctionName()
 { 
-	return auctionName; 
+	return auctionName.str(); 
 }
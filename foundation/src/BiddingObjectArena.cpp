@@ -0,0 +1,229 @@
+/*! \file   BiddingObjectArena.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Region allocator for bidding objects of an auction interval.
+
+    $Id: BiddingObjectArena.cpp 748 2015-07-23 15:30:00Z amarentes $
+*/
+
+#include "BiddingObjectArena.h"
+
+using namespace auction;
+
+//! alignment of the chunks handed out
+#define ARENA_ALIGN(x)  (((x) + 15) & ~((size_t) 15))
+
+//! space taken by the chunk header
+#define ARENA_HDR_SIZE  ARENA_ALIGN(sizeof(arenaChunk_t))
+
+//! header of the memory given
+#define ARENA_CHUNK(p)  ((arenaChunk_t *) (((char *) (p)) - ARENA_HDR_SIZE))
+
+
+__thread BiddingObjectArena *BiddingObjectArena::current = NULL;
+
+
+/* ------------------------- BiddingObjectArena ------------------------- */
+
+BiddingObjectArena::BiddingObjectArena(time_t _start, size_t _blockSize)
+	: start(_start), blockSize(_blockSize), refs(1), bytes(0)
+{
+	if (blockSize < ARENA_HDR_SIZE * 2) {
+		blockSize = ARENA_HDR_SIZE * 2;
+	}
+}
+
+
+/* ------------------------- ~BiddingObjectArena ------------------------- */
+
+BiddingObjectArena::~BiddingObjectArena()
+{
+	// Every object is retired, the ones not deleted are destroyed here.
+	// Their container nodes are in the blocks, so freeing them costs nothing.
+	for (arenaObjectListIter_t iter = objects.begin(); iter != objects.end(); ++iter) {
+		arenaChunk_t *chunk = ARENA_CHUNK(*iter);
+		if (chunk->destroy != NULL) {
+			arenaDestroy_t destroy = chunk->destroy;
+			chunk->destroy = NULL;
+			destroy(*iter);
+		}
+	}
+
+	for (arenaBlockListIter_t iter = blocks.begin(); iter != blocks.end(); ++iter) {
+		free(iter->data);
+	}
+
+	if (current == this) {
+		current = NULL;
+	}
+}
+
+
+/* ------------------------- addBlock ------------------------- */
+
+arenaBlock_t *BiddingObjectArena::addBlock(size_t size)
+{
+	arenaBlock_t block;
+
+	block.size = (size > blockSize) ? size : blockSize;
+	block.used = 0;
+	block.data = (char *) malloc(block.size);
+	if (block.data == NULL) {
+		throw Error("arena: could not allocate a block of %lu bytes",
+						(unsigned long) block.size);
+	}
+
+	blocks.push_back(block);
+	return &blocks.back();
+}
+
+
+/* ------------------------- carve ------------------------- */
+
+void *BiddingObjectArena::carve(size_t size, arenaDestroy_t destroy)
+{
+	size_t needed = ARENA_HDR_SIZE + ARENA_ALIGN(size);
+	arenaBlock_t *block = NULL;
+
+	if (!blocks.empty() && (blocks.back().size - blocks.back().used >= needed)) {
+		block = &blocks.back();
+	} else {
+		block = addBlock(needed);
+	}
+
+	arenaChunk_t *chunk = (arenaChunk_t *) (block->data + block->used);
+	chunk->arena = this;
+	chunk->destroy = destroy;
+
+	block->used += needed;
+	bytes += needed;
+
+	void *ptr = ((char *) chunk) + ARENA_HDR_SIZE;
+	if (destroy != NULL) {
+		objects.push_back(ptr);
+		__sync_fetch_and_add(&refs, 1);
+	}
+
+	return ptr;
+}
+
+
+/* ------------------------- unref ------------------------- */
+
+void BiddingObjectArena::unref()
+{
+	if (__sync_sub_and_fetch(&refs, 1) == 0) {
+		delete this;
+	}
+}
+
+
+/* ------------------------- close ------------------------- */
+
+void BiddingObjectArena::close()
+{
+	if (current == this) {
+		current = NULL;
+	}
+
+	unref();
+}
+
+
+/* ------------------------- allocate ------------------------- */
+
+void *BiddingObjectArena::allocate(size_t size, arenaDestroy_t destroy)
+{
+	if (current != NULL) {
+		return current->carve(size, destroy);
+	}
+
+	arenaChunk_t *chunk = (arenaChunk_t *) malloc(ARENA_HDR_SIZE + size);
+	if (chunk == NULL) {
+		throw std::bad_alloc();
+	}
+
+	chunk->arena = NULL;
+	chunk->destroy = destroy;
+	return ((char *) chunk) + ARENA_HDR_SIZE;
+}
+
+
+/* ------------------------- deallocate ------------------------- */
+
+void BiddingObjectArena::deallocate(void *ptr)
+{
+	if (ptr == NULL) {
+		return;
+	}
+
+	arenaChunk_t *chunk = ARENA_CHUNK(ptr);
+	if (chunk->arena == NULL) {
+		free(chunk);
+	} else if (chunk->destroy != NULL) {
+		// an object deleted, it must not be destroyed again on release.
+		chunk->destroy = NULL;
+		((BiddingObjectArena *) chunk->arena)->unref();
+	}
+	// container nodes go with the blocks.
+}
+
+
+/* ------------------------- retire ------------------------- */
+
+void BiddingObjectArena::retire(void *ptr)
+{
+	if (ptr == NULL) {
+		return;
+	}
+
+	arenaChunk_t *chunk = ARENA_CHUNK(ptr);
+	if (chunk->arena == NULL) {
+		if (chunk->destroy != NULL) {
+			chunk->destroy(ptr);
+		}
+		free(chunk);
+	} else {
+		((BiddingObjectArena *) chunk->arena)->unref();
+	}
+}
+
+
+/* ------------------------- getArena ------------------------- */
+
+BiddingObjectArena *BiddingObjectArena::getArena(void *ptr)
+{
+	return (BiddingObjectArena *) ARENA_CHUNK(ptr)->arena;
+}
+
+
+/* ------------------------- getInfo ------------------------- */
+
+string BiddingObjectArena::getInfo()
+{
+	ostringstream s;
+
+	s << "<arena start=\"" << start << "\" objects=\"" << objects.size()
+	  << "\" refs=\"" << __sync_fetch_and_add(&refs, 0) << "\" blocks=\""
+	  << blocks.size() << "\" bytes=\"" << bytes << "\"/>";
+
+	return s.str();
+}
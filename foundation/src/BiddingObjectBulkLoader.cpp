@@ -0,0 +1,320 @@
+/*! \file   BiddingObjectBulkLoader.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Load batches of bidding objects with the COPY protocol.
+
+    $Id: BiddingObjectBulkLoader.cpp 748 2015-08-11 09:10:00Z amarentes $
+*/
+
+#include "config.h"
+#include "BiddingObjectBulkLoader.h"
+#include <pqxx/pqxx>
+
+using namespace auction;
+
+
+static const char *TABLE_NAMES[] = { "biddingObjectHdr",
+                                     "biddingObjectElement",
+                                     "biddingObjectElementField",
+                                     "biddingObjectOption",
+                                     "biddingObjectOptionField" };
+
+static const char *HDR_COLUMNS[] = { "auctionSet", "auctionName", "BiddingObjectSet",
+                                     "BiddingObjectName", "sessionId", "biddingObjectType",
+                                     "biddingobjectstatus", NULL };
+
+static const char *ELEMENT_COLUMNS[] = { "auctionSet", "auctionName", "BiddingObjectSet",
+                                         "BiddingObjectName", "elementName", NULL };
+
+static const char *ELEMENTFIELD_COLUMNS[] = { "auctionSet", "auctionName", "BiddingObjectSet",
+                                              "BiddingObjectName", "elementName", "fieldName",
+                                              "fieldType", "len", "value", NULL };
+
+static const char *OPTION_COLUMNS[] = { "auctionSet", "auctionName", "BiddingObjectSet",
+                                        "BiddingObjectName", "optionName", NULL };
+
+static const char *OPTIONFIELD_COLUMNS[] = { "auctionSet", "auctionName", "BiddingObjectSet",
+                                             "BiddingObjectName", "optionName", "fieldName",
+                                             "fieldType", "len", "value", NULL };
+
+static const char *SUMMARY_TABLE_NAME = "auctionSummary";
+
+static const char *SUMMARY_COLUMNS[] = { "auctionSet", "auctionName", "startTime", "stopTime",
+                                         "demand", "quantitySold", "clearingPrice", "numBids",
+                                         "numAllocations", "executionTime", NULL };
+
+//! types of the summary columns, in the same order.
+static const char *SUMMARY_COLUMN_TYPES[] = { "VARCHAR(100) NOT NULL", "VARCHAR(100) NOT NULL",
+                                              "BIGINT", "BIGINT", "DOUBLE PRECISION",
+                                              "DOUBLE PRECISION", "DOUBLE PRECISION", "INTEGER",
+                                              "INTEGER", "BIGINT", NULL };
+
+static const char **TABLE_COLUMNS[] = { HDR_COLUMNS, ELEMENT_COLUMNS, ELEMENTFIELD_COLUMNS,
+                                        OPTION_COLUMNS, OPTIONFIELD_COLUMNS };
+
+
+//! column lists, built before any writer thread starts.
+static struct tableColumns_t
+{
+	vector<string> columns[BO_NUM_TABLES];
+	vector<string> summaryColumns;
+
+	tableColumns_t()
+	{
+		for (int t = 0; t < BO_NUM_TABLES; t++) {
+			for (const char **name = TABLE_COLUMNS[t]; *name != NULL; name++) {
+				columns[t].push_back(*name);
+			}
+		}
+
+		for (const char **name = SUMMARY_COLUMNS; *name != NULL; name++) {
+			summaryColumns.push_back(*name);
+		}
+	}
+} tableColumns;
+
+
+//! start a row with the key columns shared by every table.
+static bulkRow_t &newRow(const biddingObjectRecord_t &record, bulkRowList_t &rows)
+{
+	rows.push_back(bulkRow_t());
+
+	bulkRow_t &row = rows.back();
+	row.reserve(9);
+	row.push_back(record.auctionSet);
+	row.push_back(record.auctionName);
+	row.push_back(record.set);
+	row.push_back(record.name);
+	return row;
+}
+
+//! text form of a number as written in a row.
+template <class T>
+static string toString(T value)
+{
+	ostringstream s;
+	s.precision(15);
+	s << value;
+	return s.str();
+}
+
+//! append a row per field.
+static void appendFieldRows(const biddingObjectRecord_t &record,
+							const biddingObjectFieldRecordList_t &fields,
+							bulkRowList_t &rows)
+{
+	biddingObjectFieldRecordListConstIter_t iter;
+	for (iter = fields.begin(); iter != fields.end(); ++iter) {
+		bulkRow_t &row = newRow(record, rows);
+		row.push_back(iter->ownerName);
+		row.push_back(iter->fieldName);
+		row.push_back(iter->fieldType);
+
+		row.push_back(toString(iter->len));
+
+		row.push_back(iter->value);
+	}
+}
+
+
+/* ------------------------- getTableName ------------------------- */
+
+const char *BiddingObjectBulkLoader::getTableName(biddingObjectTable_t table)
+{
+	return TABLE_NAMES[table];
+}
+
+
+/* ------------------------- getColumns ------------------------- */
+
+const vector<string> &BiddingObjectBulkLoader::getColumns(biddingObjectTable_t table)
+{
+	return tableColumns.columns[table];
+}
+
+
+/* ------------------------- appendRows ------------------------- */
+
+void BiddingObjectBulkLoader::appendRows(const biddingObjectRecord_t &record,
+										 biddingObjectTable_t table, bulkRowList_t &rows)
+{
+	vector<string>::const_iterator iter;
+
+	switch (table) {
+	case BO_TABLE_HDR:
+		{
+			bulkRow_t &row = newRow(record, rows);
+			row.push_back(record.sessionId);
+			row.push_back(record.type);
+			row.push_back(record.state);
+		}
+		break;
+	case BO_TABLE_ELEMENT:
+		for (iter = record.elements.begin(); iter != record.elements.end(); ++iter) {
+			newRow(record, rows).push_back(*iter);
+		}
+		break;
+	case BO_TABLE_ELEMENTFIELD:
+		appendFieldRows(record, record.elementFields, rows);
+		break;
+	case BO_TABLE_OPTION:
+		for (iter = record.options.begin(); iter != record.options.end(); ++iter) {
+			newRow(record, rows).push_back(*iter);
+		}
+		break;
+	case BO_TABLE_OPTIONFIELD:
+		appendFieldRows(record, record.optionFields, rows);
+		break;
+	default:
+		throw Error("unknown bidding object table %d", (int) table);
+	}
+}
+
+
+/* ------------------------- load ------------------------- */
+
+void BiddingObjectBulkLoader::load(pqxx::work &w, const biddingObjectRecordBatch_t &batch,
+								   const string &suffix)
+{
+	try {
+
+		// Only one COPY can be open in a transaction, tables go one by one.
+		for (int t = 0; t < BO_NUM_TABLES; t++) {
+			biddingObjectTable_t table = (biddingObjectTable_t) t;
+
+			bulkRowList_t rows;
+			biddingObjectRecordBatchConstIter_t iter;
+			for (iter = batch.begin(); iter != batch.end(); ++iter) {
+				appendRows(**iter, table, rows);
+			}
+
+			if (rows.empty()) {
+				continue;
+			}
+
+			const vector<string> &columns = getColumns(table);
+			pqxx::tablewriter writer(w, getTableName(table) + suffix, columns.begin(),
+									 columns.end());
+
+			for (bulkRowListIter_t row = rows.begin(); row != rows.end(); ++row) {
+				writer << *row;
+			}
+
+			writer.complete();
+		}
+
+	} catch (const pqxx::pqxx_exception &ex) {
+		throw Error(ex.base().what());
+	}
+}
+
+
+/* ------------------------- getSummaryTableName ------------------------- */
+
+const char *BiddingObjectBulkLoader::getSummaryTableName()
+{
+	return SUMMARY_TABLE_NAME;
+}
+
+
+/* ------------------------- getSummaryColumns ------------------------- */
+
+const vector<string> &BiddingObjectBulkLoader::getSummaryColumns()
+{
+	return tableColumns.summaryColumns;
+}
+
+
+/* ------------------------- createSummaryTable ------------------------- */
+
+void BiddingObjectBulkLoader::createSummaryTable(pqxx::connection &conn)
+{
+	string columns;
+	for (int i = 0; SUMMARY_COLUMNS[i] != NULL; i++) {
+		columns += string((i > 0) ? ", " : "") + SUMMARY_COLUMNS[i] + " " + 
+				   SUMMARY_COLUMN_TYPES[i];
+	}
+
+	try {
+
+		pqxx::work w(conn);
+		w.exec(string("CREATE TABLE IF NOT EXISTS ") + SUMMARY_TABLE_NAME + " (" + columns + ")");
+		w.commit();
+
+	} catch (const pqxx::pqxx_exception &ex) {
+		throw Error("cannot create table %s: %s", SUMMARY_TABLE_NAME, ex.base().what());
+	}
+}
+
+
+/* ------------------------- appendSummaryRow ------------------------- */
+
+void BiddingObjectBulkLoader::appendSummaryRow(const auctionSummaryRecord_t &summary,
+											   bulkRowList_t &rows)
+{
+	rows.push_back(bulkRow_t());
+
+	bulkRow_t &row = rows.back();
+	row.reserve(10);
+	row.push_back(summary.auctionSet);
+	row.push_back(summary.auctionName);
+	row.push_back(toString(summary.start));
+	row.push_back(toString(summary.stop));
+	row.push_back(toString(summary.demand));
+	row.push_back(toString(summary.quantitySold));
+	row.push_back(toString(summary.clearingPrice));
+	row.push_back(toString(summary.bids));
+	row.push_back(toString(summary.allocations));
+	row.push_back(toString(summary.executionTime));
+}
+
+
+/* ------------------------- loadSummaries ------------------------- */
+
+void BiddingObjectBulkLoader::loadSummaries(pqxx::work &w, const auctionSummaryBatch_t &batch,
+											const string &suffix)
+{
+	if (batch.empty()) {
+		return;
+	}
+
+	try {
+
+		const vector<string> &columns = getSummaryColumns();
+		pqxx::tablewriter writer(w, getSummaryTableName() + suffix, columns.begin(),
+								 columns.end());
+
+		bulkRowList_t rows;
+		auctionSummaryBatchConstIter_t iter;
+		for (iter = batch.begin(); iter != batch.end(); ++iter) {
+			appendSummaryRow(**iter, rows);
+		}
+
+		for (bulkRowListIter_t row = rows.begin(); row != rows.end(); ++row) {
+			writer << *row;
+		}
+
+		writer.complete();
+
+	} catch (const pqxx::pqxx_exception &ex) {
+		throw Error(ex.base().what());
+	}
+}
@@ -0,0 +1,506 @@
+/*! \file   BiddingObjectJournal.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Local append only journal of done bidding objects and allocations.
+
+    $Id: BiddingObjectJournal.cpp 748 2015-08-13 16:40:00Z amarentes $
+*/
+
+#include "config.h"
+#include "BiddingObjectJournal.h"
+#include <fcntl.h>
+
+using namespace auction;
+
+
+/* ------------------------- encoding helpers ------------------------- */
+
+static void putFields(string &out, const biddingObjectFieldRecordList_t &fields)
+{
+	putU32(out, fields.size());
+
+	biddingObjectFieldRecordListConstIter_t iter;
+	for (iter = fields.begin(); iter != fields.end(); ++iter) {
+		putString(out, iter->ownerName);
+		putString(out, iter->fieldName);
+		putString(out, iter->fieldType);
+		putU32(out, (uint32_t) iter->len);
+		putString(out, iter->value);
+	}
+}
+
+static bool getFields(recordReader &r, biddingObjectFieldRecordList_t &values)
+{
+	uint32_t n;
+	if (!r.u32(n)) {
+		return false;
+	}
+	for (uint32_t i = 0; i < n; i++) {
+		biddingObjectFieldRecord_t field;
+		uint32_t len;
+		if (!r.str(field.ownerName) || !r.str(field.fieldName) || !r.str(field.fieldType) ||
+			!r.u32(len) || !r.str(field.value)) {
+			return false;
+		}
+		field.len = (int) len;
+		values.push_back(field);
+	}
+	return true;
+}
+
+
+/* ------------------------- encode ------------------------- */
+
+void BiddingObjectJournal::encode(const biddingObjectRecord_t &record, string &payload)
+{
+	payload.push_back((char) JOURNAL_BIDDING_OBJECT);
+	putString(payload, record.auctionSet);
+	putString(payload, record.auctionName);
+	putString(payload, record.set);
+	putString(payload, record.name);
+	putString(payload, record.sessionId);
+	putString(payload, record.type);
+	putString(payload, record.state);
+	putStrings(payload, record.elements);
+	putFields(payload, record.elementFields);
+	putStrings(payload, record.options);
+	putFields(payload, record.optionFields);
+}
+
+
+/* ------------------------- decode ------------------------- */
+
+bool BiddingObjectJournal::decode(const string &payload, biddingObjectRecord_t &record)
+{
+	if (payload.empty() || (payload[0] != (char) JOURNAL_BIDDING_OBJECT)) {
+		return false;
+	}
+
+	recordReader r(payload);
+	r.pos = 1;
+
+	return r.str(record.auctionSet) && r.str(record.auctionName) &&
+		   r.str(record.set) && r.str(record.name) && r.str(record.sessionId) &&
+		   r.str(record.type) && r.str(record.state) &&
+		   r.strings(record.elements) && getFields(r, record.elementFields) &&
+		   r.strings(record.options) && getFields(r, record.optionFields) &&
+		   r.atEnd();
+}
+
+
+/* ------------------------- encode ------------------------- */
+
+void BiddingObjectJournal::encode(const auctionSummaryRecord_t &summary, string &payload)
+{
+	payload.push_back((char) JOURNAL_AUCTION_SUMMARY);
+	putString(payload, summary.auctionSet);
+	putString(payload, summary.auctionName);
+	putU64(payload, (uint64_t) summary.start);
+	putU64(payload, (uint64_t) summary.stop);
+	putDouble(payload, summary.demand);
+	putDouble(payload, summary.quantitySold);
+	putDouble(payload, summary.clearingPrice);
+	putU32(payload, summary.bids);
+	putU32(payload, summary.allocations);
+	putU64(payload, summary.executionTime);
+}
+
+
+/* ------------------------- decode ------------------------- */
+
+bool BiddingObjectJournal::decode(const string &payload, auctionSummaryRecord_t &summary)
+{
+	if (payload.empty() || (payload[0] != (char) JOURNAL_AUCTION_SUMMARY)) {
+		return false;
+	}
+
+	recordReader r(payload);
+	r.pos = 1;
+
+	uint64_t start, stop, executionTime;
+	uint32_t bids, allocations;
+
+	if (!(r.str(summary.auctionSet) && r.str(summary.auctionName) &&
+		  r.u64(start) && r.u64(stop) && r.dbl(summary.demand) &&
+		  r.dbl(summary.quantitySold) && r.dbl(summary.clearingPrice) &&
+		  r.u32(bids) && r.u32(allocations) && r.u64(executionTime) &&
+		  r.atEnd())) {
+		return false;
+	}
+
+	summary.start = (time_t) start;
+	summary.stop = (time_t) stop;
+	summary.bids = bids;
+	summary.allocations = allocations;
+	summary.executionTime = (unsigned long) executionTime;
+	return true;
+}
+
+
+/* ------------------------- BiddingObjectJournal ------------------------- */
+
+BiddingObjectJournal::BiddingObjectJournal(string _fileName, unsigned int _syncEvery,
+										   unsigned int _syncInterval)
+  : fileName(_fileName), fd(-1), syncEvery(_syncEvery), syncInterval(_syncInterval),
+    pending(0), appended(0), syncs(0), threaded(0)
+{
+	log = Logger::getInstance();
+	ch = log->createChannel("BiddingObjectJournal");
+
+	fd = ::open(fileName.c_str(), O_RDWR | O_CREAT | O_APPEND, 0640);
+	if (fd < 0) {
+		throw Error("cannot open journal %s: %s", fileName.c_str(), strerror(errno));
+	}
+
+	char header[JOURNAL_HEADER_LEN];
+	ssize_t n = ::pread(fd, header, JOURNAL_HEADER_LEN, 0);
+
+	// A header cut short by a crash while the journal was created.
+	if ((n > 0) && (n < (ssize_t) JOURNAL_HEADER_LEN) &&
+		(memcmp(header, JOURNAL_MAGIC, min((size_t) n, (size_t) 4)) == 0)) {
+		log->wlog(ch, "incomplete header in %s, the journal is started again", 
+				  fileName.c_str());
+		if (ftruncate(fd, 0) != 0) {
+			int err = errno;
+			::close(fd);
+			throw Error("cannot truncate journal %s: %s", fileName.c_str(), strerror(err));
+		}
+		n = 0;
+	}
+
+	if (n == 0) {
+		string h(JOURNAL_MAGIC, 4);
+		putU32(h, JOURNAL_VERSION);
+		if (::write(fd, h.data(), h.size()) != (ssize_t) h.size()) {
+			int err = errno;
+			::close(fd);
+			throw Error("cannot write journal %s: %s", fileName.c_str(), strerror(err));
+		}
+	} else if ((n != (ssize_t) JOURNAL_HEADER_LEN) || (memcmp(header, JOURNAL_MAGIC, 4) != 0) ||
+			   (getU32(header + 4) != JOURNAL_VERSION)) {
+		::close(fd);
+		throw Error("%s is not a bidding object journal", fileName.c_str());
+	} else {
+		// New entries must follow the last valid one, or the reader would
+		// stop at the damaged entry before reaching them.
+		try {
+			BiddingObjectJournalReader reader(fileName);
+			biddingObjectRecord_t record;
+			auctionSummaryRecord_t summary;
+
+			while (reader.next(record, summary) != JOURNAL_END) {
+				record = biddingObjectRecord_t();
+			}
+
+			if (reader.isCorrupt()) {
+				log->wlog(ch, "damaged entry at offset %lu of %s, the rest is dropped",
+						  reader.getOffset(), fileName.c_str());
+				if (ftruncate(fd, reader.getOffset()) != 0) {
+					throw Error("cannot truncate journal %s: %s", fileName.c_str(),
+								strerror(errno));
+				}
+			}
+		} catch (Error &e) {
+			::close(fd);
+			throw e;
+		}
+	}
+
+	gettimeofday(&lastSync, NULL);
+
+#ifdef ENABLE_THREADS
+	threaded = 1;
+	mutexInit(&maccess);
+#endif
+
+}
+
+
+/* ------------------------- ~BiddingObjectJournal ------------------------- */
+
+BiddingObjectJournal::~BiddingObjectJournal()
+{
+	doSync();
+	::close(fd);
+
+#ifdef ENABLE_THREADS
+	mutexDestroy(&maccess);
+#endif
+
+}
+
+
+/* ------------------------- append ------------------------- */
+
+void BiddingObjectJournal::append(const biddingObjectRecord_t &record)
+{
+	string payload;
+	encode(record, payload);
+	appendPayload(payload);
+}
+
+
+/* ------------------------- append ------------------------- */
+
+void BiddingObjectJournal::append(const auctionSummaryRecord_t &summary)
+{
+	string payload;
+	encode(summary, payload);
+	appendPayload(payload);
+}
+
+
+/* ------------------------- appendPayload ------------------------- */
+
+void BiddingObjectJournal::appendPayload(const string &payload)
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	putU32(buffer, payload.size());
+	putU32(buffer, recordCrc32(payload.data(), payload.size()));
+	buffer.append(payload);
+
+	appended++;
+	pending++;
+
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	unsigned long elapsed = (now.tv_sec - lastSync.tv_sec) * 1000 +
+							(now.tv_usec - lastSync.tv_usec) / 1000;
+
+	if ((pending >= syncEvery) || (elapsed >= syncInterval)) {
+		doSync();
+	}
+}
+
+
+/* ------------------------- sync ------------------------- */
+
+void BiddingObjectJournal::sync()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	doSync();
+}
+
+
+/* ------------------------- doSync ------------------------- */
+
+void BiddingObjectJournal::doSync()
+{
+	if (buffer.empty()) {
+		return;
+	}
+
+	size_t done = 0;
+	while (done < buffer.size()) {
+		ssize_t n = ::write(fd, buffer.data() + done, buffer.size() - done);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			// Keep what was not written, it is retried on the next sync.
+			buffer.erase(0, done);
+			log->elog(ch, "cannot write journal %s: %s", fileName.c_str(), strerror(errno));
+			return;
+		}
+		done += n;
+	}
+
+	buffer.clear();
+
+	fdatasync(fd);
+	syncs++;
+	pending = 0;
+	gettimeofday(&lastSync, NULL);
+}
+
+
+/* ------------------------- getNumAppended ------------------------- */
+
+unsigned long BiddingObjectJournal::getNumAppended()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	return appended;
+}
+
+
+/* ------------------------- getNumSyncs ------------------------- */
+
+unsigned long BiddingObjectJournal::getNumSyncs()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	return syncs;
+}
+
+
+/* ------------------------- BiddingObjectJournalReader ------------------------- */
+
+BiddingObjectJournalReader::BiddingObjectJournalReader(string _fileName)
+  : fileName(_fileName), offset(0), entries(0), corrupt(false), lastOffset(0), lastCrc(0)
+{
+	in.open(fileName.c_str(), ios::in | ios::binary);
+	if (!in) {
+		throw Error("cannot open journal %s", fileName.c_str());
+	}
+
+	char header[JOURNAL_HEADER_LEN];
+	in.read(header, JOURNAL_HEADER_LEN);
+	if ((in.gcount() != (streamsize) JOURNAL_HEADER_LEN) ||
+		(memcmp(header, JOURNAL_MAGIC, 4) != 0) ||
+		(getU32(header + 4) != JOURNAL_VERSION)) {
+		throw Error("%s is not a bidding object journal", fileName.c_str());
+	}
+
+	offset = JOURNAL_HEADER_LEN;
+}
+
+
+/* ------------------------- ~BiddingObjectJournalReader ------------------------- */
+
+BiddingObjectJournalReader::~BiddingObjectJournalReader()
+{
+	in.close();
+}
+
+
+/* ------------------------- next ------------------------- */
+
+journalEntry_t BiddingObjectJournalReader::next(biddingObjectRecord_t &record,
+												auctionSummaryRecord_t &summary)
+{
+	if (corrupt) {
+		return JOURNAL_END;
+	}
+
+	char header[JOURNAL_ENTRY_HEADER_LEN];
+	in.read(header, JOURNAL_ENTRY_HEADER_LEN);
+
+	if (in.gcount() == 0) {
+		return JOURNAL_END;	// clean end
+	}
+
+	if (in.gcount() != (streamsize) JOURNAL_ENTRY_HEADER_LEN) {
+		corrupt = true;
+		return JOURNAL_END;
+	}
+
+	uint32_t len = getU32(header);
+	uint32_t crc = getU32(header + 4);
+
+	if ((len == 0) || (len > JOURNAL_MAX_ENTRY_LEN)) {
+		corrupt = true;
+		return JOURNAL_END;
+	}
+
+	string payload(len, '\0');
+	in.read(&payload[0], len);
+
+	if ((in.gcount() != (streamsize) len) ||
+		(recordCrc32(payload.data(), len) != crc)) {
+		corrupt = true;
+		return JOURNAL_END;
+	}
+
+	journalEntry_t type = (journalEntry_t) payload[0];
+	bool valid = false;
+
+	switch (type) {
+	case JOURNAL_BIDDING_OBJECT:
+		valid = BiddingObjectJournal::decode(payload, record);
+		break;
+	case JOURNAL_AUCTION_SUMMARY:
+		valid = BiddingObjectJournal::decode(payload, summary);
+		break;
+	default:
+		break;
+	}
+
+	if (!valid) {
+		corrupt = true;
+		return JOURNAL_END;
+	}
+
+	lastOffset = offset;
+	lastCrc = crc;
+
+	offset += JOURNAL_ENTRY_HEADER_LEN + len;
+	entries++;
+	return type;
+}
+
+
+/* ------------------------- next ------------------------- */
+
+bool BiddingObjectJournalReader::next(biddingObjectRecord_t &record)
+{
+	auctionSummaryRecord_t summary;
+	journalEntry_t type;
+
+	while ((type = next(record, summary)) == JOURNAL_AUCTION_SUMMARY);
+
+	return (type == JOURNAL_BIDDING_OBJECT);
+}
+
+
+/* ------------------------- resume ------------------------- */
+
+bool BiddingObjectJournalReader::resume(unsigned long entryOffset, uint32_t crc)
+{
+	biddingObjectRecord_t record;
+	auctionSummaryRecord_t summary;
+
+	if (entryOffset >= JOURNAL_HEADER_LEN) {
+		in.clear();
+		in.seekg(entryOffset);
+		offset = entryOffset;
+		corrupt = false;
+
+		if (in && (next(record, summary) != JOURNAL_END) && (lastCrc == crc)) {
+			entries = 0;
+			return true;
+		}
+	}
+
+	// Not the entry the position was taken at, the journal was replaced.
+	in.clear();
+	in.seekg(JOURNAL_HEADER_LEN);
+	offset = JOURNAL_HEADER_LEN;
+	entries = 0;
+	corrupt = false;
+	lastOffset = 0;
+	lastCrc = 0;
+	return false;
+}
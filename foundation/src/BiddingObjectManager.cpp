@@ -31,20 +31,41 @@
 #include "ParserFcts.h"
 #include "BiddingObjectManager.h"
 #include "Constants.h"
+#include "Timeval.h"
 #include <pqxx/pqxx>
 
 using namespace auction;
 
 /* ------------------------- BiddingObjectManager ------------------------- */
 
-BiddingObjectManager::BiddingObjectManager( int domain, string fdname, string fvname, string connectionDB) 
-    : AuctioningObjectManager(domain, fdname, fvname, "BiddingObjectManager"), connectionDBStr(connectionDB)
+BiddingObjectManager::BiddingObjectManager( int domain, string fdname, string fvname, string connectionDB,
+                                            string journalFile, unsigned long archiveInterval,
+                                            unsigned long archiveRetention, bool archiveDetach) 
+    : AuctioningObjectManager(domain, fdname, fvname, "BiddingObjectManager"), connectionDBStr(connectionDB),
+	  pool(NULL), writer(NULL), journal(NULL), partitions(NULL)
 {
         
 #ifdef DEBUG
     log->dlog(ch,"Starting");
 #endif
 
+    // First, it throws if the interval is not valid.
+    if (!connectionDBStr.empty() && (archiveInterval > 0)) {
+        partitions = new ArchivePartitions(archiveInterval, ARCHIVE_PARTITIONS_AHEAD,
+                                           archiveRetention, archiveDetach);
+    }
+
+    if (!journalFile.empty()) {
+        journal = new BiddingObjectJournal(journalFile, JOURNAL_SYNC_EVERY, 
+                                           JOURNAL_SYNC_INTERVAL);
+    }
+
+    if (!connectionDBStr.empty()) {
+        pool = new DBConnectionPool(connectionDBStr, DB_POOL_SIZE, DB_POOL_CHECK_IDLE);
+        writer = new BiddingObjectWriter(pool, DB_WRITER_QUEUE_SIZE, 
+                                         DB_WRITER_BATCH_SIZE, journal, partitions);
+    }
+
 
 }
 
@@ -58,6 +79,20 @@ BiddingObjectManager::~BiddingObjectManager()
     log->dlog(ch,"Shutdown");
 #endif
 
+    // Objects go before the arenas holding them.
+    clearAuctioningObjects();
+
+    for (biddingObjectArenaListIter_t iter = arenas.begin(); iter != arenas.end(); ++iter) {
+        iter->second->close();
+    }
+    arenas.clear();
+
+    // Write what is still queued.
+    saveDelete(writer);
+    saveDelete(pool);
+    saveDelete(journal);
+    saveDelete(partitions);
+
 }
 
 
@@ -239,27 +274,14 @@ void BiddingObjectManager::addBiddingObject(BiddingObject *b)
 		
 		AuctioningObjectManager::addAuctioningObject(b);
 
-		string aSet = b->getAuctionSet();
-		string aName = b->getAuctionName();
+		const InternedString &aSet = b->getAuctionSetHandle();
+		const InternedString &aName = b->getAuctionNameHandle();
 		
-		auctionSetBidIndexIter_t setIter;
-		setIter = bidAuctionSetIndex.find(aSet);
-		if (setIter != bidAuctionSetIndex.end())
-		{
-			auctionBidIndexIter_t actBidIter = (setIter->second).find(aName);
-			if (actBidIter != (setIter->second).end()){
-				(actBidIter->second).push_back(b->getUId());
-			}
-			else{
-				vector<int> listBids;
-				listBids.push_back(b->getUId());
-				bidAuctionSetIndex[aSet][aName] = listBids;
-			}
-		} else {
-			vector<int> listBids;
-			listBids.push_back(b->getUId());
-			bidAuctionSetIndex[aSet][aName] = listBids;
+		vector<int> *listBids = bidAuctionIndex.find(aSet, aName);
+		if (listBids == NULL) {
+			listBids = bidAuctionIndex.insert(aSet, aName, vector<int>());
 		}
+		addToUIdList(*listBids, bidAuctionPositions, b->getUId());
         
 #ifdef DEBUG    
     log->dlog(ch, "finish adding new BiddingObject with name = %s.%s",
@@ -281,14 +303,12 @@ vector<int>
 BiddingObjectManager::getBiddingObjects(string aset, string aname)
 {
 
-    auctionSetBidIndexIter_t iter;
-
-    iter = bidAuctionSetIndex.find(aset);
-    if (iter != bidAuctionSetIndex.end()) {
-        auctionBidIndexIter_t auctionBidIndexIter = (iter->second).find(aname);
-        if (auctionBidIndexIter != (iter->second).end()){
-			return auctionBidIndexIter->second;
-		}
+    InternedString set, name;
+    if (InternedString::find(aset, set) && InternedString::find(aname, name)) {
+        vector<int> *listBids = bidAuctionIndex.find(set, name);
+        if (listBids != NULL) {
+            return *listBids;
+        }
     }
 	
 	vector<int> list_return;
@@ -299,7 +319,7 @@ BiddingObjectManager::getBiddingObjects(string aset, string aname)
 
 /* ------------------------- delBiddingObject ------------------------- */
 
-void BiddingObjectManager::delBiddingObject(BiddingObject *r, EventScheduler *e)
+void BiddingObjectManager::delBiddingObject(BiddingObject *r, EventScheduler *e, bool archive)
 {
 #ifdef DEBUG    
     log->dlog(ch, "removing BiddingObject with name = %s.%s", 
@@ -310,40 +330,26 @@ void BiddingObjectManager::delBiddingObject(BiddingObject *r, EventScheduler *e)
 	
     AuctioningObjectManager::delAuctioningObject(r);
     
-    // Find the corresponding nodes in the auction BiddingObject index and deletes
-	vector<int>::iterator actBidIter;
-	auctionSetBidIndexIter_t setNode;  
-	auctionBidIndexIter_t auctionNode; 
-	
-	setNode = bidAuctionSetIndex.find(r->getAuctionSet());
-	auctionNode = (setNode->second).find(r->getAuctionName());
-		
-	for (actBidIter = (auctionNode->second).begin(); 
-			actBidIter != (auctionNode->second).end(); ++actBidIter){
-					
-		if (*actBidIter == r->getUId()){
-			(auctionNode->second).erase(actBidIter);
-			break;
+    // Find the corresponding node in the auction BiddingObject index and deletes
+	vector<int> *listBids = bidAuctionIndex.find(r->getAuctionSetHandle(), r->getAuctionNameHandle());
+	if (listBids != NULL) {
+		delFromUIdList(*listBids, bidAuctionPositions, r->getUId());
+
+		// delete the auction entry if empty.
+		if (listBids->empty()) {
+			bidAuctionIndex.erase(r->getAuctionSetHandle(), r->getAuctionNameHandle());
 		}
 	}
-		
-	// delete the auction name if empty.
-	auctionNode = (setNode->second).find(r->getAuctionName());
-	if ((auctionNode->second).empty()){
-		bidAuctionSetIndex[r->getAuctionSet()].erase(auctionNode);
-	}
-			
-	// delete BiddingObject auction set if empty
-	setNode = bidAuctionSetIndex.find(r->getAuctionSet());
-	if ((setNode->second).empty()) {
-		bidAuctionSetIndex.erase(setNode);
-	}
 	    
     if (e != NULL) {
         e->delBiddingObjectEvents(r->getUId());
     }
 
-	storeBiddingObjectAsDone(r);
+	if (archive) {
+		storeBiddingObjectAsDone(r);
+	} else {
+		r->setState(AO_DONE);
+	}
 
 }
 
@@ -366,11 +372,11 @@ void BiddingObjectManager::delBiddingObject(int uid, EventScheduler *e)
 
 void BiddingObjectManager::delBiddingObjects(string sname, EventScheduler *e)
 {
-	auctioningObjectIndex_t *objects = getAuctioningObjects(sname);
+	auctioningObjectIndex_t objects = getAuctioningObjects(sname);
 	auctioningObjectIndexIter_t iter;
 	
-    for (auctioningObjectIndexIter_t i = objects->begin(); i != objects->end(); i++) {						
-        BiddingObject *o = dynamic_cast<BiddingObject *>(getAuctioningObject(sname, i->first));
+    for (auctioningObjectIndexIter_t i = objects.begin(); i != objects.end(); i++) {						
+        BiddingObject *o = dynamic_cast<BiddingObject *>(getAuctioningObject(i->second));
         delBiddingObject(o,e);
     }
 }
@@ -387,6 +393,17 @@ BiddingObjectManager::delAuctioningObjects(auctioningObjectDB_t *biddingObjects,
         delBiddingObject(o, e);
     }
 
+    if (writer != NULL) {
+        writer->flush();
+    }
+
+    if (journal != NULL) {
+        journal->sync();
+    }
+
+    // Names, sets and sessions of the removed objects may be gone.
+    StringTable::getInstance()->collectGrown();
+
 }
 
 
@@ -401,40 +418,80 @@ void BiddingObjectManager::storeBiddingObjectAsDone(BiddingObject *r)
 #endif
     
     
-    if ( !connectionDBStr.empty()){
+    r->setState(AO_DONE);
+
+    // Rows are copied, the object may be released before they are written.
+    if (writer != NULL) {
+        writer->push(r);
+    } else if (journal != NULL) {
+        biddingObjectRecord_t record;
+        r->getRecord(record);
+        journal->append(record);
+    }
+}
 
-#ifdef DEBUG    
-		log->dlog(ch, "connection Str = '%s'", connectionDBStr.c_str());
-#endif
-		
-		try
-		{
-			
-			r->setState(AO_DONE);
-			
-			// Store in the database
-			pqxx::connection c(connectionDBStr);
+
+/* -------------------- releaseAuctioningObject -------------------- */
+
+void BiddingObjectManager::releaseAuctioningObject(AuctioningObject *a)
+{
+    BiddingObject::retire(dynamic_cast<BiddingObject *>(a));
+}
+
+
+/* -------------------- getIntervalArena -------------------- */
+
+BiddingObjectArena *BiddingObjectManager::getIntervalArena(time_t t)
+{
+    time_t start = t - (t % BIDDING_OBJECT_ARENA_INTERVAL);
+    time_t now = time(NULL);
+
+    // Past intervals take no more objects.
+    biddingObjectArenaListIter_t iter = arenas.begin();
+    while ((iter != arenas.end()) && 
+           (iter->first + BIDDING_OBJECT_ARENA_INTERVAL <= now) && (iter->first != start)) {
+        iter->second->close();
+        arenas.erase(iter++);
+    }
+
+    iter = arenas.find(start);
+    if (iter != arenas.end()) {
+        return iter->second;
+    }
+
+    BiddingObjectArena *arena = new BiddingObjectArena(start);
+    arenas[start] = arena;
+    return arena;
+}
+
+
+/* -------------------- storeAuctionSummary -------------------- */
+
+void BiddingObjectManager::storeAuctionSummary(const auctionSummaryRecord_t &summary)
+{
 
 #ifdef DEBUG    
-			log->dlog(ch, "database connected");
+    log->dlog(ch, "StoreAuctionSummary auction = %s.%s", summary.auctionSet.c_str(), 
+					summary.auctionName.c_str());
 #endif
 
-#ifdef HAVE_PQXX40
-			r->save_ver4(c);
-#else
-			r->save_ver3(c);
-#endif
-		
-			// release id
-			idSource.freeId(r->getUId());
+    if (writer != NULL) {
+        writer->push(summary);
+    } else if (journal != NULL) {
+        journal->append(summary);
+    }
+}
 
-			// remove rule
-			//saveDelete(r);
-		} catch(const std::exception &e){
-			throw Error("Error connecting to the database %s", e.what());
-		}
 
+/* -------------------- getWriterInfo -------------------- */
+
+string BiddingObjectManager::getWriterInfo()
+{
+	if (writer == NULL) {
+		return string();
 	}
+
+	return writer->getInfo();
 }
 
 
@@ -451,6 +508,29 @@ ipap_message * BiddingObjectManager::get_ipap_message(BiddingObject *biddingObje
 }
 
 
+/* ---------------------- get_ipap_messages ------------------------- */
+vector<ipap_message *> BiddingObjectManager::get_ipap_messages(biddingObjectBatch_t *batch,
+															   ipap_template_container *templates,
+															   unsigned int maxRecords,
+															   const set<uint16_t> *peerTemplates)
+{
+
+	MAPIBiddingObjectParser mbop = MAPIBiddingObjectParser(getDomain());
+
+	return mbop.get_ipap_messages(FieldDefManager::getFieldDefs(), 
+								  batch, templates, maxRecords, peerTemplates );
+}
+
+
+/* ------------------------- getAuctionKeys ------------------------- */
+
+void BiddingObjectManager::getAuctionKeys(ipap_message *message, auctionKeyList_t &auctions)
+{
+	MAPIBiddingObjectParser mbop = MAPIBiddingObjectParser(getDomain());
+	mbop.getAuctionKeys(message, auctions);
+}
+
+
 /* ------------------------- getInfo ------------------------- */
 
 string BiddingObjectManager::getInfo(string sname, string rname)
@@ -500,11 +580,11 @@ string BiddingObjectManager::getInfo(string sname)
 {
     ostringstream s;
 
-	auctioningObjectIndex_t *objects = getAuctioningObjects(sname);
+	auctioningObjectIndex_t objects = getAuctioningObjects(sname);
 	auctioningObjectIndexIter_t iter;
 
-    for (auctioningObjectIndexIter_t i = objects->begin(); i != objects->end(); i++) {						
-        BiddingObject *o = dynamic_cast<BiddingObject *>(getAuctioningObject(sname, i->first));
+    for (auctioningObjectIndexIter_t i = objects.begin(); i != objects.end(); i++) {						
+        BiddingObject *o = dynamic_cast<BiddingObject *>(getAuctioningObject(i->second));
         s << o->getInfo();
     }
     
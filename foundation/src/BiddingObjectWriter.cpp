@@ -0,0 +1,663 @@
+/*! \file   BiddingObjectWriter.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Background writer storing done bidding objects in the database.
+
+    $Id: BiddingObjectWriter.cpp 748 2015-08-10 10:30:00Z amarentes $
+*/
+
+#include "config.h"
+#include "BiddingObjectWriter.h"
+#include "BiddingObjectBulkLoader.h"
+#include "Constants.h"
+#include <pqxx/pqxx>
+
+using namespace auction;
+
+
+/* ------------------------- BiddingObjectWriter ------------------------- */
+
+BiddingObjectWriter::BiddingObjectWriter(DBConnectionPool *_pool, unsigned int _queueSize,
+										 unsigned int _batchSize, 
+										 BiddingObjectJournal *_journal,
+										 ArchivePartitions *_partitions)
+  : pool(_pool), queueSize(_queueSize), batchSize(_batchSize), journal(_journal),
+    partitions(_partitions), summaryTableReady(false), failing(false), lastFailure(0), threaded(0), 
+    stopping(0)
+{
+	log = Logger::getInstance();
+	ch = log->createChannel("BiddingObjectWriter");
+
+	memset(&stats, 0, sizeof(stats));
+
+	if (batchSize == 0) {
+		batchSize = 1;
+	}
+
+	if (queueSize < batchSize) {
+		queueSize = batchSize;
+	}
+
+#ifdef ENABLE_THREADS
+	threaded = 1;
+	mutexInit(&maccess);
+	threadCondInit(&notEmpty);
+
+	int res = threadCreate(&thread, thread_func, this);
+	if (res != 0) {
+		mutexDestroy(&maccess);
+		threadCondDestroy(&notEmpty);
+		throw Error("Cannot create database writer thread: %s", strerror(res));
+	}
+#endif
+
+	if (!threaded) {
+		log->log(ch, "Without threads the database is written from the event loop, "
+				 "%u records at a time", batchSize);
+	}
+
+#ifdef DEBUG
+	log->dlog(ch, "Starting, queue size:%u batch size:%u", queueSize, batchSize);
+#endif
+
+}
+
+
+/* ------------------------- ~BiddingObjectWriter ------------------------- */
+
+BiddingObjectWriter::~BiddingObjectWriter()
+{
+
+#ifdef ENABLE_THREADS
+	if (threaded) {
+		mutexLock(&maccess);
+		stopping = 1;
+		threadCondSignal(&notEmpty);
+		mutexUnlock(&maccess);
+
+		// the worker drains the queue before leaving
+		threadJoin(thread);
+		threaded = 0;
+	}
+#endif
+
+	stopping = 1;
+	flush();
+
+#ifdef ENABLE_THREADS
+	mutexDestroy(&maccess);
+	threadCondDestroy(&notEmpty);
+#endif
+
+#ifdef DEBUG
+	log->dlog(ch, "Shutdown, %lu records written", stats.written);
+#endif
+
+}
+
+
+/* ------------------------- thread_func ------------------------- */
+
+void *BiddingObjectWriter::thread_func(void *arg)
+{
+	((BiddingObjectWriter *)arg)->main();
+	return NULL;
+}
+
+
+/* ------------------------- main ------------------------- */
+
+void BiddingObjectWriter::main()
+{
+
+#ifdef ENABLE_THREADS
+	biddingObjectWriterBatch_t batch;
+
+	while (1) {
+
+		mutexLock(&maccess);
+		while ((queued() == 0) && !stopping) {
+			threadCondWait(&notEmpty, &maccess);
+		}
+
+		if (queued() == 0) {
+			mutexUnlock(&maccess);
+			break;
+		}
+
+		takeBatch(batch);
+		mutexUnlock(&maccess);
+
+		// One retry, unless the last batch failed as well: while the
+		// database is down batches go to the journal at once, so the queue
+		// keeps room and push() never has to wait for it.
+		bool written = writeBatch(batch);
+		if (!written && !failing) {
+			waitRetry();
+			written = writeBatch(batch);
+		}
+
+		if (!written) {
+			discardBatch(batch);
+		}
+		failing = !written;
+
+		releaseBatch(batch);
+	}
+#endif
+
+}
+
+
+/* ------------------------- waitRetry ------------------------- */
+
+void BiddingObjectWriter::waitRetry()
+{
+
+#ifdef ENABLE_THREADS
+	struct timeval now;
+	struct timespec deadline;
+	gettimeofday(&now, NULL);
+
+	deadline.tv_sec = now.tv_sec + DB_WRITER_RETRY_DELAY;
+	deadline.tv_nsec = now.tv_usec * 1000;
+
+	AUTOLOCK(threaded, &maccess);
+
+	// Pushes signal the condition as well, only stopping ends the wait early.
+	while (!stopping && (threadCondTimedWait(&notEmpty, &maccess, &deadline) == 0));
+#endif
+
+}
+
+
+/* ------------------------- enqueued ------------------------- */
+
+void BiddingObjectWriter::enqueued()
+{
+	stats.enqueued++;
+	if (queued() > stats.maxQueued) {
+		stats.maxQueued = queued();
+	}
+
+#ifdef ENABLE_THREADS
+	if (threaded) {
+		threadCondSignal(&notEmpty);
+	}
+#endif
+}
+
+
+/* ------------------------- push ------------------------- */
+
+void BiddingObjectWriter::push(BiddingObject *b)
+{
+	biddingObjectRecord_t *record = new biddingObjectRecord_t;
+	b->getRecord(*record);
+
+	unsigned int n;
+	bool full = false;
+	{
+
+#ifdef ENABLE_THREADS
+		AUTOLOCK(threaded, &maccess);
+#endif
+
+		if (queued() < queueSize) {
+			queue.push_back(record);
+			enqueued();
+		} else {
+			stats.full++;
+			full = true;
+		}
+
+		n = queued();
+	}
+
+	// The journal may sync, the worker must not wait for it.
+	if (full) {
+		spill(record);
+		delete record;
+	}
+
+	if (!threaded && (n >= batchSize)) {
+		flush();
+	}
+}
+
+
+/* ------------------------- push ------------------------- */
+
+void BiddingObjectWriter::push(const auctionSummaryRecord_t &summary)
+{
+	auctionSummaryRecord_t *record = new auctionSummaryRecord_t(summary);
+
+	unsigned int n;
+	bool full = false;
+	{
+
+#ifdef ENABLE_THREADS
+		AUTOLOCK(threaded, &maccess);
+#endif
+
+		if (queued() < queueSize) {
+			summaryQueue.push_back(record);
+			enqueued();
+		} else {
+			stats.full++;
+			full = true;
+		}
+
+		n = queued();
+	}
+
+	if (full) {
+		spill(record);
+		delete record;
+	}
+
+	if (!threaded && (n >= batchSize)) {
+		flush();
+	}
+}
+
+
+/* ------------------------- flush ------------------------- */
+
+void BiddingObjectWriter::flush()
+{
+
+#ifdef ENABLE_THREADS
+	if (threaded) {
+		AUTOLOCK(threaded, &maccess);
+		threadCondSignal(&notEmpty);
+		return;
+	}
+#endif
+
+	biddingObjectWriterBatch_t batch;
+	while (queued() > 0) {
+		takeBatch(batch);
+
+		// Never retry here, it would block the caller. While the database
+		// is down it is not tried again until DB_WRITER_RETRY_DELAY passes.
+		time_t now = time(NULL);
+		bool written = false;
+		if (!failing || (now >= lastFailure + (time_t) DB_WRITER_RETRY_DELAY)) {
+			written = writeBatch(batch);
+			failing = !written;
+			if (failing) {
+				lastFailure = now;
+			}
+		}
+
+		if (!written) {
+			discardBatch(batch);
+		}
+		releaseBatch(batch);
+	}
+}
+
+
+/* ------------------------- takeBatch ------------------------- */
+
+void BiddingObjectWriter::takeBatch(biddingObjectWriterBatch_t &batch)
+{
+	// Summaries are few, they go first.
+	while (!summaryQueue.empty() && (batch.summaries.size() < batchSize)) {
+		batch.summaries.push_back(summaryQueue.front());
+		summaryQueue.pop_front();
+	}
+
+	while (!queue.empty() && (batch.objects.size() < batchSize)) {
+		batch.objects.push_back(queue.front());
+		queue.pop_front();
+	}
+}
+
+
+/* ------------------------- writeBatch ------------------------- */
+
+bool BiddingObjectWriter::writeBatch(biddingObjectWriterBatch_t &batch)
+{
+	if (batch.objects.empty() && batch.summaries.empty()) {
+		return true;
+	}
+
+	try {
+
+		DBConnectionLease lease(pool);
+
+		try {
+
+			// Before the partitions, they are created like the table.
+			if (!summaryTableReady) {
+				try {
+					BiddingObjectBulkLoader::createSummaryTable(lease.getConnection());
+					summaryTableReady = true;
+				} catch (Error &e) {
+					// Only the summaries depend on it, tried again next batch.
+					log->elog(ch, "%s", e.getError().c_str());
+				}
+			}
+
+			string suffix;
+			if (partitions != NULL) {
+				time_t now = time(NULL);
+				partitions->maintain(lease.getConnection(), now);
+				suffix = partitions->getSuffix(now);
+			}
+
+			// Each kind in its own transaction, so one failing table does
+			// not hold back the other; what was written leaves the batch.
+			bool written = true;
+
+			if (!batch.objects.empty()) {
+				if (writeObjects(lease, batch.objects, suffix)) {
+					releaseObjects(batch);
+				} else {
+					written = false;
+				}
+			}
+
+			if (!batch.summaries.empty()) {
+				if (writeSummaries(lease, batch.summaries, suffix)) {
+					releaseSummaries(batch);
+				} else {
+					written = false;
+				}
+			}
+
+			return written;
+
+		} catch (...) {
+			// the connection may be broken, the pool opens a new one.
+			lease.invalidate();
+			throw;
+		}
+
+	} catch (Error &e) {
+		log->elog(ch, "Error preparing the archive: %s", e.getError().c_str());
+	} catch (const std::exception &e) {
+		log->elog(ch, "Error preparing the archive: %s", e.what());
+	}
+
+	failed();
+	return false;
+}
+
+
+/* ------------------------- writeObjects ------------------------- */
+
+bool BiddingObjectWriter::writeObjects(DBConnectionLease &lease,
+									   biddingObjectRecordBatch_t &objects, 
+									   const string &suffix)
+{
+	try {
+
+#ifdef HAVE_PQXX40
+		// Prepared once per connection of the pool.
+		if (!lease.isPrepared("insertBO")) {
+			BiddingObject::prepare_insert_record(lease.getConnection());
+			lease.setPrepared("insertBO");
+		}
+#endif
+
+		pqxx::work w(lease.getConnection());
+
+		// The prepared statements insert in the tables, not in the partitions.
+		if (!suffix.empty() || (objects.size() >= DB_WRITER_COPY_THRESHOLD)) {
+			BiddingObjectBulkLoader::load(w, objects, suffix);
+		} else {
+			biddingObjectRecordBatchIter_t iter;
+			for (iter = objects.begin(); iter != objects.end(); ++iter) {
+				BiddingObject::save_record(w, **iter);
+			}
+		}
+
+		w.commit();
+
+	} catch (Error &e) {
+		log->elog(ch, "Error writing %d bidding objects: %s", (int) objects.size(), 
+				  e.getError().c_str());
+		lease.invalidate();
+		failed();
+		return false;
+	} catch (const std::exception &e) {
+		log->elog(ch, "Error writing %d bidding objects: %s", (int) objects.size(), 
+				  e.what());
+		lease.invalidate();
+		failed();
+		return false;
+	}
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+	stats.batches++;
+	stats.written += objects.size();
+
+	return true;
+}
+
+
+/* ------------------------- writeSummaries ------------------------- */
+
+bool BiddingObjectWriter::writeSummaries(DBConnectionLease &lease,
+										 auctionSummaryBatch_t &summaries, 
+										 const string &suffix)
+{
+	try {
+
+		pqxx::work w(lease.getConnection());
+		BiddingObjectBulkLoader::loadSummaries(w, summaries, suffix);
+		w.commit();
+
+	} catch (Error &e) {
+		log->elog(ch, "Error writing %d auction summaries: %s", (int) summaries.size(), 
+				  e.getError().c_str());
+		lease.invalidate();
+		failed();
+		return false;
+	} catch (const std::exception &e) {
+		log->elog(ch, "Error writing %d auction summaries: %s", (int) summaries.size(), 
+				  e.what());
+		lease.invalidate();
+		failed();
+		return false;
+	}
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+	stats.batches++;
+	stats.summaries += summaries.size();
+
+	return true;
+}
+
+
+/* ------------------------- failed ------------------------- */
+
+void BiddingObjectWriter::failed()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	stats.failures++;
+}
+
+
+/* ------------------------- spill ------------------------- */
+
+bool BiddingObjectWriter::spill(biddingObjectRecord_t *record)
+{
+	// The journal has a lock of its own.
+	bool spilled = (journal != NULL);
+	if (spilled) {
+		journal->append(*record);
+	} else {
+		log->elog(ch, "Bidding object %s.%s not stored in the database",
+					record->set.c_str(), record->name.c_str());
+	}
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	if (spilled) {
+		stats.spilled++;
+	} else {
+		stats.dropped++;
+	}
+	return spilled;
+}
+
+
+/* ------------------------- spill ------------------------- */
+
+bool BiddingObjectWriter::spill(auctionSummaryRecord_t *summary)
+{
+	bool spilled = (journal != NULL);
+	if (spilled) {
+		journal->append(*summary);
+	} else {
+		log->elog(ch, "Summary of auction %s.%s not stored in the database",
+					summary->auctionSet.c_str(), summary->auctionName.c_str());
+	}
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	if (spilled) {
+		stats.spilled++;
+	} else {
+		stats.dropped++;
+	}
+	return spilled;
+}
+
+
+/* ------------------------- discardBatch ------------------------- */
+
+void BiddingObjectWriter::discardBatch(biddingObjectWriterBatch_t &batch)
+{
+	auctionSummaryBatchIter_t summaryIter;
+	for (summaryIter = batch.summaries.begin(); summaryIter != batch.summaries.end(); ++summaryIter) {
+		spill(*summaryIter);
+	}
+
+	biddingObjectRecordBatchIter_t iter;
+	for (iter = batch.objects.begin(); iter != batch.objects.end(); ++iter) {
+		spill(*iter);
+	}
+}
+
+
+/* ------------------------- releaseBatch ------------------------- */
+
+void BiddingObjectWriter::releaseBatch(biddingObjectWriterBatch_t &batch)
+{
+	releaseSummaries(batch);
+	releaseObjects(batch);
+}
+
+
+/* ------------------------- releaseObjects ------------------------- */
+
+void BiddingObjectWriter::releaseObjects(biddingObjectWriterBatch_t &batch)
+{
+	biddingObjectRecordBatchIter_t iter;
+	for (iter = batch.objects.begin(); iter != batch.objects.end(); ++iter) {
+		delete *iter;
+	}
+	batch.objects.clear();
+}
+
+
+/* ------------------------- releaseSummaries ------------------------- */
+
+void BiddingObjectWriter::releaseSummaries(biddingObjectWriterBatch_t &batch)
+{
+	auctionSummaryBatchIter_t iter;
+	for (iter = batch.summaries.begin(); iter != batch.summaries.end(); ++iter) {
+		delete *iter;
+	}
+	batch.summaries.clear();
+}
+
+
+/* ------------------------- getQueueLength ------------------------- */
+
+unsigned int BiddingObjectWriter::getQueueLength()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	return queued();
+}
+
+
+/* ------------------------- getStats ------------------------- */
+
+biddingObjectWriterStats_t BiddingObjectWriter::getStats()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	return stats;
+}
+
+
+/* ------------------------- getInfo ------------------------- */
+
+string BiddingObjectWriter::getInfo()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	ostringstream s;
+
+	s << "<writer queued=\"" << queued() << "\""
+	  << " queue_size=\"" << queueSize << "\""
+	  << " max_queued=\"" << stats.maxQueued << "\""
+	  << " enqueued=\"" << stats.enqueued << "\""
+	  << " written=\"" << stats.written << "\""
+	  << " summaries=\"" << stats.summaries << "\""
+	  << " batches=\"" << stats.batches << "\""
+	  << " failures=\"" << stats.failures << "\""
+	  << " connections=\"" << pool->getNumConnections() << "\""
+	  << " reconnects=\"" << pool->getNumReconnects() << "\""
+	  << " full=\"" << stats.full << "\""
+	  << " spilled=\"" << stats.spilled << "\""
+	  << " dropped=\"" << stats.dropped << "\" />";
+
+	return s.str();
+}
@@ -46,6 +46,36 @@ const unsigned int  DONE_LIST_SIZE = 50;
 const string        FIELDVAL_FILE = DEF_SYSCONFDIR "/fieldval.xml";
 const string        FIELDDEF_FILE = DEF_SYSCONFDIR "/fielddef.xml";
 
+// AuctionManager.cpp
+const unsigned int  ANNOUNCEMENT_CACHE_SIZE = 64;
+const uint32_t      MANAGER_MAX_UID = 0xFFFFFF;  // unique ids wrap here, 2 MB of bitmap
+
+// BiddingObjectManager.cpp
+const unsigned int  MESSAGE_MAX_RECORDS = 64;  // data records per message
+const unsigned int  ARCHIVE_PARTITIONS_AHEAD = 2;
+const time_t        BIDDING_OBJECT_ARENA_INTERVAL = 60;  // s
+
+// DBConnectionPool.cpp
+const unsigned int  DB_POOL_SIZE = 4;
+const time_t        DB_POOL_CHECK_IDLE = 30;
+
+// BiddingObjectWriter.cpp
+const unsigned int  DB_WRITER_QUEUE_SIZE = 10000;
+const unsigned int  DB_WRITER_BATCH_SIZE = 256;
+const unsigned int  DB_WRITER_RETRY_DELAY = 1;  // s
+const unsigned int  DB_WRITER_COPY_THRESHOLD = 16;
+
+// BiddingObjectJournal.cpp
+const unsigned int  JOURNAL_SYNC_EVERY = 64;
+const unsigned int  JOURNAL_SYNC_INTERVAL = 1000;  // ms
+
+// AnslpEventTransport.cpp
+const string        ANSLP_TRANSPORT_LOCAL_ADDRESS = "127.0.0.1";
+const uint32_t      ANSLP_TRANSPORT_SESSION_LIFETIME = 30;  // s
+
+// SocketTransport.cpp
+const unsigned int  SOCKET_TRANSPORT_MAX_MESSAGE = 131072;  // bytes
+
 // Logger.h
 const string DEFAULT_LOG_FILE = DEF_STATEDIR "/log/netaum.log";
 
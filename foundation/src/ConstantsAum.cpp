@@ -43,6 +43,34 @@ extern const string AUM_DEFAULT_LOG_FILE = DEF_STATEDIR "/log/netaum.log";
 // ConfigParser.h
 const string AUM_CONFIGFILE_DTD  = DEF_SYSCONFDIR "/netaum.conf.dtd";
 
+// Auctioner.h
+// seconds between state snapshots when SnapshotInterval is not set
+const unsigned long AUM_SNAPSHOT_INTERVAL = 30;
+// milliseconds between fdatasync of the state log when StateLogSyncInterval is not set
+const unsigned int AUM_STATELOG_SYNC_INTERVAL = 10;
+// size of the state log that triggers a snapshot when StateLogMaxSize is not set
+const unsigned long AUM_STATELOG_MAX_SIZE = 64 * 1024 * 1024;
+// milliseconds before an unconfirmed message is sent again, doubled on every retry
+const unsigned long AUM_RETRANSMIT_TIMEOUT = 2000;
+// limit of the retransmission timeout in milliseconds
+const unsigned long AUM_RETRANSMIT_MAX_TIMEOUT = 60000;
+// retransmissions before an unconfirmed message is dropped
+const unsigned int AUM_RETRANSMIT_RETRIES = 5;
+// unconfirmed messages kept per session
+const unsigned int AUM_MAX_PENDING_MESSAGES = 256;
+
+// AnslpProcessor.h
+// anslp events processed per wake up of the main loop
+const unsigned int AUM_ANSLP_DRAIN_BUDGET = 64;
+// milliseconds the relay thread waits on the anslp queue before checking for stop
+const unsigned int AUM_ANSLP_RELAY_WAIT = 100;
+// events converted by the anslp thread waiting for the core
+const unsigned int AUM_ANSLP_HANDOFF_SIZE = 1024;
+// microseconds the anslp thread waits when the core has not taken its events
+const unsigned int AUM_ANSLP_HANDOFF_RETRY = 1000;
+// seconds between drops of the admission buckets that are full again
+const unsigned int AUM_ANSLP_BUCKET_PRUNE = 60;
+
 
 #ifdef USE_SSL
 // certificate file location (SSL)
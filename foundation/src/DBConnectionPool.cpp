@@ -0,0 +1,216 @@
+/*! \file   DBConnectionPool.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Pool of database connections that remember their prepared statements.
+
+    $Id: DBConnectionPool.cpp 748 2015-08-12 11:20:00Z amarentes $
+*/
+
+#include "config.h"
+#include "DBConnectionPool.h"
+
+using namespace auction;
+
+
+/* ------------------------- DBConnectionPool ------------------------- */
+
+DBConnectionPool::DBConnectionPool(string connectionDB, unsigned int _maxConnections,
+								   time_t _checkIdle)
+  : connectionDBStr(connectionDB), maxConnections(_maxConnections),
+    checkIdle(_checkIdle), reconnects(0), threaded(0)
+{
+	log = Logger::getInstance();
+	ch = log->createChannel("DBConnectionPool");
+
+	if (maxConnections == 0) {
+		maxConnections = 1;
+	}
+
+#ifdef ENABLE_THREADS
+	threaded = 1;
+	mutexInit(&maccess);
+	threadCondInit(&released);
+#endif
+
+}
+
+
+/* ------------------------- ~DBConnectionPool ------------------------- */
+
+DBConnectionPool::~DBConnectionPool()
+{
+	pooledConnectionListIter_t iter;
+	for (iter = connections.begin(); iter != connections.end(); ++iter) {
+		saveDelete((*iter)->conn);
+		delete *iter;
+	}
+
+#ifdef ENABLE_THREADS
+	mutexDestroy(&maccess);
+	threadCondDestroy(&released);
+#endif
+
+}
+
+
+/* ------------------------- open ------------------------- */
+
+void DBConnectionPool::open(pooledConnection_t *entry)
+{
+	saveDelete(entry->conn);
+	entry->prepared.clear();
+
+	entry->conn = new pqxx::connection(connectionDBStr);
+	__sync_fetch_and_add(&reconnects, 1);
+
+#ifdef DEBUG
+	log->dlog(ch, "connection opened");
+#endif
+
+}
+
+
+/* ------------------------- check ------------------------- */
+
+void DBConnectionPool::check(pooledConnection_t *entry)
+{
+	if (entry->conn == NULL) {
+		open(entry);
+		return;
+	}
+
+	try {
+
+		if (!entry->conn->is_open()) {
+			// pqxx prepares again the statements declared in it.
+			entry->conn->activate();
+		} else if (time(NULL) - entry->lastUsed > checkIdle) {
+			pqxx::nontransaction n(*(entry->conn));
+			n.exec("SELECT 1");
+		}
+
+	} catch (const std::exception &e) {
+		log->wlog(ch, "connection lost, reconnecting: %s", e.what());
+		open(entry);
+	}
+}
+
+
+/* ------------------------- lease ------------------------- */
+
+pooledConnection_t *DBConnectionPool::lease()
+{
+	pooledConnection_t *entry = NULL;
+
+	{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	while (entry == NULL) {
+
+		pooledConnectionListIter_t iter;
+		for (iter = connections.begin(); iter != connections.end(); ++iter) {
+			if (!(*iter)->leased) {
+				entry = *iter;
+				break;
+			}
+		}
+
+		if ((entry == NULL) && (connections.size() < maxConnections)) {
+			entry = new pooledConnection_t;
+			entry->conn = NULL;
+			entry->lastUsed = 0;
+			entry->leased = false;
+			connections.push_back(entry);
+		}
+
+		if (entry == NULL) {
+#ifdef ENABLE_THREADS
+			threadCondWait(&released, &maccess);
+#else
+			throw Error("all the %d database connections are in use", maxConnections);
+#endif
+		}
+	}
+
+	entry->leased = true;
+
+	}
+
+	// Checked without the lock, connecting can take long and the entry
+	// is already out of the pool.
+	try {
+		check(entry);
+	} catch (const std::exception &e) {
+		release(entry, true);
+		throw Error("Error connecting to the database %s", e.what());
+	}
+
+	return entry;
+}
+
+
+/* ------------------------- release ------------------------- */
+
+void DBConnectionPool::release(pooledConnection_t *entry, bool broken)
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	if (broken) {
+		// reopened on the next lease
+		saveDelete(entry->conn);
+		entry->prepared.clear();
+	}
+
+	entry->lastUsed = time(NULL);
+	entry->leased = false;
+
+#ifdef ENABLE_THREADS
+	threadCondSignal(&released);
+#endif
+
+}
+
+
+/* ------------------------- getNumConnections ------------------------- */
+
+unsigned int DBConnectionPool::getNumConnections()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	return connections.size();
+}
+
+
+/* ------------------------- getNumReconnects ------------------------- */
+
+unsigned long DBConnectionPool::getNumReconnects()
+{
+	return __sync_fetch_and_add(&reconnects, 0);
+}
@@ -0,0 +1,137 @@
+/*! \file   EventHandoff.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Bounded lock free queue handing events from worker threads to the core.
+
+    $Id: EventHandoff.cpp 748 2015-08-20 10:15:00Z amarentes $
+*/
+
+#include "config.h"
+#include "EventHandoff.h"
+
+using namespace auction;
+
+
+/* ------------------------- EventHandoff ------------------------- */
+
+EventHandoff::EventHandoff(unsigned int capacity)
+  : pushPos(0), popPos(0)
+{
+	unsigned long size = 2;
+	while (size < capacity) {
+		size <<= 1;
+	}
+
+	mask = size - 1;
+	cells = new handoffCell_t[size];
+
+	for (unsigned long i = 0; i < size; i++) {
+		cells[i].sequence = i;
+		cells[i].event = NULL;
+	}
+}
+
+
+/* ------------------------- ~EventHandoff ------------------------- */
+
+EventHandoff::~EventHandoff()
+{
+	Event *e;
+	while ((e = pop()) != NULL) {
+		delete e;
+	}
+
+	delete[] cells;
+}
+
+
+/* ------------------------- push ------------------------- */
+
+bool EventHandoff::push(Event *e)
+{
+	handoffCell_t *cell;
+	unsigned long pos = pushPos;
+
+	while (1) {
+		cell = &cells[pos & mask];
+		unsigned long seq = cell->sequence;
+		__sync_synchronize();
+
+		long diff = (long) (seq - pos);
+
+		if (diff == 0) {
+			// Free for this position, claim it.
+			if (__sync_bool_compare_and_swap(&pushPos, pos, pos + 1)) {
+				break;
+			}
+			pos = pushPos;
+		} else if (diff < 0) {
+			// Still holds the event of the previous round: full.
+			return false;
+		} else {
+			// Another producer took it.
+			pos = pushPos;
+		}
+	}
+
+	cell->event = e;
+
+	// Publish the event before the cell shows it.
+	__sync_synchronize();
+	cell->sequence = pos + 1;
+
+	return true;
+}
+
+
+/* ------------------------- pop ------------------------- */
+
+Event *EventHandoff::pop()
+{
+	handoffCell_t *cell = &cells[popPos & mask];
+	unsigned long seq = cell->sequence;
+	__sync_synchronize();
+
+	if ((long) (seq - (popPos + 1)) < 0) {
+		return NULL;
+	}
+
+	Event *e = cell->event;
+	cell->event = NULL;
+
+	// Read the event before the cell is given back to the producers.
+	__sync_synchronize();
+	cell->sequence = popPos + mask + 1;
+	popPos++;
+
+	return e;
+}
+
+
+/* ------------------------- isEmpty ------------------------- */
+
+bool EventHandoff::isEmpty()
+{
+	unsigned long seq = cells[popPos & mask].sequence;
+	__sync_synchronize();
+
+	return ((long) (seq - (popPos + 1)) < 0);
+}
@@ -38,7 +38,7 @@ field_t::field_t(const field_t &param)
 	//! number of values
 	cnt = param.cnt;
 
-	vector<FieldValue>::const_iterator fval_iter;
+	fieldValueListConstIter_t fval_iter;
 	for ( fval_iter = param.value.begin(); fval_iter != param.value.end(); ++fval_iter )
 	{
 		FieldValue val(*fval_iter);
@@ -124,7 +124,7 @@ string field_t::getInfo(void)
 	output << " len:" << len
 		   << " cnt:" << cnt << endl;
 	
-	vector<FieldValue>::iterator val_iter;
+	fieldValueListIter_t val_iter;
 	for (val_iter = value.begin(); val_iter != value.end(); ++val_iter){
 		if (!val_iter->getType().empty())
 			output << (*val_iter).getInfo();
@@ -182,7 +182,7 @@ field_t::operator=(const field_t &param)
 	//! number of values
 	cnt = param.cnt;
 
-	vector<FieldValue>::const_iterator fval_iter;
+	fieldValueListConstIter_t fval_iter;
 	for ( fval_iter = param.value.begin(); fval_iter != param.value.end(); ++fval_iter )
 	{
 		FieldValue val = *fval_iter;
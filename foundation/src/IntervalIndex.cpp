@@ -0,0 +1,157 @@
+/*! \file   IntervalIndex.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Index of time intervals answering which ones overlap a period.
+
+    $Id: IntervalIndex.cpp 748 2015-08-21 09:40:00Z amarentes $
+*/
+
+
+#include "config.h"
+#include "IntervalIndex.h"
+
+using namespace auction;
+
+
+/* ------------------------- earlier ------------------------- */
+
+//! order by start, then id, so every interval has a single position.
+static bool earlier(const indexedInterval_t &a, const indexedInterval_t &b)
+{
+	return (a.start < b.start) || ((a.start == b.start) && (a.id < b.id));
+}
+
+
+/* ------------------------- IntervalIndex ------------------------- */
+
+IntervalIndex::IntervalIndex() : dirty(false)
+{
+
+}
+
+
+/* ------------------------- ~IntervalIndex ------------------------- */
+
+IntervalIndex::~IntervalIndex()
+{
+
+}
+
+
+/* ------------------------- insert ------------------------- */
+
+void IntervalIndex::insert(int id, time_t start, time_t stop)
+{
+	indexedInterval_t in;
+	in.start = start;
+	in.stop = stop;
+	in.id = id;
+
+	intervals.insert(lower_bound(intervals.begin(), intervals.end(), in, earlier), in);
+	dirty = true;
+}
+
+
+/* ------------------------- erase ------------------------- */
+
+bool IntervalIndex::erase(int id, time_t start)
+{
+	indexedInterval_t in;
+	in.start = start;
+	in.stop = start;
+	in.id = id;
+
+	indexedIntervalListIter_t iter = lower_bound(intervals.begin(), intervals.end(), in, earlier);
+	if ((iter == intervals.end()) || (iter->id != id) || (iter->start != start)) {
+		return false;
+	}
+
+	intervals.erase(iter);
+	dirty = true;
+	return true;
+}
+
+
+/* ------------------------- build ------------------------- */
+
+time_t IntervalIndex::build(size_t lo, size_t hi)
+{
+	size_t mid = lo + (hi - lo) / 2;
+	time_t latest = intervals[mid].stop;
+
+	if (lo < mid) {
+		latest = max(latest, build(lo, mid));
+	}
+
+	if (mid + 1 < hi) {
+		latest = max(latest, build(mid + 1, hi));
+	}
+
+	maxStop[mid] = latest;
+	return latest;
+}
+
+
+/* ------------------------- find ------------------------- */
+
+void IntervalIndex::find(time_t start, time_t stop, vector<int> &ids)
+{
+	if (intervals.empty()) {
+		return;
+	}
+
+	if (dirty) {
+		maxStop.resize(intervals.size());
+		build(0, intervals.size());
+		dirty = false;
+	}
+
+	find(0, intervals.size(), start, stop, ids);
+}
+
+
+void IntervalIndex::find(size_t lo, size_t hi, time_t start, time_t stop, 
+						 vector<int> &ids) const
+{
+	if (lo >= hi) {
+		return;
+	}
+
+	size_t mid = lo + (hi - lo) / 2;
+
+	// Everything below ends before the period.
+	if (maxStop[mid] <= start) {
+		return;
+	}
+
+	find(lo, mid, start, stop, ids);
+
+	// This one and the ones after start once the period is over.
+	if (intervals[mid].start >= stop) {
+		return;
+	}
+
+	if (intervals[mid].stop > start) {
+		ids.push_back(intervals[mid].id);
+	}
+
+	find(mid + 1, hi, start, stop, ids);
+}
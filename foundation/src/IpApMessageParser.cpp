@@ -86,6 +86,20 @@ IpApMessageParser::parseFieldValue(fieldValList_t *fieldVals, string value, fiel
 }
 
 
+/* ------------------------- readFieldValue ------------------------- */
+void 
+IpApMessageParser::readFieldValue(ipap_field &field, ipap_value_field &value, field_t *f)
+{
+	f->value.resize(MAX_FIELD_SET_SIZE);
+	f->mtype = FT_EXACT;
+	f->cnt = 1;
+	
+	// The field type checked the value when it was decoded.
+	f->value[0].setType(f->type);
+	f->value[0].setValue(field.writeValue(value));
+}
+
+
 /* ------------------------- parseName ------------------------- */
 void 
 IpApMessageParser::parseName(string id, string &set, string &name)
@@ -204,6 +218,28 @@ IpApMessageParser::findField(fieldDefList_t *fieldDefs, int eno, int ftype)
 }
 
 
+/* ------------------------- findIndexedField ------------------------- */
+fieldDefItem_t * 
+IpApMessageParser::findIndexedField(fieldDefList_t *fieldDefs, int eno, int ftype)
+{
+	if ((indexedDefs != fieldDefs) || (indexedSize != fieldDefs->size())) {
+		fieldIndex.clear();
+		for (fieldDefListIter_t iter = fieldDefs->begin(); iter != fieldDefs->end(); ++iter) {
+			fieldIndex.insert(make_pair(make_pair((iter->second).eno, (iter->second).ftype), 
+										&(iter->second)));
+		}
+		indexedDefs = fieldDefs;
+		indexedSize = fieldDefs->size();
+	}
+	
+	fieldDefKeyIndexIter_t iter = fieldIndex.find(make_pair(eno, ftype));
+	if (iter == fieldIndex.end()) {
+		return NULL;
+	}
+	return iter->second;
+}
+
+
 /* ------------------------- findField ------------------------- */
 fieldDefItem_t 
 IpApMessageParser::findField(fieldDefList_t *fieldDefs, string fname)
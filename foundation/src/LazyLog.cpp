@@ -0,0 +1,70 @@
+/*! \file   LazyLog.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Log lines whose text is only built when their level is printed.
+
+    $Id: LazyLog.cpp 748 2015-08-21 09:40:00Z amarentes $
+*/
+
+#include "config.h"
+#include "LazyLog.h"
+#include "msg/anslp_ipap_message.h"
+#include "anslp_ipap_xml_message.h"
+
+using namespace auction;
+
+
+/* ------------------------- IpApXmlFormatter::format ------------------------- */
+
+string IpApXmlFormatter::format() const
+{
+	anslp::msg::anslp_ipap_xml_message xmlMes;
+	anslp::msg::anslp_ipap_message anlp_mess(message);
+	return xmlMes.get_message(anlp_mess);
+}
+
+
+/* ------------------------- log ------------------------- */
+
+void LazyLog::log(Logger *log, int ch, lazyLogLevel_t lvl, const LogFormatter &f,
+				  const char *prefix)
+{
+	if (!isEnabled(log, lvl)) {
+		return;
+	}
+
+	string text = f.format();
+
+	switch (lvl) {
+		case LAZY_LOG_ERROR:
+			log->elog(ch, "%s%s", prefix, text.c_str());
+			break;
+		case LAZY_LOG_WARNING:
+			log->wlog(ch, "%s%s", prefix, text.c_str());
+			break;
+		case LAZY_LOG_INFO:
+			log->log(ch, "%s%s", prefix, text.c_str());
+			break;
+		default:
+			log->dlog(ch, "%s%s", prefix, text.c_str());
+			break;
+	}
+}
@@ -0,0 +1,124 @@
+/*! \file   LoopbackTransport.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    In process transport joining an agent and an auction manager.
+
+    $Id: LoopbackTransport.cpp 748 2015-08-23 16:05:00Z amarentes $
+*/
+
+#include "config.h"
+#include "LoopbackTransport.h"
+
+
+using namespace auction;
+
+
+loopbackChannelList_t LoopbackTransport::channels;
+
+mutex_t LoopbackTransport::channelsLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/* ------------------------- LoopbackTransport ------------------------- */
+
+LoopbackTransport::LoopbackTransport(string _channel, anslp::FastQueue *_queue)
+  : AnslpEventTransport("LoopbackTransport", _queue), channel(_channel)
+{
+	mutexLock(&channelsLock);
+
+	vector<LoopbackTransport *> &ends = channels[channel];
+	if (ends.size() >= 2) {
+		mutexUnlock(&channelsLock);
+		throw Error("loopback channel %s already has its two ends", channel.c_str());
+	}
+	ends.push_back(this);
+
+	mutexUnlock(&channelsLock);
+
+	log->log(ch, "Joined loopback channel %s", channel.c_str());
+}
+
+
+/* ------------------------- ~LoopbackTransport ------------------------- */
+
+LoopbackTransport::~LoopbackTransport()
+{
+	mutexLock(&channelsLock);
+
+	loopbackChannelListIter_t iter = channels.find(channel);
+	if (iter != channels.end()) {
+		vector<LoopbackTransport *> &ends = iter->second;
+		ends.erase(std::remove(ends.begin(), ends.end(), this), ends.end());
+		if (ends.empty()) {
+			channels.erase(iter);
+		}
+	}
+
+	mutexUnlock(&channelsLock);
+
+#ifdef DEBUG
+	log->dlog(ch, "Left loopback channel %s", channel.c_str());
+#endif
+
+}
+
+
+/* ------------------------- getPeer ------------------------- */
+
+LoopbackTransport *LoopbackTransport::getPeer()
+{
+	loopbackChannelListIter_t iter = channels.find(channel);
+	if (iter == channels.end()) {
+		return NULL;
+	}
+
+	vector<LoopbackTransport *> &ends = iter->second;
+	for (size_t i = 0; i < ends.size(); i++) {
+		if (ends[i] != this) {
+			return ends[i];
+		}
+	}
+	return NULL;
+}
+
+
+/* ------------------------- deliver ------------------------- */
+
+void LoopbackTransport::deliver(anslp::AnslpEvent *evt)
+{
+	// Held until the event is queued, so the peer can not go away meanwhile.
+	mutexLock(&channelsLock);
+
+	LoopbackTransport *peer = getPeer();
+	if (peer == NULL) {
+		mutexUnlock(&channelsLock);
+		delete evt;
+		throw Error("loopback channel %s has no peer", channel.c_str());
+	}
+
+	try {
+		peer->enqueue(evt);
+	} catch (Error &e) {
+		mutexUnlock(&channelsLock);
+		throw e;
+	}
+
+	mutexUnlock(&channelsLock);
+}
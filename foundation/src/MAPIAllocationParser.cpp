@@ -294,8 +294,8 @@ MAPIAllocationParser::readAllocationData( ipap_template *templ,
 		ipap_field_key kField = fieldIter->first;
 		ipap_value_field dFieldValue = fieldIter->second;
 		
-		fieldDefItem_t fItem = findField(fieldDefs, kField.get_eno() , kField.get_ftype());
-		if ((fItem.name).empty()){
+		fieldDefItem_t *fItem = findIndexedField(fieldDefs, kField.get_eno() , kField.get_ftype());
+		if (fItem == NULL){
 			ostringstream s;
 			s << "Allocation Message Parser: Field eno:" << kField.get_eno();
 			s << "fType:" << kField.get_ftype() << "is not parametrized";
@@ -337,10 +337,9 @@ MAPIAllocationParser::readAllocationData( ipap_template *templ,
 			}
 			else {
 				field_t item;
-				item.name = fItem.name;
-				item.type = fItem.type;
-				string value = field.writeValue(dFieldValue);
-				parseFieldValue(fieldVals, value, &item);
+				item.name = fItem->name;
+				item.type = fItem->type;
+				readFieldValue(field, dFieldValue, &item);
 				fields.push_back(item);
 			}
 		}
@@ -370,8 +369,8 @@ MAPIAllocationParser::readOptionData(ipap_template *templ,
 		ipap_field_key kField = fieldIter->first;
 		ipap_value_field dFieldValue = fieldIter->second;
 		
-		fieldDefItem_t fItem = findField(fieldDefs, kField.get_eno() , kField.get_ftype());
-		if ((fItem.name).empty()){
+		fieldDefItem_t *fItem = findIndexedField(fieldDefs, kField.get_eno() , kField.get_ftype());
+		if (fItem == NULL){
 			ostringstream s;
 			s << "Allocation Message Parser: Field eno:" << kField.get_eno();
 			s << "fType:" << kField.get_ftype() << "is not parametrized";
@@ -32,6 +32,22 @@
 
 using namespace auction;
 
+
+/* ------------------------- needsTemplate ------------------------- */
+
+//! false if the message or the receiver already have the template.
+static bool needsTemplate(ipap_message *message, uint16_t templId, 
+						  const set<uint16_t> *peerTemplates)
+{
+	if ((peerTemplates != NULL) && (peerTemplates->count(templId) > 0)) {
+		return false;
+	}
+	
+	list<int> templIds = message->get_template_list();
+	return (find(templIds.begin(), templIds.end(), (int) templId) == templIds.end());
+}
+
+
 MAPIBiddingObjectParser::MAPIBiddingObjectParser(int domain)
     : IpApMessageParser(domain)
 {
@@ -243,8 +259,8 @@ MAPIBiddingObjectParser::readRecord( ipap_template *templ, fieldDefList_t *field
 		ipap_field_key kField = fieldIter->first;
 		ipap_value_field dFieldValue = fieldIter->second;
 		
-		fieldDefItem_t fItem = findField(fieldDefs, kField.get_eno() , kField.get_ftype());
-		if ((fItem.name).empty()){
+		fieldDefItem_t *fItem = findIndexedField(fieldDefs, kField.get_eno() , kField.get_ftype());
+		if (fItem == NULL){
 			ostringstream s;
 			s << "BiddingObject Message Parser: Field eno:" << kField.get_eno();
 			s << "fType:" << kField.get_ftype() << "is not parametrized";
@@ -288,11 +304,10 @@ MAPIBiddingObjectParser::readRecord( ipap_template *templ, fieldDefList_t *field
 			}
 			else {
 				field_t item;
-				item.name = fItem.name;
-				item.type = fItem.type;
-				item.len = fItem.len;				
-				string value = field.writeValue(dFieldValue);
-				parseFieldValue(fieldVals, value, &item);
+				item.name = fItem->name;
+				item.type = fItem->type;
+				item.len = fItem->len;				
+				readFieldValue(field, dFieldValue, &item);
 				fields.push_back(item);
 			}
 		}
@@ -458,13 +473,15 @@ MAPIBiddingObjectParser::parseAuctionKey(fieldDefList_t *fields,
 															bidName, stype, status, elementName );
 					type = parseType(stype);
 					
+					// fields are swapped in, so they are not copied
 					if (isTemplateSubtype(IPAP_RECORD, templ->get_type())){
-						elements[elementName] = readFields;
+						elements[elementName].swap(readFields);
 						++NbrDataRead;
 					}
 					
 					if (isTemplateSubtype(IPAP_OPTIONS, templ->get_type())){	
-						options.push_back(pair<string, fieldList_t>(elementName, readFields));
+						options.push_back(pair<string, fieldList_t>(elementName, fieldList_t()));
+						options.back().second.swap(readFields);
 						NbrOptionRead++;
 					}
 				}
@@ -481,7 +498,9 @@ MAPIBiddingObjectParser::parseAuctionKey(fieldDefList_t *fields,
 			}
 		}    
      
-        b = new BiddingObject(auctionSet, auctionName, bidSet, bidName, type, elements, options);
+        // the parsed fields are handed over, not copied.
+        b = new BiddingObject(auctionSet, auctionName, bidSet, bidName, type);
+        b->takeFields(elements, options);
         
 		int istatus = ParserFcts::parseInt(status, 0, 16);
 		b->setState((AuctioningObjectState_t) istatus);        
@@ -546,7 +565,8 @@ MAPIBiddingObjectParser::get_ipap_message(fieldDefList_t *fieldDefs,
 										  BiddingObject *biddingObjectPtr, 
 										  Auction *auctionPtr, 
 										  ipap_template_container *templates,
-										  ipap_message *message)
+										  ipap_message *message,
+										  const set<uint16_t> *peerTemplates)
 {
 #ifdef DEBUG
     log->dlog(ch, "Starting get_ipap_message");
@@ -568,20 +588,25 @@ MAPIBiddingObjectParser::get_ipap_message(fieldDefList_t *fieldDefs,
 	tempType = ipap_template::getTemplateType(biddingObjectPtr->getType(), IPAP_OPTIONS);
 	optionTemplateId = auctionPtr->getBiddingObjectTemplate(biddingObjectPtr->getType(),tempType);
 	
-	// Insert BiddingObject's templates.
-	ipap_template *bidTempl = templates->get_template(dataTemplateId);
-	message->make_template(bidTempl);
+	// Insert BiddingObject's templates, unless another object of the message 
+	// did or the receiver has them.
+	if (needsTemplate(message, dataTemplateId, peerTemplates)) {
+		ipap_template *bidTempl = templates->get_template(dataTemplateId);
+		message->make_template(bidTempl);
 
 #ifdef DEBUG
-    log->dlog(ch, "Finish inserting data template - NumFields:%d", bidTempl->get_numfields());
+		log->dlog(ch, "Finish inserting data template - NumFields:%d", bidTempl->get_numfields());
 #endif
+	}
 
-	ipap_template *optTempl = templates->get_template(optionTemplateId);
-	message->make_template(optTempl);
+	if (needsTemplate(message, optionTemplateId, peerTemplates)) {
+		ipap_template *optTempl = templates->get_template(optionTemplateId);
+		message->make_template(optTempl);
 	
 #ifdef DEBUG
-    log->dlog(ch, "Finish inserting option template - NumFields:%d", optTempl->get_numfields());
+		log->dlog(ch, "Finish inserting option template - NumFields:%d", optTempl->get_numfields());
 #endif		
+	}
 
 	// Include data records.
 	elementListIter_t elemIter;
@@ -643,3 +668,98 @@ MAPIBiddingObjectParser::get_ipap_message(fieldDefList_t *fieldDefs,
 	return mes;
 		
 }
+
+
+/* ------------------------- get_ipap_messages ------------------------- */
+
+vector<ipap_message *> 
+MAPIBiddingObjectParser::get_ipap_messages(fieldDefList_t *fieldDefs, 
+										   biddingObjectBatch_t *batch,
+										   ipap_template_container *templates,
+										   unsigned int maxRecords,
+										   const set<uint16_t> *peerTemplates )
+{
+	vector<ipap_message *> messages;
+	ipap_message *mes = NULL;
+	unsigned int numRecords = 0;
+
+	try {
+
+		biddingObjectBatchIter_t iter;
+		for (iter = batch->begin(); iter != batch->end(); ++iter)
+		{
+			BiddingObject *biddingObject = iter->first;
+			Auction *auction = iter->second;
+
+			if ( (biddingObject->getAuctionSet() != auction->getSet()) || 
+				 (biddingObject->getAuctionName() != auction->getName()) ){
+				throw Error("the auction is not the same as the one referenced in the bidding object");
+			}
+
+			unsigned int records = biddingObject->getElements()->size() + 
+								   biddingObject->getOptions()->size();
+
+			// Close the message when the object does not fit.
+			if ((mes != NULL) && (numRecords + records > maxRecords)) {
+				mes->output();
+				messages.push_back(mes);
+				mes = NULL;
+			}
+
+			if (mes == NULL) {
+				mes = new ipap_message(getDomain(), IPAP_VERSION, true);
+				numRecords = 0;
+			}
+
+			get_ipap_message(fieldDefs, biddingObject, auction, templates, mes, peerTemplates);
+			numRecords += records;
+		}
+
+		if (mes != NULL) {
+			mes->output();
+			messages.push_back(mes);
+		}
+
+	} catch (Error &e) {
+		saveDelete(mes);
+		for (size_t i = 0; i < messages.size(); i++) {
+			saveDelete(messages[i]);
+		}
+		throw e;
+	}
+
+#ifdef DEBUG
+    log->dlog(ch, "get_ipap_messages - %d objects in %d messages", 
+			  batch->size(), messages.size());
+#endif
+
+	return messages;
+}
+
+
+/* ------------------------- getAuctionKeys ------------------------- */
+
+void 
+MAPIBiddingObjectParser::getAuctionKeys(ipap_message *message, auctionKeyList_t &auctions)
+{
+	ipap_field idAuctionF = message->get_field_definition( 0, IPAP_FT_IDAUCTION );
+
+	dateRecordListConstIter_t dataIter;
+	for (dataIter = message->begin(); dataIter != message->end(); ++dataIter)
+	{
+		ipap_data_record dRecord = *dataIter;
+
+		fieldDataListIter_t fieldIter;
+		for (fieldIter = dRecord.begin(); fieldIter != dRecord.end(); ++fieldIter){
+			ipap_field_key kField = fieldIter->first;
+
+			if ((kField.get_eno() == 0) && 
+				  (kField.get_ftype() == IPAP_FT_IDAUCTION)){
+				string auctionSet, auctionName;
+				parseName(idAuctionF.writeValue(fieldIter->second), auctionSet, auctionName);
+				auctions.insert(make_pair(auctionSet, auctionName));
+				break;
+			}
+		}
+	}
+}
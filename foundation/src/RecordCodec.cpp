@@ -0,0 +1,62 @@
+/*! \file   RecordCodec.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Little endian encoding of the records kept in local files.
+
+    $Id: RecordCodec.cpp 748 2015-08-17 09:20:00Z amarentes $
+*/
+
+#include "config.h"
+#include "RecordCodec.h"
+
+using namespace auction;
+
+
+//! crc32 lookup table, built before main so readers never race on it.
+struct crc32Table
+{
+	uint32_t entry[256];
+
+	crc32Table()
+	{
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++) {
+				c = (c & 1) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+			}
+			entry[i] = c;
+		}
+	}
+};
+
+static const crc32Table table;
+
+
+/* ------------------------- recordCrc32 ------------------------- */
+
+uint32_t auction::recordCrc32(const char *buf, size_t len)
+{
+	uint32_t crc = 0xFFFFFFFFU;
+	for (size_t i = 0; i < len; i++) {
+		crc = table.entry[(crc ^ (unsigned char) buf[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return crc ^ 0xFFFFFFFFU;
+}
@@ -174,12 +174,12 @@ void ResourceManager::delResource(string sname, string rname, EventScheduler *e)
 void 
 ResourceManager::delResources(string sname, EventScheduler *e)
 {
-	auctioningObjectIndex_t *objects = getAuctioningObjects(sname);
+	auctioningObjectIndex_t objects = getAuctioningObjects(sname);
 	auctioningObjectIndexIter_t iter;
 	
-    for (auctioningObjectIndexIter_t i = objects->begin(); i != objects->end(); i++) 
+    for (auctioningObjectIndexIter_t i = objects.begin(); i != objects.end(); i++) 
     {	
-        Resource *r = dynamic_cast<Resource *>(getAuctioningObject(sname, i->first));
+        Resource *r = dynamic_cast<Resource *>(getAuctioningObject(i->second));
         delResource(r,e);
     }
 }
@@ -274,11 +274,11 @@ string ResourceManager::getInfo(string sname)
 {
     ostringstream s;
 
-	auctioningObjectIndex_t *objects = getAuctioningObjects(sname);
+	auctioningObjectIndex_t objects = getAuctioningObjects(sname);
 	auctioningObjectIndexIter_t iter;
 
-    for (auctioningObjectIndexIter_t i = objects->begin(); i != objects->end(); i++) {						
-        Resource *r = dynamic_cast<Resource *>(getAuctioningObject(sname, i->first));
+    for (auctioningObjectIndexIter_t i = objects.begin(); i != objects.end(); i++) {						
+        Resource *r = dynamic_cast<Resource *>(getAuctioningObject(i->second));
         s << r->getInfo();
     }
     
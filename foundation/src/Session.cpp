@@ -28,6 +28,7 @@
 // ===========================================================
 
 #include "Session.h"
+#include "Timeval.h"
 
 using namespace auction;
 
@@ -37,7 +38,10 @@ using namespace auction;
  *
  */
 Session::Session(string _sessionId):
-	state(SS_NEW), sessionId(_sessionId), mId()
+	state(SS_NEW), sessionId(_sessionId), retransmitTimeout(0), 
+	retransmitMaxTimeout(0), retransmitRetries(0), maxPendingMessages(0), 
+	retransmitArmed(false), receivedAny(false), lastReceived(0), ackPending(false),
+	ackArmed(false), admittedMessages(0), rejectedMessages(0), mId()
 {
 	
 }
@@ -49,6 +53,8 @@ Session::Session(string _sessionId):
 Session::~Session()
 {
 	pendingMessages.clear();
+	retransmits.clear();
+	templatesInFlight.clear();
 }
 
 std::ostream& operator<<(std::ostream &out, const Session &obj) 
@@ -197,27 +203,253 @@ string Session::getInfo()
 	os << " anslp-session:" <<  getAnlspSession() << endl;
 	
 	os << "last Message Nbr:" << mId << endl;
+
+	os << " admitted:" << getAdmittedMessages() 
+	   << " rejected:" << getRejectedMessages() << endl;
 	
 	return os.str();
 }
 
-//! Confirm the response of the message with id mid.
+/* ------------------------ countAdmission -----------------------*/
+
+void Session::countAdmission(bool admitted)
+{
+	if (admitted) {
+		admittedMessages++;
+	} else {
+		rejectedMessages++;
+	}
+}
+
+/* ------------------------ confirmMessage -----------------------*/
+
 void Session::confirmMessage(uint32_t mid)
 {
 	pendingMessageListIter_t iter = pendingMessages.find(mid);
 	if (iter != pendingMessages.end()){
 		pendingMessages.erase(iter);
+		retransmits.erase(mid);
+		templatesConfirmed(mid);
 	}	
 }
+
+/* ---------------------- templatesConfirmed -----------------------*/
+
+void Session::templatesConfirmed(uint32_t mid)
+{
+	templateInFlightListIter_t iter = templatesInFlight.find(mid);
+	if (iter != templatesInFlight.end()) {
+		peerTemplates.insert(iter->second.begin(), iter->second.end());
+		templatesInFlight.erase(iter);
+	}
+}
+
+/* ----------------------- addSentTemplates ------------------------*/
+
+void Session::addSentTemplates(uint32_t mid, const list<int> &templIds)
+{
+	set<uint16_t> sent;
+	
+	list<int>::const_iterator iter;
+	for (iter = templIds.begin(); iter != templIds.end(); ++iter) {
+		if (peerTemplates.count((uint16_t) *iter) == 0) {
+			sent.insert((uint16_t) *iter);
+		}
+	}
+	
+	if (!sent.empty()) {
+		templatesInFlight[mid].swap(sent);
+	}
+}
+
+/* ---------------------- resetPeerTemplates -----------------------*/
+
+void Session::resetPeerTemplates()
+{
+	peerTemplates.clear();
+	templatesInFlight.clear();
+}
+
+/* ----------------------- confirmMessages -------------------------*/
+
+unsigned int Session::confirmMessages(uint32_t mid)
+{
+	unsigned int confirmed = 0;
+	
+	pendingMessageListIter_t iter = pendingMessages.begin();
+	while ((iter != pendingMessages.end()) && (iter->first <= mid)) {
+		retransmits.erase(iter->first);
+		templatesConfirmed(iter->first);
+		pendingMessages.erase(iter++);
+		confirmed++;
+	}
+	
+	return confirmed;
+}
+
+/* ----------------------- startReceiving -------------------------*/
+
+void Session::startReceiving(uint32_t seqNo)
+{
+	if (receivedAny && (seqNo <= lastReceived)) {
+		return;
+	}
+	
+	receivedAny = true;
+	lastReceived = seqNo;
+	receivedAhead.erase(receivedAhead.begin(), receivedAhead.upper_bound(seqNo));
+	
+	closeReceivedGap();
+}
+
+/* ----------------------- messageReceived -------------------------*/
+
+void Session::messageReceived(uint32_t seqNo)
+{
+	ackPending = true;
+	
+	if (!receivedAny) {
+		startReceiving(seqNo);
+		return;
+	}
+	
+	if (seqNo <= lastReceived) {
+		return;
+	}
+	
+	if (seqNo != lastReceived + 1) {
+		receivedAhead.insert(seqNo);
+		return;
+	}
+	
+	lastReceived = seqNo;
+	closeReceivedGap();
+}
+
+/* ---------------------- closeReceivedGap -------------------------*/
+
+void Session::closeReceivedGap()
+{
+	set<uint32_t>::iterator iter = receivedAhead.begin();
+	while ((iter != receivedAhead.end()) && (*iter == lastReceived + 1)) {
+		lastReceived = *iter;
+		receivedAhead.erase(iter++);
+	}
+}
+
+/* ------------------------- wasReceived ---------------------------*/
+
+bool Session::wasReceived(uint32_t seqNo)
+{
+	return receivedAny && 
+		   ((seqNo <= lastReceived) || (receivedAhead.count(seqNo) > 0));
+}
+
+/* --------------------------- takeAck -----------------------------*/
+
+bool Session::takeAck(uint32_t &ackSeqNo)
+{
+	if (!ackPending) {
+		return false;
+	}
 	
-//! add to the list of pensing message a new entry.
-void Session::addPendingMessage(ipap_message mes)
+	ackSeqNo = lastReceived + 1;
+	ackPending = false;
+	return true;
+}
+
+/* ---------------------- addPendingMessage ------------------------*/
+
+void Session::addPendingMessage(const ipap_message &mes)
 {
 	uint32_t mid = mes.get_seqno();
 	pendingMessageListIter_t iter = pendingMessages.find(mid);
 	if (iter == pendingMessages.end()){
+	
+		// At the limit, the oldest message gives its place.
+		while ((maxPendingMessages > 0) && (pendingMessages.size() >= maxPendingMessages)) {
+			pendingMessageListIter_t oldest = pendingMessages.begin();
+			retransmits.erase(oldest->first);
+			templatesInFlight.erase(oldest->first);
+			pendingMessages.erase(oldest);
+		}
+		
 		pendingMessages[mid] = mes;
+		
+		if (retransmitTimeout > 0) {
+			retransmitState_t state;
+			struct timeval timeout = { retransmitTimeout / 1000, (retransmitTimeout % 1000) * 1000 };
+			struct timeval now;
+			
+			gettimeofday(&now, NULL);
+			state.due = Timeval::add(now, timeout);
+			state.timeout = retransmitTimeout;
+			state.retries = 0;
+			retransmits[mid] = state;
+		}
 	} else{
 		throw Error("message to put in pending already exist");
 	}	
 }
+
+/* ---------------------- setRetransmission ------------------------*/
+
+void Session::setRetransmission(unsigned long timeout, unsigned long maxTimeout, 
+								unsigned int retries, unsigned int maxPending)
+{
+	retransmitTimeout = timeout;
+	retransmitMaxTimeout = (maxTimeout < timeout) ? timeout : maxTimeout;
+	retransmitRetries = retries;
+	maxPendingMessages = maxPending;
+}
+
+/* ---------------------- getRetransmissions -----------------------*/
+
+void Session::getRetransmissions(struct timeval now, vector<ipap_message *> &due, 
+								 vector<uint32_t> &expired)
+{
+	retransmitListIter_t iter = retransmits.begin();
+	while (iter != retransmits.end()) {
+	
+		retransmitState_t &state = iter->second;
+		
+		if (Timeval::cmp(state.due, now) > 0) {
+			++iter;
+			continue;
+		}
+		
+		if (state.retries >= retransmitRetries) {
+			expired.push_back(iter->first);
+			pendingMessages.erase(iter->first);
+			templatesInFlight.erase(iter->first);
+			retransmits.erase(iter++);
+			continue;
+		}
+		
+		state.retries++;
+		state.timeout = min(state.timeout * 2, retransmitMaxTimeout);
+		
+		struct timeval timeout = { state.timeout / 1000, (state.timeout % 1000) * 1000 };
+		state.due = Timeval::add(now, timeout);
+		
+		due.push_back(&pendingMessages[iter->first]);
+		++iter;
+	}
+}
+
+/* -------------------- getNextRetransmission ----------------------*/
+
+bool Session::getNextRetransmission(struct timeval &when)
+{
+	retransmitListIter_t iter;
+	bool found = false;
+	
+	for (iter = retransmits.begin(); iter != retransmits.end(); ++iter) {
+		if (!found || (Timeval::cmp(iter->second.due, when) < 0)) {
+			when = iter->second.due;
+			found = true;
+		}
+	}
+	
+	return found;
+}
@@ -36,7 +36,7 @@ using namespace auction;
 /* ------------------------- SessionManager ------------------------- */
 
 SessionManager::SessionManager( ) 
-    : sessions(0), idSource(1)
+    : sessions(0), idSource(1, MANAGER_MAX_UID)
 {
     log = Logger::getInstance();
     ch = log->createChannel("SessionManager");
@@ -52,17 +52,15 @@ SessionManager::SessionManager( )
 
 SessionManager::~SessionManager()
 {
-    sessionDBIter_t iter;
+    sessionUIdIndexIter_t iter;
 
 #ifdef DEBUG
     log->dlog(ch,"Shutdown");
 #endif
 
     for (iter = sessionDB.begin(); iter != sessionDB.end(); iter++) {
-        if (*iter != NULL) {
-            // delete resource request
-            saveDelete(*iter);
-        } 
+        // delete resource request
+        saveDelete(iter->second);
     }
 
     sessionDoneIter_t i;
@@ -76,8 +74,9 @@ SessionManager::~SessionManager()
 
 Session *SessionManager::getSession(int uid)
 {
-    if ((uid >= 0) && ((unsigned int)uid <= sessionDB.size())) {
-        return sessionDB[uid];
+    sessionUIdIndexIter_t iter = sessionDB.find(uid);
+    if (iter != sessionDB.end()) {
+        return iter->second;
     } else {
         return NULL;
     }
@@ -217,12 +216,6 @@ SessionManager::addSession(Session *session)
 		log->dlog(ch, "Session uId = '%d'", session->getUId());
 #endif 
 
-        // resize vector if necessary
-        if ((unsigned int)session->getUId() >= sessionDB.size()) {
-            sessionDB.reserve(session->getUId() * 2 + 1);
-            sessionDB.resize(session->getUId() + 1);
-        }
-
         // insert Session
         sessionDB[session->getUId()] = session; 	
 
@@ -365,7 +358,7 @@ void SessionManager::delSession(Session *s, EventScheduler *e)
 	int uid = s->getUId();
 	string sessionId = s->getSessionId();
 	storeSessionAsDone(s);
-	sessionDB[uid] = NULL;
+	sessionDB.erase(uid);
 	sessionIndex.erase(sessionId);
 		
 	if (e != NULL) {
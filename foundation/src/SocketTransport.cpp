@@ -0,0 +1,339 @@
+/*! \file   SocketTransport.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Unix socket transport joining an agent and an auction manager.
+
+    $Id: SocketTransport.cpp 748 2015-08-23 16:05:00Z amarentes $
+*/
+
+#include "config.h"
+#include "SocketTransport.h"
+#include "AnslpMessageCodec.h"
+#include "Constants.h"
+#include "msg/anslp_ipap_message.h"
+
+using namespace anslp;
+using namespace anslp::msg;
+using namespace auction;
+
+
+//! kinds of anslp event carried in a datagram.
+enum socketEventKind_t
+{
+	SOCKET_ADD_SESSION = 1,
+	SOCKET_REMOVE_SESSION,
+	SOCKET_AUCTION_INTERACTION
+};
+
+
+static void makeAddress(const string &path, struct sockaddr_un &addr)
+{
+	if (path.size() >= sizeof(addr.sun_path)) {
+		throw Error("socket path %s is too long", path.c_str());
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+}
+
+
+//! give the session and the messages to a new event, messages is left empty
+template <class E>
+static E *takeMessages(E *evt, const string &sessionId, vector<anslp_ipap_message *> &messages)
+{
+	evt->setSession(sessionId);
+	for (size_t i = 0; i < messages.size(); i++) {
+		evt->setObject(mspec_rule_key(), messages[i]);
+	}
+	messages.clear();
+	return evt;
+}
+
+
+/* ------------------------- SocketTransport ------------------------- */
+
+SocketTransport::SocketTransport(string _localPath, string _peerPath, 
+								 anslp::FastQueue *_queue)
+  : AnslpEventTransport("SocketTransport", _queue), localPath(_localPath), 
+    peerPath(_peerPath), fd(-1)
+{
+	struct sockaddr_un localAddr;
+	makeAddress(localPath, localAddr);
+	makeAddress(peerPath, peerAddr);
+
+	fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+	if (fd < 0) {
+		throw Error("cannot open anslp socket: %s", strerror(errno));
+	}
+
+	// Left over by an end that did not go away cleanly.
+	unlink(localPath.c_str());
+
+	if (bind(fd, (struct sockaddr *) &localAddr, sizeof(localAddr)) < 0) {
+		int err = errno;
+		close(fd);
+		throw Error("cannot bind anslp socket %s: %s", localPath.c_str(), strerror(err));
+	}
+
+	int bufSize = 2 * SOCKET_TRANSPORT_MAX_MESSAGE;
+	setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufSize, sizeof(bufSize));
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+
+#ifdef ENABLE_THREADS
+	int res = threadCreate(&thread, thread_func, this);
+	if (res != 0) {
+		close(fd);
+		unlink(localPath.c_str());
+		throw Error("cannot create anslp socket thread: %s", strerror(res));
+	}
+#endif
+
+	log->log(ch, "Anslp socket %s, peer at %s", localPath.c_str(), peerPath.c_str());
+}
+
+
+/* ------------------------- ~SocketTransport ------------------------- */
+
+SocketTransport::~SocketTransport()
+{
+
+#ifdef ENABLE_THREADS
+	// An empty datagram stops the thread, the peer never sends one.
+	struct sockaddr_un localAddr;
+	makeAddress(localPath, localAddr);
+	sendto(fd, "", 0, 0, (struct sockaddr *) &localAddr, sizeof(localAddr));
+
+	threadJoin(thread);
+#endif
+
+	close(fd);
+	unlink(localPath.c_str());
+
+#ifdef DEBUG
+	log->dlog(ch, "Closed anslp socket %s", localPath.c_str());
+#endif
+
+}
+
+
+/* ------------------------- thread_func ------------------------- */
+
+void *SocketTransport::thread_func(void *arg)
+{
+	((SocketTransport *)arg)->main();
+	return NULL;
+}
+
+
+/* ------------------------- main ------------------------- */
+
+void SocketTransport::main()
+{
+	vector<char> buffer(SOCKET_TRANSPORT_MAX_MESSAGE);
+
+	while (1) {
+		ssize_t len = recv(fd, &buffer[0], buffer.size(), 0);
+		if (len < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			log->elog(ch, "Cannot receive from anslp socket: %s", strerror(errno));
+			break;
+		}
+
+		if (len == 0) {
+			break;
+		}
+
+		handleDatagram(&buffer[0], len);
+	}
+}
+
+
+/* ------------------------- getPollFd ------------------------- */
+
+int SocketTransport::getPollFd()
+{
+#ifdef ENABLE_THREADS
+	return -1;
+#else
+	return fd;
+#endif
+}
+
+
+/* ------------------------- receive ------------------------- */
+
+void SocketTransport::receive()
+{
+	vector<char> buffer(SOCKET_TRANSPORT_MAX_MESSAGE);
+
+	while (1) {
+		ssize_t len = recv(fd, &buffer[0], buffer.size(), MSG_DONTWAIT);
+		if (len < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+				log->elog(ch, "Cannot receive from anslp socket: %s", strerror(errno));
+			}
+			break;
+		}
+
+		if (len > 0) {
+			handleDatagram(&buffer[0], len);
+		}
+	}
+}
+
+
+/* ------------------------- handleDatagram ------------------------- */
+
+void SocketTransport::handleDatagram(const char *data, size_t len)
+{
+	recordReader in(data, len);
+	AnslpEvent *evt = decodeEvent(in);
+	if (evt == NULL) {
+		log->wlog(ch, "Dropped a damaged datagram of %d bytes", (int) len);
+		return;
+	}
+
+	try {
+		enqueue(evt);
+	} catch (Error &e) {
+		log->elog(ch, "%s", e.getError().c_str());
+	}
+}
+
+
+/* ------------------------- encodeEvent ------------------------- */
+
+void SocketTransport::encodeEvent(anslp::AnslpEvent *evt, string &out)
+{
+	objectList_t *objects = NULL;
+
+	if (is_addsession_event(evt)) {
+		AddSessionEvent *e = dynamic_cast<AddSessionEvent *>(evt);
+		out.push_back((char) SOCKET_ADD_SESSION);
+		putString(out, e->getSession());
+		objects = e->getObjects();
+	} else if (is_removesession_event(evt)) {
+		RemoveSessionEvent *e = dynamic_cast<RemoveSessionEvent *>(evt);
+		out.push_back((char) SOCKET_REMOVE_SESSION);
+		putString(out, e->getSession());
+		objects = e->getObjects();
+	} else if (is_auction_interaction_event(evt)) {
+		AuctionInteractionEvent *e = dynamic_cast<AuctionInteractionEvent *>(evt);
+		out.push_back((char) SOCKET_AUCTION_INTERACTION);
+		putString(out, e->getSession());
+		objects = e->getObjects();
+	} else {
+		throw Error("the anslp socket can not carry this event");
+	}
+
+	vector<anslp_ipap_message *> messages;
+	for (objectListIter_t it = objects->begin(); it != objects->end(); ++it) {
+		anslp_ipap_message *message = dynamic_cast<anslp_ipap_message *>(it->second);
+		if (message != NULL) {
+			messages.push_back(message);
+		}
+	}
+
+	putU32(out, messages.size());
+	for (size_t i = 0; i < messages.size(); i++) {
+		putIpApMessage(out, *messages[i]);
+	}
+}
+
+
+/* ------------------------- decodeEvent ------------------------- */
+
+anslp::AnslpEvent *SocketTransport::decodeEvent(recordReader &in)
+{
+	uint8_t kind;
+	string sessionId;
+	uint32_t count;
+
+	if (!in.u8(kind) || !in.str(sessionId) || !in.u32(count)) {
+		return NULL;
+	}
+
+	vector<anslp_ipap_message *> messages;
+	bool damaged = false;
+	for (uint32_t i = 0; i < count; i++) {
+		anslp_ipap_message *message = getIpApMessage(in);
+		if (message == NULL) {
+			damaged = true;
+			break;
+		}
+		messages.push_back(message);
+	}
+
+	anslp::AnslpEvent *evt = NULL;
+	if (!damaged && in.atEnd()) {
+		switch (kind) {
+		case SOCKET_ADD_SESSION:
+			evt = takeMessages(new AddSessionEvent(queue), sessionId, messages);
+			break;
+		case SOCKET_REMOVE_SESSION:
+			evt = takeMessages(new RemoveSessionEvent(queue), sessionId, messages);
+			break;
+		case SOCKET_AUCTION_INTERACTION:
+			evt = takeMessages(new AuctionInteractionEvent(), sessionId, messages);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// Left over when the datagram is damaged.
+	for (size_t i = 0; i < messages.size(); i++) {
+		delete messages[i];
+	}
+
+	return evt;
+}
+
+
+/* ------------------------- deliver ------------------------- */
+
+void SocketTransport::deliver(anslp::AnslpEvent *evt)
+{
+	string out;
+
+	try {
+		encodeEvent(evt, out);
+	} catch (Error &e) {
+		delete evt;
+		throw e;
+	}
+	delete evt;
+
+	if (out.size() > SOCKET_TRANSPORT_MAX_MESSAGE) {
+		throw Error("anslp event of %d bytes does not fit a datagram", (int) out.size());
+	}
+
+	if (sendto(fd, out.data(), out.size(), 0, (struct sockaddr *) &peerAddr, 
+			   sizeof(peerAddr)) < 0) {
+		throw Error("cannot send to anslp socket %s: %s", peerPath.c_str(), strerror(errno));
+	}
+}
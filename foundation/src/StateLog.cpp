@@ -0,0 +1,508 @@
+/*! \file   StateLog.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Write ahead log of the auction manager state changes since the last
+    snapshot.
+
+    $Id: StateLog.cpp 748 2015-08-18 10:05:00Z amarentes $
+*/
+
+#include "config.h"
+#include "StateLog.h"
+#include "Timeval.h"
+#include <fcntl.h>
+
+using namespace auction;
+
+
+/* ------------------------- encode ------------------------- */
+
+void StateLog::encode(const stateLogEntry_t &entry, string &payload)
+{
+	payload.push_back((char) entry.type);
+	putU64(payload, entry.sequence);
+
+	switch (entry.type) {
+	case STATELOG_AUCTIONS_ADDED:
+		putString(payload, entry.message);
+		break;
+	case STATELOG_AUCTION_REMOVED:
+	case STATELOG_BIDDING_OBJECT_REMOVED:
+		putString(payload, entry.set);
+		putString(payload, entry.name);
+		break;
+	case STATELOG_BIDDING_OBJECTS_ADDED:
+	case STATELOG_MESSAGE_SENT:
+		putString(payload, entry.sessionId);
+		putU32(payload, entry.messageId);
+		putString(payload, entry.message);
+		break;
+	case STATELOG_SESSION_CREATED:
+		StateSnapshot::encode(entry.session, payload);
+		break;
+	case STATELOG_SESSION_REMOVED:
+		putString(payload, entry.sessionId);
+		break;
+	case STATELOG_MESSAGE_CONFIRMED:
+	case STATELOG_MESSAGE_EXPIRED:
+	case STATELOG_MESSAGES_CONFIRMED:
+		putString(payload, entry.sessionId);
+		putU32(payload, entry.messageId);
+		break;
+	default:
+		break;
+	}
+}
+
+
+/* ------------------------- decode ------------------------- */
+
+bool StateLog::decode(const string &payload, stateLogEntry_t &entry)
+{
+	recordReader r(payload);
+	uint8_t type;
+
+	if (!r.u8(type) || !r.u64(entry.sequence)) {
+		return false;
+	}
+
+	bool valid = false;
+
+	switch (type) {
+	case STATELOG_AUCTIONS_ADDED:
+		valid = r.str(entry.message);
+		break;
+	case STATELOG_AUCTION_REMOVED:
+	case STATELOG_BIDDING_OBJECT_REMOVED:
+		valid = r.str(entry.set) && r.str(entry.name);
+		break;
+	case STATELOG_BIDDING_OBJECTS_ADDED:
+	case STATELOG_MESSAGE_SENT:
+		valid = r.str(entry.sessionId) && r.u32(entry.messageId) && r.str(entry.message);
+		break;
+	case STATELOG_SESSION_CREATED:
+		valid = StateSnapshot::decode(r, entry.session);
+		break;
+	case STATELOG_SESSION_REMOVED:
+		valid = r.str(entry.sessionId);
+		break;
+	case STATELOG_MESSAGE_CONFIRMED:
+	case STATELOG_MESSAGE_EXPIRED:
+	case STATELOG_MESSAGES_CONFIRMED:
+		valid = r.str(entry.sessionId) && r.u32(entry.messageId);
+		break;
+	default:
+		break;
+	}
+
+	if (!valid || !r.atEnd()) {
+		return false;
+	}
+
+	entry.type = (stateLogEntryType_t) type;
+	return true;
+}
+
+
+/* ------------------------- StateLog ------------------------- */
+
+StateLog::StateLog(string _fileName, unsigned int _syncInterval)
+  : fileName(_fileName), fd(-1), syncInterval(_syncInterval), baseSequence(0),
+    sequence(0), size(0), pending(0), appended(0), syncs(0), threaded(0)
+{
+	log = Logger::getInstance();
+	ch = log->createChannel("StateLog");
+
+	fd = ::open(fileName.c_str(), O_RDWR | O_CREAT, 0640);
+	if (fd < 0) {
+		throw Error("cannot open state log %s: %s", fileName.c_str(), strerror(errno));
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		int err = errno;
+		::close(fd);
+		throw Error("cannot open state log %s: %s", fileName.c_str(), strerror(err));
+	}
+
+	if (st.st_size == 0) {
+		writeHeader();
+		size = STATELOG_HEADER_LEN;
+	} else {
+		try {
+			// Find the last sequence and where the valid entries end.
+			StateLogReader reader(fileName);
+			stateLogEntry_t entry;
+
+			baseSequence = reader.getBaseSequence();
+			sequence = baseSequence;
+			while (reader.next(entry)) {
+				if (entry.sequence > sequence) {
+					sequence = entry.sequence;
+				}
+			}
+
+			size = reader.getOffset();
+			if (reader.isCorrupt()) {
+				log->wlog(ch, "damaged entry at offset %lu of %s, the rest is dropped",
+						  size, fileName.c_str());
+				if (ftruncate(fd, size) != 0) {
+					throw Error("cannot truncate state log %s: %s", fileName.c_str(),
+								strerror(errno));
+				}
+			}
+		} catch (Error &e) {
+			::close(fd);
+			throw e;
+		}
+	}
+
+	lseek(fd, size, SEEK_SET);
+	gettimeofday(&lastSync, NULL);
+
+#ifdef ENABLE_THREADS
+	threaded = 1;
+	mutexInit(&maccess);
+#endif
+
+}
+
+
+/* ------------------------- ~StateLog ------------------------- */
+
+StateLog::~StateLog()
+{
+	doFlush(true);
+	::close(fd);
+
+#ifdef ENABLE_THREADS
+	mutexDestroy(&maccess);
+#endif
+
+}
+
+
+/* ------------------------- writeHeader ------------------------- */
+
+void StateLog::writeHeader()
+{
+	string h(STATELOG_MAGIC, 4);
+	putU32(h, STATELOG_VERSION);
+	putU64(h, baseSequence);
+
+	if (::pwrite(fd, h.data(), h.size(), 0) != (ssize_t) h.size()) {
+		throw Error("cannot write state log %s: %s", fileName.c_str(), strerror(errno));
+	}
+}
+
+
+/* ------------------------- append ------------------------- */
+
+void StateLog::append(stateLogEntry_t &entry)
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	entry.sequence = ++sequence;
+
+	string payload;
+	encode(entry, payload);
+
+	putU32(buffer, payload.size());
+	putU32(buffer, recordCrc32(payload.data(), payload.size()));
+	buffer.append(payload);
+
+	appended++;
+}
+
+
+/* ------------------------- flush ------------------------- */
+
+void StateLog::flush()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	doFlush(false);
+}
+
+
+/* ------------------------- sync ------------------------- */
+
+void StateLog::sync()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	doFlush(true);
+}
+
+
+/* ------------------------- getNextSync ------------------------- */
+
+bool StateLog::getNextSync(struct timeval &when)
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	if ((pending == 0) && buffer.empty()) {
+		return false;
+	}
+
+	struct timeval interval = { syncInterval / 1000, (syncInterval % 1000) * 1000 };
+	when = Timeval::add(lastSync, interval);
+	return true;
+}
+
+
+/* ------------------------- doFlush ------------------------- */
+
+void StateLog::doFlush(bool forceSync)
+{
+	size_t done = 0;
+	while (done < buffer.size()) {
+		ssize_t n = ::write(fd, buffer.data() + done, buffer.size() - done);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			log->elog(ch, "cannot write state log %s: %s", fileName.c_str(), strerror(errno));
+			break;
+		}
+		done += n;
+	}
+
+	// Keep what was not written, it is retried on the next flush.
+	buffer.erase(0, done);
+	size += done;
+	pending += done;
+
+	if (pending == 0) {
+		return;
+	}
+
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	unsigned long elapsed = (now.tv_sec - lastSync.tv_sec) * 1000 +
+							(now.tv_usec - lastSync.tv_usec) / 1000;
+
+	if (forceSync || (elapsed >= syncInterval)) {
+		fdatasync(fd);
+		syncs++;
+		pending = 0;
+		lastSync = now;
+	}
+}
+
+
+/* ------------------------- compact ------------------------- */
+
+void StateLog::compact(uint64_t upTo)
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	doFlush(true);
+
+	if (upTo <= baseSequence) {
+		return;
+	}
+
+	// The header goes first: if the truncation is lost, the entries left
+	// are still known to be in the snapshot.
+	baseSequence = upTo;
+	writeHeader();
+
+	if (upTo < sequence) {
+		// Entries after the snapshot, they stay until the next one.
+#ifdef DEBUG
+		log->dlog(ch, "%llu entries kept after compacting %s",
+				  (unsigned long long) (sequence - upTo), fileName.c_str());
+#endif
+		fdatasync(fd);
+		return;
+	}
+
+	if (ftruncate(fd, STATELOG_HEADER_LEN) != 0) {
+		throw Error("cannot truncate state log %s: %s", fileName.c_str(), strerror(errno));
+	}
+
+	lseek(fd, STATELOG_HEADER_LEN, SEEK_SET);
+	size = STATELOG_HEADER_LEN;
+
+	fdatasync(fd);
+	syncs++;
+}
+
+
+/* ------------------------- getSequence ------------------------- */
+
+uint64_t StateLog::getSequence()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	return sequence;
+}
+
+
+/* ------------------------- getBaseSequence ------------------------- */
+
+uint64_t StateLog::getBaseSequence()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	return baseSequence;
+}
+
+
+/* ------------------------- getSize ------------------------- */
+
+unsigned long StateLog::getSize()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	return size + buffer.size();
+}
+
+
+/* ------------------------- getNumAppended ------------------------- */
+
+unsigned long StateLog::getNumAppended()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	return appended;
+}
+
+
+/* ------------------------- getNumSyncs ------------------------- */
+
+unsigned long StateLog::getNumSyncs()
+{
+
+#ifdef ENABLE_THREADS
+	AUTOLOCK(threaded, &maccess);
+#endif
+
+	return syncs;
+}
+
+
+/* ------------------------- StateLogReader ------------------------- */
+
+StateLogReader::StateLogReader(string _fileName)
+  : fileName(_fileName), baseSequence(0), offset(0), entries(0), corrupt(false)
+{
+	in.open(fileName.c_str(), ios::in | ios::binary);
+	if (!in) {
+		throw Error("cannot open state log %s", fileName.c_str());
+	}
+
+	char header[STATELOG_HEADER_LEN];
+	in.read(header, STATELOG_HEADER_LEN);
+	if ((in.gcount() != (streamsize) STATELOG_HEADER_LEN) ||
+		(memcmp(header, STATELOG_MAGIC, 4) != 0) ||
+		(getU32(header + 4) != STATELOG_VERSION)) {
+		throw Error("%s is not a state log", fileName.c_str());
+	}
+
+	baseSequence = getU64(header + 8);
+	offset = STATELOG_HEADER_LEN;
+}
+
+
+/* ------------------------- ~StateLogReader ------------------------- */
+
+StateLogReader::~StateLogReader()
+{
+	in.close();
+}
+
+
+/* ------------------------- next ------------------------- */
+
+bool StateLogReader::next(stateLogEntry_t &entry)
+{
+	if (corrupt) {
+		return false;
+	}
+
+	char header[STATELOG_ENTRY_HEADER_LEN];
+	in.read(header, STATELOG_ENTRY_HEADER_LEN);
+
+	if (in.gcount() == 0) {
+		return false;	// clean end
+	}
+
+	if (in.gcount() != (streamsize) STATELOG_ENTRY_HEADER_LEN) {
+		corrupt = true;
+		return false;
+	}
+
+	uint32_t len = getU32(header);
+	uint32_t crc = getU32(header + 4);
+
+	if ((len == 0) || (len > STATELOG_MAX_ENTRY_LEN)) {
+		corrupt = true;
+		return false;
+	}
+
+	string payload(len, '\0');
+	in.read(&payload[0], len);
+
+	if ((in.gcount() != (streamsize) len) ||
+		(recordCrc32(payload.data(), len) != crc)) {
+		corrupt = true;
+		return false;
+	}
+
+	entry = stateLogEntry_t();
+	if (!StateLog::decode(payload, entry)) {
+		corrupt = true;
+		return false;
+	}
+
+	offset += STATELOG_ENTRY_HEADER_LEN + len;
+	entries++;
+	return true;
+}
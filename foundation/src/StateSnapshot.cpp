@@ -0,0 +1,289 @@
+/*! \file   StateSnapshot.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Snapshot of the auction manager state used for warm restarts.
+
+    $Id: StateSnapshot.cpp 748 2015-08-17 09:20:00Z amarentes $
+*/
+
+#include "config.h"
+#include "StateSnapshot.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <libgen.h>
+
+using namespace auction;
+
+
+/* ------------------------- encode ------------------------- */
+
+void StateSnapshot::encode(const sessionStateRecord_t &session, string &out)
+{
+	putString(out, session.sessionId);
+	putString(out, session.anslpSessionId);
+	putU32(out, session.state);
+	putString(out, session.senderAddress);
+	putString(out, session.receiverAddress);
+	putString(out, session.sourceAddress);
+	putU32(out, session.senderPort);
+	putU32(out, session.receiverPort);
+	putU32(out, session.protocol);
+	putU32(out, session.lifetime);
+	putU32(out, session.lastMessageId);
+	putU32(out, session.lastReceived);
+	putStrings(out, session.auctions);
+
+	putU32(out, session.pendingMessages.size());
+	pendingMessageRecordListConstIter_t iter;
+	for (iter = session.pendingMessages.begin(); iter != session.pendingMessages.end(); ++iter) {
+		putU32(out, iter->first);
+		putString(out, iter->second);
+	}
+}
+
+
+/* ------------------------- decode ------------------------- */
+
+bool StateSnapshot::decode(recordReader &r, sessionStateRecord_t &session)
+{
+	uint32_t senderPort, receiverPort, protocol, n;
+
+	if (!(r.str(session.sessionId) && r.str(session.anslpSessionId) &&
+		  r.u32(session.state) && r.str(session.senderAddress) &&
+		  r.str(session.receiverAddress) && r.str(session.sourceAddress) &&
+		  r.u32(senderPort) && r.u32(receiverPort) && r.u32(protocol) &&
+		  r.u32(session.lifetime) && r.u32(session.lastMessageId) &&
+		  r.u32(session.lastReceived) &&
+		  r.strings(session.auctions) && r.u32(n))) {
+		return false;
+	}
+
+	session.senderPort = (uint16_t) senderPort;
+	session.receiverPort = (uint16_t) receiverPort;
+	session.protocol = (uint8_t) protocol;
+
+	for (uint32_t i = 0; i < n; i++) {
+		uint32_t seqNo;
+		string message;
+		if (!r.u32(seqNo) || !r.str(message)) {
+			return false;
+		}
+		session.pendingMessages.push_back(make_pair(seqNo, message));
+	}
+	return true;
+}
+
+
+/* ------------------------- encode ------------------------- */
+
+void StateSnapshot::encode(const stateSnapshot_t &snapshot, string &payload)
+{
+	putU64(payload, snapshot.logSequence);
+	putString(payload, snapshot.auctions);
+	putString(payload, snapshot.auctionFile);
+	putU64(payload, (uint64_t) snapshot.auctionFileTime);
+
+	putU32(payload, snapshot.sessions.size());
+	sessionStateRecordListConstIter_t sessionIter;
+	for (sessionIter = snapshot.sessions.begin(); sessionIter != snapshot.sessions.end();
+		 ++sessionIter) {
+		encode(*sessionIter, payload);
+	}
+
+	putU32(payload, snapshot.biddingObjects.size());
+	biddingObjectStateRecordListConstIter_t bidIter;
+	for (bidIter = snapshot.biddingObjects.begin(); bidIter != snapshot.biddingObjects.end();
+		 ++bidIter) {
+		putString(payload, bidIter->sessionId);
+		putString(payload, bidIter->message);
+	}
+}
+
+
+/* ------------------------- decode ------------------------- */
+
+bool StateSnapshot::decode(const char *payload, size_t len, stateSnapshot_t &snapshot)
+{
+	recordReader r(payload, len);
+	uint32_t n;
+	uint64_t mtime;
+
+	if (!r.u64(snapshot.logSequence) || !r.str(snapshot.auctions) || 
+		!r.str(snapshot.auctionFile) || !r.u64(mtime) || !r.u32(n)) {
+		return false;
+	}
+	snapshot.auctionFileTime = (time_t) mtime;
+
+	snapshot.sessions.reserve(n);
+	for (uint32_t i = 0; i < n; i++) {
+		snapshot.sessions.push_back(sessionStateRecord_t());
+		if (!decode(r, snapshot.sessions.back())) {
+			return false;
+		}
+	}
+
+	if (!r.u32(n)) {
+		return false;
+	}
+
+	snapshot.biddingObjects.reserve(n);
+	for (uint32_t i = 0; i < n; i++) {
+		snapshot.biddingObjects.push_back(biddingObjectStateRecord_t());
+		biddingObjectStateRecord_t &bid = snapshot.biddingObjects.back();
+		if (!r.str(bid.sessionId) || !r.str(bid.message)) {
+			return false;
+		}
+	}
+
+	return r.atEnd();
+}
+
+
+/* ------------------------- write ------------------------- */
+
+void StateSnapshot::write(string fileName, const stateSnapshot_t &snapshot)
+{
+	string payload;
+	encode(snapshot, payload);
+
+	string data(SNAPSHOT_MAGIC, 4);
+	putU32(data, SNAPSHOT_VERSION);
+	putU64(data, (uint64_t) snapshot.created);
+	putU64(data, payload.size());
+	putU32(data, recordCrc32(payload.data(), payload.size()));
+	data.append(payload);
+
+	string tmpName = fileName + ".tmp";
+
+	int fd = ::open(tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		throw Error("cannot create snapshot %s: %s", tmpName.c_str(), strerror(errno));
+	}
+
+	size_t done = 0;
+	while (done < data.size()) {
+		ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			int err = errno;
+			::close(fd);
+			::unlink(tmpName.c_str());
+			throw Error("cannot write snapshot %s: %s", tmpName.c_str(), strerror(err));
+		}
+		done += n;
+	}
+
+	int syncRet = fsync(fd);
+	int err = errno;
+	if ((::close(fd) != 0) && (syncRet == 0)) {
+		syncRet = -1;
+		err = errno;
+	}
+
+	if (syncRet != 0) {
+		::unlink(tmpName.c_str());
+		throw Error("cannot write snapshot %s: %s", tmpName.c_str(), strerror(err));
+	}
+
+	if (::rename(tmpName.c_str(), fileName.c_str()) != 0) {
+		int err = errno;
+		::unlink(tmpName.c_str());
+		throw Error("cannot replace snapshot %s: %s", fileName.c_str(), strerror(err));
+	}
+
+	// make the rename itself durable.
+	vector<char> path(fileName.begin(), fileName.end());
+	path.push_back('\0');
+	int dirFd = ::open(dirname(&path[0]), O_RDONLY);
+	if (dirFd >= 0) {
+		fsync(dirFd);
+		::close(dirFd);
+	}
+}
+
+
+/* ------------------------- read ------------------------- */
+
+bool StateSnapshot::read(string fileName, stateSnapshot_t &snapshot)
+{
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) {
+		if (errno == ENOENT) {
+			return false;
+		}
+		throw Error("cannot open snapshot %s: %s", fileName.c_str(), strerror(errno));
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		int err = errno;
+		::close(fd);
+		throw Error("cannot open snapshot %s: %s", fileName.c_str(), strerror(err));
+	}
+
+	size_t size = (size_t) st.st_size;
+	if (size < SNAPSHOT_HEADER_LEN) {
+		::close(fd);
+		throw Error("%s is not a snapshot", fileName.c_str());
+	}
+
+	void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (map == MAP_FAILED) {
+		throw Error("cannot map snapshot %s: %s", fileName.c_str(), strerror(errno));
+	}
+
+	const char *data = (const char *) map;
+	madvise(map, size, MADV_SEQUENTIAL);
+
+	try {
+		if (memcmp(data, SNAPSHOT_MAGIC, 4) != 0) {
+			throw Error("%s is not a snapshot", fileName.c_str());
+		}
+
+		if (getU32(data + 4) != SNAPSHOT_VERSION) {
+			throw Error("snapshot %s has version %u, expected %u", fileName.c_str(),
+						getU32(data + 4), SNAPSHOT_VERSION);
+		}
+
+		uint64_t len = getU64(data + 16);
+		const char *payload = data + SNAPSHOT_HEADER_LEN;
+
+		if ((len != size - SNAPSHOT_HEADER_LEN) ||
+			(recordCrc32(payload, len) != getU32(data + 24))) {
+			throw Error("snapshot %s is damaged", fileName.c_str());
+		}
+
+		snapshot.created = (time_t) getU64(data + 8);
+		if (!decode(payload, len, snapshot)) {
+			throw Error("snapshot %s is damaged", fileName.c_str());
+		}
+
+	} catch (Error &e) {
+		munmap(map, size);
+		throw e;
+	}
+
+	munmap(map, size);
+	return true;
+}
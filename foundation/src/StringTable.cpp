@@ -0,0 +1,199 @@
+/*! \file   StringTable.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Interning table for set, name and session strings.
+
+    $Id: StringTable.cpp 748 2015-07-23 15:30:00Z amarentes $
+*/
+
+#include "StringTable.h"
+
+using namespace auction;
+
+StringTable *StringTable::s_instance = NULL;
+
+/* -------------------- getInstance -------------------- */
+
+StringTable *StringTable::getInstance()
+{
+    if (s_instance == NULL) {
+        s_instance = new StringTable();
+    }
+    return s_instance;
+}
+
+
+/* -------------------- StringTable -------------------- */
+
+StringTable::StringTable()
+  : collectedSize(1), threaded(1)
+{
+
+#ifdef ENABLE_THREADS
+    if (threaded) {
+        mutexInit(&maccess);
+    }
+#endif
+
+	// The table keeps one reference, so it is never collected.
+	emptyEntry = new internEntry_t;
+	emptyEntry->hash = hashString("");
+	emptyEntry->refs = 1;
+	entries[emptyEntry->value] = emptyEntry;
+}
+
+
+/* -------------------- ~StringTable -------------------- */
+
+StringTable::~StringTable()
+{
+	internEntryListIter_t iter;
+	for (iter = entries.begin(); iter != entries.end(); ++iter) {
+		delete iter->second;
+	}
+
+#ifdef ENABLE_THREADS
+    if (threaded) {
+        mutexDestroy(&maccess);
+    }
+#endif
+
+}
+
+
+/* -------------------- intern -------------------- */
+
+internEntry_t *StringTable::intern(const string &value)
+{
+
+#ifdef ENABLE_THREADS
+    AUTOLOCK(threaded, &maccess);
+#endif
+
+	internEntryListIter_t iter = entries.find(value);
+	if (iter != entries.end()) {
+		__sync_fetch_and_add(&(iter->second->refs), 1);
+		return iter->second;
+	}
+
+	internEntry_t *entry = new internEntry_t;
+	entry->value = value;
+	entry->hash = hashString(value);
+	entry->refs = 1;
+	entries[value] = entry;
+
+	return entry;
+}
+
+
+/* -------------------- find -------------------- */
+
+internEntry_t *StringTable::find(const string &value)
+{
+
+#ifdef ENABLE_THREADS
+    AUTOLOCK(threaded, &maccess);
+#endif
+
+	internEntryListIter_t iter = entries.find(value);
+	if (iter == entries.end()) {
+		return NULL;
+	}
+
+	__sync_fetch_and_add(&(iter->second->refs), 1);
+	return iter->second;
+}
+
+
+/* -------------------- getEmpty -------------------- */
+
+internEntry_t *StringTable::getEmpty()
+{
+	__sync_fetch_and_add(&(emptyEntry->refs), 1);
+	return emptyEntry;
+}
+
+
+/* -------------------- collect -------------------- */
+
+unsigned int StringTable::collect()
+{
+
+#ifdef ENABLE_THREADS
+    AUTOLOCK(threaded, &maccess);
+#endif
+
+	return doCollect();
+}
+
+
+/* -------------------- collectGrown -------------------- */
+
+unsigned int StringTable::collectGrown()
+{
+
+#ifdef ENABLE_THREADS
+    AUTOLOCK(threaded, &maccess);
+#endif
+
+	if (entries.size() < 2 * collectedSize) {
+		return 0;
+	}
+
+	return doCollect();
+}
+
+
+/* -------------------- doCollect -------------------- */
+
+unsigned int StringTable::doCollect()
+{
+	// An entry without references can only be reached through the table,
+	// which is locked, so it is safe to remove it here.
+	unsigned int removed = 0;
+	internEntryListIter_t iter = entries.begin();
+	while (iter != entries.end()) {
+		if (iter->second->refs == 0) {
+			delete iter->second;
+			entries.erase(iter++);
+			removed++;
+		} else {
+			++iter;
+		}
+	}
+
+	collectedSize = entries.size();
+
+	return removed;
+}
+
+
+/* -------------------- size -------------------- */
+
+unsigned int StringTable::size()
+{
+
+#ifdef ENABLE_THREADS
+    AUTOLOCK(threaded, &maccess);
+#endif
+
+	return entries.size();
+}
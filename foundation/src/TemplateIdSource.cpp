@@ -131,6 +131,20 @@ void TemplateIdSource::freeId(uint16_t id)
 }
 
 
+void TemplateIdSource::reserveId(uint16_t id)
+{
+
+#ifdef ENABLE_THREADS			
+    AUTOLOCK(threaded, &maccess);
+#endif
+
+    freeIds.remove(id);
+    if (find(idReserved.begin(), idReserved.end(), id) == idReserved.end()) {
+        idReserved.push_back(id);
+    }
+}
+
+
 void TemplateIdSource::dump( ostream &os )
 {
     os << "TemplateIdSource dump:" << endl
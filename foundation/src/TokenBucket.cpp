@@ -0,0 +1,103 @@
+/*! \file   TokenBucket.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    Token bucket limiting the rate of the bidding messages admitted.
+
+    $Id: TokenBucket.cpp 748 2015-08-22 10:20:00Z amarentes $
+*/
+
+#include "config.h"
+#include "TokenBucket.h"
+
+using namespace auction;
+
+
+/* ------------------------- TokenBucket ------------------------- */
+
+TokenBucket::TokenBucket(double _rate, double _burst)
+{
+	setRate(_rate, _burst);
+}
+
+
+/* ------------------------- setRate ------------------------- */
+
+void TokenBucket::setRate(double _rate, double _burst)
+{
+	rate = (_rate > 0) ? _rate : 0;
+
+	// Less than a token would never admit anything.
+	burst = (_burst >= 1) ? _burst : 1;
+
+	tokens = burst;
+	timerclear(&last);
+}
+
+
+/* ------------------------- refill ------------------------- */
+
+void TokenBucket::refill(struct timeval now)
+{
+	if (!timerisset(&last)) {
+		last = now;
+		return;
+	}
+
+	double elapsed = (double) (now.tv_sec - last.tv_sec) +
+					 (double) (now.tv_usec - last.tv_usec) / 1000000.0;
+
+	// A clock going back adds nothing.
+	if (elapsed > 0) {
+		tokens += elapsed * rate;
+		if (tokens > burst) {
+			tokens = burst;
+		}
+		last = now;
+	}
+}
+
+
+/* ------------------------- isAvailable ------------------------- */
+
+bool TokenBucket::isAvailable(struct timeval now, double n)
+{
+	if (rate == 0) {
+		return true;
+	}
+
+	refill(now);
+	return (tokens >= n);
+}
+
+
+/* ------------------------- take ------------------------- */
+
+bool TokenBucket::take(struct timeval now, double n)
+{
+	if (!isAvailable(now, n)) {
+		return false;
+	}
+
+	if (rate > 0) {
+		tokens -= n;
+	}
+	return true;
+}
@@ -0,0 +1,187 @@
+/*!\file   WideIdSource.cpp
+
+    Copyright 2014-2015 Universidad de los Andes, Bogotá, Colombia
+
+    This file is part of Network Auction Manager System (NETAUM).
+
+    NETAUM is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    NETAUM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this software; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+    Description:
+    manage unique 32 bit numeric ids for an id space
+
+    $Id: WideIdSource.cpp 2015-07-23 13:59:00Z amarentes $
+
+*/
+
+#include "WideIdSource.h"
+
+using namespace auction;
+
+WideIdSource::WideIdSource(int _unique, uint32_t _maxId)
+  : num(0), maxId(_maxId), unique(_unique), used(0)
+{
+    // Levels up to the one that fits the whole id space in a word.
+    uint64_t bits = (uint64_t) maxId + 1;
+    do {
+        usedMap.push_back(vector<uint32_t>());
+        bits = (bits + 31) >> 5;
+    } while (bits > 1);
+}
+
+
+WideIdSource::~WideIdSource()
+{
+    // nothing to do
+}
+
+
+void WideIdSource::setUsed(uint32_t id)
+{
+    uint64_t pos = id;
+    for (size_t level = 0; level < usedMap.size(); level++) {
+        vector<uint32_t> &map = usedMap[level];
+        uint64_t word = pos >> 5;
+        if (word >= map.size()) {
+            map.resize(word + 1, 0);
+        }
+
+        map[word] |= (1U << (pos & 31));
+
+        // The level above only changes when the word gets full.
+        if (map[word] != ~0U) {
+            break;
+        }
+        pos = word;
+    }
+}
+
+
+void WideIdSource::clearUsed(uint32_t id)
+{
+    uint64_t pos = id;
+    for (size_t level = 0; level < usedMap.size(); level++) {
+        uint32_t &bits = usedMap[level][pos >> 5];
+        bool wasFull = (bits == ~0U);
+
+        bits &= ~(1U << (pos & 31));
+
+        // The level above only changes when the word was full.
+        if (!wasFull) {
+            break;
+        }
+        pos = pos >> 5;
+    }
+}
+
+
+uint64_t WideIdSource::findClear(size_t level, uint64_t pos)
+{
+    uint64_t word = pos >> 5;
+
+    // Positions below pos count as set.
+    uint32_t bits = getWord(level, word) | ((1U << (pos & 31)) - 1);
+    if (bits != ~0U) {
+        return (word << 5) + __builtin_ctz(~bits);
+    }
+
+    // The top level is a single word, what follows it is empty.
+    if (level + 1 == usedMap.size()) {
+        return (word + 1) << 5;
+    }
+
+    // The level above tells the next word that is not full.
+    word = findClear(level + 1, word + 1);
+    return (word << 5) + __builtin_ctz(~getWord(level, word));
+}
+
+
+uint32_t WideIdSource::nextFreshId(void)
+{
+    if ((uint64_t) used > (uint64_t) maxId) {
+        throw Error("no free ids left, all %u ids are in use", maxId + 1);
+    }
+
+    // There is at least one id free, if not from num on then from 0 on.
+    uint64_t id = findClear(0, num);
+    if (id > maxId) {
+        id = findClear(0, 0);
+    }
+
+    num = (id == maxId) ? 0 : (uint32_t) id + 1;
+    return (uint32_t) id;
+}
+
+
+uint32_t WideIdSource::newId(void)
+{
+    uint32_t id;
+
+    // Ids in the stack may have been reserved after being released.
+    while (!freeIds.empty() && isUsed(freeIds.back())) {
+        freeIds.pop_back();
+    }
+
+    if (freeIds.empty()) {
+        id = nextFreshId();
+    } else {
+        id = freeIds.back();
+        freeIds.pop_back();
+    }
+
+    setUsed(id);
+    used++;
+    return id;
+}
+
+
+void WideIdSource::freeId(uint32_t id)
+{
+    if (!isUsed(id)) {
+        return;
+    }
+
+    clearUsed(id);
+    used--;
+
+    if (!unique) {
+        freeIds.push_back(id);
+    }
+}
+
+
+void WideIdSource::reserveId(uint32_t id)
+{
+    if ((id > maxId) || isUsed(id)) {
+        return;
+    }
+
+    setUsed(id);
+    used++;
+}
+
+
+void WideIdSource::dump( ostream &os )
+{
+    os << "WideIdSource dump:" << endl
+       << "Number of used ids is : " << used << endl
+       << "Number of released ids is : " << freeIds.size() << endl;
+}
+
+
+ostream& operator<< ( ostream &os, WideIdSource &rim )
+{
+    rim.dump(os);
+    return os;
+}
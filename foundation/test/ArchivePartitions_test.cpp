@@ -0,0 +1,93 @@
+/*
+ * Test the ArchivePartitions class.
+ *
+ * $Id: ArchivePartitions_test.cpp 2015-08-19 11:30:00 amarentes $
+ * $HeadURL: https://./test/ArchivePartitions_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ArchivePartitions.h"
+
+
+using namespace auction;
+
+class ArchivePartitions_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( ArchivePartitions_Test );
+
+	CPPUNIT_TEST( testSuffix );
+	CPPUNIT_TEST( testExpired );
+	CPPUNIT_TEST( testTables );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testSuffix();
+	void testExpired();
+	void testTables();
+
+  private:
+
+	//! 2015-08-19 13:47:10 UTC
+	time_t now;
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ArchivePartitions_Test );
+
+
+void ArchivePartitions_Test::setUp()
+{
+	now = 1439992030;
+}
+
+void ArchivePartitions_Test::tearDown()
+{
+
+}
+
+void ArchivePartitions_Test::testSuffix()
+{
+	ArchivePartitions daily(86400, 2, 0, false);
+	CPPUNIT_ASSERT( daily.getStart(now) == 1439942400 );
+	CPPUNIT_ASSERT( daily.getSuffix(now) == "_20150819" );
+	CPPUNIT_ASSERT( daily.getSuffix(1439942400) == "_20150819" );
+	CPPUNIT_ASSERT( daily.getSuffix(1439942399) == "_20150818" );
+
+	ArchivePartitions hourly(3600, 2, 0, false);
+	CPPUNIT_ASSERT( hourly.getSuffix(now) == "_201508191300" );
+
+	// Partitions shorter than the resolution of the names.
+	CPPUNIT_ASSERT_THROW( ArchivePartitions(10, 2, 0, false), Error );
+}
+
+void ArchivePartitions_Test::testExpired()
+{
+	ArchivePartitions daily(86400, 2, 7 * 86400, false);
+
+	CPPUNIT_ASSERT( daily.isExpired("biddingobjecthdr_20150811", "biddingObjectHdr", now) );
+	CPPUNIT_ASSERT( daily.isExpired("auctionSummary_20150301", "auctionSummary", now) );
+
+	// Still has rows younger than the retention.
+	CPPUNIT_ASSERT( !daily.isExpired("biddingobjecthdr_20150812", "biddingObjectHdr", now) );
+	CPPUNIT_ASSERT( !daily.isExpired("biddingobjecthdr_20150819", "biddingObjectHdr", now) );
+
+	// Not partitions of the table.
+	CPPUNIT_ASSERT( !daily.isExpired("biddingobjecthdr_old", "biddingObjectHdr", now) );
+	CPPUNIT_ASSERT( !daily.isExpired("biddingobjecthdrx_2015081", "biddingObjectHdr", now) );
+	CPPUNIT_ASSERT( !daily.isExpired("biddingobjectelement_20150801", "biddingObjectHdr", now) );
+	CPPUNIT_ASSERT( !daily.isExpired("biddingobjecthdr_201508011200", "biddingObjectHdr", now) );
+
+	ArchivePartitions keep(86400, 2, 0, false);
+	CPPUNIT_ASSERT( !keep.isExpired("biddingobjecthdr_20150101", "biddingObjectHdr", now) );
+}
+
+void ArchivePartitions_Test::testTables()
+{
+	const vector<string> &tables = ArchivePartitions::getTables();
+	CPPUNIT_ASSERT( tables.size() == 6 );
+	CPPUNIT_ASSERT( tables[0] == "biddingObjectHdr" );
+	CPPUNIT_ASSERT( tables[5] == "auctionSummary" );
+}
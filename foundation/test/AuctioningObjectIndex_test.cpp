@@ -0,0 +1,150 @@
+/*
+ * Test the AuctioningObjectIndex class.
+ *
+ * $Id: AuctioningObjectIndex_test.cpp 2015-08-04 14:56:00 amarentes $
+ * $HeadURL: https://./test/AuctioningObjectIndex_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "AuctioningObjectIndex.h"
+
+
+using namespace auction;
+
+class AuctioningObjectIndex_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( AuctioningObjectIndex_Test );
+
+	CPPUNIT_TEST( testIndex );
+	CPPUNIT_TEST( testUIdList );
+	CPPUNIT_TEST( testUIdIndex );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testIndex();
+	void testUIdList();
+	void testUIdIndex();
+
+  private:
+
+    AuctioningObjectIndex<int> *ptrIndex;
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( AuctioningObjectIndex_Test );
+
+
+void AuctioningObjectIndex_Test::setUp()
+{
+	ptrIndex = new AuctioningObjectIndex<int>();
+}
+
+void AuctioningObjectIndex_Test::tearDown()
+{
+	delete(ptrIndex);
+}
+
+void AuctioningObjectIndex_Test::testIndex()
+{
+	char set[20], name[20];
+
+	for (int i = 0; i < 1000; i++){
+		sprintf(set, "%d", i % 7);
+		sprintf(name, "%d", i);
+		CPPUNIT_ASSERT( ptrIndex->insert(set, name, i) != NULL );
+	}
+	CPPUNIT_ASSERT( ptrIndex->size() == 1000 );
+
+	// Duplicated keys are rejected
+	CPPUNIT_ASSERT( ptrIndex->insert("3", "10", 5) == NULL );
+
+	// (set, name) and (name, set) are different keys
+	CPPUNIT_ASSERT( ptrIndex->find("3", "10") != NULL );
+	CPPUNIT_ASSERT( *(ptrIndex->find("3", "10")) == 10 );
+	CPPUNIT_ASSERT( ptrIndex->find("10", "3") == NULL );
+	CPPUNIT_ASSERT( hashObjectKey("3", "10") != hashObjectKey("10", "3") );
+
+	// Keys are compared by handle, whichever copy is given.
+	InternedString keySet(string("3")), keyName(string("10"));
+	CPPUNIT_ASSERT( ptrIndex->find(keySet, keyName) == ptrIndex->find("3", "10") );
+
+	for (int i = 0; i < 1000; i += 2){
+		sprintf(set, "%d", i % 7);
+		sprintf(name, "%d", i);
+		CPPUNIT_ASSERT( ptrIndex->erase(set, name) == true );
+	}
+	CPPUNIT_ASSERT( ptrIndex->size() == 500 );
+	CPPUNIT_ASSERT( ptrIndex->erase("0", "0") == false );
+	CPPUNIT_ASSERT( ptrIndex->find("0", "0") == NULL );
+	CPPUNIT_ASSERT( *(ptrIndex->find("1", "1")) == 1 );
+
+	// Removed slots are reused.
+	CPPUNIT_ASSERT( ptrIndex->insert("0", "0", 7) != NULL );
+	CPPUNIT_ASSERT( *(ptrIndex->find("0", "0")) == 7 );
+}
+
+void AuctioningObjectIndex_Test::testUIdList()
+{
+	vector<int> list;
+	uidListPosition_t positions;
+
+	for (int i = 0; i < 5; i++){
+		addToUIdList(list, positions, i);
+	}
+
+	CPPUNIT_ASSERT( delFromUIdList(list, positions, 1) == true );
+	CPPUNIT_ASSERT( list.size() == 4 );
+	CPPUNIT_ASSERT( list[1] == 4 );
+	CPPUNIT_ASSERT( delFromUIdList(list, positions, 1) == false );
+	CPPUNIT_ASSERT( delFromUIdList(list, positions, 4) == true );
+	CPPUNIT_ASSERT( delFromUIdList(list, positions, 0) == true );
+	CPPUNIT_ASSERT( list.size() == 2 );
+	CPPUNIT_ASSERT( delFromUIdList(list, positions, 9) == false );
+}
+
+void AuctioningObjectIndex_Test::testUIdIndex()
+{
+	UIdIndex<int> index;
+
+	CPPUNIT_ASSERT( index.empty() );
+	CPPUNIT_ASSERT( index.begin() == index.end() );
+	CPPUNIT_ASSERT( index.find(3) == index.end() );
+
+	// Sparse uids, enough of them to grow the table a few times.
+	for (int i = 0; i < 1000; i++){
+		index[i * 4099] = i;
+	}
+	CPPUNIT_ASSERT( index.size() == 1000 );
+	CPPUNIT_ASSERT( index.find(10 * 4099)->second == 10 );
+	CPPUNIT_ASSERT( index.find(10 * 4099 + 1) == index.end() );
+
+	// Removed uids are not found, the ones after them in the probe still are.
+	for (int i = 0; i < 1000; i += 2){
+		CPPUNIT_ASSERT( index.erase(i * 4099) == 1 );
+	}
+	CPPUNIT_ASSERT( index.erase(0) == 0 );
+	CPPUNIT_ASSERT( index.size() == 500 );
+	CPPUNIT_ASSERT( index.find(10 * 4099) == index.end() );
+	CPPUNIT_ASSERT( index.find(11 * 4099)->second == 11 );
+
+	// Walking sees every entry once.
+	int n = 0, sum = 0;
+	for (UIdIndex<int>::iterator iter = index.begin(); iter != index.end(); ++iter) {
+		n++;
+		sum += iter->second;
+	}
+	CPPUNIT_ASSERT( n == 500 );
+	CPPUNIT_ASSERT( sum == 250000 );
+
+	// Inserting over tombstones reuses them.
+	index[0] = 7;
+	CPPUNIT_ASSERT( index[0] == 7 );
+	CPPUNIT_ASSERT( index.size() == 501 );
+
+	index.clear();
+	CPPUNIT_ASSERT( index.empty() );
+	CPPUNIT_ASSERT( index.find(11 * 4099) == index.end() );
+}
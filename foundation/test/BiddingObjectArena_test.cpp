@@ -0,0 +1,238 @@
+/*
+ * Test the BiddingObjectArena class.
+ *
+ * $Id: BiddingObjectArena_test.cpp 2015-08-04 14:56:00 amarentes $
+ * $HeadURL: https://./test/BiddingObjectArena_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "BiddingObjectArena.h"
+#include "BiddingObject.h"
+
+
+using namespace auction;
+
+//! object allocated through the arena, counts its destructor calls.
+class ArenaTestObject
+{
+  public:
+	static int destroyed;
+
+	char payload[200];
+
+	fieldList_t fields;
+
+	ArenaTestObject() { memset(payload, 0, sizeof(payload)); }
+
+	~ArenaTestObject() { destroyed++; }
+
+	static void *operator new(size_t size)
+	{
+		return BiddingObjectArena::allocate(size, &ArenaTestObject::destroyInArena);
+	}
+
+	static void operator delete(void *ptr)
+	{
+		BiddingObjectArena::deallocate(ptr);
+	}
+
+	static void destroyInArena(void *ptr)
+	{
+		static_cast<ArenaTestObject *>(ptr)->~ArenaTestObject();
+	}
+};
+
+int ArenaTestObject::destroyed = 0;
+
+
+class BiddingObjectArena_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( BiddingObjectArena_Test );
+
+	CPPUNIT_TEST( testAllocate );
+	CPPUNIT_TEST( testContainers );
+	CPPUNIT_TEST( testRelease );
+	CPPUNIT_TEST( testDelete );
+	CPPUNIT_TEST( testBiddingObject );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testAllocate();
+	void testContainers();
+	void testRelease();
+	void testDelete();
+	void testBiddingObject();
+
+  private:
+
+    BiddingObjectArena *ptrArena;
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( BiddingObjectArena_Test );
+
+
+void BiddingObjectArena_Test::setUp()
+{
+	ptrArena = new BiddingObjectArena(60, 1024);
+	ArenaTestObject::destroyed = 0;
+}
+
+void BiddingObjectArena_Test::tearDown()
+{
+	// Tests closing it themselves set it to NULL.
+	if (ptrArena != NULL) {
+		ptrArena->close();
+	}
+}
+
+void BiddingObjectArena_Test::testAllocate()
+{
+	// Without an arena installed objects come from the heap.
+	ArenaTestObject *heapObj = new ArenaTestObject();
+	CPPUNIT_ASSERT( BiddingObjectArena::getArena(heapObj) == NULL );
+	delete heapObj;
+	CPPUNIT_ASSERT( ArenaTestObject::destroyed == 1 );
+
+	ArenaTestObject *obj1, *obj2;
+	{
+		arenaScope scope(ptrArena);
+		obj1 = new ArenaTestObject();
+		obj2 = new ArenaTestObject();
+	}
+	CPPUNIT_ASSERT( BiddingObjectArena::getCurrent() == NULL );
+
+	CPPUNIT_ASSERT( BiddingObjectArena::getArena(obj1) == ptrArena );
+	CPPUNIT_ASSERT( BiddingObjectArena::getArena(obj2) == ptrArena );
+	CPPUNIT_ASSERT( obj1 != obj2 );
+	CPPUNIT_ASSERT( ptrArena->getNumObjects() == 2 );
+
+	// Objects are aligned.
+	CPPUNIT_ASSERT( ((size_t) obj1) % 16 == 0 );
+	CPPUNIT_ASSERT( ((size_t) obj2) % 16 == 0 );
+
+	BiddingObjectArena::retire(obj1);
+	BiddingObjectArena::retire(obj2);
+
+	// Retired, but destroyed with the arena.
+	CPPUNIT_ASSERT( ArenaTestObject::destroyed == 1 );
+}
+
+void BiddingObjectArena_Test::testContainers()
+{
+	field_t field;
+	field.name = "quantity";
+
+	fieldList_t heapFields;
+	heapFields.push_back(field);
+	CPPUNIT_ASSERT( BiddingObjectArena::getArena(&heapFields[0]) == NULL );
+
+	{
+		arenaScope scope(ptrArena);
+		fieldList_t arenaFields;
+		for (int i = 0; i < 40; i++){
+			arenaFields.push_back(field);
+		}
+		CPPUNIT_ASSERT( BiddingObjectArena::getArena(&arenaFields[0]) == ptrArena );
+
+		// Container nodes are not objects, nothing waits for them.
+		CPPUNIT_ASSERT( ptrArena->getNumObjects() == 0 );
+		CPPUNIT_ASSERT( ptrArena->getNumBlocks() > 1 );
+
+		// Swapping hands the nodes over whatever they come from.
+		arenaFields.swap(heapFields);
+		CPPUNIT_ASSERT( heapFields.size() == 40 );
+		CPPUNIT_ASSERT( arenaFields.size() == 1 );
+		CPPUNIT_ASSERT( BiddingObjectArena::getArena(&arenaFields[0]) == NULL );
+	}
+
+	// Outside the scope the nodes come from the heap again.
+	fieldList_t copy = heapFields;
+	CPPUNIT_ASSERT( BiddingObjectArena::getArena(&copy[0]) == NULL );
+	CPPUNIT_ASSERT( copy[39].name == "quantity" );
+}
+
+void BiddingObjectArena_Test::testRelease()
+{
+	vector<ArenaTestObject *> objs;
+	{
+		arenaScope scope(ptrArena);
+		for (int i = 0; i < 20; i++){
+			ArenaTestObject *obj = new ArenaTestObject();
+			field_t field;
+			obj->fields.push_back(field);
+			objs.push_back(obj);
+		}
+	}
+
+	// 20 objects of 200 bytes do not fit in a block of 1024 bytes
+	CPPUNIT_ASSERT( ptrArena->getNumBlocks() > 1 );
+	CPPUNIT_ASSERT( ptrArena->getNumObjects() == 20 );
+
+	for (int i = 0; i < 20; i++){
+		BiddingObjectArena::retire(objs[i]);
+	}
+	CPPUNIT_ASSERT( ArenaTestObject::destroyed == 0 );
+
+	// Closed with every object retired, destroyed in one pass.
+	ptrArena->close();
+	ptrArena = NULL;
+	CPPUNIT_ASSERT( ArenaTestObject::destroyed == 20 );
+}
+
+void BiddingObjectArena_Test::testDelete()
+{
+	ArenaTestObject *obj1, *obj2;
+	{
+		arenaScope scope(ptrArena);
+		obj1 = new ArenaTestObject();
+		obj2 = new ArenaTestObject();
+	}
+
+	// Closed first, the last object retired releases it.
+	ptrArena->close();
+	ptrArena = NULL;
+
+	// Deleted objects are destroyed at once, and only once.
+	delete obj1;
+	CPPUNIT_ASSERT( ArenaTestObject::destroyed == 1 );
+
+	BiddingObjectArena::retire(obj2);
+	CPPUNIT_ASSERT( ArenaTestObject::destroyed == 2 );
+}
+
+void BiddingObjectArena_Test::testBiddingObject()
+{
+	BiddingObject *bid = NULL;
+	{
+		arenaScope scope(ptrArena);
+
+		elementList_t elements;
+		optionList_t options;
+		field_t field;
+		field.name = "quantity";
+		elements["element1"].push_back(field);
+		options.push_back(pair<string, fieldList_t>("option1", fieldList_t()));
+
+		bid = new BiddingObject("1", "1", "agent1", "bid1", IPAP_BID);
+		bid->takeFields(elements, options);
+	}
+
+	CPPUNIT_ASSERT( BiddingObjectArena::getArena(bid) == ptrArena );
+	CPPUNIT_ASSERT( BiddingObjectArena::getArena(&((*bid->getElements())["element1"][0]))
+						== ptrArena );
+	CPPUNIT_ASSERT( ptrArena->getNumObjects() == 1 );
+
+	// The arena goes with its last object, the destructor runs then.
+	BiddingObject::retire(bid);
+	ptrArena->close();
+	ptrArena = NULL;
+
+	// Heap objects are deleted on retire.
+	bid = new BiddingObject("1", "1", "agent1", "bid2", IPAP_BID);
+	CPPUNIT_ASSERT( BiddingObjectArena::getArena(bid) == NULL );
+	BiddingObject::retire(bid);
+}
@@ -0,0 +1,148 @@
+/*
+ * Test the BiddingObjectBulkLoader class.
+ *
+ * $Id: BiddingObjectBulkLoader_test.cpp 2015-08-11 09:10:00 amarentes $
+ * $HeadURL: https://./test/BiddingObjectBulkLoader_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "BiddingObjectBulkLoader.h"
+
+
+using namespace auction;
+
+class BiddingObjectBulkLoader_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( BiddingObjectBulkLoader_Test );
+
+	CPPUNIT_TEST( testColumns );
+	CPPUNIT_TEST( testRows );
+	CPPUNIT_TEST( testSummaryRow );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testColumns();
+	void testRows();
+	void testSummaryRow();
+
+  private:
+
+	biddingObjectRecord_t record;
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( BiddingObjectBulkLoader_Test );
+
+
+void BiddingObjectBulkLoader_Test::setUp()
+{
+	record.auctionSet = "1";
+	record.auctionName = "1";
+	record.set = "1";
+	record.name = "Bid1";
+	record.sessionId = "session1";
+	record.type = "bid";
+	record.state = "done";
+
+	record.elements.push_back("element1");
+	record.elements.push_back("element2");
+
+	for (int i = 0; i < 3; i++){
+		biddingObjectFieldRecord_t field;
+		field.ownerName = (i < 2) ? "element1" : "element2";
+		field.fieldName = "quantity";
+		field.fieldType = "Float64";
+		field.len = 8;
+		field.value = "1";
+		record.elementFields.push_back(field);
+	}
+
+	record.options.push_back("option1");
+}
+
+void BiddingObjectBulkLoader_Test::tearDown()
+{
+}
+
+void BiddingObjectBulkLoader_Test::testColumns()
+{
+	CPPUNIT_ASSERT( BiddingObjectBulkLoader::getColumns(BO_TABLE_HDR).size() == 7 );
+	CPPUNIT_ASSERT( BiddingObjectBulkLoader::getColumns(BO_TABLE_ELEMENT).size() == 5 );
+	CPPUNIT_ASSERT( BiddingObjectBulkLoader::getColumns(BO_TABLE_ELEMENTFIELD).size() == 9 );
+	CPPUNIT_ASSERT( BiddingObjectBulkLoader::getColumns(BO_TABLE_OPTION).size() == 5 );
+	CPPUNIT_ASSERT( BiddingObjectBulkLoader::getColumns(BO_TABLE_OPTIONFIELD).size() == 9 );
+
+	CPPUNIT_ASSERT( string(BiddingObjectBulkLoader::getTableName(BO_TABLE_ELEMENTFIELD))
+						== "biddingObjectElementField" );
+}
+
+void BiddingObjectBulkLoader_Test::testRows()
+{
+	for (int t = 0; t < BO_NUM_TABLES; t++){
+		biddingObjectTable_t table = (biddingObjectTable_t) t;
+
+		bulkRowList_t rows;
+		BiddingObjectBulkLoader::appendRows(record, table, rows);
+
+		// every row has a value per column
+		for (bulkRowListIter_t iter = rows.begin(); iter != rows.end(); ++iter){
+			CPPUNIT_ASSERT( iter->size() == BiddingObjectBulkLoader::getColumns(table).size() );
+			CPPUNIT_ASSERT( (*iter)[3] == "Bid1" );
+		}
+
+		switch (table){
+		case BO_TABLE_HDR:
+			CPPUNIT_ASSERT( rows.size() == 1 );
+			CPPUNIT_ASSERT( rows[0][4] == "session1" );
+			break;
+		case BO_TABLE_ELEMENT:
+			CPPUNIT_ASSERT( rows.size() == 2 );
+			break;
+		case BO_TABLE_ELEMENTFIELD:
+			CPPUNIT_ASSERT( rows.size() == 3 );
+			CPPUNIT_ASSERT( rows[2][4] == "element2" );
+			CPPUNIT_ASSERT( rows[2][7] == "8" );
+			break;
+		case BO_TABLE_OPTION:
+			CPPUNIT_ASSERT( rows.size() == 1 );
+			break;
+		case BO_TABLE_OPTIONFIELD:
+			CPPUNIT_ASSERT( rows.empty() );
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void BiddingObjectBulkLoader_Test::testSummaryRow()
+{
+	auctionSummaryRecord_t summary;
+	summary.auctionSet = "1";
+	summary.auctionName = "2";
+	summary.start = 1438000000;
+	summary.stop = 1438000010;
+	summary.demand = 12.5;
+	summary.quantitySold = 10;
+	summary.clearingPrice = 0.125;
+	summary.bids = 3;
+	summary.allocations = 2;
+	summary.executionTime = 420;
+
+	CPPUNIT_ASSERT( string(BiddingObjectBulkLoader::getSummaryTableName()) == "auctionSummary" );
+	CPPUNIT_ASSERT( BiddingObjectBulkLoader::getSummaryColumns().size() == 10 );
+
+	bulkRowList_t rows;
+	BiddingObjectBulkLoader::appendSummaryRow(summary, rows);
+
+	CPPUNIT_ASSERT( rows.size() == 1 );
+	CPPUNIT_ASSERT( rows[0].size() == BiddingObjectBulkLoader::getSummaryColumns().size() );
+	CPPUNIT_ASSERT( rows[0][1] == "2" );
+	CPPUNIT_ASSERT( rows[0][3] == "1438000010" );
+	CPPUNIT_ASSERT( rows[0][4] == "12.5" );
+	CPPUNIT_ASSERT( rows[0][6] == "0.125" );
+	CPPUNIT_ASSERT( rows[0][9] == "420" );
+}
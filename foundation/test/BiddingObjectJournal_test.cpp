@@ -0,0 +1,309 @@
+/*
+ * Test the BiddingObjectJournal class.
+ *
+ * $Id: BiddingObjectJournal_test.cpp 2015-08-13 16:40:00 amarentes $
+ * $HeadURL: https://./test/BiddingObjectJournal_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "BiddingObjectJournal.h"
+
+
+using namespace auction;
+
+class BiddingObjectJournal_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( BiddingObjectJournal_Test );
+
+	CPPUNIT_TEST( testCrc );
+	CPPUNIT_TEST( testEncode );
+	CPPUNIT_TEST( testAppend );
+	CPPUNIT_TEST( testTruncated );
+	CPPUNIT_TEST( testCorrupted );
+	CPPUNIT_TEST( testSummary );
+	CPPUNIT_TEST( testRecover );
+	CPPUNIT_TEST( testResume );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testCrc();
+	void testEncode();
+	void testAppend();
+	void testTruncated();
+	void testCorrupted();
+	void testSummary();
+	void testRecover();
+	void testResume();
+
+  private:
+
+	biddingObjectRecord_t record;
+
+	string journalFile;
+
+	//! append n copies of the record and close the journal.
+	void write(int n);
+
+	//! number of records read, and whether the reader found damage.
+	int read(bool &corrupt);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( BiddingObjectJournal_Test );
+
+
+void BiddingObjectJournal_Test::setUp()
+{
+	record.auctionSet = "1";
+	record.auctionName = "1";
+	record.set = "1";
+	record.name = "Bid1";
+	record.sessionId = "session1";
+	record.type = "bid";
+	record.state = "done";
+
+	record.elements.push_back("element1");
+
+	biddingObjectFieldRecord_t field;
+	field.ownerName = "element1";
+	field.fieldName = "quantity";
+	field.fieldType = "Float64";
+	field.len = 8;
+	field.value = "1";
+	record.elementFields.push_back(field);
+
+	record.options.push_back("option1");
+
+	field.ownerName = "option1";
+	field.fieldName = "start";
+	field.fieldType = "UInt64";
+	field.value = "1438000000";
+	record.optionFields.push_back(field);
+
+	journalFile = "biddingobjects_test.journal";
+	unlink(journalFile.c_str());
+}
+
+void BiddingObjectJournal_Test::tearDown()
+{
+	unlink(journalFile.c_str());
+}
+
+void BiddingObjectJournal_Test::write(int n)
+{
+	BiddingObjectJournal journal(journalFile, 2, 1000);
+	for (int i = 0; i < n; i++){
+		journal.append(record);
+	}
+	CPPUNIT_ASSERT( journal.getNumAppended() == (unsigned long) n );
+}
+
+int BiddingObjectJournal_Test::read(bool &corrupt)
+{
+	BiddingObjectJournalReader reader(journalFile);
+	biddingObjectRecord_t r;
+	int n = 0;
+
+	while (reader.next(r)) {
+		n++;
+		r = biddingObjectRecord_t();
+	}
+	corrupt = reader.isCorrupt();
+	return n;
+}
+
+void BiddingObjectJournal_Test::testCrc()
+{
+	// check value of the crc32 used by zlib and ethernet
+	CPPUNIT_ASSERT( recordCrc32("123456789", 9) == 0xCBF43926U );
+}
+
+void BiddingObjectJournal_Test::testEncode()
+{
+	string payload;
+	BiddingObjectJournal::encode(record, payload);
+
+	biddingObjectRecord_t r;
+	CPPUNIT_ASSERT( BiddingObjectJournal::decode(payload, r) );
+	CPPUNIT_ASSERT( r.name == "Bid1" );
+	CPPUNIT_ASSERT( r.sessionId == "session1" );
+	CPPUNIT_ASSERT( r.elements.size() == 1 );
+	CPPUNIT_ASSERT( r.elementFields.size() == 1 );
+	CPPUNIT_ASSERT( r.elementFields[0].len == 8 );
+	CPPUNIT_ASSERT( r.optionFields.size() == 1 );
+	CPPUNIT_ASSERT( r.optionFields[0].value == "1438000000" );
+
+	// A payload cut short is rejected.
+	biddingObjectRecord_t r2;
+	CPPUNIT_ASSERT( !BiddingObjectJournal::decode(payload.substr(0, payload.size() - 1), r2) );
+}
+
+void BiddingObjectJournal_Test::testAppend()
+{
+	write(3);
+
+	// Reopening appends after what is there.
+	write(2);
+
+	bool corrupt;
+	CPPUNIT_ASSERT( read(corrupt) == 5 );
+	CPPUNIT_ASSERT( !corrupt );
+}
+
+void BiddingObjectJournal_Test::testTruncated()
+{
+	write(3);
+
+	// Entry partly written by a crash.
+	struct stat st;
+	stat(journalFile.c_str(), &st);
+	CPPUNIT_ASSERT( truncate(journalFile.c_str(), st.st_size - 5) == 0 );
+
+	bool corrupt;
+	CPPUNIT_ASSERT( read(corrupt) == 2 );
+	CPPUNIT_ASSERT( corrupt );
+}
+
+void BiddingObjectJournal_Test::testCorrupted()
+{
+	write(2);
+
+	// Flip the last byte of the second entry.
+	struct stat st;
+	stat(journalFile.c_str(), &st);
+
+	fstream f(journalFile.c_str(), ios::in | ios::out | ios::binary);
+	f.seekg(st.st_size - 1);
+	char c = f.get();
+	f.seekp(st.st_size - 1);
+	f.put(c ^ 0x01);
+	f.close();
+
+	bool corrupt;
+	CPPUNIT_ASSERT( read(corrupt) == 1 );
+	CPPUNIT_ASSERT( corrupt );
+
+	// Not a journal at all.
+	ofstream out(journalFile.c_str(), ios::out | ios::trunc);
+	out << "not a journal";
+	out.close();
+
+	CPPUNIT_ASSERT_THROW( BiddingObjectJournalReader reader(journalFile), Error );
+	CPPUNIT_ASSERT_THROW( BiddingObjectJournal journal(journalFile, 1, 1000), Error );
+}
+
+void BiddingObjectJournal_Test::testSummary()
+{
+	auctionSummaryRecord_t summary;
+	summary.auctionSet = "1";
+	summary.auctionName = "1";
+	summary.start = 1438000000;
+	summary.stop = 1438000010;
+	summary.demand = 12.5;
+	summary.quantitySold = 10;
+	summary.clearingPrice = 0.125;
+	summary.bids = 3;
+	summary.allocations = 2;
+	summary.executionTime = 420;
+
+	{
+		BiddingObjectJournal journal(journalFile, 1, 1000);
+		journal.append(record);
+		journal.append(summary);
+		journal.append(record);
+	}
+
+	BiddingObjectJournalReader reader(journalFile);
+	biddingObjectRecord_t r;
+	auctionSummaryRecord_t s;
+
+	CPPUNIT_ASSERT( reader.next(r, s) == JOURNAL_BIDDING_OBJECT );
+	CPPUNIT_ASSERT( reader.next(r, s) == JOURNAL_AUCTION_SUMMARY );
+	CPPUNIT_ASSERT( s.auctionName == "1" );
+	CPPUNIT_ASSERT( s.stop == 1438000010 );
+	CPPUNIT_ASSERT( s.demand == 12.5 );
+	CPPUNIT_ASSERT( s.clearingPrice == 0.125 );
+	CPPUNIT_ASSERT( s.allocations == 2 );
+	CPPUNIT_ASSERT( s.executionTime == 420 );
+	CPPUNIT_ASSERT( reader.next(r, s) == JOURNAL_BIDDING_OBJECT );
+	CPPUNIT_ASSERT( reader.next(r, s) == JOURNAL_END );
+	CPPUNIT_ASSERT( reader.getNumEntries() == 3 );
+
+	// Reading only bidding objects skips the summary.
+	bool corrupt;
+	CPPUNIT_ASSERT( read(corrupt) == 2 );
+	CPPUNIT_ASSERT( !corrupt );
+}
+
+void BiddingObjectJournal_Test::testRecover()
+{
+	write(3);
+
+	// Entry partly written by a crash, then the journal is opened again.
+	struct stat st;
+	stat(journalFile.c_str(), &st);
+	CPPUNIT_ASSERT( truncate(journalFile.c_str(), st.st_size - 5) == 0 );
+
+	write(2);
+
+	// The damaged entry is gone, the new ones follow the valid ones.
+	bool corrupt;
+	CPPUNIT_ASSERT( read(corrupt) == 4 );
+	CPPUNIT_ASSERT( !corrupt );
+
+	// A header cut short while the journal was created.
+	CPPUNIT_ASSERT( truncate(journalFile.c_str(), 3) == 0 );
+	write(1);
+	CPPUNIT_ASSERT( read(corrupt) == 1 );
+	CPPUNIT_ASSERT( !corrupt );
+}
+
+void BiddingObjectJournal_Test::testResume()
+{
+	write(3);
+
+	unsigned long offset;
+	uint32_t crc;
+	{
+		BiddingObjectJournalReader reader(journalFile);
+		biddingObjectRecord_t r;
+		CPPUNIT_ASSERT( reader.next(r) );
+		r = biddingObjectRecord_t();
+		CPPUNIT_ASSERT( reader.next(r) );
+		offset = reader.getLastOffset();
+		crc = reader.getLastCrc();
+	}
+
+	write(1);
+
+	// Only the entries after the second one.
+	{
+		BiddingObjectJournalReader reader(journalFile);
+		biddingObjectRecord_t r;
+		CPPUNIT_ASSERT( reader.resume(offset, crc) );
+		int n = 0;
+		while (reader.next(r)) {
+			n++;
+			r = biddingObjectRecord_t();
+		}
+		CPPUNIT_ASSERT( n == 2 );
+	}
+
+	// Another journal under the same name is read from the start.
+	unlink(journalFile.c_str());
+	write(2);
+	{
+		BiddingObjectJournalReader reader(journalFile);
+		biddingObjectRecord_t r;
+		CPPUNIT_ASSERT( !reader.resume(offset, crc ^ 1) );
+		CPPUNIT_ASSERT( !reader.resume(1000000, crc) );
+		int n = 0;
+		while (reader.next(r)) {
+			n++;
+			r = biddingObjectRecord_t();
+		}
+		CPPUNIT_ASSERT( n == 2 );
+	}
+}
@@ -0,0 +1,122 @@
+/*
+ * Test the BiddingObjectWriter class.
+ *
+ * $Id: BiddingObjectWriter_test.cpp 2015-08-10 10:30:00 amarentes $
+ * $HeadURL: https://./test/BiddingObjectWriter_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <config.h>
+#include "BiddingObjectWriter.h"
+#include "FieldValParser.h"
+#include "FieldDefParser.h"
+#include "BiddingObjectFileParser.h"
+
+using namespace auction;
+
+class BiddingObjectWriter_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( BiddingObjectWriter_Test );
+
+    CPPUNIT_TEST( testSpill );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+
+	void testSpill();
+
+  private:
+
+    FieldDefParser *ptrFieldParsers;
+    FieldValParser *ptrFieldValParser;
+    BiddingObjectFileParser *ptrBidFileParser;
+
+    fieldDefList_t fieldDefs;
+    fieldValList_t fieldVals;
+
+    auctioningObjectDB_t *bids;
+
+    string journalFile;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( BiddingObjectWriter_Test );
+
+
+void BiddingObjectWriter_Test::setUp()
+{
+	try
+	{
+		ptrBidFileParser = new BiddingObjectFileParser(0, "../../etc/example_bids1.xml");
+
+		ptrFieldParsers = new FieldDefParser(DEF_SYSCONFDIR "/fielddef.xml");
+		ptrFieldParsers->parse(&fieldDefs);
+
+		ptrFieldValParser = new FieldValParser(DEF_SYSCONFDIR "/fieldval.xml");
+		ptrFieldValParser->parse(&fieldVals);
+
+		bids = new auctioningObjectDB_t();
+		ptrBidFileParser->parse(&fieldDefs, &fieldVals, bids);
+
+		journalFile = "biddingobjects_writer_test.journal";
+		unlink(journalFile.c_str());
+	}
+	catch(Error &e){
+		std::cout << "Error:" << e.getError() << std::endl << std::flush;
+		throw e;
+	}
+}
+
+void BiddingObjectWriter_Test::tearDown()
+{
+	for (unsigned int i = 0; i < bids->size() ; i++)
+	{
+		delete(((*bids)[i]));
+	}
+	delete bids;
+
+	delete(ptrBidFileParser);
+	delete(ptrFieldParsers);
+	delete(ptrFieldValParser);
+
+	unlink(journalFile.c_str());
+}
+
+void BiddingObjectWriter_Test::testSpill()
+{
+	// Nothing listens on port 1, every batch fails.
+	DBConnectionPool pool("hostaddr=127.0.0.1 port=1 dbname=none", 1, 30);
+	BiddingObjectJournal *journal = new BiddingObjectJournal(journalFile, 64, 1000);
+	BiddingObjectWriter *writer = new BiddingObjectWriter(&pool, 4, 2, journal);
+
+	BiddingObject *bid = dynamic_cast<BiddingObject*>((*bids)[0]);
+	for (int i = 0; i < 3; i++){
+		writer->push(bid);
+	}
+
+#ifndef ENABLE_THREADS
+	// Written from the caller: the first batch fails and goes to the
+	// journal, the database is not tried again within the retry delay.
+	CPPUNIT_ASSERT( writer->getStats().failures == 1 );
+	CPPUNIT_ASSERT( writer->getStats().spilled == 2 );
+#endif
+
+	// Records still queued are sent to the journal when stopping.
+	delete writer;
+	CPPUNIT_ASSERT( journal->getNumAppended() == 3 );
+	delete journal;
+
+	BiddingObjectJournalReader reader(journalFile);
+	biddingObjectRecord_t record;
+	int records = 0;
+	while (reader.next(record)) {
+		CPPUNIT_ASSERT( record.name == bid->getName() );
+		records++;
+	}
+
+	CPPUNIT_ASSERT( !reader.isCorrupt() );
+	CPPUNIT_ASSERT( records == 3 );
+	CPPUNIT_ASSERT( pool.getNumConnections() == 1 );
+}
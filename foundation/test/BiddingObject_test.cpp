@@ -21,6 +21,7 @@ class BiddingObject_Test : public CppUnit::TestFixture {
 	CPPUNIT_TEST_SUITE( BiddingObject_Test );
 
     CPPUNIT_TEST( testBiddingObjects );
+    CPPUNIT_TEST( testRecord );
 	CPPUNIT_TEST_SUITE_END();
 
   public:
@@ -28,6 +29,7 @@ class BiddingObject_Test : public CppUnit::TestFixture {
 	void tearDown();
 
 	void testBiddingObjects();
+	void testRecord();
 	void testFieldValues();
 	void loadFieldDefs(fieldDefList_t *fieldList);
 	void loadFieldVals(fieldValList_t *fieldValList);
@@ -55,6 +57,9 @@ CPPUNIT_TEST_SUITE_REGISTRATION( BiddingObject_Test );
 
 void BiddingObject_Test::setUp() 
 {
+	
+	ptrBid1 = NULL;
+	ptrBid2 = NULL;
 		
 	try
 	{
@@ -122,6 +127,51 @@ void BiddingObject_Test::testBiddingObjects()
 	
 }
 
+void BiddingObject_Test::testRecord() 
+{
+	try{
+		auctioningObjectDB_t *new_bids = new auctioningObjectDB_t();
+
+		ptrBidFileParser->parse(&fieldDefs, &fieldVals, new_bids );
+		
+		BiddingObject *bid = dynamic_cast<BiddingObject*>((*new_bids)[0]);
+		bid->setSession("session1");
+		
+		biddingObjectRecord_t record;
+		bid->getRecord(record);
+		
+		CPPUNIT_ASSERT( record.auctionSet == bid->getAuctionSet() );
+		CPPUNIT_ASSERT( record.auctionName == bid->getAuctionName() );
+		CPPUNIT_ASSERT( record.set == bid->getSet() );
+		CPPUNIT_ASSERT( record.name == bid->getName() );
+		CPPUNIT_ASSERT( record.sessionId == "session1" );
+		
+		CPPUNIT_ASSERT( record.elements.size() == bid->getElements()->size() );
+		CPPUNIT_ASSERT( record.options.size() == bid->getOptions()->size() );
+		
+		unsigned int numFields = 0;
+		elementListIter_t iter;
+		for (iter = bid->getElements()->begin(); iter != bid->getElements()->end(); ++iter){
+			numFields = numFields + (iter->second).size();
+		}
+		CPPUNIT_ASSERT( record.elementFields.size() == numFields );
+		
+		// The record does not depend on the object.
+		for (int i = 0; i < new_bids->size() ; i++)
+		{
+			delete(((*new_bids)[i]));
+		}
+		new_bids->clear();
+		delete new_bids;
+		
+		CPPUNIT_ASSERT( record.elements[0] == record.elementFields[0].ownerName );
+
+	} catch (Error &e){
+		std::cout << "Error:" << e.getError() << std::endl << std::flush;
+		throw e;
+	}
+}
+
 void BiddingObject_Test::loadFieldDefs(fieldDefList_t *fieldList)
 {
 	const string filename = DEF_SYSCONFDIR "/fielddef.xml";
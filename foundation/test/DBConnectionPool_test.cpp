@@ -0,0 +1,58 @@
+/*
+ * Test the DBConnectionPool class.
+ *
+ * $Id: DBConnectionPool_test.cpp 2015-08-12 11:20:00 amarentes $
+ * $HeadURL: https://./test/DBConnectionPool_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "DBConnectionPool.h"
+
+
+using namespace auction;
+
+class DBConnectionPool_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( DBConnectionPool_Test );
+
+	CPPUNIT_TEST( testUnreachable );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testUnreachable();
+
+  private:
+
+	DBConnectionPool *ptrPool;
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( DBConnectionPool_Test );
+
+
+void DBConnectionPool_Test::setUp()
+{
+	// Nothing listens on port 1.
+	ptrPool = new DBConnectionPool("hostaddr=127.0.0.1 port=1 dbname=none", 2, 30);
+}
+
+void DBConnectionPool_Test::tearDown()
+{
+	delete(ptrPool);
+}
+
+void DBConnectionPool_Test::testUnreachable()
+{
+	CPPUNIT_ASSERT( ptrPool->getNumConnections() == 0 );
+
+	CPPUNIT_ASSERT_THROW( ptrPool->lease(), Error );
+
+	// The failed connection goes back to the pool, leasing again does
+	// not block nor open a second one.
+	CPPUNIT_ASSERT_THROW( ptrPool->lease(), Error );
+	CPPUNIT_ASSERT( ptrPool->getNumConnections() == 1 );
+	CPPUNIT_ASSERT( ptrPool->getNumReconnects() == 0 );
+}
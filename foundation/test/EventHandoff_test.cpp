@@ -0,0 +1,164 @@
+/*
+ * Test the EventHandoff class.
+ *
+ * $Id: EventHandoff_test.cpp 2015-08-20 10:15:00 amarentes $
+ * $HeadURL: https://./test/EventHandoff_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <pthread.h>
+
+#include "EventHandoff.h"
+
+
+using namespace auction;
+
+//! events pushed by each producer of testProducers
+static const unsigned long HANDOFF_TEST_EVENTS = 20000;
+
+static const int HANDOFF_TEST_PRODUCERS = 4;
+
+class EventHandoff_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( EventHandoff_Test );
+
+	CPPUNIT_TEST( testOrder );
+	CPPUNIT_TEST( testFull );
+	CPPUNIT_TEST( testProducers );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testOrder();
+	void testFull();
+	void testProducers();
+
+  private:
+
+	typedef struct
+	{
+		EventHandoff *handoff;
+		unsigned long producer;
+
+	} producerArg_t;
+
+	//! push HANDOFF_TEST_EVENTS events numbered after the producer.
+	static void *produce(void *arg);
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( EventHandoff_Test );
+
+
+void EventHandoff_Test::setUp()
+{
+
+}
+
+void EventHandoff_Test::tearDown()
+{
+
+}
+
+void *EventHandoff_Test::produce(void *arg)
+{
+	producerArg_t *p = (producerArg_t *) arg;
+
+	for (unsigned long i = 0; i < HANDOFF_TEST_EVENTS; i++) {
+		Event *e = new TestEvent(p->producer * HANDOFF_TEST_EVENTS + i);
+		while (!p->handoff->push(e)) {
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+void EventHandoff_Test::testOrder()
+{
+	EventHandoff handoff(5);
+	CPPUNIT_ASSERT( handoff.getCapacity() == 8 );
+	CPPUNIT_ASSERT( handoff.isEmpty() );
+	CPPUNIT_ASSERT( handoff.pop() == NULL );
+
+	// Several rounds over the cells.
+	for (unsigned long i = 0; i < 20; i++) {
+		CPPUNIT_ASSERT( handoff.push(new TestEvent(i)) );
+		CPPUNIT_ASSERT( handoff.push(new TestEvent(i + 100)) );
+
+		Event *e = handoff.pop();
+		CPPUNIT_ASSERT( e->getIval() == i );
+		delete e;
+
+		e = handoff.pop();
+		CPPUNIT_ASSERT( e->getIval() == i + 100 );
+		delete e;
+	}
+
+	CPPUNIT_ASSERT( handoff.isEmpty() );
+
+	// Left in the queue, deleted with it.
+	handoff.push(new TestEvent(1UL));
+}
+
+void EventHandoff_Test::testFull()
+{
+	EventHandoff handoff(4);
+
+	for (unsigned long i = 0; i < 4; i++) {
+		CPPUNIT_ASSERT( handoff.push(new TestEvent(i)) );
+	}
+
+	TestEvent *extra = new TestEvent(4UL);
+	CPPUNIT_ASSERT( !handoff.push(extra) );
+
+	Event *e = handoff.pop();
+	CPPUNIT_ASSERT( e->getIval() == 0 );
+	delete e;
+
+	// Room again.
+	CPPUNIT_ASSERT( handoff.push(extra) );
+	CPPUNIT_ASSERT( !handoff.isEmpty() );
+}
+
+void EventHandoff_Test::testProducers()
+{
+	EventHandoff handoff(64);
+	pthread_t threads[HANDOFF_TEST_PRODUCERS];
+	producerArg_t args[HANDOFF_TEST_PRODUCERS];
+
+	for (int i = 0; i < HANDOFF_TEST_PRODUCERS; i++) {
+		args[i].handoff = &handoff;
+		args[i].producer = i;
+		CPPUNIT_ASSERT( pthread_create(&threads[i], NULL, produce, &args[i]) == 0 );
+	}
+
+	// Every event arrives once, in the order of its producer.
+	unsigned long next[HANDOFF_TEST_PRODUCERS] = { 0 };
+	unsigned long received = 0;
+	bool ordered = true;
+
+	while (received < HANDOFF_TEST_PRODUCERS * HANDOFF_TEST_EVENTS) {
+		Event *e = handoff.pop();
+		if (e == NULL) {
+			sched_yield();
+			continue;
+		}
+
+		unsigned long producer = e->getIval() / HANDOFF_TEST_EVENTS;
+		unsigned long seq = e->getIval() % HANDOFF_TEST_EVENTS;
+		if (seq != next[producer]) {
+			ordered = false;
+		}
+		next[producer] = seq + 1;
+		received++;
+		delete e;
+	}
+
+	for (int i = 0; i < HANDOFF_TEST_PRODUCERS; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	CPPUNIT_ASSERT( ordered );
+	CPPUNIT_ASSERT( handoff.isEmpty() );
+}
@@ -0,0 +1,138 @@
+/*
+ * Test the IntervalIndex class.
+ *
+ * $Id: IntervalIndex_test.cpp 2015-08-21 09:40:00 amarentes $
+ * $HeadURL: https://./test/IntervalIndex_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "IntervalIndex.h"
+
+
+using namespace auction;
+
+class IntervalIndex_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( IntervalIndex_Test );
+
+	CPPUNIT_TEST( testFind );
+	CPPUNIT_TEST( testErase );
+	CPPUNIT_TEST( testScan );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testFind();
+	void testErase();
+	void testScan();
+
+  private:
+
+	//! sorted ids found for [start, stop)
+	vector<int> find(IntervalIndex &index, time_t start, time_t stop);
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( IntervalIndex_Test );
+
+
+void IntervalIndex_Test::setUp()
+{
+
+}
+
+void IntervalIndex_Test::tearDown()
+{
+
+}
+
+vector<int> IntervalIndex_Test::find(IntervalIndex &index, time_t start, time_t stop)
+{
+	vector<int> ids;
+	index.find(start, stop, ids);
+	sort(ids.begin(), ids.end());
+	return ids;
+}
+
+void IntervalIndex_Test::testFind()
+{
+	IntervalIndex index;
+	CPPUNIT_ASSERT( find(index, 0, 100).empty() );
+
+	index.insert(1, 10, 20);
+	index.insert(2, 15, 40);
+	index.insert(3, 30, 35);
+	index.insert(4, 50, 60);
+	CPPUNIT_ASSERT( index.size() == 4 );
+
+	vector<int> ids = find(index, 18, 31);
+	CPPUNIT_ASSERT( ids.size() == 3 );
+	CPPUNIT_ASSERT( ids[0] == 1 && ids[1] == 2 && ids[2] == 3 );
+
+	// The ends are open.
+	CPPUNIT_ASSERT( find(index, 40, 50).empty() );
+	CPPUNIT_ASSERT( find(index, 0, 10).empty() );
+
+	ids = find(index, 39, 51);
+	CPPUNIT_ASSERT( ids.size() == 2 );
+	CPPUNIT_ASSERT( ids[0] == 2 && ids[1] == 4 );
+}
+
+void IntervalIndex_Test::testErase()
+{
+	IntervalIndex index;
+	index.insert(1, 10, 20);
+	index.insert(2, 10, 30);
+
+	CPPUNIT_ASSERT( find(index, 25, 26).size() == 1 );
+
+	CPPUNIT_ASSERT( !index.erase(2, 11) );
+	CPPUNIT_ASSERT( index.erase(2, 10) );
+	CPPUNIT_ASSERT( !index.erase(2, 10) );
+
+	CPPUNIT_ASSERT( find(index, 25, 26).empty() );
+	CPPUNIT_ASSERT( find(index, 0, 100).size() == 1 );
+
+	CPPUNIT_ASSERT( index.erase(1, 10) );
+	CPPUNIT_ASSERT( index.empty() );
+}
+
+void IntervalIndex_Test::testScan()
+{
+	IntervalIndex index;
+	vector<indexedInterval_t> all;
+
+	srand(7);
+
+	// Same answers as checking every interval.
+	for (int round = 0; round < 200; round++) {
+
+		if (all.empty() || (rand() % 3) != 0) {
+			indexedInterval_t in;
+			in.id = round;
+			in.start = rand() % 1000;
+			in.stop = in.start + 1 + rand() % 200;
+			index.insert(in.id, in.start, in.stop);
+			all.push_back(in);
+		} else {
+			size_t pos = rand() % all.size();
+			CPPUNIT_ASSERT( index.erase(all[pos].id, all[pos].start) );
+			all.erase(all.begin() + pos);
+		}
+
+		time_t start = rand() % 1200;
+		time_t stop = start + 1 + rand() % 100;
+
+		vector<int> expected;
+		for (size_t i = 0; i < all.size(); i++) {
+			if ((all[i].start < stop) && (all[i].stop > start)) {
+				expected.push_back(all[i].id);
+			}
+		}
+		sort(expected.begin(), expected.end());
+
+		CPPUNIT_ASSERT( find(index, start, stop) == expected );
+	}
+}
@@ -0,0 +1,90 @@
+/*
+ * Test the LazyLog class.
+ *
+ * $Id: LazyLog_test.cpp 2015-08-21 09:40:00 amarentes $
+ * $HeadURL: https://./test/LazyLog_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "LazyLog.h"
+
+
+using namespace auction;
+
+class LazyLog_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( LazyLog_Test );
+
+	CPPUNIT_TEST( testEnabled );
+	CPPUNIT_TEST( testFormatter );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testEnabled();
+	void testFormatter();
+
+  private:
+
+	//! counts the times its text is asked for
+	class CountFormatter : public LogFormatter
+	{
+	  public:
+		mutable int calls;
+
+		CountFormatter() : calls(0) {}
+
+		virtual string format() const { calls++; return "counted"; }
+	};
+
+	Logger *log;
+	int ch;
+	int level;
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( LazyLog_Test );
+
+
+void LazyLog_Test::setUp()
+{
+	log = Logger::getInstance();
+	ch = log->createChannel("LazyLog_Test");
+	level = log->getLogLevel();
+}
+
+void LazyLog_Test::tearDown()
+{
+	log->setLogLevel(level);
+}
+
+void LazyLog_Test::testEnabled()
+{
+	log->setLogLevel(LAZY_LOG_WARNING);
+	CPPUNIT_ASSERT( LazyLog::isEnabled(log, LAZY_LOG_ERROR) );
+	CPPUNIT_ASSERT( LazyLog::isEnabled(log, LAZY_LOG_WARNING) );
+	CPPUNIT_ASSERT( !LazyLog::isEnabled(log, LAZY_LOG_INFO) );
+	CPPUNIT_ASSERT( !LazyLog::isEnabled(log, LAZY_LOG_DEBUG) );
+
+	// Logging turned off.
+	log->setLogLevel(-1);
+	CPPUNIT_ASSERT( !LazyLog::isEnabled(log, LAZY_LOG_ERROR) );
+}
+
+void LazyLog_Test::testFormatter()
+{
+	CountFormatter f;
+
+	log->setLogLevel(LAZY_LOG_INFO);
+	LazyLog::log(log, ch, LAZY_LOG_DEBUG, f);
+	CPPUNIT_ASSERT( f.calls == 0 );
+
+	LazyLog::log(log, ch, LAZY_LOG_INFO, f, "Message: ");
+	CPPUNIT_ASSERT( f.calls == 1 );
+
+	log->setLogLevel(LAZY_LOG_DEBUG);
+	LazyLog::log(log, ch, LAZY_LOG_DEBUG, f);
+	CPPUNIT_ASSERT( f.calls == 2 );
+}
@@ -0,0 +1,130 @@
+/*
+ * Test the LoopbackTransport class.
+ *
+ * $Id: LoopbackTransport_test.cpp 2015-08-23 16:05:00 amarentes $
+ * $HeadURL: https://./test/LoopbackTransport_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "LoopbackTransport.h"
+
+
+using namespace auction;
+
+class LoopbackTransport_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( LoopbackTransport_Test );
+
+	CPPUNIT_TEST( testChannel );
+	CPPUNIT_TEST( testCreate );
+	CPPUNIT_TEST( testBidding );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testChannel();
+	void testCreate();
+	void testBidding();
+
+  private:
+
+	anslp::FastQueue *agentQueue;
+	anslp::FastQueue *aumQueue;
+
+	LoopbackTransport *agent;
+	LoopbackTransport *aum;
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( LoopbackTransport_Test );
+
+
+void LoopbackTransport_Test::setUp()
+{
+	agentQueue = new anslp::FastQueue();
+	aumQueue = new anslp::FastQueue();
+
+	agent = new LoopbackTransport("test", agentQueue);
+	aum = new LoopbackTransport("test", aumQueue);
+}
+
+void LoopbackTransport_Test::tearDown()
+{
+	saveDelete(agent);
+	saveDelete(aum);
+	saveDelete(agentQueue);
+	saveDelete(aumQueue);
+}
+
+void LoopbackTransport_Test::testChannel()
+{
+	bool thrown = false;
+	try {
+		LoopbackTransport third("test", agentQueue);
+	} catch (Error &e) {
+		thrown = true;
+	}
+	CPPUNIT_ASSERT( thrown );
+
+	// Once an end leaves, its place is free again.
+	saveDelete(aum);
+	aum = new LoopbackTransport("test", aumQueue);
+}
+
+void LoopbackTransport_Test::testCreate()
+{
+	protlib::hostaddress addr;
+	addr.set_ip(agent->getLocalAddress());
+
+	ipap_message message(1, IPAP_VERSION, true);
+	agent->create("1", addr, addr, 0, 0, 0, agent->getInitiatorLifetime(), message);
+
+	// The initiator learns its anslp session id.
+	anslp::AnslpEvent *evt = agentQueue->dequeue_timedwait(10);
+	CPPUNIT_ASSERT( evt != NULL );
+	CPPUNIT_ASSERT( anslp::is_add_anslp_session_event(evt) );
+	string anslpSessionId =
+		dynamic_cast<anslp::AddAnslpSessionEvent *>(evt)->getAnslpSession();
+	delete evt;
+
+	// The peer gets the creation under that id.
+	evt = aumQueue->dequeue_timedwait(10);
+	CPPUNIT_ASSERT( evt != NULL );
+	CPPUNIT_ASSERT( anslp::is_addsession_event(evt) );
+	CPPUNIT_ASSERT( dynamic_cast<anslp::AddSessionEvent *>(evt)->getSession() == anslpSessionId );
+	delete evt;
+
+	// The answer of the peer reaches the initiator, its confirmation does not.
+	anslp::objectList_t objects;
+	aum->install(anslpSessionId, objects);
+	evt = agentQueue->dequeue_timedwait(10);
+	CPPUNIT_ASSERT( evt != NULL );
+	CPPUNIT_ASSERT( anslp::is_addsession_event(evt) );
+	delete evt;
+
+	agent->install(anslpSessionId, objects);
+	CPPUNIT_ASSERT( aumQueue->dequeue_timedwait(10) == NULL );
+}
+
+void LoopbackTransport_Test::testBidding()
+{
+	protlib::hostaddress addr;
+	addr.set_ip(agent->getLocalAddress());
+
+	anslp::session_id sid;
+	string sessionId = sid.to_string();
+
+	ipap_message message(1, IPAP_VERSION, true);
+	agent->bidding(new anslp::session_id(sid), addr, addr, 0, 0, 0, message);
+
+	anslp::AnslpEvent *evt = aumQueue->dequeue_timedwait(10);
+	CPPUNIT_ASSERT( evt != NULL );
+	CPPUNIT_ASSERT( anslp::is_auction_interaction_event(evt) );
+	CPPUNIT_ASSERT( dynamic_cast<anslp::AuctionInteractionEvent *>(evt)->getSession() == sessionId );
+	delete evt;
+
+	// Nothing comes back to the sender.
+	CPPUNIT_ASSERT( agentQueue->dequeue_timedwait(10) == NULL );
+}
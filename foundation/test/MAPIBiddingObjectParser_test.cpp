@@ -14,6 +14,7 @@
 #include "FieldDefParser.h"
 #include "BiddingObjectFileParser.h"
 #include "MAPIBiddingObjectParser.h"
+#include "Session.h"
 #include "anslp_ipap_message.h"
 #include "anslp_ipap_xml_message.h"
 
@@ -26,6 +27,9 @@ class MAPIBiddingObjectParser_Test : public CppUnit::TestFixture {
 	CPPUNIT_TEST_SUITE( MAPIBiddingObjectParser_Test );
 
     CPPUNIT_TEST( testMAPIBiddingObjectParser );
+    CPPUNIT_TEST( testMessageBatch );
+    CPPUNIT_TEST( testPeerTemplates );
+    CPPUNIT_TEST( testDecodeFields );
 	CPPUNIT_TEST_SUITE_END();
 
   public:
@@ -33,6 +37,9 @@ class MAPIBiddingObjectParser_Test : public CppUnit::TestFixture {
 	void tearDown();
 
 	void testMAPIBiddingObjectParser();
+	void testMessageBatch();
+	void testPeerTemplates();
+	void testDecodeFields();
 	void loadFieldDefs(fieldDefList_t *fieldList);
 	void loadFieldVals(fieldValList_t *fieldValList);
 	auctioningObjectDB_t * loadAuctions();
@@ -40,6 +47,16 @@ class MAPIBiddingObjectParser_Test : public CppUnit::TestFixture {
 	
 
   private:
+
+	/*! decode every field of the message, through its text or typed value
+		\returns the number of fields decoded
+	*/
+	int decodeFields(ipap_message *message, bool typed, vector<field_t> *fields);
+
+	/*! send the batch in message mid of the session, as the auctioneer does
+		\returns the templates the message carries
+	*/
+	list<int> sendBatch(biddingObjectBatch_t *batch, Session *session, uint32_t mid);
         
     FieldDefParser *ptrFieldParsers;
     FieldValParser *ptrFieldValParser;    
@@ -263,6 +280,249 @@ void MAPIBiddingObjectParser_Test::testMAPIBiddingObjectParser()
 }
 
 
+void MAPIBiddingObjectParser_Test::testMessageBatch() 
+{
+
+	try
+	{
+		auctioningObjectDB_t * auctions = loadAuctions();
+		Auction *auction = dynamic_cast<Auction *>((*auctions)[0]);
+		auctioningObjectDB_t *bids = loadBidsFromFile();
+		
+		biddingObjectBatch_t batch;
+		for(auctioningObjectDBIter_t i = bids->begin(); i != bids->end(); i++) {
+			batch.push_back(make_pair(dynamic_cast<BiddingObject *>(*i), auction));
+		}
+
+		// Every object fits, one message with the templates once.
+		vector<ipap_message *> messages = 
+				ptrMAPIBidParser->get_ipap_messages(&fieldDefs, &batch, templates, 1000);
+		CPPUNIT_ASSERT( messages.size() == 1 );
+
+		auctioningObjectDB_t *bids2 = new auctioningObjectDB_t();	
+		ptrMAPIBidParser->parse(&fieldDefs, &fieldVals, messages[0], bids2, templates );
+		CPPUNIT_ASSERT( bids2->size() == 3 );
+
+		for (size_t i = 0; i < messages.size(); i++) {
+			saveDelete(messages[i]);
+		}
+
+		// Objects with more records than the limit go alone.
+		messages = ptrMAPIBidParser->get_ipap_messages(&fieldDefs, &batch, templates, 1);
+		CPPUNIT_ASSERT( messages.size() == 3 );
+
+		for (size_t i = 0; i < messages.size(); i++) {
+			saveDelete(messages[i]);
+		}
+
+		for(auctioningObjectDBIter_t i = auctions->begin(); i != auctions->end(); i++) {
+            saveDelete(*i);
+        }
+        saveDelete(auctions);
+
+		for(auctioningObjectDBIter_t i=bids->begin(); i != bids->end(); i++) {
+            saveDelete(*i);
+        }
+        saveDelete(bids);
+
+		for(auctioningObjectDBIter_t i=bids2->begin(); i != bids2->end(); i++) {
+            saveDelete(*i);
+        }
+        saveDelete(bids2);		
+
+	} catch(Error &e){
+		std::cout << "Error:" << e.getError() << std::endl << std::flush;
+		throw e;
+	}
+}
+
+
+list<int> MAPIBiddingObjectParser_Test::sendBatch(biddingObjectBatch_t *batch, 
+													Session *session, uint32_t mid)
+{
+	vector<ipap_message *> messages = 
+			ptrMAPIBidParser->get_ipap_messages(&fieldDefs, batch, templates, 1000, 
+												&(session->getPeerTemplates()));
+	CPPUNIT_ASSERT( messages.size() == 1 );
+
+	messages[0]->set_seqno(mid);
+	session->addPendingMessage(*messages[0]);
+
+	list<int> templIds = messages[0]->get_template_list();
+	session->addSentTemplates(mid, templIds);
+
+	saveDelete(messages[0]);
+	return templIds;
+}
+
+
+void MAPIBiddingObjectParser_Test::testPeerTemplates() 
+{
+
+	try
+	{
+		auctioningObjectDB_t * auctions = loadAuctions();
+		Auction *auction = dynamic_cast<Auction *>((*auctions)[0]);
+		auctioningObjectDB_t *bids = loadBidsFromFile();
+		
+		biddingObjectBatch_t batch;
+		for(auctioningObjectDBIter_t i = bids->begin(); i != bids->end(); i++) {
+			batch.push_back(make_pair(dynamic_cast<BiddingObject *>(*i), auction));
+		}
+
+		Session session("session1");
+		session.setRetransmission(100, 100, 0, 0);
+
+		list<int> sent = sendBatch(&batch, &session, 1);
+		CPPUNIT_ASSERT( !sent.empty() );
+
+		// Not confirmed yet, the templates go again.
+		CPPUNIT_ASSERT( sendBatch(&batch, &session, 2).size() == sent.size() );
+		CPPUNIT_ASSERT( session.getPeerTemplates().empty() );
+
+		session.confirmMessages(2);
+		CPPUNIT_ASSERT( session.getPeerTemplates().size() == sent.size() );
+
+		// The peer holds them, they are left out.
+		CPPUNIT_ASSERT( sendBatch(&batch, &session, 3).empty() );
+		session.confirmMessage(3);
+
+		// Once reset they are carried again.
+		session.resetPeerTemplates();
+		CPPUNIT_ASSERT( session.getPeerTemplates().empty() );
+		CPPUNIT_ASSERT( sendBatch(&batch, &session, 4).size() == sent.size() );
+
+		// The message expires, a late ack does not make the peer hold them.
+		struct timeval later;
+		vector<ipap_message *> due;
+		vector<uint32_t> expired;
+		gettimeofday(&later, NULL);
+		later.tv_sec += 1;
+		session.getRetransmissions(later, due, expired);
+		CPPUNIT_ASSERT( expired.size() == 1 );
+		CPPUNIT_ASSERT( expired[0] == 4 );
+
+		session.confirmMessage(4);
+		CPPUNIT_ASSERT( session.getPeerTemplates().empty() );
+		CPPUNIT_ASSERT( sendBatch(&batch, &session, 5).size() == sent.size() );
+
+		for(auctioningObjectDBIter_t i = auctions->begin(); i != auctions->end(); i++) {
+            saveDelete(*i);
+        }
+        saveDelete(auctions);
+
+		for(auctioningObjectDBIter_t i=bids->begin(); i != bids->end(); i++) {
+            saveDelete(*i);
+        }
+        saveDelete(bids);
+
+	} catch(Error &e){
+		std::cout << "Error:" << e.getError() << std::endl << std::flush;
+		throw e;
+	}
+}
+
+
+int MAPIBiddingObjectParser_Test::decodeFields(ipap_message *message, bool typed, 
+												vector<field_t> *fields)
+{
+	int decoded = 0;
+
+	dateRecordListConstIter_t dataIter;
+	for (dataIter = message->begin(); dataIter != message->end(); ++dataIter)
+	{
+		ipap_data_record record = *dataIter;
+		ipap_template *templ = message->get_template_object(record.get_template_id());
+
+		fieldDataListIter_t fieldIter;
+		for (fieldIter = record.begin(); fieldIter != record.end(); ++fieldIter)
+		{
+			fieldDefItem_t fItem = IpApMessageParser::findField(&fieldDefs, 
+										fieldIter->first.get_eno(), fieldIter->first.get_ftype());
+			ipap_field field = templ->get_field(fieldIter->first.get_eno(), 
+												fieldIter->first.get_ftype());
+			field_t item;
+			item.name = fItem.name;
+			item.type = fItem.type;
+			item.len = fItem.len;
+
+			if (typed) {
+				IpApMessageParser::readFieldValue(field, fieldIter->second, &item);
+			} else {
+				IpApMessageParser::parseFieldValue(&fieldVals, 
+										field.writeValue(fieldIter->second), &item);
+			}
+
+			if (fields != NULL) {
+				fields->push_back(item);
+			}
+			decoded++;
+		}
+	}
+	return decoded;
+}
+
+void MAPIBiddingObjectParser_Test::testDecodeFields() 
+{
+
+	try
+	{
+		auctioningObjectDB_t * auctions = loadAuctions();
+		Auction *auction = dynamic_cast<Auction *>((*auctions)[0]);
+		auctioningObjectDB_t *bids = loadBidsFromFile();
+		BiddingObject *object1 = dynamic_cast<BiddingObject *> ((*bids)[0]);
+
+		ipap_message *message = ptrMAPIBidParser->get_ipap_message(&fieldDefs, object1, 
+																   auction, templates);
+
+		// Both paths read the same values.
+		vector<field_t> textFields, typedFields;
+		decodeFields(message, false, &textFields);
+		decodeFields(message, true, &typedFields);
+		CPPUNIT_ASSERT( textFields.size() == typedFields.size() );
+		CPPUNIT_ASSERT( textFields.size() > 0 );
+		for (size_t i = 0; i < textFields.size(); i++) {
+			CPPUNIT_ASSERT( textFields[i] == typedFields[i] );
+		}
+
+		// Throughput of both paths.
+		const int rounds = 2000;
+		int decoded = 0;
+
+		clock_t start = clock();
+		for (int i = 0; i < rounds; i++) {
+			decoded += decodeFields(message, false, NULL);
+		}
+		double textSecs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+		start = clock();
+		for (int i = 0; i < rounds; i++) {
+			decodeFields(message, true, NULL);
+		}
+		double typedSecs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+		cout << "Decoded " << decoded << " fields - text:" << textSecs 
+			 << "s typed:" << typedSecs << "s" << endl;
+
+		saveDelete(message);
+
+		for(auctioningObjectDBIter_t i = auctions->begin(); i != auctions->end(); i++) {
+            saveDelete(*i);
+        }
+        saveDelete(auctions);
+
+		for(auctioningObjectDBIter_t i=bids->begin(); i != bids->end(); i++) {
+            saveDelete(*i);
+        }
+        saveDelete(bids);
+
+	} catch(Error &e){
+		std::cout << "Error:" << e.getError() << std::endl << std::flush;
+		throw e;
+	}
+}
+
+
 void MAPIBiddingObjectParser_Test::loadFieldDefs(fieldDefList_t *fieldList)
 {
 	const string filename = DEF_SYSCONFDIR "/fielddef.xml";
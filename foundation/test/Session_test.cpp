@@ -0,0 +1,253 @@
+/*
+ * Test the Session class.
+ *
+ * $Id: Session_test.cpp 2015-08-25 10:20:00 amarentes $
+ * $HeadURL: https://./test/Session_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "IpAp_message.h"
+#include "Session.h"
+#include "Timeval.h"
+
+
+using namespace auction;
+
+class Session_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( Session_Test );
+
+	CPPUNIT_TEST( testPending );
+	CPPUNIT_TEST( testRetransmissions );
+	CPPUNIT_TEST( testMaxPending );
+	CPPUNIT_TEST( testReceiving );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testPending();
+	void testRetransmissions();
+	void testMaxPending();
+	void testReceiving();
+
+  private:
+
+	Session *session;
+
+	//! add a pending message with sequence number mid
+	void addMessage(uint32_t mid);
+
+	//! return now plus ms milliseconds
+	struct timeval after(struct timeval now, unsigned long ms);
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( Session_Test );
+
+
+void Session_Test::setUp()
+{
+	session = new Session("session1");
+}
+
+void Session_Test::tearDown()
+{
+	saveDelete(session);
+}
+
+void Session_Test::addMessage(uint32_t mid)
+{
+	ipap_message message(1, IPAP_VERSION, true);
+	message.set_seqno(mid);
+	session->addPendingMessage(message);
+}
+
+struct timeval Session_Test::after(struct timeval now, unsigned long ms)
+{
+	struct timeval delta = { ms / 1000, (ms % 1000) * 1000 };
+	return Timeval::add(now, delta);
+}
+
+void Session_Test::testPending()
+{
+	addMessage(1);
+	addMessage(2);
+	addMessage(3);
+	CPPUNIT_ASSERT( session->getNumPendingMessages() == 3 );
+
+	// A sequence number is pending only once.
+	bool thrown = false;
+	try {
+		addMessage(2);
+	} catch (Error &e) {
+		thrown = true;
+	}
+	CPPUNIT_ASSERT( thrown );
+
+	session->confirmMessage(2);
+	CPPUNIT_ASSERT( session->getNumPendingMessages() == 2 );
+
+	// Cumulative, confirms everything up to the number given.
+	addMessage(4);
+	CPPUNIT_ASSERT( session->confirmMessages(3) == 2 );
+	CPPUNIT_ASSERT( session->getNumPendingMessages() == 1 );
+	CPPUNIT_ASSERT( session->beginMessages()->first == 4 );
+	CPPUNIT_ASSERT( session->confirmMessages(3) == 0 );
+}
+
+void Session_Test::testRetransmissions()
+{
+	vector<ipap_message *> due;
+	vector<uint32_t> expired;
+	struct timeval when, now;
+
+	// Disabled, nothing is scheduled.
+	addMessage(1);
+	CPPUNIT_ASSERT( !session->getNextRetransmission(when) );
+	session->confirmMessage(1);
+
+	session->setRetransmission(100, 400, 2, 0);
+
+	gettimeofday(&now, NULL);
+	addMessage(2);
+	addMessage(3);
+
+	CPPUNIT_ASSERT( session->getNextRetransmission(when) );
+	CPPUNIT_ASSERT( Timeval::cmp(when, after(now, 100)) >= 0 );
+
+	session->getRetransmissions(now, due, expired);
+	CPPUNIT_ASSERT( due.empty() );
+	CPPUNIT_ASSERT( expired.empty() );
+
+	// First retransmission, the timeout doubles.
+	now = after(now, 1000);
+	session->getRetransmissions(now, due, expired);
+	CPPUNIT_ASSERT( due.size() == 2 );
+	CPPUNIT_ASSERT( due[0]->get_seqno() == 2 );
+	CPPUNIT_ASSERT( expired.empty() );
+
+	CPPUNIT_ASSERT( session->getNextRetransmission(when) );
+	CPPUNIT_ASSERT( Timeval::cmp(when, after(now, 200)) == 0 );
+
+	// A confirmed message is not sent again.
+	session->confirmMessage(2);
+
+	due.clear();
+	session->getRetransmissions(after(now, 100), due, expired);
+	CPPUNIT_ASSERT( due.empty() );
+
+	// Second one, the timeout reaches its limit.
+	now = after(now, 200);
+	session->getRetransmissions(now, due, expired);
+	CPPUNIT_ASSERT( due.size() == 1 );
+	CPPUNIT_ASSERT( due[0]->get_seqno() == 3 );
+
+	CPPUNIT_ASSERT( session->getNextRetransmission(when) );
+	CPPUNIT_ASSERT( Timeval::cmp(when, after(now, 400)) == 0 );
+
+	// Out of retries, the message expires.
+	due.clear();
+	session->getRetransmissions(when, due, expired);
+	CPPUNIT_ASSERT( due.empty() );
+	CPPUNIT_ASSERT( expired.size() == 1 );
+	CPPUNIT_ASSERT( expired[0] == 3 );
+	CPPUNIT_ASSERT( session->getNumPendingMessages() == 0 );
+	CPPUNIT_ASSERT( !session->getNextRetransmission(when) );
+}
+
+void Session_Test::testMaxPending()
+{
+	vector<ipap_message *> due;
+	vector<uint32_t> expired;
+	struct timeval when, now;
+
+	// Without retransmissions the limit holds as well.
+	session->setRetransmission(0, 0, 0, 3);
+
+	for (uint32_t mid = 1; mid <= 5; mid++) {
+		addMessage(mid);
+	}
+
+	// The oldest ones gave their place.
+	CPPUNIT_ASSERT( session->getNumPendingMessages() == 3 );
+	CPPUNIT_ASSERT( session->beginMessages()->first == 3 );
+
+	gettimeofday(&now, NULL);
+	CPPUNIT_ASSERT( !session->getNextRetransmission(when) );
+	session->getRetransmissions(after(now, 60000), due, expired);
+	CPPUNIT_ASSERT( due.empty() );
+	CPPUNIT_ASSERT( expired.empty() );
+	CPPUNIT_ASSERT( session->getNumPendingMessages() == 3 );
+
+	// A dropped message is not retransmitted.
+	session->setRetransmission(100, 100, 1, 3);
+	gettimeofday(&now, NULL);
+	for (uint32_t mid = 6; mid <= 9; mid++) {
+		addMessage(mid);
+	}
+	CPPUNIT_ASSERT( session->getNumPendingMessages() == 3 );
+	CPPUNIT_ASSERT( session->beginMessages()->first == 7 );
+
+	session->getRetransmissions(after(now, 1000), due, expired);
+	CPPUNIT_ASSERT( due.size() == 3 );
+	CPPUNIT_ASSERT( due[0]->get_seqno() == 7 );
+	CPPUNIT_ASSERT( expired.empty() );
+}
+
+void Session_Test::testReceiving()
+{
+	uint32_t ackSeqNo = 0;
+
+	CPPUNIT_ASSERT( !session->wasReceived(1) );
+	CPPUNIT_ASSERT( !session->takeAck(ackSeqNo) );
+
+	// The message setting up the session starts the sequence.
+	session->startReceiving(10);
+	CPPUNIT_ASSERT( session->getLastReceived() == 10 );
+	CPPUNIT_ASSERT( session->wasReceived(10) );
+	CPPUNIT_ASSERT( session->wasReceived(5) );
+	CPPUNIT_ASSERT( !session->wasReceived(11) );
+	CPPUNIT_ASSERT( !session->takeAck(ackSeqNo) );
+
+	session->messageReceived(11);
+	CPPUNIT_ASSERT( session->getLastReceived() == 11 );
+	CPPUNIT_ASSERT( session->takeAck(ackSeqNo) );
+	CPPUNIT_ASSERT( ackSeqNo == 12 );
+	CPPUNIT_ASSERT( !session->takeAck(ackSeqNo) );
+
+	// Out of order, the ack stays at the gap.
+	session->messageReceived(13);
+	session->messageReceived(14);
+	CPPUNIT_ASSERT( session->getLastReceived() == 11 );
+	CPPUNIT_ASSERT( session->wasReceived(13) );
+	CPPUNIT_ASSERT( !session->wasReceived(12) );
+	CPPUNIT_ASSERT( session->takeAck(ackSeqNo) );
+	CPPUNIT_ASSERT( ackSeqNo == 12 );
+
+	// Filling the gap takes the messages received ahead.
+	session->messageReceived(12);
+	CPPUNIT_ASSERT( session->getLastReceived() == 14 );
+	CPPUNIT_ASSERT( session->takeAck(ackSeqNo) );
+	CPPUNIT_ASSERT( ackSeqNo == 15 );
+
+	// A duplicate is acknowledged again, its ack may have been lost.
+	session->messageReceived(13);
+	CPPUNIT_ASSERT( session->getLastReceived() == 14 );
+	CPPUNIT_ASSERT( session->takeAck(ackSeqNo) );
+	CPPUNIT_ASSERT( ackSeqNo == 15 );
+
+	// A restart skips the gap, the sequence never goes back.
+	session->messageReceived(17);
+	session->messageReceived(18);
+	session->messageReceived(20);
+	session->startReceiving(16);
+	CPPUNIT_ASSERT( session->getLastReceived() == 18 );
+	CPPUNIT_ASSERT( session->wasReceived(20) );
+	session->startReceiving(8);
+	CPPUNIT_ASSERT( session->getLastReceived() == 18 );
+
+	session->messageReceived(19);
+	CPPUNIT_ASSERT( session->getLastReceived() == 20 );
+}
@@ -0,0 +1,162 @@
+/*
+ * Test the SocketTransport class.
+ *
+ * $Id: SocketTransport_test.cpp 2015-08-23 16:05:00 amarentes $
+ * $HeadURL: https://./test/SocketTransport_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "SocketTransport.h"
+
+
+using namespace auction;
+
+class SocketTransport_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( SocketTransport_Test );
+
+	CPPUNIT_TEST( testCreate );
+	CPPUNIT_TEST( testBidding );
+	CPPUNIT_TEST( testNoPeer );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testCreate();
+	void testBidding();
+	void testNoPeer();
+
+  private:
+
+	string agentPath;
+	string aumPath;
+
+	anslp::FastQueue *agentQueue;
+	anslp::FastQueue *aumQueue;
+
+	SocketTransport *agent;
+	SocketTransport *aum;
+
+	//! without threads nothing reads the socket of an end until it is polled
+	void poll(SocketTransport *end);
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( SocketTransport_Test );
+
+
+void SocketTransport_Test::setUp()
+{
+	ostringstream prefix;
+	prefix << "/tmp/SocketTransport_test." << getpid();
+	agentPath = prefix.str() + ".agent";
+	aumPath = prefix.str() + ".aum";
+
+	agentQueue = new anslp::FastQueue();
+	aumQueue = new anslp::FastQueue();
+
+	agent = new SocketTransport(agentPath, aumPath, agentQueue);
+	aum = new SocketTransport(aumPath, agentPath, aumQueue);
+}
+
+void SocketTransport_Test::tearDown()
+{
+	saveDelete(agent);
+	saveDelete(aum);
+	saveDelete(agentQueue);
+	saveDelete(aumQueue);
+}
+
+void SocketTransport_Test::poll(SocketTransport *end)
+{
+	if (end->getPollFd() >= 0) {
+		end->receive();
+	}
+}
+
+void SocketTransport_Test::testCreate()
+{
+	protlib::hostaddress addr;
+	addr.set_ip(agent->getLocalAddress());
+
+	ipap_message message(1, IPAP_VERSION, true);
+	agent->create("1", addr, addr, 0, 0, 0, agent->getInitiatorLifetime(), message);
+
+	// The initiator learns its anslp session id.
+	anslp::AnslpEvent *evt = agentQueue->dequeue_timedwait(1000);
+	CPPUNIT_ASSERT( evt != NULL );
+	CPPUNIT_ASSERT( anslp::is_add_anslp_session_event(evt) );
+	string anslpSessionId =
+		dynamic_cast<anslp::AddAnslpSessionEvent *>(evt)->getAnslpSession();
+	delete evt;
+
+	// The peer gets the creation under that id, with the message.
+	poll(aum);
+	evt = aumQueue->dequeue_timedwait(1000);
+	CPPUNIT_ASSERT( evt != NULL );
+	CPPUNIT_ASSERT( anslp::is_addsession_event(evt) );
+	anslp::AddSessionEvent *ase = dynamic_cast<anslp::AddSessionEvent *>(evt);
+	CPPUNIT_ASSERT( ase->getSession() == anslpSessionId );
+	CPPUNIT_ASSERT( ase->getObjects()->size() == 1 );
+	delete evt;
+
+	// The answer of the peer reaches the initiator, its confirmation does not.
+	anslp::objectList_t objects;
+	aum->install(anslpSessionId, objects);
+	poll(agent);
+	evt = agentQueue->dequeue_timedwait(1000);
+	CPPUNIT_ASSERT( evt != NULL );
+	CPPUNIT_ASSERT( anslp::is_addsession_event(evt) );
+	delete evt;
+
+	agent->install(anslpSessionId, objects);
+	poll(aum);
+	CPPUNIT_ASSERT( aumQueue->dequeue_timedwait(100) == NULL );
+}
+
+void SocketTransport_Test::testBidding()
+{
+	protlib::hostaddress addr;
+	addr.set_ip(agent->getLocalAddress());
+
+	anslp::session_id sid;
+	string sessionId = sid.to_string();
+
+	ipap_message message(1, IPAP_VERSION, true);
+	agent->bidding(new anslp::session_id(sid), addr, addr, 0, 0, 0, message);
+
+	poll(aum);
+	anslp::AnslpEvent *evt = aumQueue->dequeue_timedwait(1000);
+	CPPUNIT_ASSERT( evt != NULL );
+	CPPUNIT_ASSERT( anslp::is_auction_interaction_event(evt) );
+	anslp::AuctionInteractionEvent *aie = dynamic_cast<anslp::AuctionInteractionEvent *>(evt);
+	CPPUNIT_ASSERT( aie->getSession() == sessionId );
+	CPPUNIT_ASSERT( aie->getObjects()->size() == 1 );
+	delete evt;
+
+	// Nothing comes back to the sender.
+	poll(agent);
+	CPPUNIT_ASSERT( agentQueue->dequeue_timedwait(100) == NULL );
+}
+
+void SocketTransport_Test::testNoPeer()
+{
+	saveDelete(aum);
+
+	protlib::hostaddress addr;
+	addr.set_ip(agent->getLocalAddress());
+
+	bool thrown = false;
+	try {
+		ipap_message message(1, IPAP_VERSION, true);
+		agent->bidding(new anslp::session_id(), addr, addr, 0, 0, 0, message);
+	} catch (Error &e) {
+		thrown = true;
+	}
+	CPPUNIT_ASSERT( thrown );
+
+	// The peer can come up later.
+	aum = new SocketTransport(aumPath, agentPath, aumQueue);
+}
@@ -0,0 +1,248 @@
+/*
+ * Test the StateLog class.
+ *
+ * $Id: StateLog_test.cpp 2015-08-18 10:05:00 amarentes $
+ * $HeadURL: https://./test/StateLog_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "StateLog.h"
+#include "Timeval.h"
+
+
+using namespace auction;
+
+class StateLog_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( StateLog_Test );
+
+	CPPUNIT_TEST( testEncode );
+	CPPUNIT_TEST( testAppend );
+	CPPUNIT_TEST( testSync );
+	CPPUNIT_TEST( testTruncated );
+	CPPUNIT_TEST( testCompact );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+
+	void setUp();
+	void tearDown();
+	void testEncode();
+	void testAppend();
+	void testSync();
+	void testTruncated();
+	void testCompact();
+
+  private:
+
+	string logFile;
+
+	//! append a removal of bidding object name
+	void appendRemoval(StateLog &stateLog, string name);
+
+	//! read every entry of the log
+	vector<stateLogEntry_t> readAll(bool &corrupt);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( StateLog_Test );
+
+
+void StateLog_Test::setUp()
+{
+	logFile = "state_test.log";
+	unlink(logFile.c_str());
+}
+
+void StateLog_Test::tearDown()
+{
+	unlink(logFile.c_str());
+}
+
+void StateLog_Test::appendRemoval(StateLog &stateLog, string name)
+{
+	stateLogEntry_t entry;
+	entry.type = STATELOG_BIDDING_OBJECT_REMOVED;
+	entry.set = "bidSet";
+	entry.name = name;
+	stateLog.append(entry);
+}
+
+vector<stateLogEntry_t> StateLog_Test::readAll(bool &corrupt)
+{
+	vector<stateLogEntry_t> entries;
+	StateLogReader reader(logFile);
+	stateLogEntry_t entry;
+
+	while (reader.next(entry)) {
+		entries.push_back(entry);
+	}
+	corrupt = reader.isCorrupt();
+	return entries;
+}
+
+void StateLog_Test::testEncode()
+{
+	stateLogEntry_t entry;
+	entry.type = STATELOG_SESSION_CREATED;
+	entry.sequence = 0x100000002ULL;
+	entry.session.sessionId = "session1";
+	entry.session.state = 1;
+	entry.session.senderPort = 12244;
+	entry.session.receiverPort = 12246;
+	entry.session.protocol = 17;
+	entry.session.lifetime = 30;
+	entry.session.lastMessageId = 5;
+	entry.session.lastReceived = 3;
+	entry.session.auctions.push_back("1.1");
+	entry.session.pendingMessages.push_back(make_pair(5U, string("<message/>")));
+
+	string payload;
+	StateLog::encode(entry, payload);
+
+	stateLogEntry_t e;
+	CPPUNIT_ASSERT( StateLog::decode(payload, e) );
+	CPPUNIT_ASSERT( e.type == STATELOG_SESSION_CREATED );
+	CPPUNIT_ASSERT( e.sequence == 0x100000002ULL );
+	CPPUNIT_ASSERT( e.session.sessionId == "session1" );
+	CPPUNIT_ASSERT( e.session.lastReceived == 3 );
+	CPPUNIT_ASSERT( e.session.auctions.size() == 1 );
+	CPPUNIT_ASSERT( e.session.pendingMessages[0].second == "<message/>" );
+
+	entry.type = STATELOG_MESSAGE_SENT;
+	entry.sessionId = "session1";
+	entry.messageId = 6;
+	entry.message = "<allocation/>";
+
+	payload.clear();
+	StateLog::encode(entry, payload);
+
+	stateLogEntry_t e2;
+	CPPUNIT_ASSERT( StateLog::decode(payload, e2) );
+	CPPUNIT_ASSERT( e2.sessionId == "session1" );
+	CPPUNIT_ASSERT( e2.messageId == 6 );
+	CPPUNIT_ASSERT( e2.message == "<allocation/>" );
+
+	// Cut short or unknown type.
+	stateLogEntry_t e3;
+	CPPUNIT_ASSERT( !StateLog::decode(payload.substr(0, payload.size() - 1), e3) );
+	payload[0] = (char) 100;
+	CPPUNIT_ASSERT( !StateLog::decode(payload, e3) );
+}
+
+void StateLog_Test::testAppend()
+{
+	{
+		StateLog stateLog(logFile, 1000);
+		appendRemoval(stateLog, "1");
+		appendRemoval(stateLog, "2");
+
+		// Appended entries are only buffered.
+		CPPUNIT_ASSERT( stateLog.getSize() > STATELOG_HEADER_LEN );
+		bool corrupt;
+		CPPUNIT_ASSERT( readAll(corrupt).empty() );
+
+		stateLog.flush();
+		CPPUNIT_ASSERT( readAll(corrupt).size() == 2 );
+	}
+
+	// Reopening continues the sequence.
+	StateLog stateLog(logFile, 0);
+	CPPUNIT_ASSERT( stateLog.getSequence() == 2 );
+	appendRemoval(stateLog, "3");
+	stateLog.flush();
+	CPPUNIT_ASSERT( stateLog.getNumSyncs() == 1 );
+
+	bool corrupt;
+	vector<stateLogEntry_t> entries = readAll(corrupt);
+	CPPUNIT_ASSERT( !corrupt );
+	CPPUNIT_ASSERT( entries.size() == 3 );
+	CPPUNIT_ASSERT( entries[2].sequence == 3 );
+	CPPUNIT_ASSERT( entries[2].type == STATELOG_BIDDING_OBJECT_REMOVED );
+	CPPUNIT_ASSERT( entries[2].name == "3" );
+}
+
+void StateLog_Test::testSync()
+{
+	StateLog stateLog(logFile, 1000);
+	struct timeval when;
+	CPPUNIT_ASSERT( !stateLog.getNextSync(when) );
+
+	// Written, the sync waits for the end of the interval.
+	appendRemoval(stateLog, "1");
+	stateLog.flush();
+	CPPUNIT_ASSERT( stateLog.getNumSyncs() == 0 );
+	CPPUNIT_ASSERT( stateLog.getNextSync(when) );
+
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	CPPUNIT_ASSERT( Timeval::cmp(when, now) > 0 );
+
+	stateLog.sync();
+	CPPUNIT_ASSERT( stateLog.getNumSyncs() == 1 );
+	CPPUNIT_ASSERT( !stateLog.getNextSync(when) );
+}
+
+void StateLog_Test::testTruncated()
+{
+	{
+		StateLog stateLog(logFile, 0);
+		appendRemoval(stateLog, "1");
+		appendRemoval(stateLog, "2");
+	}
+
+	// A write cut in the middle by a crash.
+	struct stat st;
+	stat(logFile.c_str(), &st);
+	CPPUNIT_ASSERT( truncate(logFile.c_str(), st.st_size - 3) == 0 );
+
+	bool corrupt;
+	CPPUNIT_ASSERT( readAll(corrupt).size() == 1 );
+	CPPUNIT_ASSERT( corrupt );
+
+	// Opening drops the damaged entry, new entries follow the valid ones.
+	{
+		StateLog stateLog(logFile, 0);
+		CPPUNIT_ASSERT( stateLog.getSequence() == 1 );
+		appendRemoval(stateLog, "3");
+	}
+
+	vector<stateLogEntry_t> entries = readAll(corrupt);
+	CPPUNIT_ASSERT( !corrupt );
+	CPPUNIT_ASSERT( entries.size() == 2 );
+	CPPUNIT_ASSERT( entries[1].sequence == 2 );
+	CPPUNIT_ASSERT( entries[1].name == "3" );
+}
+
+void StateLog_Test::testCompact()
+{
+	{
+		StateLog stateLog(logFile, 0);
+		appendRemoval(stateLog, "1");
+		appendRemoval(stateLog, "2");
+
+		// Everything is in the snapshot.
+		stateLog.compact(2);
+		CPPUNIT_ASSERT( stateLog.getSize() == STATELOG_HEADER_LEN );
+		CPPUNIT_ASSERT( stateLog.getBaseSequence() == 2 );
+
+		appendRemoval(stateLog, "3");
+		appendRemoval(stateLog, "4");
+
+		// Entry 4 is not in the snapshot, nothing is dropped.
+		stateLog.compact(3);
+		CPPUNIT_ASSERT( stateLog.getBaseSequence() == 3 );
+	}
+
+	bool corrupt;
+	vector<stateLogEntry_t> entries = readAll(corrupt);
+	CPPUNIT_ASSERT( entries.size() == 2 );
+	CPPUNIT_ASSERT( entries[0].sequence == 3 );
+
+	StateLogReader reader(logFile);
+	CPPUNIT_ASSERT( reader.getBaseSequence() == 3 );
+
+	// The sequence survives the compaction.
+	StateLog stateLog(logFile, 0);
+	CPPUNIT_ASSERT( stateLog.getSequence() == 4 );
+}
@@ -0,0 +1,165 @@
+/*
+ * Test the StateSnapshot class.
+ *
+ * $Id: StateSnapshot_test.cpp 2015-08-17 09:20:00 amarentes $
+ * $HeadURL: https://./test/StateSnapshot_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "StateSnapshot.h"
+
+
+using namespace auction;
+
+class StateSnapshot_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( StateSnapshot_Test );
+
+	CPPUNIT_TEST( testEncode );
+	CPPUNIT_TEST( testWriteRead );
+	CPPUNIT_TEST( testDamaged );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testEncode();
+	void testWriteRead();
+	void testDamaged();
+
+  private:
+
+	stateSnapshot_t snapshot;
+
+	string snapshotFile;
+
+	//! check that s has the contents of snapshot
+	void check(const stateSnapshot_t &s);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( StateSnapshot_Test );
+
+
+void StateSnapshot_Test::setUp()
+{
+	snapshot.created = 1439800000;
+	snapshot.logSequence = 0x100000001ULL;
+	snapshot.auctions = "<auctions message/>";
+	snapshot.auctionFile = "/etc/netaum/example_auctions1.xml";
+	snapshot.auctionFileTime = 1439700000;
+
+	sessionStateRecord_t session;
+	session.sessionId = "session1";
+	session.anslpSessionId = "anslp1";
+	session.state = 2;
+	session.senderAddress = "192.168.2.11";
+	session.receiverAddress = "192.168.2.12";
+	session.sourceAddress = "192.168.2.12";
+	session.senderPort = 12244;
+	session.receiverPort = 12246;
+	session.protocol = 17;
+	session.lifetime = 30;
+	session.lastMessageId = 0xFFFFFFF0U;
+	session.lastReceived = 7;
+	session.auctions.push_back("1.1");
+	session.pendingMessages.push_back(make_pair(0xFFFFFFF0U, string("<message/>")));
+	snapshot.sessions.push_back(session);
+
+	biddingObjectStateRecord_t bid;
+	bid.sessionId = "session1";
+	bid.message = "<bid message/>";
+	snapshot.biddingObjects.push_back(bid);
+	snapshot.biddingObjects.push_back(bid);
+
+	snapshotFile = "state_test.snapshot";
+	unlink(snapshotFile.c_str());
+}
+
+void StateSnapshot_Test::tearDown()
+{
+	unlink(snapshotFile.c_str());
+	unlink((snapshotFile + ".tmp").c_str());
+}
+
+void StateSnapshot_Test::check(const stateSnapshot_t &s)
+{
+	CPPUNIT_ASSERT( s.logSequence == 0x100000001ULL );
+	CPPUNIT_ASSERT( s.auctions == "<auctions message/>" );
+	CPPUNIT_ASSERT( s.auctionFile == "/etc/netaum/example_auctions1.xml" );
+	CPPUNIT_ASSERT( s.auctionFileTime == 1439700000 );
+	CPPUNIT_ASSERT( s.sessions.size() == 1 );
+	CPPUNIT_ASSERT( s.sessions[0].sessionId == "session1" );
+	CPPUNIT_ASSERT( s.sessions[0].anslpSessionId == "anslp1" );
+	CPPUNIT_ASSERT( s.sessions[0].receiverPort == 12246 );
+	CPPUNIT_ASSERT( s.sessions[0].protocol == 17 );
+	CPPUNIT_ASSERT( s.sessions[0].lastMessageId == 0xFFFFFFF0U );
+	CPPUNIT_ASSERT( s.sessions[0].lastReceived == 7 );
+	CPPUNIT_ASSERT( s.sessions[0].auctions.size() == 1 );
+	CPPUNIT_ASSERT( s.sessions[0].pendingMessages.size() == 1 );
+	CPPUNIT_ASSERT( s.sessions[0].pendingMessages[0].second == "<message/>" );
+	CPPUNIT_ASSERT( s.biddingObjects.size() == 2 );
+	CPPUNIT_ASSERT( s.biddingObjects[1].message == "<bid message/>" );
+}
+
+void StateSnapshot_Test::testEncode()
+{
+	string payload;
+	StateSnapshot::encode(snapshot, payload);
+
+	stateSnapshot_t s;
+	CPPUNIT_ASSERT( StateSnapshot::decode(payload.data(), payload.size(), s) );
+	check(s);
+
+	// A payload cut short is rejected.
+	stateSnapshot_t s2;
+	CPPUNIT_ASSERT( !StateSnapshot::decode(payload.data(), payload.size() - 1, s2) );
+}
+
+void StateSnapshot_Test::testWriteRead()
+{
+	stateSnapshot_t s;
+	CPPUNIT_ASSERT( !StateSnapshot::read(snapshotFile, s) );
+
+	StateSnapshot::write(snapshotFile, snapshot);
+
+	// A second write replaces the first one.
+	snapshot.created++;
+	StateSnapshot::write(snapshotFile, snapshot);
+
+	CPPUNIT_ASSERT( StateSnapshot::read(snapshotFile, s) );
+	CPPUNIT_ASSERT( s.created == 1439800001 );
+	check(s);
+}
+
+void StateSnapshot_Test::testDamaged()
+{
+	StateSnapshot::write(snapshotFile, snapshot);
+
+	// Flip the last byte.
+	struct stat st;
+	stat(snapshotFile.c_str(), &st);
+
+	fstream f(snapshotFile.c_str(), ios::in | ios::out | ios::binary);
+	f.seekg(st.st_size - 1);
+	char c = f.get();
+	f.seekp(st.st_size - 1);
+	f.put(c ^ 0x01);
+	f.close();
+
+	stateSnapshot_t s;
+	CPPUNIT_ASSERT_THROW( StateSnapshot::read(snapshotFile, s), Error );
+
+	// Cut short.
+	StateSnapshot::write(snapshotFile, snapshot);
+	CPPUNIT_ASSERT( truncate(snapshotFile.c_str(), st.st_size - 3) == 0 );
+	CPPUNIT_ASSERT_THROW( StateSnapshot::read(snapshotFile, s), Error );
+
+	// Written by another version.
+	StateSnapshot::write(snapshotFile, snapshot);
+	f.open(snapshotFile.c_str(), ios::in | ios::out | ios::binary);
+	f.seekp(4);
+	f.put(SNAPSHOT_VERSION + 1);
+	f.close();
+	CPPUNIT_ASSERT_THROW( StateSnapshot::read(snapshotFile, s), Error );
+}
@@ -0,0 +1,142 @@
+/*
+ * Test the StringTable class.
+ *
+ * $Id: StringTable_test.cpp 2015-08-04 14:56:00 amarentes $
+ * $HeadURL: https://./test/StringTable_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "StringTable.h"
+
+
+using namespace auction;
+
+class StringTable_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( StringTable_Test );
+
+	CPPUNIT_TEST( testIntern );
+	CPPUNIT_TEST( testAssign );
+	CPPUNIT_TEST( testCollect );
+	CPPUNIT_TEST( testFind );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testIntern();
+	void testAssign();
+	void testCollect();
+	void testFind();
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( StringTable_Test );
+
+
+void StringTable_Test::setUp()
+{
+	StringTable::getInstance()->collect();
+}
+
+void StringTable_Test::tearDown()
+{
+	StringTable::getInstance()->collect();
+}
+
+void StringTable_Test::testIntern()
+{
+	InternedString set1("1");
+	InternedString set2(string("1"));
+	InternedString set3("2");
+	InternedString empty;
+
+	// Same value, same entry.
+	CPPUNIT_ASSERT( set1 == set2 );
+	CPPUNIT_ASSERT( &(set1.str()) == &(set2.str()) );
+	CPPUNIT_ASSERT( set1 != set3 );
+	CPPUNIT_ASSERT( set1.hash() == set2.hash() );
+	CPPUNIT_ASSERT( set1.hash() == hashString("1") );
+
+	CPPUNIT_ASSERT( set1 < set3 );
+	CPPUNIT_ASSERT( !(set3 < set1) );
+	CPPUNIT_ASSERT( !(set1 < set2) );
+
+	CPPUNIT_ASSERT( empty.empty() );
+	CPPUNIT_ASSERT( empty == InternedString("") );
+
+	const string &value = set3;
+	CPPUNIT_ASSERT( value == "2" );
+	CPPUNIT_ASSERT( (string("set") + set1) == "set1" );
+}
+
+void StringTable_Test::testAssign()
+{
+	InternedString sess1("session_a");
+	InternedString sess2("session_b");
+
+	sess2 = sess1;
+	CPPUNIT_ASSERT( sess2 == sess1 );
+	CPPUNIT_ASSERT( sess2.str() == "session_a" );
+
+	// Self assignment keeps the entry alive.
+	sess1 = sess1;
+	CPPUNIT_ASSERT( sess1.str() == "session_a" );
+
+	InternedString sess3(sess1);
+	CPPUNIT_ASSERT( sess3 == sess1 );
+}
+
+void StringTable_Test::testCollect()
+{
+	unsigned int base = StringTable::getInstance()->size();
+
+	{
+		InternedString name1("collect_1");
+		InternedString name2("collect_2");
+		InternedString name3(name1);
+
+		CPPUNIT_ASSERT( StringTable::getInstance()->size() == base + 2 );
+
+		// Referenced entries are kept.
+		CPPUNIT_ASSERT( StringTable::getInstance()->collect() == 0 );
+		CPPUNIT_ASSERT( StringTable::getInstance()->size() == base + 2 );
+	}
+
+	CPPUNIT_ASSERT( StringTable::getInstance()->collect() == 2 );
+	CPPUNIT_ASSERT( StringTable::getInstance()->size() == base );
+
+	// The empty string is never removed.
+	{
+		InternedString empty;
+	}
+	StringTable::getInstance()->collect();
+	InternedString empty;
+	CPPUNIT_ASSERT( empty.empty() );
+}
+
+void StringTable_Test::testFind()
+{
+	unsigned int base = StringTable::getInstance()->size();
+
+	InternedString handle;
+	CPPUNIT_ASSERT( InternedString::find("find_1", handle) == false );
+	CPPUNIT_ASSERT( handle.empty() );
+
+	// Looking up a value does not intern it.
+	CPPUNIT_ASSERT( StringTable::getInstance()->size() == base );
+
+	InternedString name("find_1");
+	CPPUNIT_ASSERT( InternedString::find("find_1", handle) == true );
+	CPPUNIT_ASSERT( handle == name );
+
+	// Collected only once the table doubled since the last collection.
+	StringTable::getInstance()->collect();
+	{
+		InternedString grown("find_2");
+		InternedString other(name);
+	}
+	CPPUNIT_ASSERT( StringTable::getInstance()->collectGrown() == 0 );
+	CPPUNIT_ASSERT( StringTable::getInstance()->collect() == 1 );
+}
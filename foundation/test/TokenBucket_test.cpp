@@ -0,0 +1,111 @@
+/*
+ * Test the TokenBucket class.
+ *
+ * $Id: TokenBucket_test.cpp 2015-08-22 10:20:00 amarentes $
+ * $HeadURL: https://./test/TokenBucket_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "TokenBucket.h"
+
+
+using namespace auction;
+
+class TokenBucket_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( TokenBucket_Test );
+
+	CPPUNIT_TEST( testUnlimited );
+	CPPUNIT_TEST( testBurst );
+	CPPUNIT_TEST( testRefill );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testUnlimited();
+	void testBurst();
+	void testRefill();
+
+  private:
+
+	struct timeval now;
+
+	//! now plus ms
+	struct timeval after(unsigned long ms);
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TokenBucket_Test );
+
+
+void TokenBucket_Test::setUp()
+{
+	now.tv_sec = 1440238800;
+	now.tv_usec = 0;
+}
+
+void TokenBucket_Test::tearDown()
+{
+
+}
+
+struct timeval TokenBucket_Test::after(unsigned long ms)
+{
+	struct timeval t = now;
+	t.tv_sec += ms / 1000;
+	t.tv_usec += (ms % 1000) * 1000;
+	return t;
+}
+
+void TokenBucket_Test::testUnlimited()
+{
+	TokenBucket bucket;
+	CPPUNIT_ASSERT( !bucket.isLimited() );
+
+	for (int i = 0; i < 1000; i++) {
+		CPPUNIT_ASSERT( bucket.take(now) );
+	}
+}
+
+void TokenBucket_Test::testBurst()
+{
+	TokenBucket bucket(10, 5);
+	CPPUNIT_ASSERT( bucket.isLimited() );
+
+	for (int i = 0; i < 5; i++) {
+		CPPUNIT_ASSERT( bucket.take(now) );
+	}
+	CPPUNIT_ASSERT( !bucket.isAvailable(now) );
+	CPPUNIT_ASSERT( !bucket.take(now) );
+
+	// A burst below one token still admits one message.
+	TokenBucket small(10, 0);
+	CPPUNIT_ASSERT( small.getBurst() == 1 );
+	CPPUNIT_ASSERT( small.take(now) );
+	CPPUNIT_ASSERT( !small.take(now) );
+}
+
+void TokenBucket_Test::testRefill()
+{
+	TokenBucket bucket(10, 5);
+
+	for (int i = 0; i < 5; i++) {
+		bucket.take(now);
+	}
+
+	// 10 per second, one every 100 ms.
+	CPPUNIT_ASSERT( !bucket.take(after(50)) );
+	CPPUNIT_ASSERT( bucket.take(after(150)) );
+	CPPUNIT_ASSERT( !bucket.take(after(150)) );
+
+	// Never more than the burst.
+	for (int i = 0; i < 5; i++) {
+		CPPUNIT_ASSERT( bucket.take(after(10000)) );
+	}
+	CPPUNIT_ASSERT( !bucket.take(after(10000)) );
+
+	// A clock going back does not refill.
+	CPPUNIT_ASSERT( !bucket.take(now) );
+}
@@ -0,0 +1,128 @@
+/*
+ * Test the WideIdSource class.
+ *
+ * $Id: WideIdSource_test.cpp 2015-08-04 14:56:00 amarentes $
+ * $HeadURL: https://./test/WideIdSource_test.cpp $
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "WideIdSource.h"
+
+
+using namespace auction;
+
+class WideIdSource_Test : public CppUnit::TestFixture {
+
+	CPPUNIT_TEST_SUITE( WideIdSource_Test );
+
+	CPPUNIT_TEST( testId );
+	CPPUNIT_TEST( testUnique );
+	CPPUNIT_TEST( testExhausted );
+	CPPUNIT_TEST( testWrapped );
+	CPPUNIT_TEST_SUITE_END();
+
+  public:
+	void setUp();
+	void tearDown();
+	void testId();
+	void testUnique();
+	void testExhausted();
+	void testWrapped();
+
+  private:
+
+    WideIdSource *ptrIdSource;
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( WideIdSource_Test );
+
+
+void WideIdSource_Test::setUp()
+{
+	ptrIdSource = new WideIdSource();
+}
+
+void WideIdSource_Test::tearDown()
+{
+	delete(ptrIdSource);
+}
+
+void WideIdSource_Test::testId()
+{
+	// More ids than the 16 bit source can give.
+	for (uint32_t i = 0; i < 70000; i++){
+		CPPUNIT_ASSERT( ptrIdSource->newId() == i );
+	}
+	CPPUNIT_ASSERT( ptrIdSource->getNumUsed() == 70000 );
+
+	ptrIdSource->freeId(10);
+	ptrIdSource->freeId(65536);
+	CPPUNIT_ASSERT( ptrIdSource->isUsed(10) == false );
+	CPPUNIT_ASSERT( ptrIdSource->getNumUsed() == 69998 );
+
+	// Releasing twice does not hand out the id twice.
+	ptrIdSource->freeId(10);
+	CPPUNIT_ASSERT( ptrIdSource->getNumUsed() == 69998 );
+
+	CPPUNIT_ASSERT( ptrIdSource->newId() == 65536 );
+	CPPUNIT_ASSERT( ptrIdSource->newId() == 10 );
+	CPPUNIT_ASSERT( ptrIdSource->newId() == 70000 );
+
+	// Reserved ids are skipped.
+	ptrIdSource->reserveId(70001);
+	CPPUNIT_ASSERT( ptrIdSource->newId() == 70002 );
+}
+
+void WideIdSource_Test::testUnique()
+{
+	WideIdSource uniqueSource(1, 3);
+
+	uint32_t id0 = uniqueSource.newId();
+	uint32_t id1 = uniqueSource.newId();
+	CPPUNIT_ASSERT( id0 == 0 );
+	CPPUNIT_ASSERT( id1 == 1 );
+
+	// Ids are not recycled until the space wraps around.
+	uniqueSource.freeId(id0);
+	CPPUNIT_ASSERT( uniqueSource.newId() == 2 );
+	CPPUNIT_ASSERT( uniqueSource.newId() == 3 );
+	CPPUNIT_ASSERT( uniqueSource.newId() == 0 );
+}
+
+void WideIdSource_Test::testExhausted()
+{
+	WideIdSource smallSource(0, 1);
+
+	smallSource.newId();
+	smallSource.newId();
+
+	CPPUNIT_ASSERT_THROW( smallSource.newId(), Error );
+}
+
+void WideIdSource_Test::testWrapped()
+{
+	// Several levels of words in the space.
+	uint32_t maxId = 100000;
+	WideIdSource uniqueSource(1, maxId);
+
+	for (uint32_t i = 0; i <= maxId; i++){
+		uniqueSource.newId();
+	}
+	CPPUNIT_ASSERT_THROW( uniqueSource.newId(), Error );
+
+	// After the wrap around the free ids are found in order from the last one.
+	uniqueSource.freeId(99000);
+	uniqueSource.freeId(40000);
+	uniqueSource.freeId(31);
+	uniqueSource.freeId(32);
+	CPPUNIT_ASSERT( uniqueSource.newId() == 31 );
+	CPPUNIT_ASSERT( uniqueSource.newId() == 32 );
+	CPPUNIT_ASSERT( uniqueSource.newId() == 40000 );
+
+	uniqueSource.freeId(35000);
+	CPPUNIT_ASSERT( uniqueSource.newId() == 99000 );
+	CPPUNIT_ASSERT( uniqueSource.newId() == 35000 );
+	CPPUNIT_ASSERT( uniqueSource.getNumUsed() == maxId + 1 );
+}
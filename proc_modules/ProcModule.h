@@ -46,10 +46,10 @@
 
 typedef struct
 {
-	string bidSet;
+	auction::InternedString bidSet;
 	string bidName;
 	string elementName;
-	string sessionId;
+	auction::InternedString sessionId;
 	double quantity;
 	double sellPrice;
 } alloc_proc_t;
@@ -205,7 +205,7 @@ createAllocation( auction::fieldDefList_t *fieldDefs, auction::fieldValList_t *f
 	string recordId = "Unique";
 	fillField(fieldDefs, fieldVals, 0, IPAP_FT_IDRECORD, recordId, &elementFields);
 		
-	elements[elementName] = elementFields;
+	elements[elementName].swap(elementFields);
 	
 	// construct the interval with the allocation, based on start datetime 
 	// and interval for the requesting auction
@@ -236,10 +236,12 @@ createAllocation( auction::fieldDefList_t *fieldDefs, auction::fieldValList_t *f
 
 	fillField(fieldDefs, fieldVals, 0, IPAP_FT_IDRECORD, recordId, &optionFields);
 		
-	options.push_back(pair<string, auction::fieldList_t>(elementName, optionFields));
+	options.push_back(pair<string, auction::fieldList_t>(elementName, auction::fieldList_t()));
+	options.back().second.swap(optionFields);
 	
     auction::BiddingObject *alloc = new auction::BiddingObject(auctionSet, auctionName, 
-										allocset, allocname, IPAP_ALLOCATION, elements, options);
+										allocset, allocname, IPAP_ALLOCATION);
+	alloc->takeFields(elements, options);
 
 	// All objects must be inherit the session from the bid.
 	alloc->setSession(sessionId);
@@ -419,10 +421,10 @@ void auction::execute( auction::fieldDefList_t *fieldDefs, auction::fieldValList
 			
 			alloc_proc_t alloc;
 		
-			alloc.bidSet = bid->getSet();
+			alloc.bidSet = bid->getSetHandle();
 			alloc.bidName = bid->getName();
 			alloc.elementName = elem_iter->first;
-			alloc.sessionId = bid->getSession();
+			alloc.sessionId = bid->getSessionHandle();
 			alloc.quantity = quantity;
 			orderedBids.insert(make_pair(price,alloc));
 		}
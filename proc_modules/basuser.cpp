@@ -177,7 +177,8 @@ createBid( auction::fieldDefList_t *fieldDefs, auction::fieldValList_t *fieldVal
 	string bidName = uint32ToString(lid);
 
     bid = new auction::BiddingObject(auct->getSet(), auct->getName(), 
-							bidSet, bidName, IPAP_BID, elements, options);
+							bidSet, bidName, IPAP_BID);
+    bid->takeFields(elements, options);
     
 	return bid;
 
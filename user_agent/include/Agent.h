@@ -33,6 +33,7 @@
 #include <iostream>
 #include "Error.h"
 #include "Logger.h"
+#include "LazyLog.h"
 #include "CommandLineArgs.h"
 #include "ConfigManager.h"
 #include "BiddingObjectManager.h"
@@ -48,6 +49,7 @@
 #include "EventSchedulerAgent.h"
 #include "AgentSessionManager.h"
 #include "AnslpProcessor.h"
+#include "SocketTransport.h"
 #include "anslp_ipap_xml_message.h"
 #include "anslp_ipap_message.h"
 #include "anslp_ipap_exception.h" 
@@ -115,6 +117,27 @@ class Agent
 	//! domain Id for exchanging ipap_messages
 	int domainId;
 
+	//! ms before an unconfirmed message is sent again, 0 disables retransmissions.
+	unsigned long retransmitTimeout;
+
+	//! limit of the retransmission timeout.
+	unsigned long retransmitMaxTimeout;
+
+	//! retransmissions before an unconfirmed message is dropped.
+	unsigned int retransmitRetries;
+
+	//! unconfirmed messages kept per session.
+	unsigned int maxPendingMessages;
+
+	//! ms an ack waits for more messages to acknowledge, 0 acks every message at once.
+	unsigned long ackDelay;
+
+	//! data records of the bidding objects batched in one message to an auctioneer.
+	unsigned int maxMessageRecords;
+
+	//! leave out of the messages the templates the auctioneer confirmed to hold.
+	bool templateReuse;
+
      //! FD list (from AuctionManagerComponent.h)
     fdList_t fdList;
 
@@ -124,6 +147,9 @@ class Agent
     //! 1 if the procedure for applying receiving events from the anslp component runs in a separate thread
     int aprocThread;
 
+    //! anslp socket polled by the main loop, owned by anslpc, NULL if not polled
+    SocketTransport *socketTransport;
+
     //! 1 if remote control interface is enabled
     static int enableCtrl;
 
@@ -251,6 +277,16 @@ class Agent
 	//! handle the removal of a session triggered by the anslp application.
 	void handleRemoveSession(Event *e, fd_sets_t *fds);
 
+	//! schedule the retransmission timer of the session, if it has none.
+	void armRetransmission(AgentSession *session);
+
+	void handleRetransmitMessages(Event *e, fd_sets_t *fds);
+
+	//! schedule the cumulative ack of the session towards the auctioneer, if it has none.
+	void armAck(AgentSession *session, string destination, uint16_t port);
+
+	void handleAcknowledgeMessages(Event *e, fd_sets_t *fds);
+
 
 	void intersectInterval( time_t startDttmAuc, time_t stopDttmAuc, 
 							time_t startDttmReq, time_t stopDttmReq,
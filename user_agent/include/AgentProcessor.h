@@ -30,7 +30,7 @@
 
 
 #include "AuctionManagerComponent.h"
-#include "IdSource.h"
+#include "WideIdSource.h"
 #include "EventScheduler.h"
 #include "ProcModule.h"
 #include "ModuleLoader.h"
@@ -116,7 +116,7 @@ class AgentProcessor : public AuctionManagerComponent, public FieldDefManager
     requestProcessList_t requests;
 
     //! pool of unique request process 
-    IdSource idSource;
+    WideIdSource idSource;
     
     //! identifies uniquely biddings from this agent.
     int domain;
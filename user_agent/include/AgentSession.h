@@ -35,6 +35,10 @@
 namespace auction
 {
 
+//! auctioneer address and port a bidding message went to, by message id
+typedef map<uint32_t, pair<string, uint16_t> > 				messageDestinationList_t;
+typedef map<uint32_t, pair<string, uint16_t> >::iterator 	messageDestinationListIter_t;
+
 
 class AgentSession : public Session
 {
@@ -73,6 +77,17 @@ public:
 	auctionSet_t & getAuctions(void);
 	
 	string getInfo();
+
+	//! keep where the pending message mid went, to send it again there.
+	void setMessageDestination(uint32_t mid, string destination, uint16_t port);
+
+	/*! \short  where the pending message mid went
+		\returns false if it was not set
+	*/
+	bool getMessageDestination(uint32_t mid, string &destination, uint16_t &port);
+
+	//! drop the destinations of the messages no longer pending
+	void forgetConfirmedDestinations();
 	
 protected:
 
@@ -89,6 +104,9 @@ protected:
 	//! Auctions created in this session.
 	auctionSet_t  auctionSet;
 
+	//! destinations of the bidding messages sent.
+	messageDestinationList_t messageDestinations;
+
 private:
 
     Logger *log;
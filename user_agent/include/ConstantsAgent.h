@@ -51,6 +51,10 @@ extern const string AUM_CERT_FILE;
 
 // Agent.h
 extern const string AGNT_LOCK_FILE;
+extern const unsigned long AGNT_RETRANSMIT_TIMEOUT;
+extern const unsigned long AGNT_RETRANSMIT_MAX_TIMEOUT;
+extern const unsigned int AGNT_RETRANSMIT_RETRIES;
+extern const unsigned int AGNT_MAX_PENDING_MESSAGES;
 
 // ResourceRequestFileParser.cpp
 extern const string RESOURCE_FILE_DTD;
@@ -62,7 +62,9 @@ static inline char *noNewline( char* s )
 /* ------------------------- Agent ------------------------- */
 
 Agent::Agent( int argc, char *argv[])
-    :  pprocThread(0)
+    :  retransmitTimeout(0), retransmitMaxTimeout(0), retransmitRetries(0), 
+       maxPendingMessages(0), ackDelay(0), maxMessageRecords(MESSAGE_MAX_RECORDS), 
+       templateReuse(false), pprocThread(0), socketTransport(NULL)
 {
 
     // record start time for later output
@@ -171,7 +173,8 @@ Agent::Agent( int argc, char *argv[])
         // set logging vebosity level if configured
         string verbosity = conf->getValue("VerboseLevel", "MAIN");
         if (!verbosity.empty()) {
-            log->setLogLevel( ParserFcts::parseInt( verbosity, -1, 4 ) );
+            int level = ParserFcts::parseInt( verbosity, -1, 4 );
+            log->setLogLevel( level );
         }
         
 #ifdef DEBUG
@@ -185,6 +188,39 @@ Agent::Agent( int argc, char *argv[])
         string _domainId = conf->getValue("Domain", "MAIN");
 		domainId = ParserFcts::parseInt( _domainId );
 
+		// bidding messages not confirmed in time are sent again, the 
+		// auctioneers drop the ones over their admission rate.
+		string _timeout = conf->getValue("RetransmitTimeout", "MAIN");
+		string _maxTimeout = conf->getValue("RetransmitMaxTimeout", "MAIN");
+		string _retries = conf->getValue("RetransmitRetries", "MAIN");
+		string _maxPending = conf->getValue("MaxPendingMessages", "MAIN");
+
+		retransmitTimeout = (_timeout.empty()) ? AGNT_RETRANSMIT_TIMEOUT 
+											   : ParserFcts::parseULong(_timeout);
+		retransmitMaxTimeout = (_maxTimeout.empty()) ? AGNT_RETRANSMIT_MAX_TIMEOUT 
+													 : ParserFcts::parseULong(_maxTimeout);
+		retransmitRetries = (_retries.empty()) ? AGNT_RETRANSMIT_RETRIES 
+											   : ParserFcts::parseULong(_retries);
+		maxPendingMessages = (_maxPending.empty()) ? AGNT_MAX_PENDING_MESSAGES 
+												   : ParserFcts::parseULong(_maxPending);
+
+		// cumulative acks, the auctioneers must use them too.
+		string _ackDelay = conf->getValue("AckDelay", "MAIN");
+		if (!_ackDelay.empty()) {
+			ackDelay = ParserFcts::parseULong( _ackDelay );
+		}
+
+		string _maxRecords = conf->getValue("MaxMessageRecords", "MAIN");
+		if (!_maxRecords.empty()) {
+			maxMessageRecords = ParserFcts::parseULong( _maxRecords );
+		}
+
+		// the auctioneers and the ipap library must keep the templates of a session.
+		string _templateReuse = conf->getValue("TemplateReuse", "MAIN");
+		if (!_templateReuse.empty()) {
+			templateReuse = (ParserFcts::parseBool( _templateReuse ) == 1);
+		}
+
 		// Verifies Addresses.
 		bool useIPV6 = false;
 		string _uIPV6, _sIPV6, _sIPV4;
@@ -224,16 +260,17 @@ Agent::Agent( int argc, char *argv[])
         if (!_dbName.empty()){
         
 			connectionDb = "dbname=" + _dbName; 
-			connectionDb = connectionDb + "user=" + _dbUser; 
-			connectionDb = connectionDb + "password=" + _dbPassword;
-			connectionDb = connectionDb + "hostaddr=" + _dbIp;
-			connectionDb = connectionDb + "port=" + _dbPort;
+			connectionDb = connectionDb + " user=" + _dbUser; 
+			connectionDb = connectionDb + " password=" + _dbPassword;
+			connectionDb = connectionDb + " hostaddr=" + _dbIp;
+			connectionDb = connectionDb + " port=" + _dbPort;
 		} 
         
         auto_ptr<BiddingObjectManager> _bidm(new BiddingObjectManager(domainId, 
 																	  conf->getValue("FieldDefFile", "MAIN"),
 																	  conf->getValue("FieldConstFile", "MAIN"),
-																	  connectionDb));
+																	  connectionDb,
+																	  conf->getValue("JournalFile", "MAIN")));
         bidm = _bidm;
         
         auto_ptr<AuctionManager> _aucm(new AuctionManager(domainId, 
@@ -316,7 +353,25 @@ Agent::Agent( int argc, char *argv[])
 #ifdef DEBUG
 		log->log(ch,"Anslp client conf file:%s", anslpConfFile.c_str() );
 #endif
-		auto_ptr<AnslpClient> _anslpc(new AnslpClient(anslpConfFile, anslproc->get_fqueue()));
+		// the peer listens on a local socket, the daemon is not started.
+		string socketPath = conf->getValue("AnslpSocket", "MAIN");
+		AnslpClient *client = NULL;
+		if (!socketPath.empty()) {
+			SocketTransport *transport = new SocketTransport(socketPath, 
+									 conf->getValue("AnslpPeerSocket", "MAIN"), 
+									 anslproc->get_fqueue());
+			client = new AnslpClient(transport);
+
+			// without threads the main loop reads the socket.
+			if (transport->getPollFd() >= 0) {
+				socketTransport = transport;
+				fdList[make_fd(transport->getPollFd(), FD_RD)] = NULL;
+			}
+		} else {
+			client = new AnslpClient(anslpConfFile, anslproc->get_fqueue());
+		}
+
+		auto_ptr<AnslpClient> _anslpc(client);
 					
 		anslpc = _anslpc;
 #ifdef DEBUG
@@ -839,8 +894,11 @@ void Agent::handleActivateResourceRequestInterval(Event *e)
 #endif
 			
 			
-			// Add the message as pending for ack.
+			// Add the message as pending for ack, anslp takes care of 
+			// delivering it, so it is not retransmitted.
 			session->addPendingMessage( *mes );
+			session->setRetransmission(retransmitTimeout, retransmitMaxTimeout, 
+									   retransmitRetries, maxPendingMessages);
 			
 			// Store the session as new in the sessionManager
 			asmp->addSession(session);
@@ -944,10 +1002,7 @@ Agent::readAuctionList(ipap_message &message)
 	
 
 #ifdef DEBUG
-		anslp::msg::anslp_ipap_message messagedebug(message);
-		anslp::msg::anslp_ipap_xml_message xmlMesdebug;
-		string xmlMessagedebug = xmlMesdebug.get_message(messagedebug);
-		log->dlog(ch,xmlMessagedebug.c_str() );
+		LazyLog::log(log.get(), ch, LAZY_LOG_DEBUG, IpApXmlFormatter(message));
 #endif
 		
 		// Verifies if the domain is already in the agent template list
@@ -1378,12 +1433,15 @@ void Agent::handleSingleCreateSession(string sessionId, anslp::mspec_rule_key ke
 	try 
 	{	
 
-		ipap_message message = ipap_mes->ip_message;
+		ipap_message &message = ipap_mes->ip_message;
 
 		uint32_t mid = message.get_ackseqno();
 		
 		// Acknowledge the message.
 		session->confirmMessage(mid-1);
+
+		// The auctioneer numbers its messages from this one.
+		session->startReceiving(message.get_seqno());
 		
 		auctions = readAuctionList(message);
 	
@@ -1630,6 +1688,10 @@ Agent::handleTransmitBiddingObjects(Event *e, fd_sets_t *fds)
 		string sessionId = proc->getSession(index);
 		AgentSession *session = reinterpret_cast<AgentSession *>(asmp->getSession(sessionId));
 						
+		// Group the bidding objects by auctioneer, each one gets as few messages as possible.
+		map<pair<string, int>, biddingObjectBatch_t> batches;
+		map<pair<string, int>, biddingObjectBatch_t>::iterator batchIter;
+
 		auctioningObjectDBIter_t iter;
 		for (iter = new_bids->begin(); iter != new_bids->end(); ++iter)
 		{
@@ -1640,43 +1702,69 @@ Agent::handleTransmitBiddingObjects(Event *e, fd_sets_t *fds)
 			
 			a->getConnectionString(sipv4Address, sipv6Address, 
 										iport, ipversion, destinAddr);
-													
-			int domainAuct = ParserFcts::parseInt(a->getSet());
+
+			batches[make_pair(destinAddr, iport)].push_back(make_pair(biddingObject, a));
+		}
+
+		for (batchIter = batches.begin(); batchIter != batches.end(); ++batchIter)
+		{
+			destinAddr = batchIter->first.first;
+			iport = batchIter->first.second;
+
+			// The auctions of an auctioneer share its domain.
+			int domainAuct = ParserFcts::parseInt(batchIter->second.front().second->getSet());
 
 			// Search the domain in the template container
 			agentTemplateListIter_t iterCont = agentTemplates.find(domainAuct);
 			if(iterCont == agentTemplates.end()){
 				throw Error("Auction domain:%d not found in templates container", domainAuct);
 			}
+
+			vector<ipap_message *> messages = bidm->get_ipap_messages(&(batchIter->second), 
+																	  iterCont->second, 
+																	  maxMessageRecords,
+												templateReuse ? &(session->getPeerTemplates()) : NULL);
+			for (size_t i = 0; i < messages.size(); i++)
+			{
+				ipap_message *mes = messages[i];
+
+				uint32_t mid = session->getNextMessageId();
 			
-			uint32_t mid = session->getNextMessageId();
-			
-			ipap_message *mes = bidm->get_ipap_message(biddingObject, a, iterCont->second);
-			mes->set_seqno(mid);
-			mes->set_ackseqno(0);
+				mes->set_seqno(mid);
+				mes->set_ackseqno(0);
+
+				// A pending cumulative ack goes along with the objects.
+				uint32_t ackSeqNo;
+				if ((ackDelay > 0) && session->takeAck(ackSeqNo)) {
+					mes->set_ackseqno(ackSeqNo);
+				}
 			
-			// Save the message within the pending messages.
-			session->addPendingMessage(*mes);
+				// Save the message within the pending messages.
+				session->addPendingMessage(*mes);
+				session->setMessageDestination(mid, destinAddr, iport);
+
+				if (templateReuse) {
+					session->addSentTemplates(mid, mes->get_template_list());
+				}
 			
 #ifdef DEBUG
-			// Activate to see the bidding message to send.
-			anslp::msg::anslp_ipap_xml_message messRes;
-			anslp::msg::anslp_ipap_message ipapMesBid(*mes);
-			string xmlMessage = messRes.get_message(ipapMesBid);
-			log->dlog(ch,"Bidding message: %s", xmlMessage.c_str() );
+				LazyLog::log(log.get(), ch, LAZY_LOG_DEBUG, IpApXmlFormatter(*mes), "Bidding message: ");
 #endif
 			
 			
-			// Finally send the message through the anslp client application.
-			anslpc->tg_bidding( new anslp::session_id(session->getAnlspSession()), 
-								session->getSenderAddress(), destinAddr, 
-								session->getSenderPort(), iport,
-								session->getProtocol(), 
-								*mes );
+				// Finally send the message through the anslp client application.
+				anslpc->tg_bidding( new anslp::session_id(session->getAnlspSession()), 
+									session->getSenderAddress(), destinAddr, 
+									session->getSenderPort(), iport,
+									session->getProtocol(), 
+									*mes );
 			
-			saveDelete(mes);
-
+				saveDelete(mes);
+			}
 		}
+
+		armRetransmission(session);
+
 #ifdef DEBUG
 		log->dlog(ch,"ending handleTransmitBiddingObjects" );
 #endif
@@ -1911,7 +1999,7 @@ void Agent::handleSingleObjectAuctioningInteraction(string sessionId, anslp::ans
 	try {
 
 		assert(ipap_mes != NULL);	
-		ipap_message message = ipap_mes->ip_message;
+		ipap_message &message = ipap_mes->ip_message;
 
 		// Search for the anslp session that is involved.
 		ses = asmp->getAnslpSession(sessionId);		
@@ -1926,31 +2014,39 @@ void Agent::handleSingleObjectAuctioningInteraction(string sessionId, anslp::ans
 		
 		// send the same message arriving, if it is confirming a previous message. 
 		if (ackSeqNbr > 0){
-			session->confirmMessage(ackSeqNbr-1);
+			// A cumulative ack confirms every message before it.
+			if (ackDelay > 0) {
+				session->confirmMessages(ackSeqNbr-1);
+			} else {
+				session->confirmMessage(ackSeqNbr-1);
+			}
 			
 #ifdef DEBUG
 			log->dlog(ch,"Ending handle Auction Interaction" );
 #endif				
 
 		} 
-		else 
-		{
 		
-			int domainBidObj = message.get_domain();
-			// Search the domain in the template container
-			agentTemplateListIter_t iterCont = agentTemplates.find(domainBidObj);
-			if(iterCont == agentTemplates.end()){
-				throw Error("Bidding Object domain:%d not found in templates container", domainBidObj);
-			}
-			
-			bids = bidm->parseMessage(&message,iterCont->second);
-			
-			// Add the bidding objects to the bidding object manager.
-			bidm->addAuctioningObjects(bids, evnt.get());  
-																
+		// The objects may come along with an ack, whatever mode the peer uses.
+		// A retransmission, the objects are in but the ack may have been lost.
+		bool duplicate = session->wasReceived(seqNbr);
+	
+		int domainBidObj = message.get_domain();
+		// Search the domain in the template container
+		agentTemplateListIter_t iterCont = agentTemplates.find(domainBidObj);
+		if(iterCont == agentTemplates.end()){
+			throw Error("Bidding Object domain:%d not found in templates container", domainBidObj);
+		}
+		
+		bids = bidm->parseMessage(&message,iterCont->second);
+		
+		// Objects not taken by the manager are released here.
+		bool taken = false;
+		bool reply = false;
+		
+		try {
 			// If the number of bids is greater than zero, then take the first bidding object
-			// to find the replying address.
-			
+			// to find the replying address, before the manager may drop it.
 			if ( bids->size() > 0 ){
 				auctioningObjectDBIter_t iter = bids->begin();
 				
@@ -1970,37 +2066,182 @@ void Agent::handleSingleObjectAuctioningInteraction(string sessionId, anslp::ans
 				
 				a->getConnectionString(sipv4Address, sipv6Address, 
 										iport, ipversion, destinAddr);
-																
+				reply = true;
+			}
+			
+			// Add the bidding objects to the bidding object manager, it 
+			// releases the ones it refuses.
+			if (!duplicate) {
+				taken = true;
+				bidm->addAuctioningObjects(bids, evnt.get());  
+			}
+		} catch (Error &err) {
+			log->elog( ch, err.getError().c_str() );
+		}
+
+		// Acks take a number too, so every message counts for the 
+		// cumulative ack, but only the ones with objects are acknowledged.
+		// A retransmission is acknowledged again, its ack may have been lost.
+		session->messageReceived(seqNbr);
+															
+		if (reply){
+			// The ack goes later, along with the ones of the messages arriving meanwhile.
+			if (ackDelay > 0) {
+				armAck(session, destinAddr, iport);
+			} else {
 				// Build the response for the originator agent.
 				ipap_message conf = ipap_message(domainId, IPAP_VERSION, true);
 				conf.set_seqno(session->getNextMessageId());
 				conf.set_ackseqno(seqNbr+1);
 				conf.output();
-							
+						
 				// Finally send the message through the anslp client application.
 				anslpc->tg_bidding( new anslp::session_id(session->getAnlspSession()), 
 									session->getSenderAddress(), destinAddr, 
 									session->getSenderPort(), iport,
 									session->getProtocol(), 
 									conf );
-			
-			}		
-			
-			bids->erase(bids->begin(), bids->end());
-			saveDelete(bids);
+			}
+		
+		}		
+		
+		// Retransmitted objects or the ones of a failing message are not in the manager.
+		if (!taken) {
+			auctioningObjectDBIter_t iter;
+			for (iter = bids->begin(); iter != bids->end(); ++iter) {
+				saveDelete(*iter);
+			}
+		}
+		
+		bids->erase(bids->begin(), bids->end());
+		saveDelete(bids);
 
-			
+		
 #ifdef DEBUG
-			log->dlog(ch,"Ending handle Auction Interaction" );
+		log->dlog(ch,"Ending handle Auction Interaction" );
 #endif
-			
-		}
+		
 	} catch (Error &err){
 		log->elog( ch, err.getError().c_str() );
 	}
 
 }
 
+/* -------------------- armRetransmission -------------------- */
+
+void Agent::armRetransmission(AgentSession *session)
+{
+	struct timeval when;
+
+	// One timer per session, it is armed again when it fires.
+	if (!session->isRetransmitArmed() && session->getNextRetransmission(when)) {
+		evnt->addEvent(new RetransmitMessagesEvent(when, session->getAnlspSession()));
+		session->setRetransmitArmed(true);
+	}
+}
+
+
+/* -------------------- handleRetransmitMessages -------------------- */
+
+void Agent::handleRetransmitMessages(Event *e, fd_sets_t *fds)
+{
+	string sessionId = ((RetransmitMessagesEvent *)e)->getSessionId();
+
+	// It may have been removed since the timer was armed.
+	AgentSession *session = reinterpret_cast<AgentSession *>(
+								asmp->getAnslpSession(sessionId));
+	if (session == NULL) {
+		return;
+	}
+
+	session->setRetransmitArmed(false);
+
+	struct timeval now;
+	gettimeofday(&now, NULL);
+
+	vector<ipap_message *> due;
+	vector<uint32_t> expired;
+	session->getRetransmissions(now, due, expired);
+
+	for (vector<uint32_t>::iterator iter = expired.begin(); iter != expired.end(); ++iter) {
+		log->wlog(ch, "Message %u of session %s not confirmed, dropped", 
+				  *iter, sessionId.c_str());
+	}
+
+	// The auctioneer may have lost the session state, templates go again.
+	if (!expired.empty()) {
+		session->resetPeerTemplates();
+	}
+
+	for (vector<ipap_message *>::iterator iter = due.begin(); iter != due.end(); ++iter) {
+		string destinAddr;
+		uint16_t iport;
+		if (!session->getMessageDestination((*iter)->get_seqno(), destinAddr, iport)) {
+			continue;
+		}
+
+		anslpc->tg_bidding( new anslp::session_id(session->getAnlspSession()), 
+							session->getSenderAddress(), destinAddr, 
+							session->getSenderPort(), iport,
+							session->getProtocol(), 
+							**iter );
+	}
+
+#ifdef DEBUG
+	log->dlog(ch, "Retransmitted %d messages of session %s", 
+			  (int) due.size(), sessionId.c_str());
+#endif
+
+	session->forgetConfirmedDestinations();
+	armRetransmission(session);
+}
+
+
+/* -------------------- armAck -------------------- */
+
+void Agent::armAck(AgentSession *session, string destination, uint16_t port)
+{
+	// Messages arriving before it fires share the ack.
+	if (!session->isAckArmed()) {
+		evnt->addEvent(new AcknowledgeMessagesEvent(session->getAnlspSession(), ackDelay,
+													destination, port));
+		session->setAckArmed(true);
+	}
+}
+
+
+/* -------------------- handleAcknowledgeMessages -------------------- */
+
+void Agent::handleAcknowledgeMessages(Event *e, fd_sets_t *fds)
+{
+	AcknowledgeMessagesEvent *ack = (AcknowledgeMessagesEvent *) e;
+
+	AgentSession *session = reinterpret_cast<AgentSession *>(
+								asmp->getAnslpSession(ack->getSessionId()));
+	if (session == NULL) {
+		return;
+	}
+
+	session->setAckArmed(false);
+
+	uint32_t ackSeqNo;
+	if (!session->takeAck(ackSeqNo)) {
+		return;
+	}
+
+	ipap_message conf = ipap_message(domainId, IPAP_VERSION, true);
+	conf.set_seqno(session->getNextMessageId());
+	conf.set_ackseqno(ackSeqNo);
+	conf.output();
+
+	anslpc->tg_bidding( new anslp::session_id(session->getAnlspSession()), 
+						session->getSenderAddress(), ack->getDestination(), 
+						session->getSenderPort(), ack->getPort(),
+						session->getProtocol(), 
+						conf );
+}
+
+
 void Agent::handleAuctioningInteraction(Event *e, fd_sets_t *fds)
 {
 
@@ -2135,6 +2376,14 @@ void Agent::handleEvent(Event *e, fd_sets_t *fds)
     case REMOVE_SESSION:
 		handleRemoveSession(e,fds);
 		break;
+
+	case RETRANSMIT_MESSAGES:
+		handleRetransmitMessages(e,fds);
+		break;
+
+	case ACKNOWLEDGE_MESSAGES:
+		handleAcknowledgeMessages(e,fds);
+		break;
 	  
     default:
 #ifdef DEBUG
@@ -2272,6 +2521,11 @@ void Agent::run()
 				proc->handleFDEvent(&retEvents, NULL,NULL, NULL);
             }
 			
+			// without threads the anslp socket is read here.
+			if (socketTransport != NULL) {
+				socketTransport->receive();
+			}
+
 			if (!aprocThread) {
 				anslproc->handleFDEvent(&retEvents, NULL,NULL, NULL);
 			}
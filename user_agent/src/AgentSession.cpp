@@ -103,3 +103,32 @@ auctionSet_t & AgentSession::getAuctions(void)
 {
 	return auctionSet;
 }
+
+void AgentSession::setMessageDestination(uint32_t mid, string destination, uint16_t port)
+{
+	messageDestinations[mid] = make_pair(destination, port);
+}
+
+bool AgentSession::getMessageDestination(uint32_t mid, string &destination, uint16_t &port)
+{
+	messageDestinationListIter_t iter = messageDestinations.find(mid);
+	if (iter == messageDestinations.end()) {
+		return false;
+	}
+	
+	destination = (iter->second).first;
+	port = (iter->second).second;
+	return true;
+}
+
+void AgentSession::forgetConfirmedDestinations()
+{
+	messageDestinationListIter_t iter = messageDestinations.begin();
+	while (iter != messageDestinations.end()) {
+		if (pendingMessages.find(iter->first) == pendingMessages.end()) {
+			messageDestinations.erase(iter++);
+		} else {
+			++iter;
+		}
+	}
+}
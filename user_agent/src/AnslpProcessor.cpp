@@ -91,11 +91,7 @@ void AnslpProcessor::process(eventVec_t *e, AnslpEvent *evt)
 		string sessionId = ase->getSession();
 		auction::CreateSessionEvent *retEvent = new auction::CreateSessionEvent(sessionId, ase->getQueue());
 		
-		anslp::objectList_t *objects = ase->getObjects();
-		anslp::objectListIter_t it;
-		for (it = objects->begin(); it != objects->end(); ++it){
-			retEvent->setObject(it->first, it->second->copy());
-		}
+		moveObjects(ase->getObjects(), retEvent);
 		
 		e->push_back(retEvent);	
 		
@@ -142,11 +138,7 @@ void AnslpProcessor::process(eventVec_t *e, AnslpEvent *evt)
 		string sessionId = rse->getSession();
 		RemoveSessionEvent *retEvent = new auction::RemoveSessionEvent(sessionId, rse->getQueue());
 		
-		anslp::objectList_t *objects = rse->getObjects();
-		anslp::objectListIter_t it;
-		for (it = objects->begin(); it != objects->end(); ++it){
-			retEvent->setObject(it->first,it->second->copy());
-		}
+		moveObjects(rse->getObjects(), retEvent);
 		
 		e->push_back(retEvent);	
 			
@@ -166,11 +158,7 @@ void AnslpProcessor::process(eventVec_t *e, AnslpEvent *evt)
 		string sessionId = aie->getSession();
 		auction::AuctionInteractionEvent *retEvent = new auction::AuctionInteractionEvent(sessionId);
 
-		anslp::objectList_t *objects = aie->getObjects();
-		anslp::objectListIter_t it;
-		for (it = objects->begin(); it != objects->end(); ++it){
-			retEvent->setObject(it->first, it->second->copy());
-		}
+		moveObjects(aie->getObjects(), retEvent);
 
 
 		e->push_back(retEvent);	
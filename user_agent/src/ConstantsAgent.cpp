@@ -37,6 +37,14 @@ namespace auction
 // Agent.h
 const string AGNT_DEFAULT_CONFIG_FILE = DEF_SYSCONFDIR "/netagnt.conf.xml";
 const string AGNT_LOCK_FILE			  = DEF_SYSCONFDIR "/netagent.pid";
+// milliseconds before an unconfirmed message is sent again, doubled on every retry
+const unsigned long AGNT_RETRANSMIT_TIMEOUT = 2000;
+// limit of the retransmission timeout in milliseconds
+const unsigned long AGNT_RETRANSMIT_MAX_TIMEOUT = 60000;
+// retransmissions before an unconfirmed message is dropped
+const unsigned int AGNT_RETRANSMIT_RETRIES = 5;
+// unconfirmed messages kept per session
+const unsigned int AGNT_MAX_PENDING_MESSAGES = 256;
 
 // CtrlComm.cpp
 const string AGNT_REPLY_TEMPLATE  = DEF_SYSCONFDIR "/reply.xml";   //!< html response template
@@ -314,12 +314,12 @@ void ResourceRequestManager::delResourceRequest(string sname, string rname, Even
 void ResourceRequestManager::delResourceRequests(string sname, EventScheduler *e)
 {
     
-	auctioningObjectIndex_t *objects = getAuctioningObjects(sname);
+	auctioningObjectIndex_t objects = getAuctioningObjects(sname);
 	auctioningObjectIndexIter_t iter;
 	
-    for (auctioningObjectIndexIter_t i = objects->begin(); i != objects->end(); i++) 
+    for (auctioningObjectIndexIter_t i = objects.begin(); i != objects.end(); i++) 
     {						
-        ResourceRequest *r = dynamic_cast<ResourceRequest *>(getAuctioningObject(sname, i->first));
+        ResourceRequest *r = dynamic_cast<ResourceRequest *>(getAuctioningObject(i->second));
         delResourceRequest(r,e);
     }
     
@@ -396,11 +396,11 @@ string ResourceRequestManager::getInfo(string sname)
 
     ostringstream s;
 
-	auctioningObjectIndex_t *objects = getAuctioningObjects(sname);
+	auctioningObjectIndex_t objects = getAuctioningObjects(sname);
 	auctioningObjectIndexIter_t iter;
 
-    for (auctioningObjectIndexIter_t i = objects->begin(); i != objects->end(); i++) {						
-        ResourceRequest *r = dynamic_cast<ResourceRequest *>(getAuctioningObject(sname, i->first));
+    for (auctioningObjectIndexIter_t i = objects.begin(); i != objects.end(); i++) {						
+        ResourceRequest *r = dynamic_cast<ResourceRequest *>(getAuctioningObject(i->second));
         s << r->getInfo();
     }
     